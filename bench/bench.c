@@ -0,0 +1,770 @@
+/*
+ * bench.c - End-to-end and per-phase benchmark (run with `make bench`)
+ *
+ * Times lexer_tokenize(), parser_parse() and formatter_format() on their
+ * own and the whole pipeline together, over the given files and a
+ * generated synthetic corpus. A sample times enough back-to-back runs to
+ * last at least --min-sample-ms; each measurement is repeated after a
+ * few warmup samples and reported per run as median and 95th
+ * percentile, with MB/s, tokens/s, nodes/s and the allocations of one
+ * run. Built with the counting allocator, so allocation figures are
+ * always available. Where the machine offers hardware counters
+ * (perf_counters.c), cycles, instructions, cache misses and branch
+ * mispredictions of the median sample are reported per input MB.
+ */
+#define _GNU_SOURCE
+#include "../include/lexer.h"
+#include "../include/parser.h"
+#include "../include/formatter.h"
+#include "../include/sink.h"
+#include "../include/json.h"
+#include "../include/utils.h"
+#include "../include/stats.h"
+#include "../tools/corpus.h"
+#include "perf_counters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#define DEFAULT_WARMUP 3
+#define DEFAULT_REPETITIONS 15
+#define DEFAULT_MIN_SAMPLE_MS 10.0
+#define MAX_BATCH 1000000
+#define DEFAULT_SYNTHETIC_BYTES (1024 * 1024)
+#define MAX_REPETITIONS 1000
+
+/*
+ * Benchmark input
+ * Source text with the tokens and tree built once, so single phases
+ * can be timed on their own
+ */
+typedef struct BenchInput {
+	const char *name;
+	char *source;
+	size_t length;
+
+	Lexer *lexer;
+	Parser *parser;
+	ASTNode *ast;
+	int tokens;
+	unsigned long nodes;
+	size_t output_length;  /* Formatted size (checked on every run) */
+} BenchInput;
+
+/*
+ * Phase result
+ * Times in seconds per run; allocation counts are those of one run, each
+ * hardware counter is the median over the samples, and the resident set
+ * peak is that of this measurement alone (the prepared input included)
+ */
+typedef struct BenchResult {
+	double median;
+	double p95;
+	double samples[MAX_REPETITIONS];  /* Every sample, in run order */
+	int sample_count;
+	int batch;  /* Runs timed together as one sample */
+	long peak_rss_kb;  /* Peak resident set while measured, or -1 */
+	StatsTotals memory;
+	PerfSample counters;
+} BenchResult;
+
+typedef int (*BenchFn)(BenchInput *input);
+
+typedef struct BenchPhase {
+	const char *name;
+	BenchFn run;
+} BenchPhase;
+
+static int run_lex(BenchInput *input);
+static int run_parse(BenchInput *input);
+static int run_format(BenchInput *input);
+static int run_total(BenchInput *input);
+
+static const BenchPhase phases[] = {
+	{"lex", run_lex},
+	{"parse", run_parse},
+	{"format", run_format},
+	{"total", run_total}
+};
+
+#define PHASE_COUNT ((int)(sizeof(phases) / sizeof(phases[0])))
+
+/*
+ * now - Monotonic time
+ *
+ * Return: Seconds
+ */
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/*
+ * count_node - Walker callback counting nodes
+ */
+static ASTWalkAction count_node(ASTNode *node, int depth, void *ctx)
+{
+	(void)node;
+	(void)depth;
+
+	(*(unsigned long *)ctx)++;
+	return (AST_WALK_CONTINUE);
+}
+
+/*
+ * format_tree - Format a parsed input into a memory sink
+ * @lexer: Tokens of the source
+ * @parser: Parser that built @ast (owns the comments)
+ * @ast: Syntax tree
+ * @source: Source text
+ * @length: Length of @source
+ * @output_length: Set to the size of the output
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int format_tree(Lexer *lexer, Parser *parser, ASTNode *ast,
+		       const char *source, size_t length,
+		       size_t *output_length)
+{
+	OutputSink *sink = sink_create_memory();
+	Formatter *formatter = formatter_create(sink);
+	char *output;
+	int result = -1;
+
+	if (formatter)
+	{
+		formatter_set_source(formatter, lexer_get_tokens(lexer),
+				     lexer_get_token_count(lexer));
+		formatter_set_comments(formatter, parser->comments);
+		formatter_set_source_slices(formatter, source, length);
+		result = formatter_format(formatter, ast);
+		formatter_destroy(formatter);
+	}
+
+	if (result == 0)
+		result = sink_flush(sink);
+	output = result == 0 ? sink_take_buffer(sink, output_length) : NULL;
+	if (!output)
+		result = -1;
+	mem_free(output);
+	sink_destroy(sink);
+
+	return (result);
+}
+
+/*
+ * run_lex - Tokenize the source
+ */
+static int run_lex(BenchInput *input)
+{
+	Lexer *lexer = lexer_create(input->source);
+	int result = lexer && lexer_tokenize(lexer) >= 0 ? 0 : -1;
+
+	lexer_destroy(lexer);
+	return (result);
+}
+
+/*
+ * run_parse - Parse the prepared tokens
+ */
+static int run_parse(BenchInput *input)
+{
+	Parser *parser = parser_create(lexer_get_tokens(input->lexer),
+				       lexer_get_token_count(input->lexer));
+	ASTNode *ast = parser ? parser_parse(parser) : NULL;
+	int result = ast ? 0 : -1;
+
+	ast_node_destroy(ast);
+	parser_destroy(parser);
+	return (result);
+}
+
+/*
+ * run_format - Format the prepared tree
+ */
+static int run_format(BenchInput *input)
+{
+	size_t length = 0;
+
+	if (format_tree(input->lexer, input->parser, input->ast,
+			input->source, input->length, &length) != 0)
+		return (-1);
+
+	return (length == input->output_length ? 0 : -1);
+}
+
+/*
+ * run_total - Lex, parse and format from scratch
+ */
+static int run_total(BenchInput *input)
+{
+	Lexer *lexer = lexer_create(input->source);
+	Parser *parser = NULL;
+	ASTNode *ast = NULL;
+	size_t length = 0;
+	int result = -1;
+
+	if (lexer && lexer_tokenize(lexer) >= 0)
+		parser = parser_create(lexer_get_tokens(lexer),
+				       lexer_get_token_count(lexer));
+	if (parser)
+		ast = parser_parse(parser);
+	if (ast)
+		result = format_tree(lexer, parser, ast, input->source,
+				     input->length, &length);
+
+	ast_node_destroy(ast);
+	parser_destroy(parser);
+	lexer_destroy(lexer);
+
+	return (result == 0 && length == input->output_length ? 0 : -1);
+}
+
+/*
+ * prepare_input - Build the tokens and tree of an input
+ * @input: Input with its source set
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int prepare_input(BenchInput *input)
+{
+	ASTVisitor counter = {count_node, NULL, NULL};
+
+	input->length = strlen(input->source);
+	input->lexer = lexer_create(input->source);
+	if (!input->lexer || lexer_tokenize(input->lexer) < 0)
+		return (-1);
+	input->tokens = lexer_get_token_count(input->lexer);
+
+	input->parser = parser_create(lexer_get_tokens(input->lexer),
+				      input->tokens);
+	input->ast = input->parser ? parser_parse(input->parser) : NULL;
+	if (!input->ast)
+		return (-1);
+
+	counter.ctx = &input->nodes;
+	if (ast_walk(input->ast, &counter, 1) < 0)
+		return (-1);
+
+	return (format_tree(input->lexer, input->parser, input->ast,
+			    input->source, input->length,
+			    &input->output_length));
+}
+
+/*
+ * release_input - Free an input's source, tokens and tree
+ * @input: Input to release
+ */
+static void release_input(BenchInput *input)
+{
+	ast_node_destroy(input->ast);
+	parser_destroy(input->parser);
+	lexer_destroy(input->lexer);
+	free(input->source);
+}
+
+/*
+ * synthetic_source - Generate a C file of roughly the requested size
+ * @bytes: Target size
+ *
+ * The default tools/gen_corpus mix with seed 1: documented functions
+ * with nested control flow, structs, typedefs, function pointers,
+ * preprocessor blocks and initializers, about half of them with the
+ * spacing squeezed out. The text only depends on @bytes.
+ *
+ * Return: NUL-terminated source, or NULL on allocation failure
+ */
+static char *synthetic_source(size_t bytes)
+{
+	CorpusOptions opts;
+	char *source;
+
+	corpus_defaults(&opts);
+	opts.bytes = bytes;
+	if (corpus_generate(&opts, &source, NULL) != 0)
+		return (NULL);
+
+	return (source);
+}
+
+/*
+ * compare_times - qsort comparator for doubles
+ */
+static int compare_times(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return ((x > y) - (x < y));
+}
+
+/* Largest peak resident set seen, across resets */
+static long run_peak_kb;
+
+/*
+ * peak_rss_kb - Peak resident set size of the process
+ *
+ * The peak since the last reset_peak_rss() where Linux offers one
+ * (VmHWM), else since the process started.
+ *
+ * Return: Kilobytes
+ */
+static long peak_rss_kb(void)
+{
+	struct rusage usage;
+	char line[128];
+	long peak = -1;
+	FILE *fp = fopen("/proc/self/status", "r");
+
+	while (fp && peak < 0 && fgets(line, sizeof(line), fp))
+		if (strncmp(line, "VmHWM:", 6) == 0)
+			peak = atol(line + 6);
+	if (fp)
+		fclose(fp);
+	if (peak < 0)
+		peak = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+
+	if (peak > run_peak_kb)
+		run_peak_kb = peak;
+	return (peak);
+}
+
+/*
+ * reset_peak_rss - Lower the peak resident set to the current one
+ *
+ * Writing 5 to /proc/self/clear_refs resets VmHWM (Linux 4.0 on), so
+ * each measurement gets its own peak instead of the largest so far.
+ *
+ * Return: 0 on success, -1 if the peak cannot be reset
+ */
+static int reset_peak_rss(void)
+{
+	FILE *fp;
+
+	/* Keep the peak being dropped for the whole run's figure */
+	peak_rss_kb();
+	fp = fopen("/proc/self/clear_refs", "w");
+
+	if (!fp)
+		return (-1);
+	if (fputs("5", fp) < 0)
+	{
+		fclose(fp);
+		return (-1);
+	}
+	return (fclose(fp) == 0 ? 0 : -1);
+}
+
+/*
+ * run_batch - Run a phase several times in a row
+ * @input: Prepared input
+ * @phase: Phase to run
+ * @batch: Number of runs
+ *
+ * Return: 0 on success, -1 if a run failed
+ */
+static int run_batch(BenchInput *input, const BenchPhase *phase, int batch)
+{
+	int i;
+
+	for (i = 0; i < batch; i++)
+		if (phase->run(input) != 0)
+			return (-1);
+
+	return (0);
+}
+
+/*
+ * calibrate - Number of runs that take at least the minimum sample time
+ * @input: Prepared input
+ * @phase: Phase to run
+ * @min_sample: Minimum time of a sample, in seconds
+ *
+ * A small input formats in microseconds, where the clock and a stray
+ * interrupt are a large part of one run's time; timing a batch of runs
+ * as one sample keeps every sample well above that noise.
+ *
+ * Return: Runs per sample, or -1 if a run failed
+ */
+static int calibrate(BenchInput *input, const BenchPhase *phase,
+		     double min_sample)
+{
+	double start, elapsed;
+	int batch = 1;
+
+	for (;;)
+	{
+		start = now();
+		if (run_batch(input, phase, batch) != 0)
+			return (-1);
+		elapsed = now() - start;
+		if (elapsed >= min_sample || batch >= MAX_BATCH)
+			return (batch);
+		if (elapsed * 4 < min_sample)
+			batch *= 4;
+		else
+			batch = (int)(batch * min_sample / elapsed) + 1;
+		if (batch > MAX_BATCH)
+			batch = MAX_BATCH;
+	}
+}
+
+/*
+ * measure - Time one phase on one input
+ * @input: Prepared input
+ * @phase: Phase to run
+ * @warmup: Untimed samples first
+ * @repetitions: Timed samples
+ * @min_sample: Minimum time of a sample, in seconds
+ * @counters: Hardware counters read around each sample, or NULL
+ * @result: Filled with the timings, allocations and counts
+ *
+ * Each sample times a batch of runs (see calibrate()) and records the
+ * time per run.
+ *
+ * Return: 0 on success, -1 if a run failed
+ */
+static int measure(BenchInput *input, const BenchPhase *phase, int warmup,
+		   int repetitions, double min_sample, PerfCounters *counters,
+		   BenchResult *result)
+{
+	double times[MAX_REPETITIONS];
+	double counts[PERF_COUNTER_COUNT][MAX_REPETITIONS];
+	PerfSample sample;
+	int batch, can_reset, i, c;
+
+	result->peak_rss_kb = -1;
+	can_reset = reset_peak_rss() == 0;
+	batch = calibrate(input, phase, min_sample);
+	if (batch < 0)
+		return (-1);
+	result->batch = batch;
+
+	for (i = 0; i < warmup; i++)
+		if (run_batch(input, phase, batch) != 0)
+			return (-1);
+
+	memset(&result->counters, 0, sizeof(result->counters));
+	for (c = 0; c < PERF_COUNTER_COUNT; c++)
+		result->counters.valid[c] = counters != NULL;
+
+	for (i = 0; i < repetitions; i++)
+	{
+		double start;
+
+		if (counters)
+			perf_counters_start(counters);
+		start = now();
+		if (run_batch(input, phase, batch) != 0)
+			return (-1);
+		times[i] = (now() - start) / batch;
+		if (counters)
+		{
+			perf_counters_stop(counters, &sample);
+			for (c = 0; c < PERF_COUNTER_COUNT; c++)
+			{
+				counts[c][i] = sample.values[c] / batch;
+				result->counters.valid[c] &= sample.valid[c];
+			}
+		}
+		result->samples[i] = times[i];
+	}
+	result->sample_count = repetitions;
+
+	/* Allocations of one run, outside the timed samples */
+	stats_reset();
+	if (phase->run(input) != 0)
+		return (-1);
+	stats_totals(&result->memory);
+	if (can_reset)
+		result->peak_rss_kb = peak_rss_kb();
+
+	for (c = 0; c < PERF_COUNTER_COUNT && counters; c++)
+	{
+		qsort(counts[c], repetitions, sizeof(double), compare_times);
+		result->counters.values[c] = counts[c][repetitions / 2];
+	}
+
+	qsort(times, repetitions, sizeof(double), compare_times);
+	result->median = repetitions % 2 ? times[repetitions / 2] :
+		(times[repetitions / 2 - 1] + times[repetitions / 2]) / 2;
+	result->p95 = times[(repetitions * 95 + 99) / 100 - 1];
+
+	return (0);
+}
+
+/*
+ * rate - Items per second at a given time
+ */
+static double rate(double items, double seconds)
+{
+	return (seconds > 0 ? items / seconds : 0.0);
+}
+
+/*
+ * print_row - Print one result as a table row
+ * @input: Input
+ * @phase: Phase
+ * @result: Its measurements
+ * @with_counters: Add the hardware counter columns
+ */
+static void print_row(const BenchInput *input, const BenchPhase *phase,
+		      const BenchResult *result, int with_counters)
+{
+	/* Cycles and instructions in millions per MB, misses in thousands */
+	static const double units[PERF_COUNTER_COUNT] = {1e6, 1e6, 1e3, 1e3,
+							  1e3};
+	const PerfSample *counts = &result->counters;
+	double megabytes = input->length / 1e6;
+	int i;
+
+	printf("%-28s %-7s %9.3f %9.3f %8.2f %8.2f %8.2f %9lu",
+	       input->name, phase->name, result->median * 1e3,
+	       result->p95 * 1e3,
+	       rate(input->length / 1e6, result->median),
+	       rate(input->tokens / 1e6, result->median),
+	       rate(input->nodes / 1e6, result->median),
+	       result->memory.allocs);
+	if (result->peak_rss_kb >= 0)
+		printf(" %8ld", result->peak_rss_kb);
+	else
+		printf(" %8s", "-");
+
+	for (i = 0; with_counters && i < PERF_COUNTER_COUNT; i++)
+	{
+		if (counts->valid[i])
+			printf(" %8.1f", counts->values[i] / units[i] / megabytes);
+		else
+			printf(" %8s", "-");
+		if (i != PERF_INSTRUCTIONS)
+			continue;
+
+		/* Instructions per cycle follows the instructions */
+		if (counts->valid[PERF_CYCLES] && counts->valid[PERF_INSTRUCTIONS] &&
+		    counts->values[PERF_CYCLES] > 0)
+			printf(" %5.2f", counts->values[PERF_INSTRUCTIONS] /
+			       counts->values[PERF_CYCLES]);
+		else
+			printf(" %5s", "-");
+	}
+	putchar('\n');
+}
+
+/*
+ * write_row - Write one result as a JSON object
+ */
+static void write_row(FILE *fp, int first, const BenchInput *input,
+		      const BenchPhase *phase, const BenchResult *result)
+{
+	int i, counted = 0;
+
+	fputs(first ? "\n    {\"input\":" : ",\n    {\"input\":", fp);
+	json_write_string(fp, input->name, strlen(input->name));
+	fprintf(fp, ",\"phase\":\"%s\",\"bytes\":%lu,\"tokens\":%d,\"nodes\":%lu,"
+		"\"median_ms\":%.6f,\"p95_ms\":%.6f,"
+		"\"mb_per_s\":%.3f,\"tokens_per_s\":%.0f,\"nodes_per_s\":%.0f,"
+		"\"allocations\":%lu,\"alloc_bytes\":%lu,\"peak_bytes\":%lu",
+		phase->name, (unsigned long)input->length, input->tokens, input->nodes,
+		result->median * 1e3, result->p95 * 1e3,
+		rate(input->length / 1e6, result->median),
+		rate(input->tokens, result->median),
+		rate(input->nodes, result->median),
+		result->memory.allocs, (unsigned long)result->memory.bytes,
+		(unsigned long)result->memory.peak);
+	if (result->peak_rss_kb >= 0)
+		fprintf(fp, ",\"peak_rss_kb\":%ld", result->peak_rss_kb);
+
+	/* Kept for the statistical tests of bench_compare */
+	fprintf(fp, ",\"batch\":%d,\"samples_ms\":[", result->batch);
+	for (i = 0; i < result->sample_count; i++)
+		fprintf(fp, i ? ",%.6f" : "%.6f", result->samples[i] * 1e3);
+	fputs("]", fp);
+
+	/* Hardware counts (median over the runs) per input MB */
+	for (i = 0; i < PERF_COUNTER_COUNT; i++)
+	{
+		if (!result->counters.valid[i])
+			continue;
+		fprintf(fp, "%s\"%s\":%.1f", counted ? "," : ",\"per_mb\":{",
+			perf_counter_name(i), result->counters.values[i] /
+			(input->length / 1e6));
+		counted++;
+	}
+	fputs(counted ? "}}" : "}", fp);
+}
+
+/*
+ * usage - Print command line help
+ */
+static void usage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [--warmup N] [--reps N] [--min-sample-ms MS]"
+		" [--synthetic BYTES] [--json FILE] [--label TEXT]"
+		" [--no-counters] [files...]\n", program);
+}
+
+/*
+ * main - Run the benchmark
+ * @argc: Argument count
+ * @argv: Options and input files
+ *
+ * Return: 0 on success, 1 on error
+ */
+int main(int argc, char **argv)
+{
+	int warmup = DEFAULT_WARMUP, repetitions = DEFAULT_REPETITIONS;
+	long synthetic = DEFAULT_SYNTHETIC_BYTES;
+	double min_sample_ms = DEFAULT_MIN_SAMPLE_MS;
+	const char *json_path = NULL, *label = "";
+	BenchInput *inputs;
+	PerfCounters hardware, *counters = NULL;
+	FILE *json = NULL;
+	int input_count = 0, i, p, first = 1, status = 0, use_counters = 1;
+
+	inputs = calloc(argc + 1, sizeof(BenchInput));
+	if (!inputs)
+		return (1);
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+			warmup = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+			repetitions = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--min-sample-ms") == 0 && i + 1 < argc)
+			min_sample_ms = atof(argv[++i]);
+		else if (strcmp(argv[i], "--synthetic") == 0 && i + 1 < argc)
+			synthetic = atol(argv[++i]);
+		else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			json_path = argv[++i];
+		else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc)
+			label = argv[++i];
+		else if (strcmp(argv[i], "--no-counters") == 0)
+			use_counters = 0;
+		else if (argv[i][0] == '-')
+		{
+			usage(argv[0]);
+			free(inputs);
+			return (1);
+		}
+		else
+		{
+			inputs[input_count].name = argv[i];
+			inputs[input_count].source = read_file(argv[i]);
+			if (!inputs[input_count].source)
+			{
+				fprintf(stderr, "Error: Could not read '%s'\n",
+					argv[i]);
+				status = 1;
+				break;
+			}
+			input_count++;
+		}
+	}
+	if (repetitions < 1 || repetitions > MAX_REPETITIONS || warmup < 0 ||
+	    min_sample_ms < 0)
+	{
+		usage(argv[0]);
+		status = 1;
+	}
+
+	if (status == 0 && synthetic > 0)
+	{
+		inputs[input_count].name = "synthetic";
+		inputs[input_count].source = synthetic_source(synthetic);
+		if (inputs[input_count].source)
+			input_count++;
+		else
+			status = 1;
+	}
+
+	if (status == 0 && json_path)
+	{
+		json = fopen(json_path, "w");
+		if (!json)
+		{
+			fprintf(stderr, "Error: Could not write '%s'\n",
+				json_path);
+			status = 1;
+		}
+		else
+		{
+			fputs("{\"version\":2,\"label\":", json);
+			json_write_string(json, label, strlen(label));
+			fprintf(json, ",\"warmup\":%d,\"repetitions\":%d,"
+				"\"min_sample_ms\":%g,\"results\":[", warmup,
+				repetitions, min_sample_ms);
+		}
+	}
+
+	if (status == 0 && use_counters)
+	{
+		/* Containers and some VMs have none; the timings still run */
+		if (perf_counters_open(&hardware) > 0)
+			counters = &hardware;
+		perf_counters_explain(stderr, &hardware);
+	}
+
+	if (status == 0)
+	{
+		printf("%-28s %-7s %9s %9s %8s %8s %8s %9s %8s", "input",
+		       "phase", "median ms", "p95 ms", "MB/s", "Mtok/s",
+		       "Mnode/s", "allocs", "rss KB");
+		if (counters)
+			printf(" %8s %8s %5s %8s %8s %8s", "Mcyc/MB", "Mins/MB",
+			       "IPC", "KL1m/MB", "KLLC/MB", "Kbrm/MB");
+		putchar('\n');
+	}
+
+	for (i = 0; i < input_count && status == 0; i++)
+	{
+		if (prepare_input(&inputs[i]) != 0)
+		{
+			fprintf(stderr, "Error: Could not format '%s'\n",
+				inputs[i].name);
+			status = 1;
+			break;
+		}
+
+		for (p = 0; p < PHASE_COUNT; p++)
+		{
+			BenchResult result;
+
+			if (measure(&inputs[i], &phases[p], warmup, repetitions,
+				    min_sample_ms / 1e3, counters, &result) != 0)
+			{
+				fprintf(stderr, "Error: %s failed on '%s'\n",
+					phases[p].name, inputs[i].name);
+				status = 1;
+				break;
+			}
+			print_row(&inputs[i], &phases[p], &result,
+				  counters != NULL);
+			if (json)
+				write_row(json, first, &inputs[i], &phases[p],
+					  &result);
+			first = 0;
+		}
+	}
+
+	if (json)
+	{
+		peak_rss_kb();
+		fprintf(json, "\n  ],\"peak_rss_kb\":%ld}\n", run_peak_kb);
+		if (fclose(json) != 0)
+			status = 1;
+	}
+
+	if (counters)
+		perf_counters_close(counters);
+	for (i = 0; i < argc + 1; i++)
+		if (inputs[i].source)
+			release_input(&inputs[i]);
+	free(inputs);
+
+	return (status);
+}
@@ -0,0 +1,968 @@
+/*
+ * bench_compare.c - Baseline store and regression gate for `make bench`
+ *
+ * `save NAME FILE` keeps a copy of a bench JSON result as baseline NAME.
+ * `compare NAME FILE` matches the rows of a new result to the baseline by
+ * input and phase and checks, for each:
+ *   throughput  - MB/s from the timed samples; a drop counts only if the
+ *                 medians differ by more than the threshold and a
+ *                 one-sided Mann-Whitney U test over the samples says
+ *                 the new ones are slower, with the p values of all rows
+ *                 Holm-adjusted so that the chance of any false alarm in
+ *                 the whole table stays below alpha; with too few
+ *                 samples for any adjusted p to get below alpha, the
+ *                 medians alone decide and the row is flagged
+ *   allocations - per input byte, and bytes allocated and peak live
+ *                 heap per input byte; these do not vary between runs,
+ *                 so the threshold alone decides
+ * and the whole run's peak RSS per input byte. The exit status is 1 if
+ * anything regressed, so the comparison can gate a change.
+ *
+ * A baseline recorded earlier ran under other machine conditions (clock
+ * speed, load, cache state), which shift every row at once. `interleave
+ * NAME BENCH [args]` avoids that: it runs the bench binary saved with
+ * baseline NAME and BENCH in alternating rounds, then compares the
+ * rounds of each side, one median per round.
+ */
+#define _GNU_SOURCE
+#include "../include/json.h"
+#include "../include/utils.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define DEFAULT_DIR "bench_baselines"
+#define DEFAULT_THRESHOLD 5.0  /* Percent */
+#define DEFAULT_ALPHA 0.01
+#define DEFAULT_ROUNDS 10
+#define DEFAULT_ROUND_REPS 3
+#define MAX_SAMPLES 1000
+#define MAX_ROUNDS 100
+
+/*
+ * Memory metrics of a row, each divided by the input size
+ */
+typedef enum {
+	METRIC_ALLOCS,
+	METRIC_ALLOC_BYTES,
+	METRIC_PEAK_BYTES,
+	METRIC_COUNT
+} Metric;
+
+static const char *metric_keys[METRIC_COUNT] = {
+	"allocations", "alloc_bytes", "peak_bytes"
+};
+
+static const char *metric_names[METRIC_COUNT] = {
+	"allocs/B", "bytes/B", "peak/B"
+};
+
+/*
+ * Comparison settings
+ * @threshold: Relative change that counts, in percent
+ * @alpha: Significance level of the throughput tests, over all rows
+ * @rounds: Rounds of each side run by `interleave`
+ * @reps: Timed samples per input and phase in each round
+ */
+typedef struct CompareOptions {
+	double threshold;
+	double alpha;
+	int rounds;
+	int reps;
+} CompareOptions;
+
+/*
+ * Results of one side of a comparison
+ * The rows of @docs[0] are the ones compared; the samples of a row are
+ * pooled from all documents.
+ */
+typedef struct ResultSet {
+	JsonValue *docs[MAX_ROUNDS];
+	int count;
+} ResultSet;
+
+/*
+ * Throughput comparison of one input and phase
+ * @base: Baseline row (first result)
+ * @fresh: New row (first result)
+ * @base_rate: Baseline MB/s at the median
+ * @fresh_rate: New MB/s at the median
+ * @p: Holm-adjusted p of the new samples being slower
+ * @floor: Lowest p the test can give for these sample counts
+ * @timed: Both sides have samples
+ */
+typedef struct CompareRow {
+	const JsonValue *base;
+	const JsonValue *fresh;
+	double base_rate;
+	double fresh_rate;
+	double p;
+	double floor;
+	int timed;
+} CompareRow;
+
+/*
+ * number - Read a numeric member
+ * @object: JSON object
+ * @key: Member name
+ *
+ * Return: The number, or -1 if it is missing or not a number
+ */
+static double number(const JsonValue *object, const char *key)
+{
+	const JsonValue *value = json_get(object, key);
+
+	if (!value || value->type != JSON_NUMBER)
+		return (-1.0);
+	return (value->number);
+}
+
+/*
+ * load_result - Read and parse a bench JSON result
+ * @path: File to read
+ *
+ * Return: Parsed document with a "results" array, or NULL (reported)
+ */
+static JsonValue *load_result(const char *path)
+{
+	char *text = read_file(path);
+	JsonValue *doc;
+	const JsonValue *results;
+
+	if (!text)
+	{
+		fprintf(stderr, "Error: Could not read '%s'\n", path);
+		return (NULL);
+	}
+
+	doc = json_parse(text, strlen(text));
+	free(text);
+	results = json_get(doc, "results");
+	if (!results || results->type != JSON_ARRAY)
+	{
+		fprintf(stderr, "Error: '%s' is not a bench result\n", path);
+		json_free(doc);
+		return (NULL);
+	}
+
+	return (doc);
+}
+
+/*
+ * baseline_file - Path of a file belonging to a baseline
+ * @dir: Baseline directory
+ * @name: Baseline name
+ * @suffix: File name suffix, such as ".json"
+ *
+ * Return: Allocated path
+ */
+static char *baseline_file(const char *dir, const char *name,
+			   const char *suffix)
+{
+	size_t length = strlen(dir) + strlen(name) + strlen(suffix) + 2;
+	char *path = malloc(length);
+
+	if (path)
+		snprintf(path, length, "%s/%s%s", dir, name, suffix);
+	return (path);
+}
+
+/*
+ * baseline_path - Resolve a baseline name
+ * @dir: Baseline directory
+ * @name: Baseline name, or the path of a result file
+ *
+ * Return: Allocated path
+ */
+static char *baseline_path(const char *dir, const char *name)
+{
+	if (strchr(name, '/') || (strlen(name) > 5 &&
+	    strcmp(name + strlen(name) - 5, ".json") == 0))
+		return (strdup(name));
+
+	return (baseline_file(dir, name, ".json"));
+}
+
+/*
+ * find_row - Find the row of an input and phase
+ * @results: Results array
+ * @input: Input name
+ * @phase: Phase name
+ *
+ * Return: Row, or NULL
+ */
+static const JsonValue *find_row(const JsonValue *results, const char *input,
+				 const char *phase)
+{
+	int i;
+
+	for (i = 0; i < results->count; i++)
+	{
+		const JsonValue *row = &results->items[i];
+		const char *row_input = json_string(json_get(row, "input"));
+		const char *row_phase = json_string(json_get(row, "phase"));
+
+		if (row_input && row_phase && strcmp(row_input, input) == 0 &&
+		    strcmp(row_phase, phase) == 0)
+			return (row);
+	}
+
+	return (NULL);
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return ((x > y) - (x < y));
+}
+
+/*
+ * median - Median of a sample (sorts it)
+ */
+static double median(double *values, int count)
+{
+	qsort(values, count, sizeof(double), compare_doubles);
+	return (count % 2 ? values[count / 2] :
+		(values[count / 2 - 1] + values[count / 2]) / 2);
+}
+
+/*
+ * read_samples - Read the sample times of an input and phase
+ * @set: Results to pool
+ * @input: Input name
+ * @phase: Phase name
+ * @samples: Filled with milliseconds
+ *
+ * From a single result every sample counts. From several, each result
+ * gives the median of its samples: the samples of one bench process
+ * share its placement, clock speed and memory layout, so only separate
+ * processes are independent observations. Results written before the
+ * samples were kept have only the median, which stands in for them.
+ *
+ * Return: Number of samples
+ */
+static int read_samples(const ResultSet *set, const char *input,
+			const char *phase, double *samples)
+{
+	static double own[MAX_SAMPLES];
+	const JsonValue *row, *list;
+	int count = 0, own_count;
+	int d, i;
+
+	for (d = 0; d < set->count && count < MAX_SAMPLES; d++)
+	{
+		row = find_row(json_get(set->docs[d], "results"), input, phase);
+		if (!row)
+			continue;
+
+		list = json_get(row, "samples_ms");
+		own_count = 0;
+		for (i = 0; list && list->type == JSON_ARRAY &&
+		     i < list->count && own_count < MAX_SAMPLES; i++)
+			if (list->items[i].type == JSON_NUMBER &&
+			    list->items[i].number > 0)
+				own[own_count++] = list->items[i].number;
+		if (own_count == 0 && number(row, "median_ms") > 0)
+			own[own_count++] = number(row, "median_ms");
+
+		if (set->count > 1 && own_count > 0)
+			samples[count++] = median(own, own_count);
+		for (i = 0; set->count == 1 && i < own_count; i++)
+			samples[count++] = own[i];
+	}
+
+	return (count);
+}
+
+/*
+ * slower_p - One-sided Mann-Whitney U test
+ * @base: Baseline run times
+ * @base_count: Number of baseline runs
+ * @fresh: New run times
+ * @fresh_count: Number of new runs
+ *
+ * Uses the normal approximation with tie and continuity corrections,
+ * which is close enough from about eight runs on each side.
+ *
+ * Return: Probability of new runs at least this much slower by chance,
+ * or 1 if there are too few runs to tell
+ */
+static double slower_p(const double *base, int base_count,
+		       const double *fresh, int fresh_count)
+{
+	int total = base_count + fresh_count;
+	double *values, *ranks;
+	int *from_fresh;
+	double rank_sum = 0, ties = 0, u, mean, variance, z;
+	int i, j, k;
+
+	if (base_count < 2 || fresh_count < 2)
+		return (1.0);
+
+	values = malloc(sizeof(double) * total);
+	ranks = malloc(sizeof(double) * total);
+	from_fresh = malloc(sizeof(int) * total);
+	if (!values || !ranks || !from_fresh)
+	{
+		free(values);
+		free(ranks);
+		free(from_fresh);
+		return (1.0);
+	}
+
+	/* Pool and sort both samples, remembering where each value came from */
+	for (i = 0; i < total; i++)
+	{
+		values[i] = i < base_count ? base[i] : fresh[i - base_count];
+		from_fresh[i] = i >= base_count;
+	}
+	for (i = 1; i < total; i++)
+	{
+		double value = values[i];
+		int flag = from_fresh[i];
+
+		for (j = i - 1; j >= 0 && values[j] > value; j--)
+		{
+			values[j + 1] = values[j];
+			from_fresh[j + 1] = from_fresh[j];
+		}
+		values[j + 1] = value;
+		from_fresh[j + 1] = flag;
+	}
+
+	/* Tied values share the mean of their ranks */
+	for (i = 0; i < total; i = j)
+	{
+		for (j = i + 1; j < total && values[j] == values[i]; j++)
+			;
+		for (k = i; k < j; k++)
+			ranks[k] = (i + 1 + j) / 2.0;
+		ties += (double)(j - i) * (j - i) * (j - i) - (j - i);
+	}
+	for (i = 0; i < total; i++)
+		if (from_fresh[i])
+			rank_sum += ranks[i];
+
+	free(values);
+	free(ranks);
+	free(from_fresh);
+
+	u = rank_sum - fresh_count * (fresh_count + 1) / 2.0;
+	mean = base_count * (double)fresh_count / 2.0;
+	variance = base_count * (double)fresh_count / 12.0 *
+		((total + 1) - ties / ((double)total * (total - 1)));
+	if (variance <= 0)
+		return (1.0);
+
+	z = (u - mean - 0.5) / sqrt(variance);
+	return (0.5 * erfc(z / sqrt(2.0)));
+}
+
+/*
+ * smallest_p - Lowest p slower_p() can return for these sample sizes
+ * @base_count: Number of baseline runs
+ * @fresh_count: Number of new runs
+ *
+ * Reached when every new run is slower than every baseline run. If it is
+ * not below alpha, the test cannot detect anything.
+ *
+ * Return: The p value, or 1 if there are too few runs to test
+ */
+static double smallest_p(int base_count, int fresh_count)
+{
+	double pairs = base_count * (double)fresh_count;
+	double z;
+
+	if (base_count < 2 || fresh_count < 2)
+		return (1.0);
+
+	z = (pairs / 2.0 - 0.5) /
+		sqrt(pairs / 12.0 * (base_count + fresh_count + 1));
+	return (0.5 * erfc(z / sqrt(2.0)));
+}
+
+/*
+ * change - Relative change in percent
+ */
+static double change(double base, double fresh)
+{
+	return (base > 0 ? (fresh - base) / base * 100.0 : 0.0);
+}
+
+/*
+ * test_row - Run the throughput test of one input and phase
+ * @base: Baseline results
+ * @fresh: New results
+ * @row: Row with its base and fresh rows set; the rest is filled in
+ */
+static void test_row(const ResultSet *base, const ResultSet *fresh,
+		     CompareRow *row)
+{
+	static double base_ms[MAX_SAMPLES], fresh_ms[MAX_SAMPLES];
+	const char *input = json_string(json_get(row->fresh, "input"));
+	const char *phase = json_string(json_get(row->fresh, "phase"));
+	double bytes = number(row->fresh, "bytes");
+	int base_count = read_samples(base, input, phase, base_ms);
+	int fresh_count = read_samples(fresh, input, phase, fresh_ms);
+
+	row->p = 1.0;
+	row->floor = 1.0;
+	row->timed = bytes > 0 && base_count > 0 && fresh_count > 0;
+	if (!row->timed)
+		return;
+
+	row->p = slower_p(base_ms, base_count, fresh_ms, fresh_count);
+	row->floor = smallest_p(base_count, fresh_count);
+	row->base_rate = bytes / 1e3 / median(base_ms, base_count);
+	row->fresh_rate = bytes / 1e3 / median(fresh_ms, fresh_count);
+}
+
+/*
+ * holm_adjust - Adjust the p values of the timed rows for their number
+ * @rows: Rows
+ * @count: Number of rows
+ *
+ * Each row tested at alpha adds its own chance of a false alarm: 32 rows
+ * at 0.01 flag something on about one unchanged run in four. Holm's
+ * step-down method keeps the chance of any false alarm below alpha: the
+ * k-th smallest of m p values is multiplied by m - k + 1, and adjusted
+ * values never decrease along that order. The floors are multiplied by
+ * m, the factor of the smallest p.
+ */
+static void holm_adjust(CompareRow *rows, int count)
+{
+	CompareRow **order = malloc(sizeof(CompareRow *) * (count + 1));
+	CompareRow *row;
+	double running = 0, adjusted;
+	int m = 0, i, j;
+
+	for (i = 0; i < count; i++)
+	{
+		if (!rows[i].timed)
+			continue;
+		if (!order)
+		{
+			/* Bonferroni: never below what Holm would give */
+			m++;
+			continue;
+		}
+
+		/* Insert by p; tables are a few dozen rows */
+		for (j = m++; j > 0 && order[j - 1]->p > rows[i].p; j--)
+			order[j] = order[j - 1];
+		order[j] = &rows[i];
+	}
+
+	for (i = 0; i < count; i++)
+		if (rows[i].timed)
+			rows[i].floor = fmin(1.0, rows[i].floor * m);
+
+	if (!order)
+	{
+		for (i = 0; i < count; i++)
+			if (rows[i].timed)
+				rows[i].p = fmin(1.0, rows[i].p * m);
+		return;
+	}
+
+	for (j = 0; j < m; j++)
+	{
+		row = order[j];
+		adjusted = fmin(1.0, row->p * (m - j));
+		running = fmax(running, adjusted);
+		row->p = running;
+	}
+	free(order);
+}
+
+/*
+ * report_row - Print the comparison of one input and phase
+ * @row: Tested row
+ * @opts: Settings
+ * @underpowered: Incremented if the samples are too few for the test
+ *
+ * Return: Number of regressed metrics
+ */
+static int report_row(const CompareRow *row, const CompareOptions *opts,
+		      int *underpowered)
+{
+	double bytes = number(row->fresh, "bytes");
+	double delta;
+	int regressed = 0, testable;
+	int m;
+
+	if (!row->timed)
+	{
+		printf("  (no timings)\n");
+		return (0);
+	}
+
+	testable = row->floor < opts->alpha;
+	if (!testable)
+		(*underpowered)++;
+	delta = change(row->base_rate, row->fresh_rate);
+	printf(" %9.2f %9.2f %+7.1f%% %7.4f", row->base_rate, row->fresh_rate,
+	       delta, row->p);
+	if (-delta > opts->threshold && (row->p < opts->alpha || !testable))
+	{
+		printf(" SLOWER");
+		regressed++;
+	}
+	if (!testable)
+		printf(" (too few samples, median only)");
+
+	for (m = 0; m < METRIC_COUNT; m++)
+	{
+		double before = number(row->base, metric_keys[m]);
+		double after = number(row->fresh, metric_keys[m]);
+		double base_bytes = number(row->base, "bytes");
+
+		if (before < 0 || after < 0 || base_bytes <= 0)
+			continue;
+		delta = change(before / base_bytes, after / bytes);
+		if (delta > opts->threshold)
+		{
+			printf(" %s %+.1f%%", metric_names[m], delta);
+			regressed++;
+		}
+	}
+	putchar('\n');
+
+	return (regressed);
+}
+
+/*
+ * input_bytes - Total size of the inputs of a result
+ * @results: Results array
+ *
+ * Return: Bytes, counting each input once
+ */
+static double input_bytes(const JsonValue *results)
+{
+	double total = 0;
+	int i;
+
+	for (i = 0; i < results->count; i++)
+	{
+		const char *phase = json_string(json_get(&results->items[i],
+							 "phase"));
+
+		if (phase && strcmp(phase, "total") == 0)
+			total += number(&results->items[i], "bytes");
+	}
+
+	return (total);
+}
+
+/*
+ * label - Label of a result
+ */
+static const char *label(const JsonValue *doc)
+{
+	const char *text = json_string(json_get(doc, "label"));
+
+	return (text && *text ? text : "-");
+}
+
+/*
+ * compare - Compare new results to a baseline
+ * @base_set: Baseline results
+ * @fresh_set: New results
+ * @opts: Settings
+ *
+ * Return: Number of regressions
+ */
+static int compare(const ResultSet *base_set, const ResultSet *fresh_set,
+		   const CompareOptions *opts)
+{
+	const JsonValue *base = json_get(base_set->docs[0], "results");
+	const JsonValue *fresh = json_get(fresh_set->docs[0], "results");
+	CompareRow *rows;
+	double base_rss, fresh_rss, delta;
+	int regressions = 0, missing = 0, underpowered = 0, count = 0;
+	int i;
+
+	rows = calloc(fresh->count + 1, sizeof(CompareRow));
+	if (!rows)
+	{
+		fprintf(stderr, "Error: Out of memory\n");
+		return (1);
+	}
+
+	for (i = 0; i < fresh->count; i++)
+	{
+		const JsonValue *row = &fresh->items[i];
+		const char *input = json_string(json_get(row, "input"));
+		const char *phase = json_string(json_get(row, "phase"));
+
+		if (!input || !phase)
+			continue;
+		rows[count].base = find_row(base, input, phase);
+		if (!rows[count].base)
+		{
+			missing++;
+			continue;
+		}
+		rows[count].fresh = row;
+		test_row(base_set, fresh_set, &rows[count++]);
+	}
+	holm_adjust(rows, count);
+
+	printf("baseline %s, new %s (%d and %d results, threshold %.1f%%, "
+	       "alpha %g over all rows)\n", label(base_set->docs[0]),
+	       label(fresh_set->docs[0]), base_set->count, fresh_set->count,
+	       opts->threshold, opts->alpha);
+	printf("%-28s %-7s %9s %9s %8s %7s\n", "input", "phase", "base MB/s",
+	       "new MB/s", "change", "Holm p");
+	for (i = 0; i < count; i++)
+	{
+		printf("%-28s %-7s", json_string(json_get(rows[i].fresh, "input")),
+		       json_string(json_get(rows[i].fresh, "phase")));
+		regressions += report_row(&rows[i], opts, &underpowered);
+	}
+	free(rows);
+
+	base_rss = number(base_set->docs[0], "peak_rss_kb");
+	fresh_rss = number(fresh_set->docs[0], "peak_rss_kb");
+	if (base_rss > 0 && fresh_rss > 0 && input_bytes(base) > 0 &&
+	    input_bytes(fresh) > 0)
+	{
+		delta = change(base_rss / input_bytes(base),
+			       fresh_rss / input_bytes(fresh));
+		printf("peak RSS per input byte: %+.1f%%%s\n", delta,
+		       delta > opts->threshold ? " HIGHER" : "");
+		if (delta > opts->threshold)
+			regressions++;
+	}
+
+	if (missing > 0)
+		printf("%d rows have no baseline\n", missing);
+	if (underpowered > 0)
+		fprintf(stderr, "Warning: %d rows have too few samples for p to "
+			"get below alpha %g; their throughput was judged on the "
+			"median change alone (run more --reps or --rounds)\n",
+			underpowered, opts->alpha);
+	printf("%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+
+	return (regressions);
+}
+
+/*
+ * copy_program - Copy an executable
+ * @from: Source path
+ * @to: Target path
+ *
+ * Return: 0 on success, -1 on error (reported)
+ */
+static int copy_program(const char *from, const char *to)
+{
+	char buffer[65536];
+	FILE *in = fopen(from, "rb");
+	FILE *out = in ? fopen(to, "wb") : NULL;
+	size_t n;
+	int status = 0;
+
+	if (!out)
+	{
+		fprintf(stderr, "Error: Could not copy '%s' to '%s'\n", from, to);
+		if (in)
+			fclose(in);
+		return (-1);
+	}
+
+	while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+		if (fwrite(buffer, 1, n, out) != n)
+			status = -1;
+	if (ferror(in))
+		status = -1;
+	fclose(in);
+	if (fclose(out) != 0 || chmod(to, 0755) != 0)
+		status = -1;
+	if (status != 0)
+		fprintf(stderr, "Error: Could not copy '%s' to '%s'\n", from, to);
+
+	return (status);
+}
+
+/*
+ * save - Store a result as a baseline
+ * @dir: Baseline directory (created if needed)
+ * @name: Baseline name
+ * @path: Result file
+ * @bench: Bench binary that produced it, kept for `interleave`, or NULL
+ *
+ * Return: 0 on success, 1 on error
+ */
+static int save(const char *dir, const char *name, const char *path,
+		const char *bench)
+{
+	JsonValue *doc = load_result(path);
+	char *target;
+	FILE *fp;
+	int status = 0;
+
+	if (!doc)
+		return (1);
+
+	target = baseline_path(dir, name);
+	if (!target || (mkdir(dir, 0755) != 0 && errno != EEXIST))
+	{
+		fprintf(stderr, "Error: Could not create '%s'\n", dir);
+		json_free(doc);
+		free(target);
+		return (1);
+	}
+
+	fp = fopen(target, "w");
+	if (!fp)
+	{
+		fprintf(stderr, "Error: Could not write '%s'\n", target);
+		status = 1;
+	}
+	else
+	{
+		json_write_value(fp, doc);
+		fputc('\n', fp);
+		if (fclose(fp) != 0)
+			status = 1;
+		else
+			printf("Saved %s as baseline '%s'\n", path, name);
+	}
+
+	json_free(doc);
+	free(target);
+
+	if (status == 0 && bench)
+	{
+		target = baseline_file(dir, name, ".bench");
+		if (!target || copy_program(bench, target) != 0)
+			status = 1;
+		free(target);
+	}
+
+	return (status);
+}
+
+/*
+ * run_bench - Run a bench binary once
+ * @program: Bench binary
+ * @args: Arguments passed on (the inputs), NULL-terminated
+ * @reps: Timed samples per input and phase
+ * @name: Label of the result
+ * @json_path: Where the result goes
+ *
+ * The printed table is discarded; errors still reach stderr.
+ *
+ * Return: Parsed result, or NULL (reported)
+ */
+static JsonValue *run_bench(const char *program, char **args, int reps,
+			    const char *name, const char *json_path)
+{
+	char reps_text[16];
+	char **argv;
+	int count, i, wstatus, null_fd;
+	pid_t pid;
+
+	for (count = 0; args[count]; count++)
+		;
+	argv = malloc(sizeof(char *) * (count + 9));
+	if (!argv)
+		return (NULL);
+
+	snprintf(reps_text, sizeof(reps_text), "%d", reps);
+	argv[0] = (char *)program;
+	argv[1] = "--reps";
+	argv[2] = reps_text;
+	argv[3] = "--no-counters";
+	argv[4] = "--label";
+	argv[5] = (char *)name;
+	argv[6] = "--json";
+	argv[7] = (char *)json_path;
+	for (i = 0; i <= count; i++)
+		argv[8 + i] = args[i];
+
+	fflush(NULL);
+	pid = fork();
+	if (pid == 0)
+	{
+		null_fd = open("/dev/null", O_WRONLY);
+		if (null_fd >= 0)
+			dup2(null_fd, STDOUT_FILENO);
+		execv(program, argv);
+		perror(program);
+		_exit(127);
+	}
+	free(argv);
+
+	if (pid < 0 || waitpid(pid, &wstatus, 0) < 0 ||
+	    !WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
+	{
+		fprintf(stderr, "Error: '%s' failed\n", program);
+		return (NULL);
+	}
+
+	return (load_result(json_path));
+}
+
+/*
+ * interleave - Benchmark the baseline's binary and a new one in turns
+ * @dir: Baseline directory
+ * @name: Baseline name
+ * @bench: New bench binary
+ * @args: Bench arguments (the inputs), NULL-terminated
+ * @opts: Settings
+ *
+ * Each round runs both binaries, and the side that goes first
+ * alternates, so a drift in machine speed falls on both alike.
+ *
+ * Return: 0 if nothing regressed, 1 on a regression or error
+ */
+static int interleave(const char *dir, const char *name, const char *bench,
+		      char **args, const CompareOptions *opts)
+{
+	ResultSet sets[2];  /* Baseline, new */
+	const char *programs[2], *names[2] = {name, "new"};
+	char *json_paths[2];
+	char *base_bench = baseline_file(dir, name, ".bench");
+	JsonValue *doc;
+	int round, k, side, failed = 0, status = 1;
+
+	memset(sets, 0, sizeof(sets));
+	programs[0] = base_bench;
+	programs[1] = bench;
+	json_paths[0] = baseline_file(dir, name, ".base-run.json");
+	json_paths[1] = baseline_file(dir, name, ".new-run.json");
+
+	if (!base_bench || !json_paths[0] || !json_paths[1])
+		failed = 1;
+	else if (access(base_bench, X_OK) != 0)
+	{
+		fprintf(stderr, "Error: Baseline '%s' has no bench binary '%s' "
+			"(save it with make bench-baseline)\n", name, base_bench);
+		failed = 1;
+	}
+
+	for (round = 0; round < opts->rounds && !failed; round++)
+	{
+		fprintf(stderr, "Round %d of %d\n", round + 1, opts->rounds);
+		for (k = 0; k < 2 && !failed; k++)
+		{
+			side = (round + k) % 2;
+			doc = run_bench(programs[side], args, opts->reps,
+					names[side], json_paths[side]);
+			if (doc)
+				sets[side].docs[sets[side].count++] = doc;
+			else
+				failed = 1;
+		}
+	}
+
+	if (!failed)
+		status = compare(&sets[0], &sets[1], opts) > 0 ? 1 : 0;
+
+	for (side = 0; side < 2; side++)
+	{
+		for (k = 0; k < sets[side].count; k++)
+			json_free(sets[side].docs[k]);
+		if (json_paths[side])
+			unlink(json_paths[side]);
+		free(json_paths[side]);
+	}
+	free(base_bench);
+
+	return (status);
+}
+
+/*
+ * usage - Print command line help
+ */
+static void usage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [--dir DIR] save NAME RESULT.json [BENCH]\n"
+		"       %s [--dir DIR] [--threshold PERCENT] [--alpha P] "
+		"compare NAME|BASELINE.json RESULT.json\n"
+		"       %s [--dir DIR] [--threshold PERCENT] [--alpha P] "
+		"[--rounds N] [--reps N] interleave NAME BENCH [files...]\n",
+		program, program, program);
+}
+
+/*
+ * main - Store or check a benchmark baseline
+ * @argc: Argument count
+ * @argv: Options and command
+ *
+ * Return: 0 if nothing regressed, 1 on a regression or error
+ */
+int main(int argc, char **argv)
+{
+	CompareOptions opts = {DEFAULT_THRESHOLD, DEFAULT_ALPHA, DEFAULT_ROUNDS,
+			       DEFAULT_ROUND_REPS};
+	const char *dir = DEFAULT_DIR;
+	ResultSet base, fresh;
+	char *path;
+	int i, args, status;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++)
+	{
+		if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc)
+			dir = argv[++i];
+		else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+			opts.threshold = atof(argv[++i]);
+		else if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc)
+			opts.alpha = atof(argv[++i]);
+		else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc)
+			opts.rounds = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+			opts.reps = atoi(argv[++i]);
+		else
+		{
+			usage(argv[0]);
+			return (1);
+		}
+	}
+	args = i < argc ? argc - i - 1 : -1;
+	if (opts.threshold < 0 || opts.alpha <= 0 || opts.alpha >= 1 ||
+	    opts.rounds < 1 || opts.rounds > MAX_ROUNDS || opts.reps < 1 ||
+	    args < 0)
+	{
+		usage(argv[0]);
+		return (1);
+	}
+
+	if (strcmp(argv[i], "save") == 0 && (args == 2 || args == 3))
+		return (save(dir, argv[i + 1], argv[i + 2],
+			     args == 3 ? argv[i + 3] : NULL));
+	if (strcmp(argv[i], "interleave") == 0 && args >= 2)
+		return (interleave(dir, argv[i + 1], argv[i + 2], argv + i + 3,
+				   &opts));
+	if (strcmp(argv[i], "compare") != 0 || args != 2)
+	{
+		usage(argv[0]);
+		return (1);
+	}
+
+	path = baseline_path(dir, argv[i + 1]);
+	base.docs[0] = path ? load_result(path) : NULL;
+	free(path);
+	fresh.docs[0] = base.docs[0] ? load_result(argv[i + 2]) : NULL;
+	if (!fresh.docs[0])
+	{
+		json_free(base.docs[0]);
+		return (1);
+	}
+	base.count = 1;
+	fresh.count = 1;
+
+	status = compare(&base, &fresh, &opts) > 0 ? 1 : 0;
+
+	json_free(base.docs[0]);
+	json_free(fresh.docs[0]);
+	return (status);
+}
@@ -0,0 +1,1095 @@
+/*
+ * complexity_fuzz.c - Search for inputs that cost more than linear work
+ * (run with `make fuzz-complexity`)
+ *
+ * A candidate is a seed file cut into prefix, pumped part A, middle,
+ * pumped part B and suffix. It is measured with A and B repeated k, 2k,
+ * 4k and 8k times, and a power law is fitted to each work counter (tokens
+ * visited by the parser, formatter tasks, allocations and allocated
+ * bytes) against the input size. A counter growing faster than
+ * size^threshold makes a finding, which is minimized and written out
+ * with a header saying what to pump, so `--check` can replay the
+ * findings as a regression corpus; findings marked --known are expected
+ * to stay super-linear until fixed. Every measurement runs in a child
+ * process under a time limit, so hangs and crashes are findings too.
+ * The counters are deterministic: the same seed finds the same inputs.
+ */
+#define _GNU_SOURCE
+#include "../include/lexer.h"
+#include "../include/parser.h"
+#include "../include/formatter.h"
+#include "../include/sink.h"
+#include "../include/utils.h"
+#include "../include/stats.h"
+#include "../include/timings.h"
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define DEFAULT_ITERATIONS 200
+#define DEFAULT_THRESHOLD 1.15
+#define DEFAULT_TIMEOUT 2
+#define DEFAULT_PUMP_BYTES 2048
+#define DEFAULT_MAX_FINDINGS 10
+#define MINIMIZE_BUDGET 400
+#define HANG_MINIMIZE_BUDGET 20
+#define PUMP_STEPS 4
+#define HEADER_FORMAT "/* complexity-fuzz pump A=%lu,%lu B=%lu,%lu */\n"
+
+/*
+ * Parts of a candidate, in text order
+ */
+typedef enum {
+	PART_PREFIX,
+	PART_A,
+	PART_MIDDLE,
+	PART_B,
+	PART_SUFFIX,
+	PART_COUNT
+} PartIndex;
+
+/*
+ * Work counters read from one run
+ */
+typedef enum {
+	METRIC_VISITED,
+	METRIC_TASKS,
+	METRIC_ALLOCS,
+	METRIC_BYTES,
+	METRIC_COUNT
+} Metric;
+
+static const char *metric_names[METRIC_COUNT] = {
+	"tokens-visited", "format-tasks", "allocations", "alloc-bytes"
+};
+
+/*
+ * Outcome of evaluating a candidate
+ */
+typedef enum {
+	VERDICT_LINEAR,
+	VERDICT_SUPERLINEAR,
+	VERDICT_HANG,
+	VERDICT_CRASH
+} VerdictKind;
+
+static const char *verdict_names[] = {
+	"linear", "superlinear", "hang", "crash"
+};
+
+/*
+ * Candidate - Input with two pumpable parts
+ * @part: NUL-terminated text of each part (owned)
+ */
+typedef struct Candidate {
+	char *part[PART_COUNT];
+} Candidate;
+
+/*
+ * Work - Counters of one run, as sent back by the child
+ * @status: 0, or the VerdictKind that ended the run
+ * @counter: Value of each metric
+ */
+typedef struct Work {
+	int status;
+	unsigned long counter[METRIC_COUNT];
+} Work;
+
+/*
+ * Verdict - Result of evaluating a candidate
+ * @kind: Classification
+ * @metric: Fastest-growing counter
+ * @exponent: Fitted exponent of that counter
+ * @bytes: Size of the largest input measured
+ */
+typedef struct Verdict {
+	VerdictKind kind;
+	Metric metric;
+	double exponent;
+	size_t bytes;
+} Verdict;
+
+/*
+ * FuzzOptions - Command line settings
+ * @known: Findings (with --check) that are open issues
+ * @known_count: Number of @known
+ */
+typedef struct FuzzOptions {
+	int iterations;
+	unsigned long seed;
+	double threshold;
+	int timeout;
+	size_t pump_bytes;
+	int max_findings;
+	const char *out_dir;
+	int check;
+	char **known;
+	int known_count;
+} FuzzOptions;
+
+/* Fragments inserted into pumped text */
+static const char *fragments[] = {
+	"(", ")", "{", "}", "[", "]", ";", ",", "*", "&", "=", "x", "x, ",
+	"int ", "int x;\n", "static ", "const ", "unsigned long ", "struct s ",
+	"typedef ", "enum e { A, B };\n", "if (x) ", "else ", "return x;\n",
+	"/* c */", "// c\n", "\n", "#define X 1\n", "#include <x.h>\n",
+	"\"s\" ", "'c' ", "a[i] = ", "f(x) ", "(int)", "sizeof(x) ",
+	"x ? y : ", "->x", "\\\n", "case 1: ", "l: ", "goto l;\n",
+	"__attribute__((unused)) "
+};
+
+/* Open and close texts pumped together to build nesting */
+static const char *nestings[][2] = {
+	{"(", ")"}, {"{", "}"}, {"[", "]"}, {"f(", ")"}, {"{ ", " }"},
+	{"if (x) {\n", "}\n"}, {"while (x) {\n", "}\n"},
+	{"do {\n", "} while (x);\n"}, {"switch (x) {\ncase 1:\n", "}\n"},
+	{"struct s {\n", "};\n"}, {"x ? (", ") : y"}, {"if (x)\n", "\n"}
+};
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+static unsigned long long rng_state;
+
+/*
+ * rng - Next pseudo-random number (xorshift64*)
+ */
+static unsigned long rng(void)
+{
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return ((unsigned long)((rng_state * 2685821657736338717ULL) >> 33));
+}
+
+/*
+ * rng_below - Pseudo-random number in [0, n)
+ */
+static size_t rng_below(size_t n)
+{
+	return (n > 0 ? rng() % n : 0);
+}
+
+/*
+ * substring - Copy part of a text
+ * @text: Source text
+ * @start: First byte
+ * @length: Bytes to copy
+ *
+ * Return: NUL-terminated copy, or NULL on allocation failure
+ */
+static char *substring(const char *text, size_t start, size_t length)
+{
+	char *copy = malloc(length + 1);
+
+	if (!copy)
+		return (NULL);
+	memcpy(copy, text + start, length);
+	copy[length] = '\0';
+	return (copy);
+}
+
+/*
+ * candidate_free - Release the parts of a candidate
+ */
+static void candidate_free(Candidate *candidate)
+{
+	int i;
+
+	for (i = 0; i < PART_COUNT; i++)
+	{
+		free(candidate->part[i]);
+		candidate->part[i] = NULL;
+	}
+}
+
+/*
+ * candidate_copy - Deep copy a candidate
+ *
+ * Return: 0 on success, -1 on allocation failure
+ */
+static int candidate_copy(Candidate *copy, const Candidate *candidate)
+{
+	int i;
+
+	for (i = 0; i < PART_COUNT; i++)
+	{
+		copy->part[i] = strdup(candidate->part[i]);
+		if (!copy->part[i])
+		{
+			candidate_free(copy);
+			return (-1);
+		}
+	}
+	return (0);
+}
+
+/*
+ * build_input - Assemble a candidate with its pumped parts repeated
+ * @candidate: Candidate
+ * @pumps: Repetitions of A and B
+ * @length: Set to the length of the result
+ *
+ * Return: NUL-terminated input, or NULL on allocation failure
+ */
+static char *build_input(const Candidate *candidate, size_t pumps,
+			 size_t *length)
+{
+	size_t lengths[PART_COUNT], total = 0, pos = 0, i, r;
+	char *text;
+
+	for (i = 0; i < PART_COUNT; i++)
+	{
+		lengths[i] = strlen(candidate->part[i]);
+		total += i == PART_A || i == PART_B ? lengths[i] * pumps :
+			lengths[i];
+	}
+
+	text = malloc(total + 1);
+	if (!text)
+		return (NULL);
+	for (i = 0; i < PART_COUNT; i++)
+	{
+		size_t repeat = i == PART_A || i == PART_B ? pumps : 1;
+
+		for (r = 0; r < repeat; r++)
+		{
+			memcpy(text + pos, candidate->part[i], lengths[i]);
+			pos += lengths[i];
+		}
+	}
+	text[pos] = '\0';
+	*length = pos;
+
+	return (text);
+}
+
+/*
+ * run_pipeline - Lex, parse and format an input, counting the work
+ * @source: NUL-terminated input
+ * @length: Length of @source
+ * @work: Filled with the counters
+ *
+ * Runs in the child; nothing is freed since the child exits right after.
+ */
+static void run_pipeline(const char *source, size_t length, Work *work)
+{
+	Lexer *lexer;
+	Parser *parser = NULL;
+	ASTNode *ast = NULL;
+	StatsTotals totals;
+
+	stats_reset();
+	timings_reset();
+
+	lexer = lexer_create(source);
+	if (lexer && lexer_tokenize(lexer) >= 0)
+		parser = parser_create(lexer_get_tokens(lexer),
+				       lexer_get_token_count(lexer));
+	if (parser)
+		ast = parser_parse(parser);
+	if (ast)
+	{
+		OutputSink *sink = sink_create_memory();
+		Formatter *formatter = sink ? formatter_create(sink) : NULL;
+
+		if (formatter)
+		{
+			formatter_set_source(formatter, lexer_get_tokens(lexer),
+					     lexer_get_token_count(lexer));
+			formatter_set_comments(formatter, parser->comments);
+			formatter_set_source_slices(formatter, source, length);
+			if (formatter_format(formatter, ast) == 0)
+				sink_flush(sink);
+		}
+	}
+
+	stats_totals(&totals);
+	work->status = 0;
+	work->counter[METRIC_VISITED] = timings_counter(COUNT_TOKENS_VISITED);
+	work->counter[METRIC_TASKS] = timings_counter(COUNT_FORMAT_TASKS);
+	work->counter[METRIC_ALLOCS] = totals.allocs;
+	work->counter[METRIC_BYTES] = totals.bytes;
+}
+
+/*
+ * measure - Run the pipeline on an input in a child process
+ * @source: NUL-terminated input
+ * @length: Length of @source
+ * @timeout: Seconds before the child counts as hung
+ * @work: Filled with the counters, or just a status on hang or crash
+ *
+ * Return: 0 on success, -1 if the child could not be started
+ */
+static int measure(const char *source, size_t length, int timeout,
+		   Work *work)
+{
+	int fds[2], wstatus;
+	size_t got = 0;
+	pid_t pid;
+
+	if (pipe(fds) != 0)
+		return (-1);
+	fflush(NULL);
+	pid = fork();
+	if (pid < 0)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return (-1);
+	}
+
+	if (pid == 0)
+	{
+		Work result;
+
+		close(fds[0]);
+		/* Parse errors are expected on mutated input */
+		if (!freopen("/dev/null", "w", stderr) ||
+		    !freopen("/dev/null", "w", stdout))
+			_exit(2);
+		alarm(timeout);
+		run_pipeline(source, length, &result);
+		if (write(fds[1], &result, sizeof(result)) !=
+		    (ssize_t)sizeof(result))
+			_exit(2);
+		_exit(0);
+	}
+
+	close(fds[1]);
+	while (got < sizeof(*work))
+	{
+		ssize_t n = read(fds[0], (char *)work + got,
+				 sizeof(*work) - got);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		got += n;
+	}
+	close(fds[0]);
+	while (waitpid(pid, &wstatus, 0) < 0 && errno == EINTR)
+		;
+
+	if (WIFSIGNALED(wstatus))
+		work->status = WTERMSIG(wstatus) == SIGALRM ? VERDICT_HANG :
+			VERDICT_CRASH;
+	else if (got != sizeof(*work) || WEXITSTATUS(wstatus) != 0)
+		work->status = VERDICT_CRASH;
+
+	return (0);
+}
+
+/*
+ * fit_exponent - Least-squares slope of log(work) against log(size)
+ * @sizes: Input sizes
+ * @values: Counter values
+ * @count: Number of points
+ *
+ * Return: Fitted exponent, or 0 if a value is zero
+ */
+static double fit_exponent(const double *sizes, const double *values,
+			   int count)
+{
+	double sx = 0, sy = 0, sxx = 0, sxy = 0, denominator;
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		double x, y;
+
+		if (values[i] <= 0 || sizes[i] <= 0)
+			return (0.0);
+		x = log(sizes[i]);
+		y = log(values[i]);
+		sx += x;
+		sy += y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+	denominator = count * sxx - sx * sx;
+
+	return (denominator > 0 ? (count * sxy - sx * sy) / denominator : 0.0);
+}
+
+/*
+ * evaluate - Measure a candidate at growing pump counts
+ * @candidate: Candidate with a non-empty A or B
+ * @options: Threshold, timeout and pump size
+ * @verdict: Filled with the classification
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int evaluate(const Candidate *candidate, const FuzzOptions *options,
+		    Verdict *verdict)
+{
+	double sizes[PUMP_STEPS], values[METRIC_COUNT][PUMP_STEPS];
+	size_t pumped = strlen(candidate->part[PART_A]) +
+		strlen(candidate->part[PART_B]);
+	size_t pumps;
+	int step, m;
+
+	verdict->kind = VERDICT_LINEAR;
+	verdict->metric = METRIC_VISITED;
+	verdict->exponent = 0.0;
+	verdict->bytes = 0;
+	if (pumped == 0)
+		return (-1);
+
+	/* Smallest pump count sized so the largest input stays small */
+	pumps = options->pump_bytes / pumped;
+	if (pumps < 2)
+		pumps = 2;
+
+	for (step = 0; step < PUMP_STEPS; step++, pumps *= 2)
+	{
+		size_t length;
+		char *input = build_input(candidate, pumps, &length);
+		Work work;
+
+		if (!input)
+			return (-1);
+		memset(&work, 0, sizeof(work));
+		if (measure(input, length, options->timeout, &work) != 0)
+		{
+			free(input);
+			return (-1);
+		}
+		free(input);
+		verdict->bytes = length;
+
+		if (work.status != 0)
+		{
+			verdict->kind = work.status;
+			return (0);
+		}
+		sizes[step] = length;
+		for (m = 0; m < METRIC_COUNT; m++)
+			values[m][step] = work.counter[m];
+	}
+
+	for (m = 0; m < METRIC_COUNT; m++)
+	{
+		double exponent = fit_exponent(sizes, values[m], PUMP_STEPS);
+
+		if (m == 0 || exponent > verdict->exponent)
+		{
+			verdict->exponent = exponent;
+			verdict->metric = m;
+		}
+	}
+	if (verdict->exponent > options->threshold)
+		verdict->kind = VERDICT_SUPERLINEAR;
+
+	return (0);
+}
+
+/*
+ * same_finding - Check a verdict still shows the original problem
+ * @verdict: Verdict of a reduced candidate
+ * @original: Verdict before minimizing
+ * @floor: Lowest exponent still accepted
+ */
+static int same_finding(const Verdict *verdict, const Verdict *original,
+			double floor)
+{
+	if (verdict->kind != original->kind)
+		return (0);
+	if (verdict->kind == VERDICT_SUPERLINEAR)
+		return (verdict->metric == original->metric &&
+			verdict->exponent >= floor);
+	return (1);
+}
+
+/*
+ * minimize - Shrink a finding while it keeps its verdict
+ * @candidate: Finding (parts replaced in place)
+ * @options: Evaluation settings
+ * @verdict: Verdict of the finding (updated to the final one)
+ *
+ * Deletes halving chunks of each part, the fixed parts first, until no
+ * single byte can go or the evaluation budget is spent. A reduction must
+ * keep at least half of the growth above the threshold, so the result
+ * does not drift down to a borderline case.
+ */
+static void minimize(Candidate *candidate, const FuzzOptions *options,
+		     Verdict *verdict)
+{
+	static const PartIndex order[PART_COUNT] = {
+		PART_SUFFIX, PART_PREFIX, PART_MIDDLE, PART_A, PART_B
+	};
+	const Verdict original = *verdict;
+	double floor = (options->threshold + verdict->exponent) / 2;
+	int budget = verdict->kind == VERDICT_HANG ? HANG_MINIMIZE_BUDGET :
+		MINIMIZE_BUDGET;
+	int p;
+
+	for (p = 0; p < PART_COUNT && budget > 0; p++)
+	{
+		PartIndex index = order[p];
+		size_t chunk = strlen(candidate->part[index]) / 2;
+
+		if (chunk == 0)
+			chunk = 1;
+		for (; chunk > 0 && budget > 0; chunk /= 2)
+		{
+			size_t offset = 0;
+
+			while (budget > 0 &&
+			       offset + chunk <= strlen(candidate->part[index]))
+			{
+				char *text = candidate->part[index];
+				size_t length = strlen(text);
+				char *shorter = malloc(length - chunk + 1);
+				Verdict trial;
+
+				if (!shorter)
+					return;
+				memcpy(shorter, text, offset);
+				memcpy(shorter + offset, text + offset + chunk,
+				       length - offset - chunk + 1);
+
+				candidate->part[index] = shorter;
+				budget--;
+				if (evaluate(candidate, options, &trial) == 0 &&
+				    same_finding(&trial, &original, floor))
+				{
+					free(text);
+					*verdict = trial;
+				}
+				else
+				{
+					candidate->part[index] = text;
+					free(shorter);
+					offset += chunk;
+				}
+			}
+		}
+	}
+}
+
+/*
+ * line_start - Offset of a line in a text
+ * @text: Text
+ * @line: Zero-based line number (clamped to the end)
+ */
+static size_t line_start(const char *text, size_t line)
+{
+	size_t offset = 0;
+
+	while (line > 0 && text[offset])
+	{
+		if (text[offset] == '\n')
+			line--;
+		offset++;
+	}
+	return (offset);
+}
+
+/*
+ * count_lines - Number of lines in a text
+ */
+static size_t count_lines(const char *text)
+{
+	size_t lines = 1;
+
+	for (; *text; text++)
+		if (*text == '\n')
+			lines++;
+	return (lines);
+}
+
+/*
+ * insert_fragment - Insert a random fragment into a text
+ * @text: Text (freed and replaced)
+ *
+ * Return: New text, or NULL on allocation failure
+ */
+static char *insert_fragment(char *text)
+{
+	const char *fragment = fragments[rng_below(ARRAY_SIZE(fragments))];
+	size_t length = strlen(text), add = strlen(fragment);
+	size_t at = rng_below(length + 1);
+	char *result = malloc(length + add + 1);
+
+	if (result)
+	{
+		memcpy(result, text, at);
+		memcpy(result + at, fragment, add);
+		memcpy(result + at + add, text + at, length - at + 1);
+	}
+	free(text);
+	return (result);
+}
+
+/*
+ * make_candidate - Cut a random candidate out of the seeds
+ * @candidate: Filled with the new parts
+ * @seeds: Seed texts
+ * @seed_count: Number of seeds (at least one)
+ *
+ * Pumps a span of lines, an inserted fragment, a nesting pair, or a span
+ * spliced in from another seed; spans are sometimes mutated first.
+ *
+ * Return: 0 on success, -1 on allocation failure
+ */
+static int make_candidate(Candidate *candidate, char **seeds, int seed_count)
+{
+	const char *seed = seeds[rng_below(seed_count)];
+	const char *donor = seeds[rng_below(seed_count)];
+	size_t at = line_start(seed, rng_below(count_lines(seed)));
+	size_t length = strlen(seed);
+	int strategy = rng_below(4), i;
+
+	memset(candidate, 0, sizeof(*candidate));
+	candidate->part[PART_MIDDLE] = strdup("");
+	candidate->part[PART_B] = strdup("");
+
+	if (strategy == 0 || strategy == 3)
+	{
+		/* A span of one to four lines, of this seed or another */
+		const char *source = strategy == 0 ? seed : donor;
+		size_t first = rng_below(count_lines(source));
+		size_t start = line_start(source, first);
+		size_t end = line_start(source, first + 1 + rng_below(4));
+
+		candidate->part[PART_A] = substring(source, start, end - start);
+		if (candidate->part[PART_A] && rng_below(2))
+			candidate->part[PART_A] =
+				insert_fragment(candidate->part[PART_A]);
+
+		/* A span of the seed itself is pumped where it stands */
+		if (strategy == 0)
+		{
+			candidate->part[PART_PREFIX] = substring(seed, 0, start);
+			at = end;
+		}
+	}
+	else if (strategy == 1)
+		candidate->part[PART_A] = strdup(
+			fragments[rng_below(ARRAY_SIZE(fragments))]);
+	else
+	{
+		size_t pair = rng_below(ARRAY_SIZE(nestings));
+
+		candidate->part[PART_A] = strdup(nestings[pair][0]);
+		free(candidate->part[PART_B]);
+		candidate->part[PART_B] = strdup(nestings[pair][1]);
+		free(candidate->part[PART_MIDDLE]);
+		candidate->part[PART_MIDDLE] = strdup(rng_below(2) ? "x" :
+						      "x = 1;\n");
+	}
+
+	if (strategy != 0)
+		candidate->part[PART_PREFIX] = substring(seed, 0, at);
+	candidate->part[PART_SUFFIX] = substring(seed, at, length - at);
+
+	for (i = 0; i < PART_COUNT; i++)
+		if (!candidate->part[i])
+		{
+			candidate_free(candidate);
+			return (-1);
+		}
+	return (0);
+}
+
+/*
+ * write_finding - Save a finding with its pump header
+ * @candidate: Finding
+ * @verdict: Its verdict
+ * @dir: Output directory
+ * @number: Sequence number
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int write_finding(const Candidate *candidate, const Verdict *verdict,
+			 const char *dir, int number)
+{
+	size_t offsets[PART_COUNT], offset = 0;
+	char path[4096];
+	FILE *fp;
+	int i;
+
+	for (i = 0; i < PART_COUNT; i++)
+	{
+		offsets[i] = offset;
+		offset += strlen(candidate->part[i]);
+	}
+
+	snprintf(path, sizeof(path), "%s/%s-%s-%03d.c", dir,
+		 verdict_names[verdict->kind],
+		 verdict->kind == VERDICT_SUPERLINEAR ?
+		 metric_names[verdict->metric] : "pipeline", number);
+	fp = fopen(path, "w");
+	if (!fp)
+	{
+		fprintf(stderr, "Error: Could not write '%s'\n", path);
+		return (-1);
+	}
+	fprintf(fp, HEADER_FORMAT,
+		(unsigned long)offsets[PART_A],
+		(unsigned long)strlen(candidate->part[PART_A]),
+		(unsigned long)offsets[PART_B],
+		(unsigned long)strlen(candidate->part[PART_B]));
+	for (i = 0; i < PART_COUNT; i++)
+		fputs(candidate->part[i], fp);
+	if (fclose(fp) != 0)
+		return (-1);
+
+	printf("  -> %s\n", path);
+	return (0);
+}
+
+/*
+ * load_finding - Read a saved finding back into a candidate
+ * @path: File written by write_finding()
+ * @candidate: Filled with the parts
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int load_finding(const char *path, Candidate *candidate)
+{
+	unsigned long a_start, a_length, b_start, b_length;
+	char *text = read_file(path);
+	const char *body;
+	size_t length;
+
+	memset(candidate, 0, sizeof(*candidate));
+	if (!text)
+		return (-1);
+	body = strchr(text, '\n');
+	if (sscanf(text, HEADER_FORMAT, &a_start, &a_length, &b_start,
+		   &b_length) != 4 || !body)
+	{
+		free(text);
+		return (-1);
+	}
+	body++;
+	length = strlen(body);
+	if (a_start + a_length > b_start || b_start + b_length > length)
+	{
+		free(text);
+		return (-1);
+	}
+
+	candidate->part[PART_PREFIX] = substring(body, 0, a_start);
+	candidate->part[PART_A] = substring(body, a_start, a_length);
+	candidate->part[PART_MIDDLE] = substring(body, a_start + a_length,
+		b_start - a_start - a_length);
+	candidate->part[PART_B] = substring(body, b_start, b_length);
+	candidate->part[PART_SUFFIX] = substring(body, b_start + b_length,
+		length - b_start - b_length);
+	free(text);
+
+	if (!candidate->part[PART_PREFIX] || !candidate->part[PART_A] ||
+	    !candidate->part[PART_MIDDLE] || !candidate->part[PART_B] ||
+	    !candidate->part[PART_SUFFIX])
+	{
+		candidate_free(candidate);
+		return (-1);
+	}
+	return (0);
+}
+
+/*
+ * print_verdict - Print one verdict line
+ */
+static void print_verdict(const char *label, const Verdict *verdict)
+{
+	if (verdict->kind == VERDICT_SUPERLINEAR ||
+	    verdict->kind == VERDICT_LINEAR)
+		printf("%s: %s, %s ~ n^%.2f up to %lu bytes\n", label,
+		       verdict_names[verdict->kind],
+		       metric_names[verdict->metric], verdict->exponent,
+		       (unsigned long)verdict->bytes);
+	else
+		printf("%s: %s at %lu bytes\n", label,
+		       verdict_names[verdict->kind],
+		       (unsigned long)verdict->bytes);
+}
+
+/*
+ * is_known - Check whether a finding is marked as an open issue
+ * @path: Finding file
+ * @options: Settings with the --known list
+ *
+ * Return: 1 if it is, 0 otherwise
+ */
+static int is_known(const char *path, const FuzzOptions *options)
+{
+	int i;
+
+	for (i = 0; i < options->known_count; i++)
+		if (strcmp(options->known[i], path) == 0)
+			return (1);
+	return (0);
+}
+
+/*
+ * check_corpus - Replay saved findings
+ * @paths: Finding files
+ * @count: Number of files
+ * @options: Evaluation settings
+ *
+ * A known finding passes while it stays super-linear and fails once it
+ * scales linearly, so that the list is kept up to date; hangs and
+ * crashes always fail.
+ *
+ * Return: 0 if every finding behaves as expected, 1 otherwise
+ */
+static int check_corpus(char **paths, int count, const FuzzOptions *options)
+{
+	int i, failures = 0, known = 0;
+
+	if (count == 0)
+	{
+		printf("No findings to check\n");
+		return (0);
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		Candidate candidate;
+		Verdict verdict;
+		int open = is_known(paths[i], options);
+
+		if (load_finding(paths[i], &candidate) != 0)
+		{
+			fprintf(stderr, "Error: '%s' is not a finding\n",
+				paths[i]);
+			failures++;
+			continue;
+		}
+		if (evaluate(&candidate, options, &verdict) != 0)
+		{
+			fprintf(stderr, "Error: Could not measure '%s'\n",
+				paths[i]);
+			failures++;
+		}
+		else
+		{
+			print_verdict(paths[i], &verdict);
+			if (open && verdict.kind == VERDICT_SUPERLINEAR)
+			{
+				printf("  known issue\n");
+				known++;
+			}
+			else if (open)
+			{
+				printf("  no longer super-linear: drop it from "
+				       "the known list\n");
+				failures++;
+			}
+			else if (verdict.kind != VERDICT_LINEAR)
+				failures++;
+		}
+		candidate_free(&candidate);
+	}
+
+	printf("%d of %d findings failing, %d known issues\n", failures, count,
+	       known);
+	return (failures > 0);
+}
+
+/*
+ * fuzz - Generate, evaluate and save candidates
+ * @seeds: Seed texts
+ * @seed_count: Number of seeds
+ * @options: Settings
+ *
+ * Return: 0 on success, 1 on error
+ */
+static int fuzz(char **seeds, int seed_count, const FuzzOptions *options)
+{
+	char **saved;
+	int iteration, found = 0, s, status = 0;
+
+	saved = calloc(options->max_findings + 1, sizeof(char *));
+	if (!saved)
+		return (1);
+	if (mkdir(options->out_dir, 0777) != 0 && errno != EEXIST)
+	{
+		fprintf(stderr, "Error: Could not create '%s'\n",
+			options->out_dir);
+		free(saved);
+		return (1);
+	}
+
+	for (iteration = 0; iteration < options->iterations &&
+	     found < options->max_findings; iteration++)
+	{
+		Candidate candidate, copy;
+		Verdict verdict;
+		char label[64];
+		char *text;
+		size_t length;
+		int duplicate = 0;
+
+		if (make_candidate(&candidate, seeds, seed_count) != 0)
+		{
+			status = 1;
+			break;
+		}
+		if (evaluate(&candidate, options, &verdict) != 0 ||
+		    verdict.kind == VERDICT_LINEAR)
+		{
+			candidate_free(&candidate);
+			continue;
+		}
+
+		snprintf(label, sizeof(label), "iteration %d", iteration);
+		print_verdict(label, &verdict);
+		if (candidate_copy(&copy, &candidate) == 0)
+		{
+			minimize(&copy, options, &verdict);
+			candidate_free(&candidate);
+			candidate = copy;
+		}
+
+		/* Different mutations often minimize to the same input */
+		text = build_input(&candidate, 1, &length);
+		for (s = 0; text && s < found; s++)
+			if (strcmp(saved[s], text) == 0)
+				duplicate = 1;
+		if (text && !duplicate)
+		{
+			print_verdict("  minimized", &verdict);
+			if (write_finding(&candidate, &verdict, options->out_dir,
+					  found + 1) != 0)
+				status = 1;
+			saved[found++] = text;
+		}
+		else
+			free(text);
+		candidate_free(&candidate);
+	}
+
+	printf("%d iterations, %d findings in %s\n", iteration, found,
+	       options->out_dir);
+	for (s = 0; s < found; s++)
+		free(saved[s]);
+	free(saved);
+	return (status);
+}
+
+/*
+ * usage - Print command line help
+ */
+static void usage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [--iterations N] [--seed N] [--out DIR]"
+		" [--threshold X] [--timeout SEC] [--pump-bytes N]"
+		" [--max-findings N] seeds...\n"
+		"       %s --check [--threshold X] [--timeout SEC]"
+		" [--known FINDING]... findings...\n", program, program);
+}
+
+/*
+ * main - Fuzz for super-linear inputs, or replay saved findings
+ * @argc: Argument count
+ * @argv: Options and seed (or finding) files
+ *
+ * Return: 0 on success, 1 on error or (with --check) on a failing finding
+ */
+int main(int argc, char **argv)
+{
+	FuzzOptions options = {
+		DEFAULT_ITERATIONS, 1, DEFAULT_THRESHOLD, DEFAULT_TIMEOUT,
+		DEFAULT_PUMP_BYTES, DEFAULT_MAX_FINDINGS, "complexity_findings",
+		0, NULL, 0
+	};
+	char **files, **seeds;
+	int file_count = 0, i, status;
+
+	files = calloc(argc + 1, sizeof(char *));
+	options.known = calloc(argc + 1, sizeof(char *));
+	if (!files || !options.known)
+	{
+		free(files);
+		free(options.known);
+		return (1);
+	}
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+			options.iterations = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			options.seed = strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			options.out_dir = argv[++i];
+		else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+			options.threshold = atof(argv[++i]);
+		else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc)
+			options.timeout = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--pump-bytes") == 0 && i + 1 < argc)
+			options.pump_bytes = strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--max-findings") == 0 && i + 1 < argc)
+			options.max_findings = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--check") == 0)
+			options.check = 1;
+		else if (strcmp(argv[i], "--known") == 0 && i + 1 < argc)
+			options.known[options.known_count++] = argv[++i];
+		else if (argv[i][0] == '-')
+		{
+			usage(argv[0]);
+			free(files);
+			free(options.known);
+			return (1);
+		}
+		else
+			files[file_count++] = argv[i];
+	}
+	/* An empty corpus is nothing to check, but fuzzing needs seeds */
+	if ((file_count == 0 && !options.check) || options.timeout < 1 ||
+	    options.max_findings < 1)
+	{
+		usage(argv[0]);
+		free(files);
+		free(options.known);
+		return (1);
+	}
+
+	if (options.check)
+	{
+		status = check_corpus(files, file_count, &options);
+		free(files);
+		free(options.known);
+		return (status);
+	}
+
+	seeds = calloc(file_count, sizeof(char *));
+	if (!seeds)
+	{
+		free(files);
+		return (1);
+	}
+	status = 0;
+	for (i = 0; i < file_count && status == 0; i++)
+	{
+		seeds[i] = read_file(files[i]);
+		if (!seeds[i])
+		{
+			fprintf(stderr, "Error: Could not read '%s'\n",
+				files[i]);
+			status = 1;
+		}
+	}
+
+	rng_state = options.seed * 2654435761ULL + 1;
+	if (status == 0)
+		status = fuzz(seeds, file_count, &options);
+
+	for (i = 0; i < file_count; i++)
+		free(seeds[i]);
+	free(seeds);
+	free(files);
+	free(options.known);
+	return (status);
+}
@@ -0,0 +1,661 @@
+/*
+ * golden.c - Golden corpus runner (run with `make test-golden`)
+ *
+ * Formats every input and compares the result with the file of the
+ * same name in the expected directory through a compare sink, checks
+ * that formatting the result again changes nothing (an input that fails
+ * either check fails the run, and --update does not write output that
+ * is not idempotent), and times the whole
+ * pipeline to report MB/s, so that wrong output and slow output show up
+ * in the same run. Inputs run in parallel, each in its own child process
+ * with a timeout, so a hang or crash fails one input rather than the run.
+ */
+#define _GNU_SOURCE
+#include "../include/lexer.h"
+#include "../include/parser.h"
+#include "../include/formatter.h"
+#include "../include/sink.h"
+#include "../include/json.h"
+#include "../include/utils.h"
+#include "../include/stats.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define DEFAULT_EXPECTED_DIR "formatted"
+#define DEFAULT_REPETITIONS 5
+#define DEFAULT_TIMEOUT 10
+#define MAX_REPETITIONS 100
+#define MAX_PATH_LENGTH 4096
+#define SNIPPET_LENGTH 72
+
+/*
+ * Outcome of one input
+ *   GOLDEN_PASS     - output matches the expected file
+ *   GOLDEN_DIFF     - output differs from the expected file
+ *   GOLDEN_MISSING  - no expected file
+ *   GOLDEN_UPDATED  - expected file rewritten (--update)
+ *   GOLDEN_KEPT     - output not idempotent, expected file left (--update)
+ *   GOLDEN_ERROR    - input unreadable or not formatted
+ *   GOLDEN_HANG     - child exceeded the timeout
+ *   GOLDEN_CRASH    - child died or returned no result
+ */
+typedef enum {
+	GOLDEN_PASS,
+	GOLDEN_DIFF,
+	GOLDEN_MISSING,
+	GOLDEN_UPDATED,
+	GOLDEN_KEPT,
+	GOLDEN_ERROR,
+	GOLDEN_HANG,
+	GOLDEN_CRASH
+} GoldenVerdict;
+
+/*
+ * GoldenResult - What a child reports about its input
+ * @index: Input index
+ * @verdict: GoldenVerdict
+ * @idempotent: Formatting the output again reproduced it
+ * @diff_line: First line that differs from the expected file, or 0
+ * @diff_column: Column of the first difference on that line
+ * @input_bytes: Size of the input
+ * @seconds: Median time of the whole pipeline
+ * @expected: Expected text around the difference, to the end of line
+ * @actual: Output around the difference, to the end of line
+ *
+ * Smaller than PIPE_BUF, so children can share one pipe.
+ */
+typedef struct GoldenResult {
+	int index;
+	int verdict;
+	int idempotent;
+	int diff_line;
+	int diff_column;
+	size_t input_bytes;
+	double seconds;
+	char expected[SNIPPET_LENGTH];
+	char actual[SNIPPET_LENGTH];
+} GoldenResult;
+
+/*
+ * GoldenOptions - Settings shared by every input
+ */
+typedef struct GoldenOptions {
+	const char *expected_dir;
+	int repetitions;
+	int timeout;
+	int update;
+} GoldenOptions;
+
+/*
+ * now - Monotonic time
+ *
+ * Return: Seconds
+ */
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/*
+ * compare_times - qsort comparator for doubles
+ */
+static int compare_times(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return ((x > y) - (x < y));
+}
+
+/*
+ * format_into - Lex, parse and format a source into a sink
+ * @source: NUL-terminated source
+ * @length: Length of @source
+ * @sink: Destination, flushed on success
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int format_into(const char *source, size_t length, OutputSink *sink)
+{
+	Lexer *lexer = lexer_create(source);
+	Parser *parser = NULL;
+	Formatter *formatter = NULL;
+	ASTNode *ast = NULL;
+	int result = -1;
+
+	if (lexer && lexer_tokenize(lexer) >= 0)
+		parser = parser_create(lexer_get_tokens(lexer),
+				       lexer_get_token_count(lexer));
+	if (parser)
+		ast = parser_parse(parser);
+	if (ast)
+		formatter = formatter_create(sink);
+	if (formatter)
+	{
+		formatter_set_source(formatter, lexer_get_tokens(lexer),
+				     lexer_get_token_count(lexer));
+		formatter_set_comments(formatter, parser->comments);
+		formatter_set_source_slices(formatter, source, length);
+		result = formatter_format(formatter, ast);
+		formatter_destroy(formatter);
+	}
+	if (result == 0)
+		result = sink_flush(sink);
+
+	ast_node_destroy(ast);
+	parser_destroy(parser);
+	lexer_destroy(lexer);
+
+	return (result);
+}
+
+/*
+ * copy_line - Copy the start of a line into a snippet
+ * @snippet: Destination of SNIPPET_LENGTH bytes
+ * @line: Start of the line
+ * @end: End of the text
+ */
+static void copy_line(char *snippet, const char *line, const char *end)
+{
+	size_t length = 0;
+
+	while (line + length < end && line[length] != '\n' &&
+	       length + 1 < SNIPPET_LENGTH)
+		length++;
+	memcpy(snippet, line, length);
+	snippet[length] = '\0';
+}
+
+/*
+ * first_difference - Locate the first line where two texts differ
+ * @result: Gets the line number and both lines
+ * @expected: Expected text
+ * @expected_length: Length of @expected
+ * @actual: Output
+ * @actual_length: Length of @actual
+ */
+static void first_difference(GoldenResult *result, const char *expected,
+			     size_t expected_length, const char *actual,
+			     size_t actual_length)
+{
+	size_t i = 0, line_start = 0;
+	int line = 1;
+
+	while (i < expected_length && i < actual_length &&
+	       expected[i] == actual[i])
+	{
+		if (expected[i] == '\n')
+		{
+			line++;
+			line_start = i + 1;
+		}
+		i++;
+	}
+
+	/* Long lines are shown from shortly before the difference */
+	result->diff_line = line;
+	result->diff_column = (int)(i - line_start) + 1;
+	if (i - line_start > SNIPPET_LENGTH / 2)
+		line_start = i - SNIPPET_LENGTH / 4;
+	copy_line(result->expected, expected + line_start,
+		  expected + expected_length);
+	copy_line(result->actual, actual + line_start, actual + actual_length);
+}
+
+/*
+ * write_expected - Replace an expected file with new output
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int write_expected(const char *path, const char *text, size_t length)
+{
+	FILE *fp = fopen(path, "w");
+	int status = 0;
+
+	if (!fp)
+		return (-1);
+	if (fwrite(text, 1, length, fp) != length)
+		status = -1;
+	if (fclose(fp) != 0)
+		status = -1;
+
+	return (status);
+}
+
+/*
+ * time_runs - Time the pipeline, comparing each run with a reference
+ * @source: Input
+ * @length: Length of @source
+ * @reference: Text the output is compared with
+ * @reference_length: Length of @reference
+ * @repetitions: Timed runs
+ * @matches: Set when the output equals @reference
+ *
+ * Return: Median seconds, or -1 on error
+ */
+static double time_runs(const char *source, size_t length,
+			const char *reference, size_t reference_length,
+			int repetitions, int *matches)
+{
+	double times[MAX_REPETITIONS], start;
+	OutputSink *sink;
+	int i, status;
+
+	for (i = 0; i < repetitions; i++)
+	{
+		sink = sink_create_compare(reference, reference_length);
+		if (!sink)
+			return (-1);
+		start = now();
+		status = format_into(source, length, sink);
+		times[i] = now() - start;
+		*matches = sink_matches(sink);
+		sink_destroy(sink);
+		if (status != 0)
+			return (-1);
+	}
+
+	qsort(times, repetitions, sizeof(double), compare_times);
+	return (times[repetitions / 2]);
+}
+
+/*
+ * run_input - Check and time one input (runs in the child)
+ * @input: Input path
+ * @opts: Settings
+ * @result: Filled in (index already set)
+ */
+static void run_input(const char *input, const GoldenOptions *opts,
+		      GoldenResult *result)
+{
+	char path[MAX_PATH_LENGTH];
+	const char *base = strrchr(input, '/');
+	char *source = read_file(input), *expected, *output = NULL;
+	size_t length, expected_length = 0, output_length = 0;
+	OutputSink *sink;
+	int matches = 0;
+
+	result->verdict = GOLDEN_ERROR;
+	if (!source)
+		return;
+	length = strlen(source);
+	result->input_bytes = length;
+
+	snprintf(path, sizeof(path), "%s/%s", opts->expected_dir,
+		 base ? base + 1 : input);
+	expected = opts->update ? NULL : read_file(path);
+	if (expected)
+		expected_length = strlen(expected);
+
+	/* One run into memory, for the idempotency check and the diff */
+	sink = sink_create_memory();
+	if (sink && format_into(source, length, sink) == 0)
+		output = sink_take_buffer(sink, &output_length);
+	sink_destroy(sink);
+
+	if (output)
+	{
+		sink = sink_create_compare(output, output_length);
+		result->idempotent = sink &&
+			format_into(output, output_length, sink) == 0 &&
+			sink_matches(sink);
+		sink_destroy(sink);
+
+		result->seconds = time_runs(source, length,
+			expected ? expected : output,
+			expected ? expected_length : output_length,
+			opts->repetitions, &matches);
+	}
+
+	if (!output || result->seconds < 0)
+		result->verdict = GOLDEN_ERROR;
+	else if (opts->update && !result->idempotent)
+		result->verdict = GOLDEN_KEPT;
+	else if (opts->update)
+		result->verdict = write_expected(path, output, output_length) == 0
+			? GOLDEN_UPDATED : GOLDEN_ERROR;
+	else if (!expected)
+		result->verdict = GOLDEN_MISSING;
+	else if (matches)
+		result->verdict = GOLDEN_PASS;
+	else
+	{
+		result->verdict = GOLDEN_DIFF;
+		first_difference(result, expected, expected_length, output,
+				 output_length);
+	}
+
+	mem_free(output);
+	free(expected);
+	free(source);
+}
+
+/*
+ * start_child - Fork a child that runs one input
+ * @input: Input path
+ * @index: Input index
+ * @opts: Settings
+ * @fd: Write end of the result pipe
+ *
+ * Return: Child pid, or -1 if it could not be started
+ */
+static pid_t start_child(const char *input, int index,
+			 const GoldenOptions *opts, int fd)
+{
+	pid_t pid;
+
+	fflush(NULL);
+	pid = fork();
+	if (pid == 0)
+	{
+		GoldenResult result;
+
+		memset(&result, 0, sizeof(result));
+		result.index = index;
+		/* Parse errors would interleave with the report */
+		if (!freopen("/dev/null", "w", stderr))
+			_exit(2);
+		alarm(opts->timeout);
+		run_input(input, opts, &result);
+		if (write(fd, &result, sizeof(result)) != (ssize_t)sizeof(result))
+			_exit(2);
+		_exit(0);
+	}
+
+	return (pid);
+}
+
+/*
+ * read_result - Read one result from the pipe into its slot
+ * @fd: Read end of the result pipe
+ * @results: Results by input index
+ * @count: Number of inputs
+ *
+ * Return: 0 on success, -1 if no whole result could be read
+ */
+static int read_result(int fd, GoldenResult *results, int count)
+{
+	GoldenResult result;
+	size_t got = 0;
+
+	while (got < sizeof(result))
+	{
+		ssize_t n = read(fd, (char *)&result + got, sizeof(result) - got);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return (-1);
+		got += n;
+	}
+	if (result.index < 0 || result.index >= count)
+		return (-1);
+	results[result.index] = result;
+
+	return (0);
+}
+
+/*
+ * run_all - Run every input, at most @jobs at a time
+ * @inputs: Input paths
+ * @count: Number of inputs
+ * @jobs: Children running at once
+ * @opts: Settings
+ * @results: Filled in by input index
+ *
+ * Return: 0 on success, -1 if the children could not be started
+ */
+static int run_all(char **inputs, int count, int jobs,
+		   const GoldenOptions *opts, GoldenResult *results)
+{
+	pid_t *pids = calloc(count, sizeof(pid_t));
+	int fds[2], next = 0, running = 0, done, i, wstatus;
+	pid_t pid;
+
+	if (!pids || pipe(fds) != 0)
+	{
+		free(pids);
+		return (-1);
+	}
+
+	while (next < count || running > 0)
+	{
+		while (next < count && running < jobs)
+		{
+			results[next].index = next;
+			results[next].verdict = GOLDEN_CRASH;
+			pids[next] = start_child(inputs[next], next, opts, fds[1]);
+			if (pids[next] < 0)
+				break;
+			next++;
+			running++;
+		}
+		if (running == 0)
+			break;
+
+		pid = waitpid(-1, &wstatus, 0);
+		if (pid < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		done = -1;
+		for (i = 0; i < next && done < 0; i++)
+			if (pids[i] == pid)
+				done = i;
+		if (done < 0)
+			continue;
+		running--;
+
+		/* A child writes its result just before exiting cleanly */
+		if (WIFSIGNALED(wstatus))
+			results[done].verdict = WTERMSIG(wstatus) == SIGALRM ?
+				GOLDEN_HANG : GOLDEN_CRASH;
+		else if (WEXITSTATUS(wstatus) == 0)
+			read_result(fds[0], results, count);
+	}
+
+	close(fds[0]);
+	close(fds[1]);
+	free(pids);
+
+	return (next == count ? 0 : -1);
+}
+
+/*
+ * verdict_name - Report word of a verdict
+ */
+static const char *verdict_name(int verdict)
+{
+	static const char *const names[] = {"ok", "DIFF", "MISSING", "updated",
+					    "NOT UPDATED", "ERROR", "HANG",
+					    "CRASH"};
+
+	return (verdict >= 0 && verdict <= GOLDEN_CRASH ? names[verdict] : "?");
+}
+
+/*
+ * is_failure - Whether a result fails the run
+ * @result: Result
+ */
+static int is_failure(const GoldenResult *result)
+{
+	if (result->verdict != GOLDEN_PASS && result->verdict != GOLDEN_UPDATED)
+		return (1);
+	return (!result->idempotent);
+}
+
+/*
+ * print_result - Print the report line of one input
+ */
+static void print_result(const char *input, const GoldenResult *result)
+{
+	const char *stability = "";
+
+	if (result->verdict <= GOLDEN_KEPT)
+	{
+		if (!result->idempotent)
+			stability = ", UNSTABLE";
+		printf("%-36s %8.1f %9.3f %8.2f  %s%s\n", input,
+		       result->input_bytes / 1024.0, result->seconds * 1e3,
+		       result->seconds > 0 ? result->input_bytes / 1e6 /
+		       result->seconds : 0.0, verdict_name(result->verdict),
+		       stability);
+	}
+	else
+		printf("%-36s %8s %9s %8s  %s\n", input, "-", "-", "-",
+		       verdict_name(result->verdict));
+
+	if (result->verdict == GOLDEN_DIFF)
+		printf("    line %d, column %d\n    expected: %s\n"
+		       "    actual:   %s\n", result->diff_line,
+		       result->diff_column, result->expected, result->actual);
+}
+
+/*
+ * write_json - Write the results as JSON
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int write_json(const char *path, char **inputs,
+		      const GoldenResult *results, int count)
+{
+	FILE *fp = fopen(path, "w");
+	int i;
+
+	if (!fp)
+		return (-1);
+	fputs("{\"version\":1,\"results\":[", fp);
+	for (i = 0; i < count; i++)
+	{
+		const GoldenResult *result = &results[i];
+
+		fputs(i ? ",{\"input\":" : "{\"input\":", fp);
+		json_write_string(fp, inputs[i], strlen(inputs[i]));
+		fprintf(fp, ",\"status\":\"%s\",\"idempotent\":%s,"
+			"\"bytes\":%lu,\"median_ms\":%.4f,\"mb_per_s\":%.3f}",
+			verdict_name(result->verdict),
+			result->idempotent ? "true" : "false",
+			(unsigned long)result->input_bytes,
+			result->seconds * 1e3,
+			result->seconds > 0 ? result->input_bytes / 1e6 /
+			result->seconds : 0.0);
+	}
+	fputs("]}\n", fp);
+
+	return (fclose(fp) == 0 ? 0 : -1);
+}
+
+/*
+ * usage - Print command line help
+ */
+static void usage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [--jobs N] [--reps N] [--timeout SECONDS]"
+		" [--expected DIR] [--update]"
+		" [--json FILE] files...\n", program);
+}
+
+/*
+ * main - Run the golden corpus
+ * @argc: Argument count
+ * @argv: Options and input files
+ *
+ * Return: 0 if every input passed, 1 otherwise
+ */
+int main(int argc, char **argv)
+{
+	GoldenOptions opts = {DEFAULT_EXPECTED_DIR, DEFAULT_REPETITIONS,
+			      DEFAULT_TIMEOUT, 0};
+	char **inputs = NULL;
+	const char *json_path = NULL;
+	GoldenResult *results = NULL;
+	int input_count = 0, failures = 0, status = 0;
+	long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	double total_seconds = 0;
+	size_t total_bytes = 0;
+	int i;
+
+	inputs = malloc(sizeof(char *) * argc);
+	if (!inputs)
+		return (1);
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+			jobs = atol(argv[++i]);
+		else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+			opts.repetitions = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc)
+			opts.timeout = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--expected") == 0 && i + 1 < argc)
+			opts.expected_dir = argv[++i];
+		else if (strcmp(argv[i], "--update") == 0)
+			opts.update = 1;
+		else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			json_path = argv[++i];
+		else if (argv[i][0] == '-')
+			status = 1;
+		else
+			inputs[input_count++] = argv[i];
+	}
+	if (jobs < 1)
+		jobs = 1;
+	if (status != 0 || input_count == 0 || opts.repetitions < 1 ||
+	    opts.repetitions > MAX_REPETITIONS || opts.timeout < 1)
+	{
+		usage(argv[0]);
+		free(inputs);
+		return (1);
+	}
+
+	results = calloc(input_count, sizeof(GoldenResult));
+	if (!results || run_all(inputs, input_count, jobs, &opts, results) != 0)
+	{
+		fprintf(stderr, "Error: Could not run the inputs\n");
+		status = 1;
+	}
+
+	if (status == 0)
+	{
+		printf("%-36s %8s %9s %8s  %s\n", "input", "KB", "median ms",
+		       "MB/s", "result");
+		for (i = 0; i < input_count; i++)
+		{
+			print_result(inputs[i], &results[i]);
+			if (is_failure(&results[i]))
+				failures++;
+			if (results[i].verdict <= GOLDEN_KEPT)
+			{
+				total_bytes += results[i].input_bytes;
+				total_seconds += results[i].seconds;
+			}
+		}
+		printf("%d inputs, %d failed, %.2f MB/s over %.1f KB "
+		       "(%ld jobs)\n", input_count, failures,
+		       total_seconds > 0 ? total_bytes / 1e6 / total_seconds :
+		       0.0, total_bytes / 1024.0, jobs);
+		if (failures > 0)
+			status = 1;
+		if (json_path &&
+		    write_json(json_path, inputs, results, input_count) != 0)
+		{
+			fprintf(stderr, "Error: Could not write '%s'\n",
+				json_path);
+			status = 1;
+		}
+	}
+
+	free(results);
+	free(inputs);
+	return (status);
+}
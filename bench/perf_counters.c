@@ -0,0 +1,236 @@
+/*
+ * perf_counters.c - Hardware counters for the benchmark (Linux
+ * perf_event_open)
+ *
+ * Each counter is opened on its own, so a machine that lacks one (L1
+ * events are often missing in virtual machines) still reports the rest.
+ * Where none can be opened, in most containers or with a strict
+ * perf_event_paranoid, the benchmark runs without them. Elsewhere than
+ * on Linux nothing opens.
+ */
+#define _GNU_SOURCE
+#include "perf_counters.h"
+#include <errno.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+ * Event type and configuration of each counter
+ */
+static const struct {
+	unsigned int type;
+	unsigned long long config;
+} events[PERF_COUNTER_COUNT] = {
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+		(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		(PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+};
+
+/*
+ * perf_counters_open - Open every counter that the machine offers
+ * @counters: Counters to fill in
+ *
+ * Return: Number of counters opened (0 if none is available)
+ */
+int perf_counters_open(PerfCounters *counters)
+{
+	struct perf_event_attr attr;
+	int i;
+
+	counters->open_count = 0;
+	counters->error = 0;
+	for (i = 0; i < PERF_COUNTER_COUNT; i++)
+	{
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = events[i].type;
+		attr.config = events[i].config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+			PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		counters->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0,
+						 -1, -1, 0);
+		if (counters->fds[i] >= 0)
+			counters->open_count++;
+		else if (counters->error == 0)
+			counters->error = errno;
+	}
+
+	return (counters->open_count);
+}
+
+/*
+ * perf_counters_close - Close the open counters
+ */
+void perf_counters_close(PerfCounters *counters)
+{
+	int i;
+
+	for (i = 0; i < PERF_COUNTER_COUNT; i++)
+	{
+		if (counters->fds[i] >= 0)
+			close(counters->fds[i]);
+		counters->fds[i] = -1;
+	}
+	counters->open_count = 0;
+}
+
+/*
+ * perf_counters_start - Zero and start the open counters
+ */
+void perf_counters_start(PerfCounters *counters)
+{
+	int i;
+
+	for (i = 0; i < PERF_COUNTER_COUNT; i++)
+		if (counters->fds[i] >= 0)
+		{
+			ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+}
+
+/*
+ * perf_counters_stop - Stop the open counters and read them
+ * @counters: Counters
+ * @sample: Gets the counts; a counter that did not run is not valid
+ *
+ * When there are more counters than the PMU has registers, the kernel
+ * time-shares them; counts are scaled by enabled over running time.
+ */
+void perf_counters_stop(PerfCounters *counters, PerfSample *sample)
+{
+	unsigned long long data[3];
+	int i;
+
+	for (i = 0; i < PERF_COUNTER_COUNT; i++)
+		if (counters->fds[i] >= 0)
+			ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+	for (i = 0; i < PERF_COUNTER_COUNT; i++)
+	{
+		sample->values[i] = 0;
+		sample->valid[i] = 0;
+		if (counters->fds[i] < 0 ||
+		    read(counters->fds[i], data, sizeof(data)) !=
+		    (ssize_t)sizeof(data) || data[2] == 0)
+			continue;
+		sample->values[i] = (double)data[0] * data[1] / data[2];
+		sample->valid[i] = 1;
+	}
+}
+
+#else
+
+/*
+ * perf_counters_open - No counters outside Linux
+ *
+ * Return: 0
+ */
+int perf_counters_open(PerfCounters *counters)
+{
+	int i;
+
+	for (i = 0; i < PERF_COUNTER_COUNT; i++)
+		counters->fds[i] = -1;
+	counters->open_count = 0;
+	counters->error = ENOSYS;
+	return (0);
+}
+
+/*
+ * perf_counters_close - Nothing to close
+ */
+void perf_counters_close(PerfCounters *counters)
+{
+	counters->open_count = 0;
+}
+
+/*
+ * perf_counters_start - Nothing to start
+ */
+void perf_counters_start(PerfCounters *counters)
+{
+	(void)counters;
+}
+
+/*
+ * perf_counters_stop - Report every counter as not valid
+ */
+void perf_counters_stop(PerfCounters *counters, PerfSample *sample)
+{
+	(void)counters;
+	memset(sample, 0, sizeof(*sample));
+}
+
+#endif /* __linux__ */
+
+/*
+ * perf_counter_name - Short name of a counter (JSON key)
+ */
+const char *perf_counter_name(PerfCounter counter)
+{
+	static const char *const names[PERF_COUNTER_COUNT] = {
+		"cycles", "instructions", "l1d_misses", "llc_misses",
+		"branch_misses"
+	};
+
+	return ((unsigned int)counter < PERF_COUNTER_COUNT ?
+		names[counter] : "?");
+}
+
+/*
+ * perf_counters_explain - Say which counters are missing, and why
+ * @out: Stream
+ * @counters: Counters after perf_counters_open
+ */
+void perf_counters_explain(FILE *out, const PerfCounters *counters)
+{
+	const char *reason;
+	int i;
+
+	if (counters->open_count == PERF_COUNTER_COUNT)
+		return;
+
+	switch (counters->error)
+	{
+	case EACCES:
+	case EPERM:
+		reason = "not permitted (see /proc/sys/kernel/"
+			"perf_event_paranoid)";
+		break;
+	case ENOENT:
+	case EOPNOTSUPP:
+		reason = "not supported by this CPU or virtual machine";
+		break;
+	case ENOSYS:
+		reason = "perf_event_open is not available";
+		break;
+	default:
+		reason = strerror(counters->error);
+		break;
+	}
+
+	if (counters->open_count == 0)
+	{
+		fprintf(out, "Hardware counters unavailable: %s\n", reason);
+		return;
+	}
+	fputs("Hardware counters missing:", out);
+	for (i = 0; i < PERF_COUNTER_COUNT; i++)
+		if (counters->fds[i] < 0)
+			fprintf(out, " %s", perf_counter_name(i));
+	fprintf(out, " (%s)\n", reason);
+}
@@ -0,0 +1,48 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+
+/*
+ * Hardware counters read around each benchmark run
+ */
+typedef enum {
+	PERF_CYCLES,
+	PERF_INSTRUCTIONS,
+	PERF_L1D_MISSES,     /* L1 data cache read misses */
+	PERF_LLC_MISSES,     /* Last level cache misses */
+	PERF_BRANCH_MISSES,  /* Mispredicted branches */
+	PERF_COUNTER_COUNT
+} PerfCounter;
+
+/*
+ * PerfCounters - Open counters of this process (user space only)
+ * @fds: Event descriptors, -1 where the counter could not be opened
+ * @open_count: Number of counters opened
+ * @error: errno of the first counter that failed to open, or 0
+ */
+typedef struct PerfCounters {
+	int fds[PERF_COUNTER_COUNT];
+	int open_count;
+	int error;
+} PerfCounters;
+
+/*
+ * PerfSample - Counts of one run
+ * @values: Count per counter, scaled up if the kernel multiplexed it
+ * @valid: The counter was open and ran
+ */
+typedef struct PerfSample {
+	double values[PERF_COUNTER_COUNT];
+	int valid[PERF_COUNTER_COUNT];
+} PerfSample;
+
+int perf_counters_open(PerfCounters *counters);
+void perf_counters_close(PerfCounters *counters);
+void perf_counters_start(PerfCounters *counters);
+void perf_counters_stop(PerfCounters *counters, PerfSample *sample);
+
+const char *perf_counter_name(PerfCounter counter);
+void perf_counters_explain(FILE *out, const PerfCounters *counters);
+
+#endif /* PERF_COUNTERS_H */
@@ -0,0 +1,688 @@
+/*
+ * scaling.c - Fitted complexity exponents per input axis
+ * (run with `make bench-scaling`)
+ *
+ * Each axis generates a valid C file that grows in one direction only:
+ * function count, statement count, nesting depth, expression length,
+ * initializer size, comment count, else-if chain length or switch case
+ * count. The whole pipeline (lex, parse, format into memory, teardown)
+ * runs at doubling sizes, and a power law in the axis size is fitted to
+ * the median time, allocated bytes and peak live bytes. Each timed
+ * sample repeats the pipeline until it lasts --min-sample-ms, so even
+ * the smallest sizes are timed well above the clock's noise. An axis whose
+ * memory exponent exceeds the limit, or whose time exponent does by more
+ * than TIME_MARGIN standard errors, is flagged. The inputs only
+ * depend on the axis and size, so runs are comparable across commits.
+ */
+#define _GNU_SOURCE
+#include "../include/lexer.h"
+#include "../include/parser.h"
+#include "../include/formatter.h"
+#include "../include/sink.h"
+#include "../include/stats.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define DEFAULT_STEPS 8
+#define DEFAULT_REPETITIONS 7
+#define DEFAULT_MIN_SAMPLE_MS 20.0
+#define MAX_BATCH 100000
+#define DEFAULT_LIMIT 1.1
+#define TIME_MARGIN 2.0
+#define MAX_STEPS 12
+#define MAX_REPETITIONS 100
+
+/*
+ * TextBuffer - Growing generated source
+ */
+typedef struct TextBuffer {
+	char *data;
+	size_t length;
+	size_t capacity;
+	int failed;
+} TextBuffer;
+
+typedef void (*GenerateFn)(TextBuffer *text, int size);
+
+/*
+ * ScalingAxis - One direction of growth
+ * @name: Axis name
+ * @base: Size of the first step (doubled at each further step)
+ * @generate: Writes an input of a given size
+ * @max_size: Largest size the input stays valid at, or 0 for no limit
+ */
+typedef struct ScalingAxis {
+	const char *name;
+	int base;
+	GenerateFn generate;
+	int max_size;
+} ScalingAxis;
+
+/*
+ * ScalingPoint - Measurements at one size
+ */
+typedef struct ScalingPoint {
+	int size;
+	size_t input_bytes;
+	size_t output_bytes;
+	double seconds;  /* Median time of one run */
+	int batch;       /* Runs per timed sample */
+	StatsTotals memory;
+} ScalingPoint;
+
+/*
+ * append - Append formatted text to a buffer
+ * @text: Buffer (marked failed on allocation failure)
+ * @format: printf format
+ */
+static void append(TextBuffer *text, const char *format, ...)
+{
+	va_list args;
+	int needed;
+
+	while (!text->failed)
+	{
+		va_start(args, format);
+		needed = vsnprintf(text->data + text->length,
+				   text->capacity - text->length, format, args);
+		va_end(args);
+		if (needed < 0)
+			text->failed = 1;
+		else if (text->length + needed < text->capacity)
+		{
+			text->length += needed;
+			return;
+		}
+		else
+		{
+			size_t new_capacity = text->capacity * 2 + needed;
+			char *new_data = realloc(text->data, new_capacity);
+
+			if (!new_data)
+				text->failed = 1;
+			else
+			{
+				text->data = new_data;
+				text->capacity = new_capacity;
+			}
+		}
+	}
+}
+
+/*
+ * gen_functions - @size small documented functions
+ */
+static void gen_functions(TextBuffer *text, int size)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		append(text, "/**\n * f_%d - Scale a value\n * @a: Value\n *\n"
+		       " * Return: Scaled value\n */\nint f_%d(int a)\n{\n"
+		       "\tif (a > %d)\n\t\treturn (a / 2);\n"
+		       "\treturn (a * %d);\n}\n\n", i, i, i, i % 7 + 2);
+}
+
+/*
+ * gen_statements - One function with @size statements
+ */
+static void gen_statements(TextBuffer *text, int size)
+{
+	int i;
+
+	append(text, "int f(int a, int b)\n{\n\tint total = 0;\n\n");
+	for (i = 0; i < size; i++)
+		append(text, i % 2 ? "\ttotal += a * %d;\n" :
+		       "\ttotal -= b + %d;\n", i);
+	append(text, "\treturn (total);\n}\n");
+}
+
+/*
+ * gen_nesting - Blocks nested @size deep (written unindented, so the
+ * indentation of the output is part of the cost)
+ *
+ * Each level is an if and its block, two levels for the parser, so
+ * NESTING_MAX_SIZE keeps the innermost statement within
+ * PARSER_MAX_DEPTH instead of measuring its raw text fallback.
+ */
+#define NESTING_MAX_SIZE ((PARSER_MAX_DEPTH - 1) / 2)
+
+static void gen_nesting(TextBuffer *text, int size)
+{
+	int i;
+
+	append(text, "int f(int a)\n{\n");
+	for (i = 0; i < size; i++)
+		append(text, "if (a > %d) {\na--;\n", i);
+	for (i = 0; i < size; i++)
+		append(text, "}\n");
+	append(text, "return (a);\n}\n");
+}
+
+/*
+ * gen_expression - One binary expression with @size operands
+ */
+static void gen_expression(TextBuffer *text, int size)
+{
+	int i;
+
+	append(text, "int f(int a)\n{\n\treturn (a");
+	for (i = 0; i < size; i++)
+		append(text, i % 3 ? " + a * %d" : " - %d", i);
+	append(text, ");\n}\n");
+}
+
+/*
+ * gen_initializer - One array initializer with @size elements
+ */
+static void gen_initializer(TextBuffer *text, int size)
+{
+	int i;
+
+	append(text, "static const int table[] = {");
+	for (i = 0; i < size; i++)
+		append(text, i ? ", %d" : "%d", i * 7 % 1000);
+	append(text, "};\n");
+}
+
+/*
+ * gen_comments - @size statements, each with a leading and a trailing
+ * comment
+ */
+static void gen_comments(TextBuffer *text, int size)
+{
+	int i;
+
+	append(text, "int f(int a)\n{\n");
+	for (i = 0; i < size; i++)
+		append(text, i % 2 ? "\t/* step %d */\n\ta++; /* up */\n" :
+		       "\t// step %d\n\ta--; // down\n", i);
+	append(text, "\treturn (a);\n}\n");
+}
+
+/*
+ * gen_else_if - An if / else if chain of @size branches
+ */
+static void gen_else_if(TextBuffer *text, int size)
+{
+	int i;
+
+	append(text, "int f(int a)\n{\n");
+	for (i = 0; i < size; i++)
+		append(text, i ? "\telse if (a == %d)\n\t\treturn (%d);\n" :
+		       "\tif (a == %d)\n\t\treturn (%d);\n", i, i * 3);
+	append(text, "\treturn (-1);\n}\n");
+}
+
+/*
+ * gen_switch - A switch of @size cases
+ */
+static void gen_switch(TextBuffer *text, int size)
+{
+	int i;
+
+	append(text, "int f(int a)\n{\n\tswitch (a)\n\t{\n");
+	for (i = 0; i < size; i++)
+		append(text, "\tcase %d:\n\t\ta += %d;\n\t\tbreak;\n", i, i * 3);
+	append(text, "\tdefault:\n\t\tbreak;\n\t}\n\treturn (a);\n}\n");
+}
+
+static const ScalingAxis axes[] = {
+	{"functions", 64, gen_functions, 0},
+	{"statements", 256, gen_statements, 0},
+	{"nesting", 2, gen_nesting, NESTING_MAX_SIZE},
+	{"expression", 64, gen_expression, 0},
+	{"initializer", 256, gen_initializer, 0},
+	{"comments", 256, gen_comments, 0},
+	{"else-if", 64, gen_else_if, 0},
+	{"switch", 128, gen_switch, 0}
+};
+
+#define AXIS_COUNT ((int)(sizeof(axes) / sizeof(axes[0])))
+
+/*
+ * now - Monotonic time
+ *
+ * Return: Seconds
+ */
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+/*
+ * run_pipeline - Lex, parse and format a source, then free everything
+ * @source: NUL-terminated input
+ * @length: Length of @source
+ * @output_length: Set to the size of the output
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int run_pipeline(const char *source, size_t length,
+			size_t *output_length)
+{
+	Lexer *lexer = lexer_create(source);
+	Parser *parser = NULL;
+	ASTNode *ast = NULL;
+	OutputSink *sink = NULL;
+	Formatter *formatter = NULL;
+	char *output = NULL;
+	int result = -1;
+
+	if (lexer && lexer_tokenize(lexer) >= 0)
+		parser = parser_create(lexer_get_tokens(lexer),
+				       lexer_get_token_count(lexer));
+	if (parser)
+		ast = parser_parse(parser);
+	if (ast && parser->error_count == 0)
+		sink = sink_create_memory();
+	if (sink)
+		formatter = formatter_create(sink);
+	if (formatter)
+	{
+		formatter_set_source(formatter, lexer_get_tokens(lexer),
+				     lexer_get_token_count(lexer));
+		formatter_set_comments(formatter, parser->comments);
+		formatter_set_source_slices(formatter, source, length);
+		result = formatter_format(formatter, ast);
+		formatter_destroy(formatter);
+		if (result == 0)
+			result = sink_flush(sink);
+		output = result == 0 ?
+			sink_take_buffer(sink, output_length) : NULL;
+		if (!output)
+			result = -1;
+	}
+
+	mem_free(output);
+	sink_destroy(sink);
+	ast_node_destroy(ast);
+	parser_destroy(parser);
+	lexer_destroy(lexer);
+
+	return (result);
+}
+
+/*
+ * compare_times - qsort comparator for doubles
+ */
+static int compare_times(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return ((x > y) - (x < y));
+}
+
+/*
+ * run_batch - Run the pipeline several times and time the whole batch
+ * @text: Generated input
+ * @batch: Number of runs
+ * @point: Output size is stored here
+ * @seconds: Set to the elapsed time
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int run_batch(const TextBuffer *text, int batch, ScalingPoint *point,
+		     double *seconds)
+{
+	double start = now();
+	int i;
+
+	for (i = 0; i < batch; i++)
+		if (run_pipeline(text->data, text->length,
+				 &point->output_bytes) != 0)
+			return (-1);
+	*seconds = now() - start;
+
+	return (0);
+}
+
+/*
+ * calibrate - Runs per sample so that a sample lasts @min_sample
+ * @text: Generated input
+ * @min_sample: Minimum time of a sample, in seconds
+ * @point: Output size is stored here
+ *
+ * Return: Runs per sample, or -1 on error
+ */
+static int calibrate(const TextBuffer *text, double min_sample,
+		     ScalingPoint *point)
+{
+	double elapsed;
+	int batch = 1;
+
+	for (;;)
+	{
+		if (run_batch(text, batch, point, &elapsed) != 0)
+			return (-1);
+		if (elapsed >= min_sample || batch >= MAX_BATCH)
+			return (batch);
+		if (elapsed * 4 < min_sample)
+			batch *= 4;
+		else
+			batch = (int)(batch * min_sample / elapsed) + 1;
+		if (batch > MAX_BATCH)
+			batch = MAX_BATCH;
+	}
+}
+
+/*
+ * measure_in_process - Generate one input and measure the pipeline on it
+ * @axis: Axis
+ * @size: Axis size
+ * @repetitions: Timed samples (calibration runs come first)
+ * @min_sample: Minimum time of a sample, in seconds
+ * @point: Filled with the results
+ *
+ * Memory figures come from one more run on its own.
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int measure_in_process(const ScalingAxis *axis, int size,
+			      int repetitions, double min_sample,
+			      ScalingPoint *point)
+{
+	TextBuffer text = {NULL, 0, 0, 0};
+	double times[MAX_REPETITIONS];
+	int i, result;
+
+	text.capacity = 4096;
+	text.data = malloc(text.capacity);
+	if (!text.data)
+		return (-1);
+	text.data[0] = '\0';
+	axis->generate(&text, size);
+	if (text.failed)
+	{
+		free(text.data);
+		return (-1);
+	}
+
+	point->size = size;
+	point->input_bytes = text.length;
+	point->batch = calibrate(&text, min_sample, point);
+	result = point->batch > 0 ? 0 : -1;
+	for (i = 0; i < repetitions && result == 0; i++)
+	{
+		result = run_batch(&text, point->batch, point, &times[i]);
+		times[i] /= point->batch;
+	}
+	if (result == 0)
+	{
+		stats_reset();
+		result = run_pipeline(text.data, text.length,
+				      &point->output_bytes);
+		stats_totals(&point->memory);
+	}
+	free(text.data);
+	if (result != 0)
+		return (-1);
+
+	qsort(times, repetitions, sizeof(double), compare_times);
+	point->seconds = repetitions % 2 ? times[repetitions / 2] :
+		(times[repetitions / 2 - 1] + times[repetitions / 2]) / 2;
+
+	return (0);
+}
+
+/*
+ * measure_point - Measure one size in a fresh child process
+ * @axis: Axis
+ * @size: Axis size
+ * @repetitions: Timed samples
+ * @min_sample: Minimum time of a sample, in seconds
+ * @point: Filled with the results
+ *
+ * Each size starts from a clean heap, so what earlier sizes left behind
+ * (the parser does not free everything) does not slow the later ones.
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int measure_point(const ScalingAxis *axis, int size, int repetitions,
+			 double min_sample, ScalingPoint *point)
+{
+	int fds[2], wstatus;
+	size_t got = 0;
+	pid_t pid;
+
+	if (pipe(fds) != 0)
+		return (-1);
+	fflush(NULL);
+	pid = fork();
+	if (pid < 0)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return (-1);
+	}
+	if (pid == 0)
+	{
+		close(fds[0]);
+		if (measure_in_process(axis, size, repetitions, min_sample,
+				       point) != 0 ||
+		    write(fds[1], point, sizeof(*point)) !=
+		    (ssize_t)sizeof(*point))
+			_exit(1);
+		_exit(0);
+	}
+
+	close(fds[1]);
+	while (got < sizeof(*point))
+	{
+		ssize_t n = read(fds[0], (char *)point + got,
+				 sizeof(*point) - got);
+
+		if (n <= 0)
+			break;
+		got += n;
+	}
+	close(fds[0]);
+	if (waitpid(pid, &wstatus, 0) < 0 || !WIFEXITED(wstatus) ||
+	    WEXITSTATUS(wstatus) != 0 || got != sizeof(*point))
+		return (-1);
+
+	return (0);
+}
+
+/*
+ * fit_exponent - Least-squares slope of log(y) against log(x)
+ * @points: Measurements
+ * @count: Number of points
+ * @value: Which figure of a point to fit
+ * @error: Set to the slope's standard error (may be NULL)
+ *
+ * Return: Fitted exponent
+ */
+static double fit_exponent(const ScalingPoint *points, int count,
+			   double (*value)(const ScalingPoint *point),
+			   double *error)
+{
+	double sx = 0, sy = 0, sxx = 0, sxy = 0, residuals = 0;
+	double denominator, slope, intercept;
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		double x = log(points[i].size);
+		double y = log(value(&points[i]) > 0 ? value(&points[i]) : 1e-12);
+
+		sx += x;
+		sy += y;
+		sxx += x * x;
+		sxy += x * y;
+	}
+	denominator = count * sxx - sx * sx;
+	if (error)
+		*error = 0.0;
+	if (denominator <= 0)
+		return (0.0);
+	slope = (count * sxy - sx * sy) / denominator;
+	intercept = (sy - slope * sx) / count;
+	for (i = 0; i < count; i++)
+	{
+		double x = log(points[i].size);
+		double y = log(value(&points[i]) > 0 ? value(&points[i]) : 1e-12);
+		double r = y - (intercept + slope * x);
+
+		residuals += r * r;
+	}
+	if (error && count > 2)
+		*error = sqrt(residuals / (count - 2) * count / denominator);
+
+	return (slope);
+}
+
+static double point_time(const ScalingPoint *point)
+{
+	return (point->seconds);
+}
+
+static double point_alloc_bytes(const ScalingPoint *point)
+{
+	return (point->memory.bytes);
+}
+
+static double point_peak(const ScalingPoint *point)
+{
+	return (point->memory.peak);
+}
+
+static double point_output(const ScalingPoint *point)
+{
+	return (point->output_bytes);
+}
+
+/*
+ * usage - Print command line help
+ */
+static void usage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [--steps N] [--reps N] [--min-sample-ms MS]"
+		" [--limit X] [--strict] [axis...]\n", program);
+}
+
+/*
+ * main - Measure each axis and fit its exponents
+ * @argc: Argument count
+ * @argv: Options and axis names (all axes when none are given)
+ *
+ * Return: 0 on success, 1 on error or (with --strict) a flagged axis
+ */
+int main(int argc, char **argv)
+{
+	int steps = DEFAULT_STEPS, repetitions = DEFAULT_REPETITIONS;
+	int selected[AXIS_COUNT] = {0};
+	int any_selected = 0, strict = 0, flagged = 0, status = 0;
+	double limit = DEFAULT_LIMIT, min_sample_ms = DEFAULT_MIN_SAMPLE_MS;
+	int i, a, s;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+			steps = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc)
+			repetitions = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--min-sample-ms") == 0 && i + 1 < argc)
+			min_sample_ms = atof(argv[++i]);
+		else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc)
+			limit = atof(argv[++i]);
+		else if (strcmp(argv[i], "--strict") == 0)
+			strict = 1;
+		else
+		{
+			for (a = 0; a < AXIS_COUNT; a++)
+				if (strcmp(argv[i], axes[a].name) == 0)
+					break;
+			if (a == AXIS_COUNT)
+			{
+				usage(argv[0]);
+				return (1);
+			}
+			selected[a] = 1;
+			any_selected = 1;
+		}
+	}
+	if (steps < 3 || steps > MAX_STEPS || repetitions < 1 ||
+	    repetitions > MAX_REPETITIONS || min_sample_ms < 0)
+	{
+		usage(argv[0]);
+		return (1);
+	}
+
+	printf("%-12s %7s %10s %10s %10s %6s %12s %10s\n", "axis", "size",
+	       "in bytes", "out bytes", "median ms", "runs", "alloc bytes",
+	       "peak KB");
+	for (a = 0; a < AXIS_COUNT && status == 0; a++)
+	{
+		ScalingPoint points[MAX_STEPS];
+		int count = steps;
+
+		if (any_selected && !selected[a])
+			continue;
+		while (axes[a].max_size > 0 &&
+		       (axes[a].base << (count - 1)) > axes[a].max_size)
+			count--;
+		if (count < 3)
+		{
+			fprintf(stderr, "Error: %s only has %d sizes up to %d\n",
+				axes[a].name, count, axes[a].max_size);
+			status = 1;
+			break;
+		}
+		for (s = 0; s < count; s++)
+		{
+			if (measure_point(&axes[a], axes[a].base << s,
+					  repetitions, min_sample_ms / 1e3,
+					  &points[s]) != 0)
+			{
+				fprintf(stderr, "Error: %s failed at size %d\n",
+					axes[a].name, axes[a].base << s);
+				status = 1;
+				break;
+			}
+			printf("%-12s %7d %10lu %10lu %10.3f %6d %12lu %10.1f\n",
+			       axes[a].name, points[s].size,
+			       (unsigned long)points[s].input_bytes,
+			       (unsigned long)points[s].output_bytes,
+			       points[s].seconds * 1e3, points[s].batch,
+			       (unsigned long)points[s].memory.bytes,
+			       points[s].memory.peak / 1024.0);
+			fflush(stdout);
+		}
+		if (status != 0)
+			break;
+
+		{
+			double time_error;
+			double time_exp = fit_exponent(points, count, point_time,
+						       &time_error);
+			double alloc_exp = fit_exponent(points, count,
+							point_alloc_bytes, NULL);
+			double peak_exp = fit_exponent(points, count, point_peak,
+						       NULL);
+			double output_exp = fit_exponent(points, count,
+							 point_output, NULL);
+			int flag = time_exp - TIME_MARGIN * time_error > limit ||
+				alloc_exp > limit || peak_exp > limit;
+
+			printf("%-12s exponents: time %.2f +- %.2f, alloc bytes "
+			       "%.2f, peak %.2f, output %.2f%s\n\n", axes[a].name,
+			       time_exp, time_error, alloc_exp, peak_exp, output_exp,
+			       flag ? "  FLAG" : "");
+			flagged += flag;
+		}
+	}
+
+	if (status == 0)
+		printf("%d axes above n^%.2f\n", flagged, limit);
+	return (status != 0 || (strict && flagged) ? 1 : 0);
+}
@@ -16,7 +16,7 @@ static unsigned int hash(const char *name)
 	while (*name)
 	{
 		h = h * 31 + (unsigned char)*name;
-		++name;
+		name++;
 	}
 
 	return (h % SYMBOL_TABLE_SIZE);
@@ -36,7 +36,7 @@ SymbolTable *symbol_table_create(SymbolTable *parent)
 	table = malloc(sizeof(SymbolTable));
 	if (!table)
 		return (NULL);
-	for (i = 0; i < SYMBOL_TABLE_SIZE; ++i)
+	for (i = 0; i < SYMBOL_TABLE_SIZE; i++)
 		table->buckets[i] = NULL;
 
 	table->parent = parent;
@@ -57,7 +57,7 @@ void symbol_table_destroy(SymbolTable *table)
 
 	if (!table)
 		return;
-	for (i = 0; i < SYMBOL_TABLE_SIZE; ++i)
+	for (i = 0; i < SYMBOL_TABLE_SIZE; i++)
 	{
 		sym = table->buckets[i];
 		while (sym)
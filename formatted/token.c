@@ -48,7 +48,33 @@ void token_destroy(Token *token)
  */
 const char *token_type_to_string(TokenType type)
 {
-	static const char *names[] = {"WHITESPACE", "NEWLINE", "COMMENT_LINE", "COMMENT_BLOCK", "PREPROCESSOR", "IDENTIFIER", "INTEGER", "FLOAT", "STRING", "CHAR", "IF", "ELSE", "WHILE", "FOR", "DO", "SWITCH", "CASE", "DEFAULT", "BREAK", "CONTINUE", "RETURN", "GOTO", "TYPEDEF", "STRUCT", "UNION", "ENUM", "SIZEOF", "VOID", "CHAR_KW", "SHORT", "INT", "LONG", "FLOAT_KW", "DOUBLE", "SIGNED", "UNSIGNED", "CONST", "VOLATILE", "STATIC", "EXTERN", "AUTO", "REGISTER", "PLUS", "MINUS", "STAR", "SLASH", "PERCENT", "ASSIGN", "PLUS_ASSIGN", "MINUS_ASSIGN", "STAR_ASSIGN", "SLASH_ASSIGN", "PERCENT_ASSIGN", "AMPERSAND_ASSIGN", "PIPE_ASSIGN", "CARET_ASSIGN", "LSHIFT_ASSIGN", "RSHIFT_ASSIGN", "EQUAL", "NOT_EQUAL", "LESS", "GREATER", "LESS_EQUAL", "GREATER_EQUAL", "LOGICAL_AND", "LOGICAL_OR", "LOGICAL_NOT", "AMPERSAND", "PIPE", "CARET", "TILDE", "LSHIFT", "RSHIFT", "INCREMENT", "DECREMENT", "ARROW", "DOT", "ELLIPSIS", "QUESTION", "COLON", "LPAREN", "RPAREN", "LBRACE", "RBRACE", "LBRACKET", "RBRACKET", "SEMICOLON", "COMMA", "EOF", "ERROR"};
+	static const char *names[] = {"WHITESPACE", "NEWLINE", "COMMENT_LINE",
+				      "COMMENT_BLOCK", "PREPROCESSOR",
+				      "IDENTIFIER", "INTEGER", "FLOAT",
+				      "STRING", "CHAR", "IF", "ELSE", "WHILE",
+				      "FOR", "DO", "SWITCH", "CASE", "DEFAULT",
+				      "BREAK", "CONTINUE", "RETURN", "GOTO",
+				      "TYPEDEF", "STRUCT", "UNION", "ENUM",
+				      "SIZEOF", "VOID", "CHAR_KW", "SHORT",
+				      "INT", "LONG", "FLOAT_KW", "DOUBLE",
+				      "SIGNED", "UNSIGNED", "CONST", "VOLATILE",
+				      "STATIC", "EXTERN", "AUTO", "REGISTER",
+				      "PLUS", "MINUS", "STAR", "SLASH",
+				      "PERCENT", "ASSIGN", "PLUS_ASSIGN",
+				      "MINUS_ASSIGN", "STAR_ASSIGN",
+				      "SLASH_ASSIGN", "PERCENT_ASSIGN",
+				      "AMPERSAND_ASSIGN", "PIPE_ASSIGN",
+				      "CARET_ASSIGN", "LSHIFT_ASSIGN",
+				      "RSHIFT_ASSIGN", "EQUAL", "NOT_EQUAL",
+				      "LESS", "GREATER", "LESS_EQUAL",
+				      "GREATER_EQUAL", "LOGICAL_AND",
+				      "LOGICAL_OR", "LOGICAL_NOT", "AMPERSAND",
+				      "PIPE", "CARET", "TILDE", "LSHIFT",
+				      "RSHIFT", "INCREMENT", "DECREMENT",
+				      "ARROW", "DOT", "ELLIPSIS", "QUESTION",
+				      "COLON", "LPAREN", "RPAREN", "LBRACE",
+				      "RBRACE", "LBRACKET", "RBRACKET",
+				      "SEMICOLON", "COMMA", "EOF", "ERROR"};
 
 	if (type < 0 || type > TOK_ERROR)
 		return ("UNKNOWN");
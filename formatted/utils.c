@@ -79,7 +79,7 @@ int is_digit(char c)
  */
 int is_alpha(char c)
 {
-	return (c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z' || c == '_');
+	return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_');
 }
 
 /*
@@ -111,7 +111,9 @@ int is_whitespace(char c)
  * @column: Column number
  * @message: Error message
  */
-void report_error(const char *filename, int line, int column, const char *message)
+void report_error(const char *filename, int line, int column,
+		  const char *message)
 {
-	fprintf(stderr, "%s:%d:%d: error: %s\n", filename ? filename : "<input>", line, column, message);
+	fprintf(stderr, "%s:%d:%d: error: %s\n",
+		filename ? filename : "<input>", line, column, message);
 }
@@ -0,0 +1,2 @@
+/* complexity-fuzz pump A=9,1 B=10,0 */
+/**/o*e(){
\ No newline at end of file
@@ -0,0 +1,2 @@
+/* complexity-fuzz pump A=10,6 B=16,0 */
+/**/t x(){if(x) }
\ No newline at end of file
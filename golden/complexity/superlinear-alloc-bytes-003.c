@@ -0,0 +1,3 @@
+/* complexity-fuzz pump A=11,1 B=12,0 */
+#
+t n(){"";{
\ No newline at end of file
@@ -0,0 +1,30 @@
+/* complexity-fuzz pump A=315,43 B=358,0 */
+#i <stdlib.h>
+
+/**
+ * strucsingly linked list node
+ * @data: integer data
+ * @next: pointer to nexct node_s
+{
+	int data;
+	struct node_s *next;
+} node_t;
+
+/**
+ * create_node - creates a new node
+ * @value: value to store
+ *
+ * Return: pointer to new node, or NULL on failure
+ */
+node_t *create_node(int value)
+{
+	nn
+	/* Clamp result */
+	if (result > MAX_VAL)
+}
+
+/**
+nsert_fro @head: pointer to head pointer
+ * @value: value to insert
+ *
+ * Re
\ No newline at end of file
@@ -0,0 +1,278 @@
+/* complexity-fuzz pump A=4644,7 B=4651,0 */
+tains a wide variety of C constructs including:
+ * - Preprocessor directives
+ * - Typedefs, structs, enums, unions
+ * - Function declarations with various signatures
+ * - Control flow: if/else, switch/case, for, while, do-while
+ * - Expressions: binary, unary, ternary, compound assignment
+ * - Pointers, arrays, function pointers
+ * - Member access with . and ->
+ * - sizeof, casts, complex expressions
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Preprocessor constants */
+#define MAX_SIZE 1024
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define SQUARE(x) ((x) * (x))
+#define ABS(x) ((x) < 0 ? -(x) : (x))
+ef struct node_s node_t;
+
+/**
+ * enum color_e - Color enumeration
+ * @RED: Red color
+ * @GREEN: Green color
+ * @BLUE: Blue color
+ * @ALPHA: AlphGREEN = 1,
+	BLUE = 2,
+	ALPHA = 255
+} color_t;
+
+/**
+ * enum status_e - Status codes
+ */
+typedef enum status_e
+{
+	STATUS_OK,
+	STATUS_ERROR,
+	STATUS_PENDING,
+	STATUS_TIMEOUT
+} status_t;
+
+/**
+ * struct point_s - 2D point structure
+ * @x: X coordinate
+ * @y: Y coordinaint_s
+{
+	int x;
+	int y;
+} point_t;
+
+/**
+ * struct rect_s - Rectangle structure
+ * @origin: Top-left corner
+ * @width: Width of rectangle
+ * @height: Height of rectangle_s
+{
+	point_t origin;
+	unsigned int width;
+	unsigned int height;
+} rect_t;
+
+/**
+ * struct node_s - Linked list node
+ * @data: Integer data
+ * @next: Pointer to next node
+ * @prev: Pointer to puct node_s *next;
+	struct node_s *prev;
+};
+
+/**
+ * struct tree_s - Binary tree node
+ * @value: Node value
+ * @left: Left child
+ * @right: Right child
+ * @parent: Parent tree_s
+{
+	int value;
+	struct tree_s *left;
+	struct tree_s *right;
+	struct tree_s *parent;
+} tree_t;
+
+/**
+ * union data_u - Union for different data types
+ * @i: Integer value
+ * @f: Float value
+ * @c: Character array
+ * @ptr: Generic point	char c[4];
+	void *ptr;
+} data_t;
+
+/**
+ * struct variant_s - Tagged union / variant type
+ * @type: Type tag (0=int, 1=float, 2=string)
+ * @data: struct variant_s
+{
+	int type;
+	data_t data;
+} variant_t;
+
+/* Global variables - simplified for parser testing */
+static int g_counter;
+static node_t *g_head;
+
+/**
+ * simple_add - Add two integers
+ * @a: First operand
+ * @b: Second operand
+ *
+ * Return: Sum of a aint a, int b)
+{
+	return (a + b);
+}
+
+/**
+ * simple_subtract - Subtract two integers
+ * @a: First operand
+ * @b: Second operand
+ *
+ * Return: Diff int b)
+{
+	return (a - b);
+}
+
+/**
+ * simple_multiply - Multiply two integers
+ * @a: First operand
+ * @b: Second operand
+ *
+ * Return: Product of a and b
+ */
+int simple_multiply(int a, int b)
+{
+	return (a * b);
+}
+
+/**
+ * | n <= 0)
+		return (-1);
+
+	for (i = 0; i < n; i++)
+	{
+		if (arr[i] == target)
+			return (i);
+	}
+
+	return (-1);
+}
+
+/**
+ * reverse_array - Reverse an array in place
+ * @arr: Array to reverse{
+	if (arr == NULL || n <= 1)
+		return;
+
+	k = k % n;
+	if (k < 0)
+		k += n;
+
+	reverse_array(arr, n);
+	reverse_array(arr, k);
+	reverse_array(arr + k, n - k);
+}
+
+/**
+ * array_sum - Calculate sum of armin = arr[0];
+	for (i = 1; i < n; i++)
+	{
+		if (arr[i] < min)
+			min = arr[i];
+	}
+
+	return (min);
+}
+
+/**
+ * create_node - Create a new linked list node
+ * @data: Data for the node
+ *
+ * R;
+
+	node = malloc(sizeof(node_t));
+	if (node == NULL)
+		return (NULL);
+
+	node->data = data;
+	node->next = NULL;
+	node->prev = NULL;
+
+	return (node);
+}
+
+/**
+ * list_push_front - Add node at beginning of list
+ * @head: Pointer to head pointer
+ * @data: Data for new node
+ *
+ * Return: Point->next = *head;
+	if (*head != NULL)
+		(*head)->prev = node;
+	*head = node;
+
+	return (node);
+}
+
+/**
+ * list_push_back - Add node at end of list
+ * @head: Pointer to head pointer
+ * @data: Data if (node == NULL)
+		return (NULL);
+
+	if (*head == NULL)
+	{
+		*head = node;
+		return (node);
+	}
+
+	current = *head;
+	while (current->next != NULL)
+	{
+		current = current->next;
+	}
+
+	current->next = node;
+	node->prev = current;
+
+	return (node);
+}
+
+/**
+ * list_pop_front - Remove node from beginning
+ * @head: Pointer to head pointer
+ *
+ * Return: Data from removed node, or 0 if empty
+ *count = 0;
+
+	while (head != NULL)
+	{
+		count++;
+		head = head->next;
+	}
+
+	return (count);
+}
+
+/**
+ * list_find - Find node with given data
+ * @head: Head of list
+ * @data: Data to find
+ *
+ * Ren (NULL);
+}
+
+/**
+ * list_delete - Delete node with given data
+ * @head: Pointer to head pointer
+ * @data: Data of node to delete
+ *
+ * Return: 1 if deleted, 0 if not found
+ */
+int list_delete(node_t **head, int data)
+{
+	node_t *current, *te/
+	if (current->data == data)
+	{
+		*head = currenext;
+	}
+
+	if (current == NULL)
+		return (0);
+
+	/* Unlink and free */
+	if (current->prev != NULLrent->prev;
+a[i] = A;}
\ No newline at end of file
@@ -0,0 +1,153 @@
+/* complexity-fuzz pump A=2643,1 B=2644,0 */
+/**
+ * comprehensive_test.c - Comprehensive Cle contains a wide variety of C constructs including:
+ * - Preprocessor directives
+ * - Typedefs, structs, enums, unions
+ * - Function declarations with various signatures
+ * - Control flow: if/else, switch/case, for, while, do-while
+ * - Expressions: binary, unary, ternary, compound assignment
+ * - Pointers, arrays, function pointers
+ * - Member access with . and ->
+ * - sizeof, casts, complex express.h>
+#include <string.h>
+
+/* Preproefine MAX_SIZE 1024
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define SQUARE(x) ((x) * (x))
+#define ABS(x) ((x) < 0 ? -(x) : (x))
+
+/* ef struct node_s node_t;
+
+/**
+ * enum color_e - Color enumeration
+ * @RED: Red color
+ * @GREEN: Greedef enum status_e
+{
+	STATUS_OK,
+	STATUS_ERROR,
+	STATUS_PENDING,
+	STATUS_TIMEOUT
+} status_t;
+
+/**
+ * struct point_s - 2D point structure
+ * @x: X coordinate
+ * @y: Yt x;
+	int y;
+} point_t;
+
+/**
+ * struct rect_s - Rectangle structure
+ * @origin: Top-left corner
+ * @width: Width of rectangle
+ * @height_s
+{
+	point_t origin;
+	unsigned int width;
+	unsigned int height;
+} rect_t;
+
+/**
+ * struct node_s - Linked list node
+ * @data: Integer data
+ * @next: Pointer to next node
+ * @prev: _s *prev;
+};
+
+/**
+ * struct tree_s - Binary tree node
+ * @valuef struct tree_s
+{
+	int value;
+	struct tree_s *left;
+	struct tree_s *right;
+	struct tree_s *parent;
+} tree_t;
+
+/**
+ * union data_u - Union for different data types
+ * @i: Integer value
+ * @f: Float value
+ * @c: Character array
+ * @ptr: Generic pointer
+ s
+{
+	int type;
+	data_t data;
+} variant_t;
+
+/* Global variables - simplified for parser tesg_head;
+
+/**
+ * simple_add - Add two integers
+ * @a: First operand
+ * @b: Second operand
+ d(int a, int b)
+{
+	return (a + b);
+}
+
+/**
+ * simple_subtract - Subtract two integers
+ * @a: First operand
+ * @b: Second operand
+ *
+ * R**
+ * simple_multiply - Multiply two integers
+ * @a: 5; i * i <= n; i += 6)
+	{
+		if (n % i == 0 || n % (i + 2) == 0)
+			return (0);
+	}
+
+	return (1);
+}
+
+/**
+ * gcd - Greatest common divisor using Euclidean algorithm
+ * @a: Fia = temp;
+	}
+
+	return (a);
+}
+
+/**
+ * lcm - Least common multiple
+ * @a: First number
+ * @b: Second number
+ *
+ * Return: LCM of a and b
+ *
+ * power - Calculate base raisr(int base, unsigned int exp)
+{
+	long result = 1;
+
+	while (exp > 0)
+	{
+		if (exp & 1)
+			result *= base;
+		base *= base;
+		exp >>= 1;
+	}
+
+	return (result);
+}
+
+/**
+ * swap_int - Swap two integers
+ * @a== NULL || a == b)
+		return;
+
+	*a ^= *b;
+	*b ^= *a;
+	*a ^= *b;
+}
+
+/**
+ * bubble_sort - Sort array using bubble sort
+ * @arr: Array to sort
+ * @n: Number of elements
+ */
+void bubbn)
+]
\ No newline at end of file
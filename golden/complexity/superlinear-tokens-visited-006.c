@@ -0,0 +1,160 @@
+/* complexity-fuzz pump A=1771,1 B=1772,0 */
+/**
+ * comprehensive_test.c - Comprehensive C file to stress-test the parser
+ *
+ * This file contains a wide variety of C constructs including:
+ * - Preprocessor directives
+ * - Typedefs, structs, enums, unions
+ * - Function declarations with various signatures
+ * - Control flow: if/else, switch/case, for, while, do-while
+ * - Expressions: binary, unary, ternary, compound assignment
+ * - Pointers, arrays, function pointers
+ * - Member access with . and ->
+ * - sizeof, casts, complex expressions
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Preprocessor constants */
+#define MAX_SIZE 1024
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define SQUARE(x) ((x) * (x))
+#define ABS(x) ((x) < 0 ? -(x) : (x))
+
+/* Forward declarations */
+struct node_s;
+typedef struct node_s node_t;
+
+/**
+ * enum color_e - Color enumeration
+ * @RED: Red color
+ * @GREEN: Green color
+ * @BLUE: Blue color
+ * @ALPHA: Alpha channel
+ */
+typedef enum color_e
+{
+	RED = 0,
+	GREEN = 1,
+	BLUE = 2,
+	ALPHA = 255
+} color_t;
+
+/**
+ * enum status_e - Status codes
+ */
+typedef enum status_e
+{
+	STATUS_OK,
+	STATUS_ERROR,
+	STATUS_PENDING,
+	STATUS_TIMEOUT
+} status_t;
+
+/**
+ * struct point_s - 2D point structure
+ * @x: X coordinate
+ * @y: Y coordinate
+ */
+typedef struct point_s
+{
+	int x;
+	int y;
+} point_t;
+
+/**
+ * struct rect_s - Rectangle structure
+ * @origin: Top-left corner
+ * @width: Width of rectangle
+ * @height: Height of rectangle
+ */
+typedef struct rect_s
+{
+	point_t origin;
+	unsigned int width;
+	unsigned int height;
+} rect_t;
+
+/**
+ * struct node_s - Linked list node
+ * @data: Integer data
+ * @next: Pointer to next node
+ * @prev: Pointer to previous node
+ */
+struct node_s
+{
+	int data;
+	struct node_s *next;
+	struct node_s *prev;
+};
+,e_find(treroot,valuealue)
+			returnvalueoot = rootelse
+			roroot-/**
+ * tree_min - Find minimum value in tree
+ e_min(tree_t *root)
+{
+	if (root == NULL)
+		return (NULL);
+
+	while (root->left != NULL)ree_max(tree_t *root)
+{
+	if (root == NULL)
+		return (NULL);
+
+	while (root->right != NULL)
+		root = root->right;
+
+	return (root);
+}
+
+/**
+ * tree_height - Calculate height ofht = tree_height(root->left);
+	right_height = tree_height(root->right);
+
+	return (1 + (left_height > right_height ? left_height : right_height));
+}
+
+/**
+ * tree_size - Coun(tree_t *root)
+{
+	if (root == NULL)
+		return (0);
+
+	return (1 + tree_size(root->left) + tree_size(root->right));
+}
+
+/**
+ * tree_free - Free all nodes in tree
+ * @root: Poinoot);
+	*root = NULL;
+}
+
+/**
+ * point_distance_sq - Calculate squared distance between 1.y;
+
+	return (dx * dx + dy * dy);
+}
+
+/**
+ * rect_area - Calculate area of rectangle
+ idth * r.height);
+}
+
+/**
+ * rect_perimeter - Calculate perimeter of rectangle
+ * @r: R2 * (r.width + r.height));
+}
+
+/**
+ * rect_contains_point - Check if rectangle containsgin.x + (int)r.width &&
+		p.y >= r.origin.y &&
+		p.y < r.origin.y + (int)r.height);
+}
+
+/**
+ * rect_intersects - Check if two rectangles intersect
+ * @r1: First rectangle
+ *ts(rect_t r1, m
@@ -0,0 +1,91 @@
+/* complexity-fuzz pump A=1510,11 B=1528,3 */
+/**
+ * comprehensive_test.c - Comprehensive C file to stress-test the parser
+ *
+ * This file contains a wide variety of C constructs including:
+ * - Preprocessor directives
+ * - Typedefs, structs, enums, unions
+ * - Function declarations with various signatures
+ * - Control flow: if/else, switch/case, for, while, do-while
+ * - Expressions: binary, unary, ternary, compound assignment
+ * - Pointers, arrays, function pointers
+ * - Member access with . and ->
+ * - sizeof, casts, complex expressions
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Preprocessor constants */
+#define MAX_SIZE 1024
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define SQUARE(x) ((x) * (x))
+#define ABS(x) ((x) < 0 ? -(x) : (x))
+
+/* Forward declarations */
+struct node_s;
+typedef struct node_s node_t;
+
+/**
+ * enum color_e - Color enumeration
+ * @RED: Red color
+ * @GREEN: Green color
+ * @BLUE: Blue color
+ * @ALPHA: Alpha channel
+ */
+typedef enum color_e
+{
+	RED = 0,
+	GREEN = 1,
+	BLUE = 2,
+	ALPHA = 255
+} color_t;
+
+/**
+ * enum status_e - Status codes
+ */
+typedef enum status_e
+{
+	STATUS_OK,
+	STATUS_ERROR,
+	STATUS_PENDING,
+	STATUS_TIMEOUT
+} status_t;
+
+/**
+ * struct point_s - 2D point structure
+ * @x: X coordinate
+ * @y: Y coordinate
+ */
+typedef struct point_s
+{
+	int x;
+	int y;
+} point_t;
+
+/**
+ * struct rect_s - Rectangle structure
+ * @origin: Top-left corner
+ * @width: Width of rectangle
+ * @height: Height of rectangle
+ */
+typedef struct rect_s
+{
+	point_t origin;
+struct s {
+x = 1;
+};
+/*rray elements
+ * @arr: Array t**
+ * compare_int_desc - Compare function for descending order
+ * @a: First value
+ * @ba, int b)
+{
+	return (-compare_int(a, b));
+}
+
+/**
+ * complex_expression_demo - Demonstrate&& 
+}
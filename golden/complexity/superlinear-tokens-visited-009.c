@@ -0,0 +1,181 @@
+/* complexity-fuzz pump A=2612,1 B=2620,1 */
+
+
+/**
+ * linear_search - Search for value in arr1)
+		return;
+
+	for (i = 0, j = n - 1; i < j; i++, j--)
+	{
+		swap_int(&arr[i], &arr[j]);
+	}
+}
+
+/**
+ * rotate_array - Rotate array erse_array(arr, k);
+	reverse_array(arr + k, n - k);
+}
+
+/**
+ * array_sum - Calculate sum of array elements
+ * @arr: Array
+ * arr[i];
+	}
+
+	return (max);
+}
+
+/**
+ * array_min - Find minimum element
+ * @arr: Array
+ * @n: Number of elements
+ *
+ * Return: Minimu
+	if (head == NULL)
+		return (NULL);
+
+	node = create_node(data);
+	if (node == NULL)
+		return (NULL);
+
+	node->next = *head;
+	if (*head != NULL)
+		(*head)->prev = node;
+	*head = node;
+
+	return (node);
+}
+
+/**
+ * list_push_back - Add node at end of list
+ * L)
+		return (NULL);
+
+	if (*head == NULL)
+	{
+		*head = node;
+		return (node);
+	}
+
+	current = *head;
+	while (current->next != NULL)
+	{
+		current = current->next;
+	}
+
+	current->next = node;
+	node->prev = current;
+
+	return (node);
+}
+
+/**
+ * list_pop_front -ode_t *head, int data)
+{
+	while (head != NULL)
+	{
+		if (head->data == data)
+			return (head);
+		head = head->next;
+	}
+
+	return (NULL);
+}
+
+/**
+ * list_delete - Delete node with given data
+ * @head: Pointer to head pointer
+ * @data: Data of node to delete
+ *
+ * Re/
+	if (current->prev != NULL)
+		current->prev->next = current->next;
+	if (current->next != NULL)
+		current->next->prev = current->prev;
+
+	free(current);
+	return (1);
+}
+
+/**
+ * list_reverse - Reverse a linked list
+ * @head: Pointer to head pointalue)
+{
+	tree_t *node;
+
+	node = malloc(sizeof(tree_t));
+	if (node == NULL)
+		return (NULL);
+
+	node->value = value;
+	node->left = NULL;
+	node->right = NULL;
+	node->parent = NULL;
+
+	return (node);
+}
+
+/**
+ * tree_insert - Insert value into BST
+ * @root: Poue)
+			root = root->left;
+		else
+			root = root->right;
+	}
+
+	return (NULL);
+}
+
+/**
+ * tree_min - Find minimum valuet == NULL)
+		return (NULL);
+
+	while (root->left != NULL)
+		root = root->left;
+
+	return (root);
+}
+
+/**
+ * tree_max - Find maximheight, right_height;
+
+	if (root == NULL)
+		return (-1);
+
+	left_height = tree_height(root->left);
+	right_height = tree_height(root->right);
+
+	return (1 + (left_height > right_height ? left_height : right_height));
+}
+
+/**
+ * tree_size - Count nodes in tree
+ * @root: R/
+void tree_free(tree_t **root)
+{
+	if (root == NULL || *root == NULL)
+		return;
+
+	tree_free(&((*root)->left));
+	tree_free(&((*root)->right));
+	free(*root);
+	*root = NULL;
+}
+
+/**
+ * point_distance_sq - Calculate squared distance between p)
+{
+	int dx = p2.x - p1.x;
+	int dy = p2.y - p1.y;
+
+	return (dx * dx + dy * dy);
+}
+
+/**
+ * rect_area - Calculate area of rectangle
+ * @r: Rectangle
+ *
+ * Return: Area
+ */
+{x = 1;
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "limit.h"
+
+/**
+ * at_limit - Lines that end exactly at column 80 or one past it
+ * @token: Token to check
+ * @parser: Parser state
+ *
+ * Return: Nonzero if the token is significant
+ */
+int at_limit(Token *token, Parser *parser)
+{
+	int i, start = parser->current, end = parser->current + 6;
+	int new_cap = parser->pending_comment_capacity == 0 ? 4 : parser->pending_comment_capacity * 2;
+
+	if (token && token->type != TOK_WHITESPACE && token->type != TOK_NEWLNX)
+		return (token);
+	if (token && token->type != TOK_WHITESPACE && token->type != TOK_NEWLINE)
+		return (NULL);
+	while (start < end && is_type_keyword(peek_ahead(parser, start)->types))
+		start++;
+	if (i > 0)
+	{
+		if (new_cap > 0)
+		{
+			if (end > start)
+			{
+				result = compute_it(first_argument, second_one);
+				result = compute_it(first_argument, second_ones);
+				result = parser->pending_comment_capacity + other_value * 2;
+			}
+		}
+	}
+	return (type == TOK_STRUCT || type == TOK_TYPEDEF || type == TOK_EXTERN);
+}
@@ -0,0 +1,86 @@
+/*
+ * columns.c - Lint diagnostics at exact start columns (make test-lint)
+ */
+
+int f1(void)
+{
+	return (1);
+}
+
+int f2(void)
+{
+	return (2);
+}
+
+int f3(void)
+{
+	return (3);
+}
+
+int f4(void)
+{
+	return (4);
+}
+
+int f5(void)
+{
+	return (5);
+}
+
+static int six(int x)
+{
+	x++;
+	int y = x;
+
+	return (y);
+}
+
+int big(int n)
+{
+	int total = 0;
+
+	total += n * 0;
+	total += n * 1;
+	total += n * 2;
+	total += n * 3;
+	total += n * 4;
+	total += n * 5;
+	total += n * 6;
+	total += n * 7;
+	total += n * 8;
+	total += n * 9;
+	total += n * 10;
+	total += n * 11;
+	total += n * 12;
+	total += n * 13;
+	total += n * 14;
+	total += n * 15;
+	total += n * 16;
+	total += n * 17;
+	total += n * 18;
+	total += n * 19;
+	total += n * 20;
+	total += n * 21;
+	total += n * 22;
+	total += n * 23;
+	total += n * 24;
+	total += n * 25;
+	total += n * 26;
+	total += n * 27;
+	total += n * 28;
+	total += n * 29;
+	total += n * 30;
+	total += n * 31;
+	total += n * 32;
+	total += n * 33;
+	total += n * 34;
+	total += n * 35;
+	total += n * 36;
+	total += n * 37;
+	return (total);
+}
+
+int wide(int first_argument, int second_argument, int third_argument, int fourth)
+{
+	return (first_argument + second_argument + third_argument + fourth + 1234567);
+}
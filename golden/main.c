@@ -9,16 +9,11 @@
 #include <unistd.h>
 
 /* Options structure */
-/* -i: modify files in place */
-/* -c: check if formatted (don't modify) */
-/* -d: show diff of changes */
-/* -o: output to specific file */
-typedef struct
-{
-	int in_place;
-	int check_only;
-	int show_diff;
-	char *output_file;
+typedef struct {
+	int in_place;      /* -i: modify files in place */
+	int check_only;    /* -c: check if formatted (don't modify) */
+	int show_diff;     /* -d: show diff of changes */
+	char *output_file; /* -o: output to specific file */
 } Options;
 
 /**
@@ -68,19 +63,22 @@ static char *format_to_string(const char *source, size_t *out_len)
 	lexer = lexer_create(source);
 	if (!lexer)
 		return (NULL);
+
 	if (lexer_tokenize(lexer) < 0)
 	{
 		lexer_destroy(lexer);
 		return (NULL);
 	}
-	parser = parser_create(lexer_get_tokens(lexer), lexer_get_token_count(lexer));
-	/* Parse and format to memory stream */
+
+	parser = parser_create(lexer_get_tokens(lexer),
+			       lexer_get_token_count(lexer));
 	if (!parser)
 	{
 		lexer_destroy(lexer);
 		return (NULL);
 	}
 
+	/* Parse and format to memory stream */
 	{
 		ASTNode *ast = parser_parse(parser);
 
@@ -107,6 +105,7 @@ static char *format_to_string(const char *source, size_t *out_len)
 
 	if (out_len)
 		*out_len = size;
+
 	return (result);
 }
 
@@ -128,14 +127,16 @@ static int do_write_file(const char *filename, const char *content, size_t len)
 		fprintf(stderr, "Error: Could not open '%s' for writing\n", filename);
 		return (-1);
 	}
+
 	if (fwrite(content, 1, len, fp) != len)
 	{
 		fprintf(stderr, "Error: Failed to write to '%s'\n", filename);
 		fclose(fp);
 		return (-1);
 	}
+
 	fclose(fp);
-	return ((0));
+	return (0);
 }
 
 /**
@@ -158,14 +159,16 @@ static int process_file(const char *filename, Options *opts)
 		fprintf(stderr, "Error: Could not read file '%s'\n", filename);
 		return (-1);
 	}
+
 	formatted = format_to_string(source, &formatted_len);
-	/* Check mode: compare and report */
 	if (!formatted)
 	{
 		fprintf(stderr, "Error: Failed to format '%s'\n", filename);
 		free(source);
 		return (-1);
 	}
+
+	/* Check mode: compare and report */
 	if (opts->check_only)
 	{
 		if (strcmp(source, formatted) != 0)
@@ -178,6 +181,7 @@ static int process_file(const char *filename, Options *opts)
 			printf("%s: OK\n", filename);
 		}
 	}
+	/* Diff mode: show differences */
 	else if (opts->show_diff)
 	{
 		if (strcmp(source, formatted) != 0)
@@ -196,7 +200,9 @@ static int process_file(const char *filename, Options *opts)
 
 					fputs(formatted, temp_file);
 					fclose(temp_file);
-					snprintf(cmd, sizeof(cmd), "diff -u '%s' '%s' | head -100", filename, temp_path);
+					snprintf(cmd, sizeof(cmd),
+						"diff -u '%s' '%s' | head -100",
+						filename, temp_path);
 					system(cmd);
 				}
 				unlink(temp_path);
@@ -208,9 +214,9 @@ static int process_file(const char *filename, Options *opts)
 			printf("%s: no changes\n", filename);
 		}
 	}
+	/* In-place mode: write back to file */
 	else if (opts->in_place)
 	{
-		/* File already formatted, no change needed */
 		if (strcmp(source, formatted) != 0)
 		{
 			if (do_write_file(filename, formatted, formatted_len) < 0)
@@ -220,18 +226,20 @@ static int process_file(const char *filename, Options *opts)
 		}
 		else
 		{
+			/* File already formatted, no change needed */
 		}
 	}
+	/* Output file mode */
+	else if (opts->output_file)
+	{
+		if (do_write_file(opts->output_file, formatted, formatted_len) < 0)
+			result = -1;
+	}
+	/* Default: print to stdout */
 	else
-		if (opts->output_file)
-		{
-			if (do_write_file(opts->output_file, formatted, formatted_len) < 0)
-				result = -1;
-		}
-		else
-		{
-			printf("%s", formatted);
-		}
+	{
+		printf("%s", formatted);
+	}
 
 	free(formatted);
 	free(source);
@@ -254,81 +262,91 @@ int main(int argc, char **argv)
 	int error_count = 0;
 	int needs_format = 0;
 
-	/* First pass: parse options */
 	if (argc < 2)
 	{
 		print_usage(argv[0]);
-		return ((1));
+		return (1);
 	}
-	for (i = 1; i < argc; ++i)
+
+	/* First pass: parse options */
+	for (i = 1; i < argc; i++)
 	{
 		if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
 		{
 			print_usage(argv[0]);
-			return ((0));
+			return (0);
 		}
-		else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--version") == 0)
+		else if (strcmp(argv[i], "-v") == 0 ||
+			 strcmp(argv[i], "--version") == 0)
 		{
 			print_version();
-			return ((0));
+			return (0);
 		}
-		else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--in-place") == 0)
+		else if (strcmp(argv[i], "-i") == 0 ||
+			 strcmp(argv[i], "--in-place") == 0)
 		{
-			opts->in_place = 1;
+			opts.in_place = 1;
 		}
-		else
-			if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--check") == 0)
-			{
-				opts->check_only = 1;
-			}
-			else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--diff") == 0)
+		else if (strcmp(argv[i], "-c") == 0 ||
+			 strcmp(argv[i], "--check") == 0)
+		{
+			opts.check_only = 1;
+		}
+		else if (strcmp(argv[i], "-d") == 0 ||
+			 strcmp(argv[i], "--diff") == 0)
+		{
+			opts.show_diff = 1;
+		}
+		else if (strcmp(argv[i], "-o") == 0 ||
+			 strcmp(argv[i], "--output") == 0)
+		{
+			if (i + 1 < argc)
 			{
-				opts->show_diff = 1;
+				opts.output_file = argv[++i];
 			}
-			else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0)
+			else
 			{
-				if (i + 1 < argc)
-				{
-					opts->output_file = argv[++i];
-				}
-				else
-				{
-					fprintf(stderr, "Error: -o requires a filename\n");
-					return ((1));
-				}
+				fprintf(stderr, "Error: -o requires a filename\n");
+				return (1);
 			}
+		}
 	}
 
 	/* Second pass: process files */
-	for (i = 1; i < argc; ++i)
+	for (i = 1; i < argc; i++)
 	{
 		int ret;
 
 		/* Skip options */
 		if (argv[i][0] == '-')
 		{
-			if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0)
-				++i; /* Skip the output filename too */
+			if (strcmp(argv[i], "-o") == 0 ||
+			    strcmp(argv[i], "--output") == 0)
+				i++; /* Skip the output filename too */
 			continue;
 		}
-		++file_count;
+
+		file_count++;
 		ret = process_file(argv[i], &opts);
 
 		if (ret < 0)
-			++error_count;
+			error_count++;
 		else if (ret > 0)
-			++needs_format;
+			needs_format++;
 	}
 
 	if (file_count == 0)
 	{
 		fprintf(stderr, "Error: No input files\n");
-		return ((1));
+		return (1);
 	}
-	/* In check mode, return 1 if any files need formatting */
+
 	if (error_count > 0)
-		return ((1));
-	if (opts->check_only && needs_format > 0)
-		return ((1));
-	return ((0));
+		return (1);
+
+	/* In check mode, return 1 if any files need formatting */
+	if (opts.check_only && needs_format > 0)
+		return (1);
+
+	return (0);
 }
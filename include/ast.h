@@ -45,6 +45,9 @@ typedef enum {
 	NODE_UNPARSED      /* Raw source preserved when parsing fails */
 } NodeType;
 
+/* One past the highest NodeType */
+#define NODE_TYPE_COUNT (NODE_UNPARSED + 1)
+
 /* Raw segment data for unparsed source regions */
 typedef struct RawSegmentData {
 	char *text;
@@ -114,15 +117,19 @@ typedef struct ASTNode {
 	int child_count;
 	int child_capacity;
 
-	/* Comments attached to this node */
-	Token **leading_comments;
-	int leading_comment_count;
-	Token **trailing_comments;
-	int trailing_comment_count;
+	/* Key of this node's comments in the CommentTable (0 = none) */
+	int comment_id;
 
 	/* Blank lines before this node (user-added, max 1 preserved) */
 	int blank_lines_before;
 
+	/* Pairs of parentheses around this expression in the source */
+	int parens;
+
+	/* Source token span [token_start, token_end), top-level items only */
+	int token_start;
+	int token_end;
+
 	/* Node-specific data */
 	void *data;
 } ASTNode;
@@ -134,8 +141,38 @@ void ast_node_destroy(ASTNode *node);
 /* Child management */
 int ast_node_add_child(ASTNode *parent, ASTNode *child);
 
-/* Comment management */
-int ast_node_add_leading_comment(ASTNode *node, Token *comment);
-int ast_node_add_trailing_comment(ASTNode *node, Token *comment);
+const char *ast_node_type_name(NodeType type);
+
+/*
+ * AST walker
+ *
+ * ast_walk() visits a tree depth-first without recursion, calling each
+ * visitor's enter callback before a node's children and its leave
+ * callback after them. Several visitors can share one traversal; each
+ * decides independently what it sees:
+ *   AST_WALK_CONTINUE - keep going
+ *   AST_WALK_SKIP     - (from enter) do not visit this node's children;
+ *                       leave is still called for the node itself
+ *   AST_WALK_STOP     - this visitor sees nothing further
+ * Children are only traversed while at least one visitor wants them, and
+ * the walk ends once every visitor has stopped.
+ */
+#define AST_WALK_MAX_VISITORS 16
+
+typedef enum {
+	AST_WALK_CONTINUE,
+	AST_WALK_SKIP,
+	AST_WALK_STOP
+} ASTWalkAction;
+
+typedef ASTWalkAction (*ASTVisitFn)(ASTNode *node, int depth, void *ctx);
+
+typedef struct ASTVisitor {
+	ASTVisitFn enter;  /* May be NULL */
+	ASTVisitFn leave;  /* May be NULL */
+	void *ctx;         /* Passed to both callbacks */
+} ASTVisitor;
+
+int ast_walk(ASTNode *root, const ASTVisitor *visitors, int visitor_count);
 
 #endif /* AST_H */
@@ -0,0 +1,58 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Bump when the on-disk layout changes */
+#define CACHE_FORMAT_VERSION 1
+
+/*
+ * Cache entry
+ * Formatted output of one top-level item, keyed by its structural hash
+ */
+typedef struct CacheEntry {
+	uint64_t hash;
+	char *text;
+	size_t length;
+} CacheEntry;
+
+/*
+ * Format cache
+ * Persistent per-file store of formatted top-level items. Entries loaded
+ * from disk are only read; entries stored during a run replace them when
+ * the cache is saved, so items that no longer exist are dropped.
+ */
+typedef struct FormatCache {
+	char *path;  /* NULL for a cache kept in memory only */
+
+	CacheEntry *entries;  /* Loaded from disk, sorted by hash */
+	int entry_count;
+
+	CacheEntry *fresh;    /* Stored during this run */
+	int fresh_count;
+	int fresh_capacity;
+
+	int hits;
+	int misses;
+} FormatCache;
+
+/* Cache lifecycle */
+FormatCache *cache_open(const char *dir, const char *source_path);
+FormatCache *cache_create(void);
+int cache_save(FormatCache *cache);
+void cache_commit(FormatCache *cache);
+void cache_close(FormatCache *cache);
+
+/* Lookup and store */
+const CacheEntry *cache_lookup(FormatCache *cache, uint64_t hash);
+int cache_store(FormatCache *cache, uint64_t hash, const char *text,
+		size_t length);
+
+/* Hashing (64-bit FNV-1a) */
+#define CACHE_HASH_INIT 0xcbf29ce484222325ULL
+uint64_t cache_hash_bytes(uint64_t hash, const void *data, size_t length);
+uint64_t cache_hash_string(uint64_t hash, const char *str);
+uint64_t cache_hash_int(uint64_t hash, int value);
+
+#endif /* CACHE_H */
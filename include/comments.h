@@ -0,0 +1,59 @@
+#ifndef COMMENTS_H
+#define COMMENTS_H
+
+#include "token.h"
+#include "ast.h"
+
+/*
+ * Comment position relative to the node it is attached to
+ */
+typedef enum {
+	COMMENT_LEADING,   /* On the lines above the node */
+	COMMENT_TRAILING   /* On the same line, after the node */
+} CommentPosition;
+
+/*
+ * Comment table entry
+ */
+typedef struct CommentEntry {
+	int node_id;      /* ASTNode.comment_id of the owning node */
+	int position;     /* CommentPosition */
+	int token_index;  /* Index of the comment token in the token array */
+} CommentEntry;
+
+/*
+ * Comment table
+ * Per-file side table holding every attached comment. Entries are
+ * appended in parse order; nodes only carry a small id. Lookups go
+ * through an index built lazily by a stable counting sort on
+ * (node id, position), so a node's comments keep their source order.
+ */
+typedef struct CommentTable {
+	Token **tokens;
+	int token_count;
+
+	CommentEntry *entries;
+	int count;
+	int capacity;
+
+	int next_id;  /* Next node id to hand out (ids start at 1) */
+
+	/* Lookup index, rebuilt when entries were added since last lookup */
+	int *order;   /* Entry indices sorted by (node id, position) */
+	int *first;   /* Per key: offset of its first entry in order */
+	int indexed;  /* Number of entries covered by the index */
+	int index_keys;
+} CommentTable;
+
+/* Table lifecycle */
+CommentTable *comment_table_create(Token **tokens, int token_count);
+void comment_table_destroy(CommentTable *table);
+
+/* Attach and look up comments */
+int comment_table_add(CommentTable *table, ASTNode *node,
+		      CommentPosition position, int token_index);
+int comment_table_find(CommentTable *table, const ASTNode *node,
+		       CommentPosition position, int *first);
+Token *comment_table_token(CommentTable *table, int n);
+
+#endif /* COMMENTS_H */
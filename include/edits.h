@@ -0,0 +1,50 @@
+#ifndef EDITS_H
+#define EDITS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Text edit
+ * Replace @delete_length source bytes at @offset with new text
+ */
+typedef struct TextEdit {
+	size_t offset;
+	size_t delete_length;
+	size_t insert;         /* Start of the new text in EditList.text */
+	size_t insert_length;
+} TextEdit;
+
+/*
+ * Edit list
+ * Non-overlapping edits in source order that turn the source into the
+ * formatted output. The last edit may still be open, collecting the
+ * text it inserts, until the end of the replaced source is known.
+ */
+typedef struct EditList {
+	TextEdit *edits;
+	int count;
+	int capacity;
+	int open;  /* The last edit is still collecting text */
+
+	char *text;  /* Inserted text of all edits */
+	size_t text_length;
+	size_t text_capacity;
+
+	int failed;  /* Allocation error */
+} EditList;
+
+/* Edit list lifecycle */
+EditList *edit_list_create(void);
+void edit_list_destroy(EditList *list);
+
+/* Building */
+void edit_list_open(EditList *list, size_t offset);
+void edit_list_insert(EditList *list, const char *text, size_t length);
+void edit_list_close(EditList *list, const char *source, size_t end);
+
+/* Serialization */
+int edit_list_write(const EditList *list, const char *source_path,
+		    FILE *fp);
+
+#endif /* EDITS_H */
@@ -2,14 +2,26 @@
 #define FORMATTER_H
 
 #include "ast.h"
-#include <stdio.h>
+#include "cache.h"
+#include "comments.h"
+#include "edits.h"
+#include "layout.h"
+#include "sink.h"
+#include "source_map.h"
+
+/* Bump whenever the formatted output changes; it keys the cache */
+#define FORMATTER_OUTPUT_VERSION 2
+
+struct FormatTask;
+struct PendingAnchor;
 
 /*
  * Formatter structure
  * Manages pretty-printing of AST to formatted code
  */
 typedef struct {
-	FILE *output;
+	OutputSink *sink;
+	Layout *layout;  /* Line breaking between the emitters and the sink */
 	int indent_level;
 	int column;
 	int line;
@@ -19,12 +31,63 @@ typedef struct {
 	int indent_width;
 	int use_tabs;
 	int max_line_length;
+
+	/* Explicit traversal stack (the formatter never recurses on the AST) */
+	struct FormatTask *tasks;
+	int task_count;
+	int task_capacity;
+	int failed;
+
+	/* Source tokens (needed to hash top-level items for the cache) */
+	Token **tokens;
+	int token_count;
+
+	/* Comments attached to the AST being formatted */
+	CommentTable *comments;
+
+	/* Per-item output cache (optional) */
+	FormatCache *cache;
+	uint64_t item_hash;
+	char *capture;
+	size_t capture_length;
+	size_t capture_capacity;
+	int capturing;
+
+	/* Source slices: output equal to the source is written as slices of it */
+	const char *source;
+	size_t source_length;
+	size_t source_pos;   /* Source byte the next output byte must match */
+	size_t match_start;  /* Start of the matched run not yet written */
+	int matching;
+	size_t slice_bytes;  /* Output written as source slices */
+
+	/* Source map (optional): anchors wait in a queue until laid out */
+	SourceMap *source_map;
+	size_t output_offset;  /* Bytes of output produced so far */
+	struct PendingAnchor *pending;
+	int pending_head;
+	int pending_count;
+	int pending_capacity;
+
+	/* Edit list (optional): output is aligned with the source as it goes */
+	EditList *edits;
+	size_t edit_pos;  /* Source offset of the next unedited byte */
 } Formatter;
 
 /* Formatter lifecycle */
-Formatter *formatter_create(FILE *output);
+Formatter *formatter_create(OutputSink *sink);
 void formatter_destroy(Formatter *formatter);
 
+/* Configuration */
+void formatter_set_source(Formatter *formatter, Token **tokens,
+			  int token_count);
+void formatter_set_cache(Formatter *formatter, FormatCache *cache);
+void formatter_set_comments(Formatter *formatter, CommentTable *comments);
+void formatter_set_source_slices(Formatter *formatter, const char *source,
+				 size_t length);
+void formatter_set_source_map(Formatter *formatter, SourceMap *map);
+void formatter_set_edits(Formatter *formatter, EditList *edits);
+
 /* Main formatting */
 int formatter_format(Formatter *formatter, ASTNode *ast);
 
@@ -0,0 +1,54 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Nesting limit of parsed documents */
+#define JSON_MAX_DEPTH 64
+
+/*
+ * JSON value types
+ */
+typedef enum {
+	JSON_NULL,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+} JsonType;
+
+/*
+ * JSON value
+ * Arrays and objects own their members; object member names are in
+ * @keys, parallel to @items.
+ */
+typedef struct JsonValue {
+	JsonType type;
+	int boolean;
+	double number;
+	char *string;   /* JSON_STRING: decoded UTF-8, NUL-terminated */
+	size_t length;  /* Length of @string (it may hold NUL bytes) */
+
+	struct JsonValue *items;
+	char **keys;
+	int count;
+	int capacity;
+} JsonValue;
+
+/* Parsing */
+JsonValue *json_parse(const char *text, size_t length);
+void json_free(JsonValue *value);
+
+/* Access (NULL-safe: a missing value yields NULL or the fallback) */
+const JsonValue *json_get(const JsonValue *object, const char *key);
+const JsonValue *json_index(const JsonValue *array, int index);
+const char *json_string(const JsonValue *value);
+long json_long(const JsonValue *value, long fallback);
+
+/* Writing */
+void json_write_string(FILE *fp, const char *text, size_t length);
+void json_write_value(FILE *fp, const JsonValue *value);
+
+#endif /* JSON_H */
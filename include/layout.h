@@ -0,0 +1,98 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stddef.h>
+
+/* Size of a block or break that is known not to fit */
+#define LAYOUT_INFINITY 0x3fffffff
+
+/*
+ * Layout document tokens
+ */
+typedef enum {
+	LAYOUT_TEXT,   /* Unbreakable text (no newlines) */
+	LAYOUT_BREAK,  /* Blank that may become a line break */
+	LAYOUT_BEGIN,  /* Start of a group */
+	LAYOUT_END     /* End of a group */
+} LayoutKind;
+
+typedef struct LayoutToken {
+	LayoutKind kind;
+	const char *text;  /* LAYOUT_TEXT: borrowed, valid until printed */
+	int length;        /* Text length, or blank width of a break */
+	int size;          /* Flat width; negative while still undecided */
+} LayoutToken;
+
+/*
+ * Group being printed
+ */
+typedef struct LayoutBlock {
+	int indent;  /* Column continuation lines start at */
+	int broken;  /* Group did not fit: its breaks may become newlines */
+} LayoutBlock;
+
+/* Receives the laid-out text */
+typedef void (*LayoutWriteFn)(void *ctx, const char *text, size_t length);
+
+/*
+ * Layout engine
+ * Oppen-style pretty printer. The document is a stream of text, breaks
+ * and group brackets. Groups that fit on the rest of the line print flat;
+ * in a group that does not fit, each break becomes a newline only when
+ * the text up to the next break does not fit (fill mode). Continuation
+ * lines are aligned with the column where the group started, or indented
+ * one level past the line's own indentation when the text would not fit
+ * there.
+ *
+ * Tokens are buffered only until their layout is decided, which happens
+ * as soon as the pending text is wider than the remaining space, so the
+ * lookahead is bounded by the line width and every token is sized once.
+ */
+typedef struct Layout {
+	int width;       /* Maximum line length */
+	int tab_width;
+	int use_tabs;    /* Continuation indentation uses tabs, then spaces */
+
+	LayoutWriteFn write;
+	void *write_ctx;
+
+	/* Ring buffer of undecided tokens, indexed by stream position */
+	LayoutToken *ring;
+	int ring_capacity;  /* Power of two */
+	long left;          /* Oldest buffered token */
+	long right;         /* One past the newest buffered token */
+	long left_total;    /* Flat width printed so far */
+	long right_total;   /* Flat width scanned so far */
+
+	/* Stream positions of open groups and pending breaks */
+	long *scan;
+	int scan_bottom;
+	int scan_top;
+	int scan_capacity;
+
+	/* Groups being printed */
+	LayoutBlock *blocks;
+	int block_count;
+	int block_capacity;
+
+	int space;        /* Room left on the current line */
+	int line_indent;  /* Width of the current line's leading blanks */
+	int line_blank;   /* Nothing but blanks on the current line yet */
+	int failed;       /* Allocation error */
+} Layout;
+
+/* Layout lifecycle */
+Layout *layout_create(int width, int tab_width, int use_tabs,
+		      LayoutWriteFn write, void *write_ctx);
+void layout_destroy(Layout *layout);
+
+/* Document stream */
+void layout_text(Layout *layout, const char *text, size_t length);
+void layout_break(Layout *layout, int blank);
+void layout_tail_break(Layout *layout, int blank);
+void layout_begin(Layout *layout);
+void layout_end(Layout *layout);
+void layout_lines(Layout *layout, const char *text, size_t length);
+void layout_flush(Layout *layout);
+
+#endif /* LAYOUT_H */
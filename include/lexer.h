@@ -19,6 +19,8 @@ typedef struct {
 	Token **tokens;
 	int token_count;
 	int token_capacity;
+	int streamed;      /* Leading tokens handed out by lexer_next() */
+	int stream_ended;  /* lexer_next() has handed out TOK_EOF */
 
 	int error_count;
 } Lexer;
@@ -30,6 +32,9 @@ void lexer_destroy(Lexer *lexer);
 /* Main tokenization */
 int lexer_tokenize(Lexer *lexer);
 
+/* Streaming: one token at a time, owned by the caller */
+Token *lexer_next(Lexer *lexer);
+
 /* Token access */
 Token **lexer_get_tokens(Lexer *lexer);
 int lexer_get_token_count(Lexer *lexer);
@@ -0,0 +1,48 @@
+#ifndef LINT_H
+#define LINT_H
+
+#include "ast.h"
+#include <stdio.h>
+
+/* Betty limits */
+#define LINT_MAX_COLUMNS 80         /* Display columns, tabs every 8 */
+#define LINT_MAX_FUNCTION_LINES 40  /* Lines between a body's braces */
+#define LINT_MAX_FUNCTIONS 5        /* Function definitions per file */
+
+#define LINT_MESSAGE_SIZE 96
+
+/*
+ * Lint diagnostic
+ * A broken style rule at a 1-based line and byte column of the input
+ */
+typedef struct LintDiagnostic {
+	int line;
+	int column;
+	char message[LINT_MESSAGE_SIZE];
+} LintDiagnostic;
+
+/*
+ * Lint report
+ * Diagnostics of one file, in line and column order once checked
+ */
+typedef struct LintReport {
+	LintDiagnostic *items;
+	int count;
+	int capacity;
+
+	int failed;  /* Allocation error */
+} LintReport;
+
+/* Lint report lifecycle */
+LintReport *lint_report_create(void);
+void lint_report_destroy(LintReport *report);
+
+/* Checking */
+int lint_check(LintReport *report, Token **tokens, int token_count,
+	       ASTNode *ast);
+
+/* Serialization */
+int lint_report_write(const LintReport *report, const char *source_path,
+		      FILE *fp);
+
+#endif /* LINT_H */
@@ -0,0 +1,56 @@
+#ifndef LSP_H
+#define LSP_H
+
+#include <stdio.h>
+#include "lexer.h"
+#include "parser.h"
+#include "cache.h"
+#include "edits.h"
+
+/*
+ * Open document
+ * Text kept in sync through didChange, with the tokens and syntax tree
+ * of its current version (rebuilt by the first request after a change)
+ */
+typedef struct LspDocument {
+	char *uri;
+	char *text;  /* NUL-terminated */
+	size_t length;
+	size_t capacity;
+	long version;
+
+	size_t *lines;  /* Offset of each line start */
+	int line_count;
+	int line_capacity;
+
+	Lexer *lexer;  /* NULL while the text is newer than the tree */
+	Parser *parser;
+	ASTNode *ast;
+
+	FormatCache *cache;  /* Formatted items of earlier versions */
+	EditList *edits;     /* Formatting edits of the current version */
+
+	struct LspDocument *next;
+} LspDocument;
+
+/*
+ * Language server
+ * JSON-RPC over a pair of streams, one message at a time
+ */
+typedef struct LspServer {
+	FILE *in;
+	FILE *out;
+	LspDocument *documents;
+
+	int initialized;
+	int shutdown;  /* Shutdown request received */
+	int exited;    /* Exit notification received */
+
+	char *body;  /* Current message */
+	size_t body_capacity;
+} LspServer;
+
+/* Serve until the client exits; returns the process exit status */
+int lsp_run(FILE *in, FILE *out);
+
+#endif /* LSP_H */
@@ -4,6 +4,15 @@
 #include "token.h"
 #include "ast.h"
 #include "symbol_table.h"
+#include "comments.h"
+
+/*
+ * Deepest nesting of statements, unary operands (parentheses and casts
+ * included) and initializer braces the recursive descent parser follows.
+ * Anything nested deeper is kept as raw text, so parsing needs a bounded
+ * amount of stack whatever the input. Else-if chains do not nest here.
+ */
+#define PARSER_MAX_DEPTH 256
 
 /*
  * Parser structure
@@ -16,11 +25,15 @@ typedef struct {
 
 	int error_count;
 	int whitespace_start;
+	int depth;  /* Current nesting, at most PARSER_MAX_DEPTH */
 
 	SymbolTable *symbols;  /* Symbol table for typedef tracking */
 
-	/* Comment collection buffer */
-	Token **pending_comments;
+	/* Attached comments, owned by the parser */
+	CommentTable *comments;
+
+	/* Comment collection buffer (token indices) */
+	int *pending_comments;
 	int pending_comment_count;
 	int pending_comment_capacity;
 
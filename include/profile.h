@@ -0,0 +1,48 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "ast.h"
+#include <stdio.h>
+
+#ifdef BETTY_TIMINGS
+
+/*
+ * Construct profiler (build with `make TIMINGS=1`)
+ * Charges parse and format time, and allocations in STATS=1 builds, to
+ * each top-level item and to the node types inside it. Only the span
+ * between profile_begin_file() and profile_end_file() is recorded.
+ */
+#define PROFILE_ENABLED 1
+
+void profile_begin_file(const char *filename, Token **tokens);
+void profile_end_file(void);
+
+void profile_statement_begin(void);
+void profile_statement_end(const ASTNode *node);
+void profile_item_parsed(const ASTNode *item, int index);
+
+void profile_format_task(const ASTNode *node);
+void profile_format_item(int index);
+
+void profile_report(FILE *out, int top);
+
+#else
+
+/* Disabled: instrumentation compiles to nothing */
+#define PROFILE_ENABLED 0
+
+#define profile_begin_file(filename, tokens) ((void)0)
+#define profile_end_file() ((void)0)
+
+#define profile_statement_begin() ((void)0)
+#define profile_statement_end(node) ((void)0)
+#define profile_item_parsed(item, index) ((void)0)
+
+#define profile_format_task(node) ((void)0)
+#define profile_format_item(index) ((void)0)
+
+#define profile_report(out, top) ((void)0)
+
+#endif /* BETTY_TIMINGS */
+
+#endif /* PROFILE_H */
@@ -0,0 +1,77 @@
+#ifndef SINK_H
+#define SINK_H
+
+#include <stddef.h>
+
+/*
+ * Output sink backends
+ */
+typedef enum {
+	SINK_MEMORY,   /* Growable in-memory buffer */
+	SINK_COMPARE,  /* Compare against expected text, store nothing */
+	SINK_GATHER    /* Segment list written to a descriptor with writev */
+} SinkKind;
+
+/*
+ * Gather sink segment: a borrowed slice or a piece of the sink's arena
+ */
+typedef struct SinkSegment {
+	const char *data;
+	size_t length;
+} SinkSegment;
+
+/*
+ * Gather sink arena chunk, holding copied (non-borrowed) output
+ */
+typedef struct SinkChunk {
+	struct SinkChunk *next;
+	size_t used;
+	size_t size;
+	char data[];
+} SinkChunk;
+
+/*
+ * Output sink
+ * Destination of formatted output. The formatter hands over whole spans;
+ * each backend decides whether to keep, write or compare them.
+ */
+typedef struct OutputSink {
+	SinkKind kind;
+
+	/* SINK_MEMORY */
+	char *buffer;
+	size_t length;
+	size_t capacity;
+
+	/* SINK_GATHER */
+	int fd;
+	SinkSegment *segments;
+	int segment_count;
+	int segment_capacity;
+	SinkChunk *chunks;  /* Arena, newest chunk first */
+
+	/* SINK_COMPARE */
+	const char *expected;
+	size_t expected_length;
+	int mismatch;  /* Output diverged from the expected text */
+
+	size_t written;  /* Total bytes accepted */
+	int failed;      /* Allocation or write error */
+} OutputSink;
+
+/* Sink lifecycle */
+OutputSink *sink_create_memory(void);
+OutputSink *sink_create_compare(const char *expected, size_t length);
+OutputSink *sink_create_gather(int fd);
+void sink_destroy(OutputSink *sink);
+
+/* Output */
+int sink_write(OutputSink *sink, const char *data, size_t length);
+int sink_write_ref(OutputSink *sink, const char *data, size_t length);
+int sink_flush(OutputSink *sink);
+
+/* Results */
+char *sink_take_buffer(OutputSink *sink, size_t *length);
+int sink_matches(const OutputSink *sink);
+
+#endif /* SINK_H */
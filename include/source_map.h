@@ -0,0 +1,41 @@
+#ifndef SOURCE_MAP_H
+#define SOURCE_MAP_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Source map anchor
+ * Byte offset in the formatted output and the offset of the same text in
+ * the original source
+ */
+typedef struct SourceAnchor {
+	size_t output;
+	size_t input;
+} SourceAnchor;
+
+/*
+ * Source map
+ * Anchors at token boundaries, in output order (output offsets never
+ * decrease). A position between two anchors maps by its distance from the
+ * preceding one.
+ */
+typedef struct SourceMap {
+	SourceAnchor *anchors;
+	int count;
+	int capacity;
+} SourceMap;
+
+/* Source map lifecycle */
+SourceMap *source_map_create(void);
+void source_map_destroy(SourceMap *map);
+
+/* Building and lookup */
+int source_map_add(SourceMap *map, size_t output, size_t input);
+size_t source_map_input(const SourceMap *map, size_t output);
+
+/* Serialization */
+int source_map_write(const SourceMap *map, const char *source_path,
+		     FILE *fp);
+
+#endif /* SOURCE_MAP_H */
@@ -0,0 +1,74 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Memory subsystems
+ * Every allocation is charged to the subsystem that made it
+ */
+typedef enum {
+	MEM_LEXER,
+	MEM_TOKENS,
+	MEM_PARSER,
+	MEM_AST,
+	MEM_SYMBOLS,
+	MEM_COMMENTS,
+	MEM_FORMATTER,
+	MEM_CACHE,
+	MEM_OUTPUT,
+	MEM_SERVER,
+	MEM_SUBSYSTEM_COUNT
+} MemSubsystem;
+
+/*
+ * Allocation totals since the last stats_reset(), over all subsystems
+ */
+typedef struct StatsTotals {
+	unsigned long allocs;  /* Allocations and reallocations */
+	size_t bytes;
+	size_t peak;           /* Peak live bytes */
+} StatsTotals;
+
+#ifdef BETTY_STATS
+
+/*
+ * Counting allocator (build with `make STATS=1`)
+ * Each block carries a small header recording its size and subsystem so
+ * frees and reallocs can be charged back correctly.
+ */
+#define STATS_ENABLED 1
+
+void *mem_alloc(size_t size, MemSubsystem subsystem);
+void *mem_calloc(size_t count, size_t size, MemSubsystem subsystem);
+void *mem_realloc(void *ptr, size_t size, MemSubsystem subsystem);
+char *mem_strdup(const char *str, MemSubsystem subsystem);
+void mem_free(void *ptr);
+
+void stats_reset(void);
+void stats_end_phase(const char *name);
+void stats_report(FILE *out, const char *label, size_t input_bytes);
+void stats_totals(StatsTotals *totals);
+
+#else
+
+/* Disabled: the allocator compiles down to the libc calls */
+#define STATS_ENABLED 0
+
+#define mem_alloc(size, subsystem) malloc(size)
+#define mem_calloc(count, size, subsystem) calloc(count, size)
+#define mem_realloc(ptr, size, subsystem) realloc(ptr, size)
+#define mem_strdup(str, subsystem) strdup(str)
+#define mem_free(ptr) free(ptr)
+
+#define stats_reset() ((void)0)
+#define stats_end_phase(name) ((void)0)
+#define stats_report(out, label, input_bytes) ((void)0)
+#define stats_totals(totals) memset((totals), 0, sizeof(StatsTotals))
+
+#endif /* BETTY_STATS */
+
+#endif /* STATS_H */
@@ -0,0 +1,70 @@
+#ifndef TIMINGS_H
+#define TIMINGS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Timed phases
+ * Phases nest (recovery runs inside parse, writes inside format); time
+ * is charged to the innermost one, so the phases of a file add up.
+ */
+typedef enum {
+	TIME_READ,
+	TIME_LEX,
+	TIME_PARSE,
+	TIME_RECOVERY,  /* Raw capture of code the parser gave up on */
+	TIME_LINT,      /* Style checks on the parsed file (--lint) */
+	TIME_FORMAT,
+	TIME_VERIFY,
+	TIME_WRITE,
+	TIME_PHASE_COUNT
+} TimingPhase;
+
+/*
+ * Event counters
+ */
+typedef enum {
+	COUNT_REWINDS,         /* Speculative parses that backtracked */
+	COUNT_REWOUND_TOKENS,  /* Tokens given back by those rewinds */
+	COUNT_UNPARSED,        /* NODE_UNPARSED fallbacks */
+	COUNT_BYTES_EMITTED,   /* Bytes written to output sinks */
+	COUNT_TOKENS_VISITED,  /* Tokens consumed or looked ahead over */
+	COUNT_FORMAT_TASKS,    /* Tasks pushed on the formatter's stack */
+	TIME_COUNTER_COUNT
+} TimingCounter;
+
+#ifdef BETTY_TIMINGS
+
+/*
+ * Phase timer (build with `make TIMINGS=1`)
+ * CLOCK_MONOTONIC spans; the first file timed starts the aggregate.
+ */
+#define TIMINGS_ENABLED 1
+
+void timing_begin(TimingPhase phase);
+void timing_end(TimingPhase phase);
+void timing_count(TimingCounter counter, unsigned long amount);
+unsigned long timings_counter(TimingCounter counter);
+
+void timings_reset(void);
+void timings_report(FILE *out, const char *label, size_t input_bytes);
+void timings_report_total(FILE *out);
+
+#else
+
+/* Disabled: instrumentation compiles to nothing */
+#define TIMINGS_ENABLED 0
+
+#define timing_begin(phase) ((void)0)
+#define timing_end(phase) ((void)0)
+#define timing_count(counter, amount) ((void)0)
+#define timings_counter(counter) (0UL)
+
+#define timings_reset() ((void)0)
+#define timings_report(out, label, input_bytes) ((void)0)
+#define timings_report_total(out) ((void)0)
+
+#endif /* BETTY_TIMINGS */
+
+#endif /* TIMINGS_H */
@@ -120,14 +120,21 @@ typedef enum {
 typedef struct {
 	TokenType type;
 	char *lexeme;
-	int line;
-	int column;
+	int line;    /* Line of the last character (see token_start()) */
+	int column;  /* Byte column of the last character */
 	int length;
+	int offset;  /* Byte offset of the first character, -1 if unknown */
 } Token;
 
 /* Token creation and destruction */
 Token *token_create(TokenType type, const char *lexeme, int line, int column);
+Token *token_create_len(TokenType type, const char *text, int length,
+			int line, int column);
 void token_destroy(Token *token);
 const char *token_type_to_string(TokenType type);
 
+/* Position of the first character */
+int token_start_column(const Token *token);
+void token_start(Token **tokens, int index, int *line, int *column);
+
 #endif /* TOKEN_H */
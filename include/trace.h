@@ -0,0 +1,38 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifdef BETTY_TIMINGS
+
+/*
+ * Trace-event recorder (build with `make TIMINGS=1`)
+ * Spans and counters are appended to an in-memory buffer and written as
+ * Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev) when the
+ * trace is closed. Names and categories must outlive the trace. Not
+ * thread-safe; the formatter records from its only thread.
+ */
+#define TRACE_ENABLED 1
+
+int trace_open(const char *path);
+int trace_active(void);
+void trace_begin(const char *name, const char *category);
+void trace_end(const char *name, const char *category);
+void trace_counter(const char *name, double value);
+void trace_memory(void);
+int trace_close(void);
+
+#else
+
+/* Disabled: tracing compiles to nothing */
+#define TRACE_ENABLED 0
+
+#define trace_open(path) (-1)
+#define trace_active() 0
+#define trace_begin(name, category) ((void)0)
+#define trace_end(name, category) ((void)0)
+#define trace_counter(name, value) ((void)(value))
+#define trace_memory() ((void)0)
+#define trace_close() 0
+
+#endif /* BETTY_TIMINGS */
+
+#endif /* TRACE_H */
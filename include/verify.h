@@ -0,0 +1,27 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include "token.h"
+
+/*
+ * Verification result
+ * Counts of what was compared and, when the texts are not equivalent,
+ * where they first differ
+ */
+typedef struct VerifyResult {
+	int tokens;          /* Code tokens compared */
+	int comments;        /* Comments compared */
+	const char *reason;  /* NULL when equivalent */
+	int input_line;      /* First difference, 0 at end of text */
+	int input_column;
+	int output_line;
+	int output_column;
+	char input_text[32];   /* Differing tokens, shortened */
+	char output_text[32];
+} VerifyResult;
+
+/* Token equivalence of a source and its formatted output */
+int verify_tokens(Token **source, int source_count, Token **output,
+		  int output_count, VerifyResult *result);
+
+#endif /* VERIFY_H */
@@ -1,7 +1,21 @@
 #include "../include/ast.h"
+#include "../include/stats.h"
 #include <stdlib.h>
 
 #define INITIAL_CHILD_CAPACITY 8
+#define INITIAL_WALK_CAPACITY 64
+
+/*
+ * WalkFrame - One node on the ast_walk() stack
+ * @node: Node being visited
+ * @next_child: Next child to descend into (-1 before enter callbacks)
+ * @depth: Depth of the node (root is 0)
+ */
+typedef struct WalkFrame {
+	ASTNode *node;
+	int next_child;
+	int depth;
+} WalkFrame;
 
 /*
  * ast_node_create - Create a new AST node
@@ -14,7 +28,7 @@ ASTNode *ast_node_create(NodeType type, Token *token)
 {
 	ASTNode *node;
 
-	node = malloc(sizeof(ASTNode));
+	node = mem_alloc(sizeof(ASTNode), MEM_AST);
 	if (!node)
 		return (NULL);
 
@@ -22,58 +36,138 @@ ASTNode *ast_node_create(NodeType type, Token *token)
 	node->token = token;
 
 	node->child_capacity = INITIAL_CHILD_CAPACITY;
-	node->children = malloc(sizeof(ASTNode *) * node->child_capacity);
+	node->children = mem_alloc(sizeof(ASTNode *) * node->child_capacity,
+				   MEM_AST);
 	if (!node->children)
 	{
-		free(node);
+		mem_free(node);
 		return (NULL);
 	}
 
 	node->child_count = 0;
-	node->leading_comments = NULL;
-	node->leading_comment_count = 0;
-	node->trailing_comments = NULL;
-	node->trailing_comment_count = 0;
+	node->comment_id = 0;
 	node->blank_lines_before = 0;
+	node->parens = 0;
+	node->token_start = -1;
+	node->token_end = -1;
 	node->data = NULL;
 
 	return (node);
 }
 
+/*
+ * free_var_data - Release a declarator and the declarators after it
+ * @var: Declarator data, or NULL
+ * @owns_init: Whether @var->init_expr is owned here rather than a child
+ *
+ * The first declarator's initializer is a child of the node; those of
+ * the declarators after a comma hang only off their data.
+ */
+static void free_var_data(VarDeclData *var, int owns_init)
+{
+	int i;
+
+	if (!var)
+		return;
+
+	for (i = 0; i < var->extra_count; i++)
+		free_var_data(var->extra_vars[i], 1);
+	if (owns_init)
+		ast_node_destroy(var->init_expr);
+	mem_free(var->extra_vars);
+	mem_free(var->type_tokens);
+	mem_free(var->array_tokens);
+	mem_free(var);
+}
+
+/*
+ * free_node_data - Release node-specific data owned by the node
+ * @node: Node whose data to free
+ *
+ * Token arrays are the parser's; the tokens in them are the lexer's.
+ * Function parameters are not children, so they are destroyed here.
+ */
+static void free_node_data(ASTNode *node)
+{
+	int i;
+
+	if (!node->data)
+		return;
+
+	switch (node->type)
+	{
+	case NODE_UNPARSED:
+		mem_free(((RawSegmentData *)node->data)->text);
+		break;
+	case NODE_FUNCTION:
+	case NODE_PARAM:
+	case NODE_TYPE_EXPR:
+	{
+		FunctionData *func = (FunctionData *)node->data;
+
+		for (i = 0; i < func->param_count; i++)
+			ast_node_destroy(func->params[i]);
+		mem_free(func->params);
+		mem_free(func->return_type_tokens);
+		break;
+	}
+	case NODE_VAR_DECL:
+		free_var_data((VarDeclData *)node->data, 0);
+		node->data = NULL;
+		return;
+	case NODE_TYPEDEF:
+		mem_free(((TypedefData *)node->data)->base_type_tokens);
+		break;
+	case NODE_FUNC_PTR:
+		mem_free(((FuncPtrData *)node->data)->return_type_tokens);
+		mem_free(((FuncPtrData *)node->data)->param_tokens);
+		break;
+	default:
+		break;
+	}
+	mem_free(node->data);
+	node->data = NULL;
+}
+
 /*
  * ast_node_destroy - Free AST node and all children
  * @node: Node to destroy
+ *
+ * Runs without recursion so arbitrarily deep trees (long else-if chains,
+ * deeply nested blocks) cannot overflow the stack. Nodes waiting to be
+ * freed are chained through their already-released data pointer, so no
+ * extra memory is needed either.
  */
 void ast_node_destroy(ASTNode *node)
 {
+	ASTNode *pending;
 	int i;
 
 	if (!node)
 		return;
 
-	for (i = 0; i < node->child_count; i++)
-		ast_node_destroy(node->children[i]);
+	free_node_data(node);
+	pending = node;
 
-	free(node->children);
-	free(node->leading_comments);
-	free(node->trailing_comments);
-	if (node->type == NODE_UNPARSED && node->data)
+	while (pending)
 	{
-		RawSegmentData *segment = (RawSegmentData *)node->data;
+		node = pending;
+		pending = (ASTNode *)node->data;
 
-		free(segment->text);
-		free(segment);
-	}
-	else if (node->type == NODE_SIZEOF && node->data)
-	{
-		free(node->data);
-	}
-	else if (node->type == NODE_CAST && node->data)
-	{
-		free(node->data);
+		for (i = 0; i < node->child_count; i++)
+		{
+			ASTNode *child = node->children[i];
+
+			if (!child)
+				continue;
+			free_node_data(child);
+			child->data = pending;
+			pending = child;
+		}
+
+		mem_free(node->children);
+		mem_free(node);
 	}
-	/* Note: other node-specific data typically references lexer-owned tokens */
-	free(node);
 }
 
 /*
@@ -94,8 +188,8 @@ int ast_node_add_child(ASTNode *parent, ASTNode *child)
 	if (parent->child_count >= parent->child_capacity)
 	{
 		new_capacity = parent->child_capacity * 2;
-		new_children = realloc(parent->children,
-				       sizeof(ASTNode *) * new_capacity);
+		new_children = mem_realloc(parent->children,
+				       sizeof(ASTNode *) * new_capacity, MEM_AST);
 		if (!new_children)
 			return (-1);
 
@@ -108,57 +202,182 @@ int ast_node_add_child(ASTNode *parent, ASTNode *child)
 }
 
 /*
- * ast_node_add_leading_comment - Add leading comment to node
- * @node: AST node
- * @comment: Comment token
+ * ast_node_type_name - Name of a node type
+ * @type: Node type
  *
- * Return: 0 on success, -1 on failure
+ * Return: Upper-case name, as printed by the dump tools
  */
-int ast_node_add_leading_comment(ASTNode *node, Token *comment)
+const char *ast_node_type_name(NodeType type)
 {
-	Token **new_comments;
-	int new_count;
-
-	if (!node || !comment)
-		return (-1);
-
-	new_count = node->leading_comment_count + 1;
-	new_comments = realloc(node->leading_comments,
-			       sizeof(Token *) * new_count);
-	if (!new_comments)
-		return (-1);
-
-	new_comments[node->leading_comment_count] = comment;
-	node->leading_comments = new_comments;
-	node->leading_comment_count = new_count;
-
-	return (0);
+	switch (type)
+	{
+	case NODE_PROGRAM: return "PROGRAM";
+	case NODE_FUNCTION: return "FUNCTION";
+	case NODE_VAR_DECL: return "VAR_DECL";
+	case NODE_STRUCT: return "STRUCT";
+	case NODE_TYPEDEF: return "TYPEDEF";
+	case NODE_ENUM: return "ENUM";
+	case NODE_ENUM_VALUE: return "ENUM_VALUE";
+	case NODE_BLOCK: return "BLOCK";
+	case NODE_IF: return "IF";
+	case NODE_WHILE: return "WHILE";
+	case NODE_FOR: return "FOR";
+	case NODE_DO_WHILE: return "DO_WHILE";
+	case NODE_SWITCH: return "SWITCH";
+	case NODE_CASE: return "CASE";
+	case NODE_RETURN: return "RETURN";
+	case NODE_BREAK: return "BREAK";
+	case NODE_CONTINUE: return "CONTINUE";
+	case NODE_GOTO: return "GOTO";
+	case NODE_LABEL: return "LABEL";
+	case NODE_EXPR_STMT: return "EXPR_STMT";
+	case NODE_BINARY: return "BINARY";
+	case NODE_UNARY: return "UNARY";
+	case NODE_CALL: return "CALL";
+	case NODE_LITERAL: return "LITERAL";
+	case NODE_IDENTIFIER: return "IDENTIFIER";
+	case NODE_MEMBER_ACCESS: return "MEMBER_ACCESS";
+	case NODE_ARRAY_ACCESS: return "ARRAY_ACCESS";
+	case NODE_CAST: return "CAST";
+	case NODE_SIZEOF: return "SIZEOF";
+	case NODE_TERNARY: return "TERNARY";
+	case NODE_PARAM: return "PARAM";
+	case NODE_FUNC_PTR: return "FUNC_PTR";
+	case NODE_PREPROCESSOR: return "PREPROCESSOR";
+	case NODE_TYPE_EXPR: return "TYPE_EXPR";
+	case NODE_INIT_LIST: return "INIT_LIST";
+	case NODE_UNPARSED: return "UNPARSED";
+	default: return "UNKNOWN";
+	}
 }
 
 /*
- * ast_node_add_trailing_comment - Add trailing comment to node
- * @node: AST node
- * @comment: Comment token
+ * ast_walk - Visit a tree depth-first with one or more fused visitors
+ * @root: Root of the tree to walk
+ * @visitors: Visitors to run (see ast.h for callback semantics)
+ * @visitor_count: Number of visitors (at most AST_WALK_MAX_VISITORS)
  *
- * Return: 0 on success, -1 on failure
+ * The traversal uses an explicit stack, so depth is bounded by memory
+ * rather than by the C stack. Callbacks must not change the children of
+ * nodes that are still being walked.
+ *
+ * Return: 0 if the walk completed, 1 if every visitor stopped early,
+ * -1 on error
  */
-int ast_node_add_trailing_comment(ASTNode *node, Token *comment)
+int ast_walk(ASTNode *root, const ASTVisitor *visitors, int visitor_count)
 {
-	Token **new_comments;
-	int new_count;
+	WalkFrame *stack;
+	int skip_depth[AST_WALK_MAX_VISITORS];
+	int stopped[AST_WALK_MAX_VISITORS];
+	int count = 0, capacity = INITIAL_WALK_CAPACITY;
+	int active = visitor_count;
+	int i;
 
-	if (!node || !comment)
+	if (!visitors || visitor_count <= 0 ||
+	    visitor_count > AST_WALK_MAX_VISITORS)
 		return (-1);
+	if (!root)
+		return (0);
 
-	new_count = node->trailing_comment_count + 1;
-	new_comments = realloc(node->trailing_comments,
-			       sizeof(Token *) * new_count);
-	if (!new_comments)
+	for (i = 0; i < visitor_count; i++)
+	{
+		skip_depth[i] = -1;
+		stopped[i] = 0;
+	}
+
+	stack = mem_alloc(sizeof(WalkFrame) * capacity, MEM_AST);
+	if (!stack)
 		return (-1);
 
-	new_comments[node->trailing_comment_count] = comment;
-	node->trailing_comments = new_comments;
-	node->trailing_comment_count = new_count;
+	stack[0].node = root;
+	stack[0].next_child = -1;
+	stack[0].depth = 0;
+	count = 1;
 
-	return (0);
+	while (count > 0 && active > 0)
+	{
+		WalkFrame *frame = &stack[count - 1];
+		ASTNode *node = frame->node;
+		int depth = frame->depth;
+
+		if (frame->next_child < 0)
+		{
+			int descend = 0;
+
+			frame->next_child = 0;
+			for (i = 0; i < visitor_count; i++)
+			{
+				ASTWalkAction action = AST_WALK_CONTINUE;
+
+				if (stopped[i] || skip_depth[i] >= 0)
+					continue;
+				if (visitors[i].enter)
+					action = visitors[i].enter(node, depth,
+								   visitors[i].ctx);
+				if (action == AST_WALK_STOP)
+				{
+					stopped[i] = 1;
+					active--;
+				}
+				else if (action == AST_WALK_SKIP)
+					skip_depth[i] = depth;
+				else
+					descend = 1;
+			}
+
+			/* Nobody wants the children: go straight to leave */
+			if (!descend)
+				frame->next_child = node->child_count;
+		}
+
+		if (frame->next_child < node->child_count)
+		{
+			ASTNode *child = node->children[frame->next_child++];
+
+			if (!child)
+				continue;
+
+			if (count >= capacity)
+			{
+				WalkFrame *new_stack = mem_realloc(stack,
+					sizeof(WalkFrame) * capacity * 2, MEM_AST);
+
+				if (!new_stack)
+				{
+					mem_free(stack);
+					return (-1);
+				}
+				stack = new_stack;
+				capacity *= 2;
+			}
+
+			stack[count].node = child;
+			stack[count].next_child = -1;
+			stack[count].depth = depth + 1;
+			count++;
+			continue;
+		}
+
+		count--;
+		for (i = 0; i < visitor_count; i++)
+		{
+			if (stopped[i])
+				continue;
+			/* Still inside a subtree this visitor skipped */
+			if (skip_depth[i] >= 0 && skip_depth[i] < depth)
+				continue;
+			skip_depth[i] = -1;
+
+			if (visitors[i].leave &&
+			    visitors[i].leave(node, depth, visitors[i].ctx) ==
+			    AST_WALK_STOP)
+			{
+				stopped[i] = 1;
+				active--;
+			}
+		}
+	}
+
+	mem_free(stack);
+	return (active > 0 ? 0 : 1);
 }
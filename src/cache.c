@@ -0,0 +1,421 @@
+#define _GNU_SOURCE
+#include "../include/cache.h"
+#include "../include/utils.h"
+#include "../include/stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC "betty-fmt-cache"
+#define INITIAL_FRESH_CAPACITY 16
+
+static int load_entries(FormatCache *cache, const char *data);
+static int compare_entries(const void *a, const void *b);
+static void free_entries(CacheEntry *entries, int count);
+
+/*
+ * cache_hash_bytes - Fold bytes into a running FNV-1a hash
+ * @hash: Current hash value (CACHE_HASH_INIT to start)
+ * @data: Bytes to hash
+ * @length: Number of bytes
+ *
+ * Return: Updated hash
+ */
+uint64_t cache_hash_bytes(uint64_t hash, const void *data, size_t length)
+{
+	const unsigned char *p = data;
+	size_t i;
+
+	for (i = 0; i < length; i++)
+	{
+		hash ^= p[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return (hash);
+}
+
+/*
+ * cache_hash_string - Fold a NUL-terminated string (and its end) into a hash
+ * @hash: Current hash value
+ * @str: String to hash (NULL hashes like an empty string)
+ *
+ * The terminating NUL is hashed too, so "ab" + "c" differs from "a" + "bc".
+ *
+ * Return: Updated hash
+ */
+uint64_t cache_hash_string(uint64_t hash, const char *str)
+{
+	if (str)
+		hash = cache_hash_bytes(hash, str, strlen(str));
+
+	return (cache_hash_bytes(hash, "", 1));
+}
+
+/*
+ * cache_hash_int - Fold an integer into a hash
+ * @hash: Current hash value
+ * @value: Value to hash
+ *
+ * Return: Updated hash
+ */
+uint64_t cache_hash_int(uint64_t hash, int value)
+{
+	return (cache_hash_bytes(hash, &value, sizeof(value)));
+}
+
+/*
+ * cache_open - Open the cache for a source file
+ * @dir: Cache directory (created if missing)
+ * @source_path: Path of the file being formatted
+ *
+ * Each source path maps to its own cache file inside @dir. A missing or
+ * unreadable cache file simply yields an empty cache.
+ *
+ * Return: Pointer to new cache, or NULL on failure
+ */
+FormatCache *cache_open(const char *dir, const char *source_path)
+{
+	FormatCache *cache;
+	char *data;
+	size_t path_len;
+
+	if (!dir || !source_path)
+		return (NULL);
+
+	cache = mem_alloc(sizeof(FormatCache), MEM_CACHE);
+	if (!cache)
+		return (NULL);
+
+	cache->entries = NULL;
+	cache->entry_count = 0;
+	cache->fresh = NULL;
+	cache->fresh_count = 0;
+	cache->fresh_capacity = 0;
+	cache->hits = 0;
+	cache->misses = 0;
+
+	/* dir + '/' + 16 hex digits + ".cache" + NUL */
+	path_len = strlen(dir) + 24;
+	cache->path = mem_alloc(path_len, MEM_CACHE);
+	if (!cache->path)
+	{
+		mem_free(cache);
+		return (NULL);
+	}
+	snprintf(cache->path, path_len, "%s/%016llx.cache", dir,
+		 (unsigned long long)cache_hash_string(CACHE_HASH_INIT,
+						       source_path));
+
+	mkdir(dir, 0755);
+
+	data = read_file(cache->path);
+	if (data)
+	{
+		if (load_entries(cache, data) < 0)
+		{
+			/* Corrupt or stale cache: start empty */
+			free_entries(cache->entries, cache->entry_count);
+			cache->entries = NULL;
+			cache->entry_count = 0;
+		}
+		free(data);
+	}
+
+	return (cache);
+}
+
+/*
+ * load_entries - Parse cache file contents
+ * @cache: Cache to fill
+ * @data: File contents
+ *
+ * Layout: a "betty-fmt-cache <version>" line, then one record per item:
+ * "<hash in hex> <length>\n" followed by <length> bytes and a newline.
+ *
+ * Return: 0 on success, -1 if the data is malformed
+ */
+static int load_entries(FormatCache *cache, const char *data)
+{
+	const char *p = data;
+	const char *end = data + strlen(data);
+	char *next;
+	int capacity = 0;
+	unsigned long version;
+
+	if (strncmp(p, CACHE_MAGIC " ", strlen(CACHE_MAGIC) + 1) != 0)
+		return (-1);
+	p += strlen(CACHE_MAGIC) + 1;
+
+	version = strtoul(p, &next, 10);
+	if (next == p || *next != '\n' || version != CACHE_FORMAT_VERSION)
+		return (-1);
+	p = next + 1;
+
+	while (p < end)
+	{
+		CacheEntry *entry;
+		uint64_t hash;
+		unsigned long length;
+
+		hash = strtoull(p, &next, 16);
+		if (next == p || *next != ' ')
+			return (-1);
+		p = next + 1;
+
+		length = strtoul(p, &next, 10);
+		if (next == p || *next != '\n')
+			return (-1);
+		p = next + 1;
+
+		if ((size_t)(end - p) < length + 1 || p[length] != '\n')
+			return (-1);
+
+		if (cache->entry_count >= capacity)
+		{
+			int new_capacity = capacity == 0 ? 16 : capacity * 2;
+			CacheEntry *new_entries = mem_realloc(cache->entries,
+				sizeof(CacheEntry) * new_capacity, MEM_CACHE);
+
+			if (!new_entries)
+				return (-1);
+			cache->entries = new_entries;
+			capacity = new_capacity;
+		}
+
+		entry = &cache->entries[cache->entry_count];
+		entry->text = mem_alloc(length + 1, MEM_CACHE);
+		if (!entry->text)
+			return (-1);
+		memcpy(entry->text, p, length);
+		entry->text[length] = '\0';
+		entry->length = length;
+		entry->hash = hash;
+		cache->entry_count++;
+
+		p += length + 1;
+	}
+
+	qsort(cache->entries, cache->entry_count, sizeof(CacheEntry),
+	      compare_entries);
+
+	return (0);
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+	const CacheEntry *ea = a;
+	const CacheEntry *eb = b;
+
+	if (ea->hash < eb->hash)
+		return (-1);
+	return (ea->hash > eb->hash);
+}
+
+/*
+ * cache_lookup - Find the cached output for an item hash
+ * @cache: Cache to search
+ * @hash: Structural hash of the item
+ *
+ * Return: Matching entry, or NULL on a miss
+ */
+const CacheEntry *cache_lookup(FormatCache *cache, uint64_t hash)
+{
+	CacheEntry key;
+	const CacheEntry *entry;
+
+	if (!cache || cache->entry_count == 0)
+	{
+		if (cache)
+			cache->misses++;
+		return (NULL);
+	}
+
+	key.hash = hash;
+	entry = bsearch(&key, cache->entries, cache->entry_count,
+			sizeof(CacheEntry), compare_entries);
+
+	if (entry)
+		cache->hits++;
+	else
+		cache->misses++;
+
+	return (entry);
+}
+
+/*
+ * cache_store - Record the output of an item for the next run
+ * @cache: Cache instance
+ * @hash: Structural hash of the item
+ * @text: Formatted output
+ * @length: Length of @text
+ *
+ * Return: 0 on success, -1 on error
+ */
+int cache_store(FormatCache *cache, uint64_t hash, const char *text,
+		size_t length)
+{
+	CacheEntry *entry;
+
+	if (!cache || !text)
+		return (-1);
+
+	if (cache->fresh_count >= cache->fresh_capacity)
+	{
+		int new_capacity = cache->fresh_capacity == 0 ?
+			INITIAL_FRESH_CAPACITY : cache->fresh_capacity * 2;
+		CacheEntry *new_fresh = mem_realloc(cache->fresh,
+			sizeof(CacheEntry) * new_capacity, MEM_CACHE);
+
+		if (!new_fresh)
+			return (-1);
+		cache->fresh = new_fresh;
+		cache->fresh_capacity = new_capacity;
+	}
+
+	entry = &cache->fresh[cache->fresh_count];
+	entry->text = mem_alloc(length + 1, MEM_CACHE);
+	if (!entry->text)
+		return (-1);
+	memcpy(entry->text, text, length);
+	entry->text[length] = '\0';
+	entry->length = length;
+	entry->hash = hash;
+	cache->fresh_count++;
+
+	return (0);
+}
+
+/*
+ * cache_create - Create an empty cache that lives in memory only
+ *
+ * For long-running callers that format the same text repeatedly: use
+ * cache_commit() between runs instead of saving and reopening.
+ *
+ * Return: Pointer to new cache, or NULL on failure
+ */
+FormatCache *cache_create(void)
+{
+	return (mem_calloc(1, sizeof(FormatCache), MEM_CACHE));
+}
+
+/*
+ * cache_commit - Make the entries stored during this run the lookup set
+ * @cache: Cache instance
+ *
+ * The in-memory counterpart of cache_save() followed by cache_open():
+ * entries from the previous run that were not stored again are dropped.
+ */
+void cache_commit(FormatCache *cache)
+{
+	if (!cache)
+		return;
+
+	free_entries(cache->entries, cache->entry_count);
+	cache->entries = cache->fresh;
+	cache->entry_count = cache->fresh_count;
+	cache->fresh = NULL;
+	cache->fresh_count = 0;
+	cache->fresh_capacity = 0;
+
+	qsort(cache->entries, cache->entry_count, sizeof(CacheEntry),
+	      compare_entries);
+}
+
+/*
+ * cache_save - Write the entries stored during this run to disk
+ * @cache: Cache instance
+ *
+ * The file is written to a unique temporary file next to it (mkstemp)
+ * and renamed into place, so a concurrent or interrupted run never sees
+ * a partial cache and concurrent saves never write the same file; the
+ * last rename wins.
+ *
+ * Return: 0 on success, -1 on error
+ */
+int cache_save(FormatCache *cache)
+{
+	FILE *fp;
+	char *tmp_path;
+	size_t len;
+	int i, fd;
+	int failed = 0;
+
+	if (!cache || !cache->path)
+		return (-1);
+
+	len = strlen(cache->path) + 8;
+	tmp_path = mem_alloc(len, MEM_CACHE);
+	if (!tmp_path)
+		return (-1);
+	snprintf(tmp_path, len, "%s.XXXXXX", cache->path);
+
+	fd = mkstemp(tmp_path);
+	if (fd < 0)
+	{
+		mem_free(tmp_path);
+		return (-1);
+	}
+	fp = fdopen(fd, "w");
+	if (!fp)
+	{
+		close(fd);
+		remove(tmp_path);
+		mem_free(tmp_path);
+		return (-1);
+	}
+
+	if (fprintf(fp, "%s %d\n", CACHE_MAGIC, CACHE_FORMAT_VERSION) < 0)
+		failed = 1;
+
+	for (i = 0; i < cache->fresh_count && !failed; i++)
+	{
+		CacheEntry *entry = &cache->fresh[i];
+
+		if (fprintf(fp, "%016llx %lu\n", (unsigned long long)entry->hash,
+			    (unsigned long)entry->length) < 0 ||
+		    fwrite(entry->text, 1, entry->length, fp) != entry->length ||
+		    fputc('\n', fp) == EOF)
+			failed = 1;
+	}
+
+	if (fclose(fp) != 0)
+		failed = 1;
+
+	if (failed || rename(tmp_path, cache->path) != 0)
+	{
+		remove(tmp_path);
+		mem_free(tmp_path);
+		return (-1);
+	}
+
+	mem_free(tmp_path);
+	return (0);
+}
+
+/*
+ * cache_close - Free cache memory (does not save)
+ * @cache: Cache to close
+ */
+void cache_close(FormatCache *cache)
+{
+	if (!cache)
+		return;
+
+	free_entries(cache->entries, cache->entry_count);
+	free_entries(cache->fresh, cache->fresh_count);
+	mem_free(cache->path);
+	mem_free(cache);
+}
+
+static void free_entries(CacheEntry *entries, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		mem_free(entries[i].text);
+	mem_free(entries);
+}
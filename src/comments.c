@@ -0,0 +1,195 @@
+#include "../include/comments.h"
+#include "../include/stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_COMMENT_CAPACITY 64
+
+static int build_index(CommentTable *table);
+
+/*
+ * comment_table_create - Create an empty comment table
+ * @tokens: Token array the comments refer to
+ * @token_count: Number of tokens
+ *
+ * Return: Pointer to new table, or NULL on failure
+ */
+CommentTable *comment_table_create(Token **tokens, int token_count)
+{
+	CommentTable *table;
+
+	table = mem_alloc(sizeof(CommentTable), MEM_COMMENTS);
+	if (!table)
+		return (NULL);
+
+	table->tokens = tokens;
+	table->token_count = token_count;
+	table->entries = NULL;
+	table->count = 0;
+	table->capacity = 0;
+	table->next_id = 1;
+	table->order = NULL;
+	table->first = NULL;
+	table->indexed = 0;
+	table->index_keys = 0;
+
+	return (table);
+}
+
+/*
+ * comment_table_destroy - Free comment table memory
+ * @table: Table to destroy
+ */
+void comment_table_destroy(CommentTable *table)
+{
+	if (!table)
+		return;
+
+	mem_free(table->entries);
+	mem_free(table->order);
+	mem_free(table->first);
+	mem_free(table);
+}
+
+/*
+ * comment_table_add - Attach a comment token to a node
+ * @table: Comment table
+ * @node: Node to attach to (gets an id on its first comment)
+ * @position: Leading or trailing
+ * @token_index: Index of the comment token
+ *
+ * Return: 0 on success, -1 on error
+ */
+int comment_table_add(CommentTable *table, ASTNode *node,
+		      CommentPosition position, int token_index)
+{
+	CommentEntry *entry;
+
+	if (!table || !node || token_index < 0 ||
+	    token_index >= table->token_count)
+		return (-1);
+
+	if (table->count >= table->capacity)
+	{
+		int new_capacity = table->capacity == 0 ?
+			INITIAL_COMMENT_CAPACITY : table->capacity * 2;
+		CommentEntry *new_entries = mem_realloc(table->entries,
+			sizeof(CommentEntry) * new_capacity, MEM_COMMENTS);
+
+		if (!new_entries)
+			return (-1);
+		table->entries = new_entries;
+		table->capacity = new_capacity;
+	}
+
+	if (node->comment_id == 0)
+		node->comment_id = table->next_id++;
+
+	entry = &table->entries[table->count++];
+	entry->node_id = node->comment_id;
+	entry->position = position;
+	entry->token_index = token_index;
+
+	return (0);
+}
+
+/*
+ * build_index - Sort entry indices by (node id, position)
+ * @table: Comment table
+ *
+ * Node ids are dense, so a counting sort keyed on id * 2 + position
+ * orders the table in linear time and keeps append order within a key.
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int build_index(CommentTable *table)
+{
+	int keys = table->next_id * 2 + 1;
+	int *order, *first;
+	int i;
+
+	order = mem_alloc(sizeof(int) * (table->count > 0 ? table->count : 1),
+			  MEM_COMMENTS);
+	first = mem_calloc(keys + 1, sizeof(int), MEM_COMMENTS);
+	if (!order || !first)
+	{
+		mem_free(order);
+		mem_free(first);
+		return (-1);
+	}
+
+	for (i = 0; i < table->count; i++)
+		first[table->entries[i].node_id * 2 +
+		      table->entries[i].position + 1]++;
+	for (i = 0; i < keys; i++)
+		first[i + 1] += first[i];
+	for (i = 0; i < table->count; i++)
+	{
+		int key = table->entries[i].node_id * 2 +
+			table->entries[i].position;
+
+		order[first[key]++] = i;
+	}
+
+	/* The placement pass advanced each start to the next key's start */
+	for (i = keys; i > 0; i--)
+		first[i] = first[i - 1];
+	first[0] = 0;
+
+	mem_free(table->order);
+	mem_free(table->first);
+	table->order = order;
+	table->first = first;
+	table->indexed = table->count;
+	table->index_keys = keys;
+
+	return (0);
+}
+
+/*
+ * comment_table_find - Find the comments attached to a node
+ * @table: Comment table
+ * @node: Node to look up
+ * @position: Leading or trailing
+ * @first: Set to the position of the first match (for comment_table_token)
+ *
+ * Return: Number of matching comments (0 if none or on error)
+ */
+int comment_table_find(CommentTable *table, const ASTNode *node,
+		       CommentPosition position, int *first)
+{
+	int key;
+
+	if (!table || !node || node->comment_id == 0)
+		return (0);
+
+	if (table->indexed != table->count || !table->first)
+	{
+		if (build_index(table) < 0)
+			return (0);
+	}
+
+	key = node->comment_id * 2 + position;
+	if (key >= table->index_keys)
+		return (0);
+
+	if (first)
+		*first = table->first[key];
+
+	return (table->first[key + 1] - table->first[key]);
+}
+
+/*
+ * comment_table_token - Get the comment token at a lookup position
+ * @table: Comment table
+ * @n: Position returned by comment_table_find (plus offset)
+ *
+ * Return: Comment token, or NULL if out of range
+ */
+Token *comment_table_token(CommentTable *table, int n)
+{
+	if (!table || !table->order || n < 0 || n >= table->indexed)
+		return (NULL);
+
+	return (table->tokens[table->entries[table->order[n]].token_index]);
+}
@@ -0,0 +1,181 @@
+#include "../include/edits.h"
+#include "../include/json.h"
+#include "../include/stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_EDIT_CAPACITY 64
+#define INITIAL_TEXT_CAPACITY 1024
+
+/*
+ * edit_list_create - Create an empty edit list
+ *
+ * Return: Pointer to new edit list, or NULL on failure
+ */
+EditList *edit_list_create(void)
+{
+	return (mem_calloc(1, sizeof(EditList), MEM_OUTPUT));
+}
+
+/*
+ * edit_list_destroy - Free edit list memory
+ * @list: Edit list to destroy
+ */
+void edit_list_destroy(EditList *list)
+{
+	if (!list)
+		return;
+
+	mem_free(list->edits);
+	mem_free(list->text);
+	mem_free(list);
+}
+
+/*
+ * edit_list_open - Start an edit
+ * @list: Edit list
+ * @offset: Source offset the edit starts at (not before earlier edits)
+ *
+ * Text passed to edit_list_insert() goes into this edit until it is
+ * closed. An edit that is still open is left as it is.
+ */
+void edit_list_open(EditList *list, size_t offset)
+{
+	TextEdit *edit;
+
+	if (!list || list->open || list->failed)
+		return;
+
+	if (list->count >= list->capacity)
+	{
+		int new_capacity = list->capacity == 0 ?
+			INITIAL_EDIT_CAPACITY : list->capacity * 2;
+		TextEdit *new_edits = mem_realloc(list->edits,
+			sizeof(TextEdit) * new_capacity, MEM_OUTPUT);
+
+		if (!new_edits)
+		{
+			list->failed = 1;
+			return;
+		}
+		list->edits = new_edits;
+		list->capacity = new_capacity;
+	}
+
+	edit = &list->edits[list->count++];
+	edit->offset = offset;
+	edit->delete_length = 0;
+	edit->insert = list->text_length;
+	edit->insert_length = 0;
+	list->open = 1;
+}
+
+/*
+ * edit_list_insert - Add text to the open edit
+ * @list: Edit list
+ * @text: Text to insert (copied)
+ * @length: Length of @text
+ */
+void edit_list_insert(EditList *list, const char *text, size_t length)
+{
+	if (!list || !list->open || list->failed || length == 0)
+		return;
+
+	if (list->text_length + length > list->text_capacity)
+	{
+		size_t new_capacity = list->text_capacity == 0 ?
+			INITIAL_TEXT_CAPACITY : list->text_capacity;
+		char *new_text;
+
+		while (new_capacity < list->text_length + length)
+			new_capacity *= 2;
+		new_text = mem_realloc(list->text, new_capacity, MEM_OUTPUT);
+		if (!new_text)
+		{
+			list->failed = 1;
+			return;
+		}
+		list->text = new_text;
+		list->text_capacity = new_capacity;
+	}
+
+	memcpy(list->text + list->text_length, text, length);
+	list->text_length += length;
+	list->edits[list->count - 1].insert_length += length;
+}
+
+/*
+ * edit_list_close - Finish the open edit
+ * @list: Edit list
+ * @source: Source text the offsets refer to
+ * @end: Source offset where the replaced text ends (not before the start)
+ *
+ * The end of the replaced text that the new text repeats is kept, so a
+ * closed edit never ends in unchanged bytes; an edit left with nothing to
+ * do is dropped.
+ */
+void edit_list_close(EditList *list, const char *source, size_t end)
+{
+	TextEdit *edit;
+
+	if (!list || !list->open || list->failed)
+		return;
+
+	list->open = 0;
+	edit = &list->edits[list->count - 1];
+	edit->delete_length = end - edit->offset;
+
+	while (edit->delete_length > 0 && edit->insert_length > 0 &&
+	       source[edit->offset + edit->delete_length - 1] ==
+	       list->text[edit->insert + edit->insert_length - 1])
+	{
+		edit->delete_length--;
+		edit->insert_length--;
+	}
+	list->text_length = edit->insert + edit->insert_length;
+
+	if (edit->delete_length == 0 && edit->insert_length == 0)
+		list->count--;
+}
+
+/*
+ * edit_list_write - Write an edit list as JSON
+ * @list: Edit list (all edits closed)
+ * @source_path: Name of the formatted file (recorded in the output)
+ * @fp: Output stream
+ *
+ * Format: {"version":1,"source":"<path>","edits":[{"offset":N,
+ * "delete":N,"insert":"..."},...]} with byte offsets into the original
+ * source, in increasing order.
+ *
+ * Return: 0 on success, -1 on error
+ */
+int edit_list_write(const EditList *list, const char *source_path,
+		    FILE *fp)
+{
+	const TextEdit *edit;
+	int i;
+
+	if (!list || list->failed || list->open || !fp)
+		return (-1);
+
+	fputs("{\"version\":1,\"source\":", fp);
+	source_path = source_path ? source_path : "";
+	json_write_string(fp, source_path, strlen(source_path));
+	fputs(",\"edits\":[", fp);
+
+	for (i = 0; i < list->count; i++)
+	{
+		edit = &list->edits[i];
+		fprintf(fp, "%s{\"offset\":%lu,\"delete\":%lu,\"insert\":",
+			i > 0 ? "," : "", (unsigned long)edit->offset,
+			(unsigned long)edit->delete_length);
+		json_write_string(fp, list->text + edit->insert,
+				  edit->insert_length);
+		fputc('}', fp);
+	}
+
+	fputs("]}\n", fp);
+
+	return (ferror(fp) ? -1 : 0);
+}
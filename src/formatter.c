@@ -1,54 +1,159 @@
 #include "../include/formatter.h"
+#include "../include/stats.h"
+#include "../include/timings.h"
+#include "../include/profile.h"
 #include <stdlib.h>
 #include <string.h>
 
-/* Forward declarations */
+#define INITIAL_TASK_CAPACITY 64
+
+/*
+ * Traversal tasks
+ *
+ * Formatting never recurses on the AST. Each node handler emits whatever
+ * text it can immediately and pushes the remaining work (children,
+ * separators, closing text) onto an explicit stack in reverse order, so
+ * the depth of the C stack stays constant regardless of how deeply the
+ * input nests.
+ */
+typedef enum {
+	TASK_NODE,        /* Statement-level node dispatch */
+	TASK_EXPR,        /* Expression */
+	TASK_TEXT,        /* Literal text */
+	TASK_INDENT_TEXT, /* Indentation followed by text */
+	TASK_SPACED,      /* Text surrounded by single spaces */
+	TASK_GROUP_BEGIN, /* Open a layout group */
+	TASK_GROUP_END,   /* Close a layout group */
+	TASK_NEWLINE,     /* Line break */
+	TASK_INDENT_IN,   /* Increase indent level */
+	TASK_INDENT_OUT,  /* Decrease indent level */
+	TASK_BODY,        /* Body of a control statement */
+	TASK_ELSE,        /* Else branch of an if (iterates else-if chains) */
+	TASK_STMT_END,    /* ";" + trailing comments + newline */
+	TASK_CLOSE,       /* Dedent and close a braced body */
+	TASK_ITEMS,       /* Next top-level program item */
+	TASK_STMTS,       /* Next statement of a block */
+	TASK_CHILDREN,    /* Next child of a node, no separators */
+	TASK_LIST,        /* Next comma-separated expression */
+	TASK_CASES,       /* Next case of a switch */
+	TASK_VAR_REST,    /* Next extra variable of a declaration */
+	TASK_TYPEDEF_END, /* Typedef alias and semicolon */
+	TASK_ITEM_END     /* Store captured top-level item in the cache */
+} TaskKind;
+
+/* TASK_TEXT and TASK_SPACED flags */
+#define TEXT_BREAK 0x1  /* The blank after the text may become a newline */
+#define TEXT_TOKEN 0x2  /* TASK_TEXT: the text is the lexeme of node->token */
+#define TEXT_TAIL 0x4   /* TASK_SPACED: the break is before a short last operand */
+
+/* Widest operand that is not left alone on a continuation line */
+#define SHORT_OPERAND 8
+
+/* TASK_STMTS flags */
+#define STMTS_HAD_VAR_DECL 0x1
+#define STMTS_ADDED_BLANK 0x2
+
+/* TASK_CLOSE flags */
+#define CLOSE_INDENT 0x1
+#define CLOSE_NEWLINE 0x2
+
+typedef struct FormatTask {
+	TaskKind kind;
+	int flags;
+	int index;
+	ASTNode *node;
+	const char *text;
+} FormatTask;
+
+/*
+ * Source map anchor waiting for its text to reach the output
+ */
+typedef struct PendingAnchor {
+	const char *text;  /* Exact pointer the layout will write */
+	size_t input;
+} PendingAnchor;
+
+/* Traversal */
+static void push_task(Formatter *fmt, TaskKind kind, ASTNode *node,
+		      const char *text, int index, int flags);
+static void push_node(Formatter *fmt, ASTNode *node);
+static void push_expr(Formatter *fmt, ASTNode *node);
+static void push_text(Formatter *fmt, const char *text);
+static int format_run(Formatter *fmt);
+
+/* Item cache */
+static int item_hash(Formatter *fmt, ASTNode *node, uint64_t *out);
+static void end_item_capture(Formatter *fmt);
+static int replay_is_exact(Formatter *fmt, ASTNode *item,
+			   const CacheEntry *entry);
+
+/* Node handlers */
 static void format_node(Formatter *fmt, ASTNode *node);
-static void format_program(Formatter *fmt, ASTNode *node);
+static void format_program_item(Formatter *fmt, ASTNode *node, int index);
 static void format_function(Formatter *fmt, ASTNode *node);
 static void format_block(Formatter *fmt, ASTNode *node);
+static void format_block_stmt(Formatter *fmt, ASTNode *node, int index,
+			      int flags);
 static void format_var_decl(Formatter *fmt, ASTNode *node);
+static void format_var_rest(Formatter *fmt, ASTNode *node, int index);
 static void format_func_ptr(Formatter *fmt, ASTNode *node);
 static void format_if(Formatter *fmt, ASTNode *node);
+static void format_else(Formatter *fmt, ASTNode *node);
+static void format_body(Formatter *fmt, ASTNode *node);
 static void format_while(Formatter *fmt, ASTNode *node);
 static void format_for(Formatter *fmt, ASTNode *node);
 static void format_do_while(Formatter *fmt, ASTNode *node);
 static void format_switch(Formatter *fmt, ASTNode *node);
+static void format_case(Formatter *fmt, ASTNode *node, int index);
 static void format_return(Formatter *fmt, ASTNode *node);
 static void format_expression(Formatter *fmt, ASTNode *node);
+static void format_parens(Formatter *fmt, ASTNode *node);
 static void format_unparsed(Formatter *fmt, ASTNode *node);
 static void format_binary(Formatter *fmt, ASTNode *node);
 static void format_unary(Formatter *fmt, ASTNode *node);
 static void format_call(Formatter *fmt, ASTNode *node);
+static void format_list(Formatter *fmt, ASTNode *node, int index, int start);
 static void format_struct(Formatter *fmt, ASTNode *node);
 static void format_typedef(Formatter *fmt, ASTNode *node);
+static void format_typedef_end(Formatter *fmt, ASTNode *node, int has_ptr);
 static void format_enum(Formatter *fmt, ASTNode *node);
 
 /* Output helpers */
 static void emit(Formatter *fmt, const char *str);
-static void emit_char(Formatter *fmt, char c);
+static void emit_token(Formatter *fmt, const Token *tok);
+static void emit_at(Formatter *fmt, const char *str, int input);
+static void emit_span(Formatter *fmt, const char *str, size_t len);
+static void emit_break(Formatter *fmt);
+static void emit_group_begin(Formatter *fmt);
+static void emit_group_end(Formatter *fmt);
+static void output_span(void *ctx, const char *str, size_t len);
+static void begin_item(Formatter *fmt, ASTNode *item);
+static void end_match(Formatter *fmt);
+static void edit_anchor(Formatter *fmt, size_t input);
+static void edit_output(Formatter *fmt, const char *str, size_t len);
 static void emit_newline(Formatter *fmt);
 static void emit_indent(Formatter *fmt);
 static void emit_space(Formatter *fmt);
+static void emit_trailing_comments(Formatter *fmt, ASTNode *node);
 
 /*
  * formatter_create - Create a new formatter
- * @output: Output file stream
+ * @sink: Destination of the formatted output
  *
  * Return: Pointer to new formatter, or NULL on failure
  */
-Formatter *formatter_create(FILE *output)
+Formatter *formatter_create(OutputSink *sink)
 {
 	Formatter *formatter;
 
-	if (!output)
+	if (!sink)
 		return (NULL);
 
-	formatter = malloc(sizeof(Formatter));
+	formatter = mem_alloc(sizeof(Formatter), MEM_FORMATTER);
 	if (!formatter)
 		return (NULL);
 
-	formatter->output = output;
+	formatter->sink = sink;
 	formatter->indent_level = 0;
 	formatter->column = 0;
 	formatter->line = 1;
@@ -59,6 +164,49 @@ Formatter *formatter_create(FILE *output)
 	formatter->use_tabs = 1;
 	formatter->max_line_length = 80;
 
+	formatter->layout = layout_create(formatter->max_line_length,
+					  formatter->indent_width,
+					  formatter->use_tabs, output_span,
+					  formatter);
+	if (!formatter->layout)
+	{
+		mem_free(formatter);
+		return (NULL);
+	}
+
+	formatter->tasks = NULL;
+	formatter->task_count = 0;
+	formatter->task_capacity = 0;
+	formatter->failed = 0;
+
+	formatter->tokens = NULL;
+	formatter->token_count = 0;
+	formatter->comments = NULL;
+
+	formatter->cache = NULL;
+	formatter->item_hash = 0;
+	formatter->capture = NULL;
+	formatter->capture_length = 0;
+	formatter->capture_capacity = 0;
+	formatter->capturing = 0;
+
+	formatter->source = NULL;
+	formatter->source_length = 0;
+	formatter->source_pos = 0;
+	formatter->match_start = 0;
+	formatter->matching = 0;
+	formatter->slice_bytes = 0;
+
+	formatter->source_map = NULL;
+	formatter->output_offset = 0;
+	formatter->pending = NULL;
+	formatter->pending_head = 0;
+	formatter->pending_count = 0;
+	formatter->pending_capacity = 0;
+
+	formatter->edits = NULL;
+	formatter->edit_pos = 0;
+
 	return (formatter);
 }
 
@@ -71,7 +219,118 @@ void formatter_destroy(Formatter *formatter)
 	if (!formatter)
 		return;
 
-	free(formatter);
+	layout_destroy(formatter->layout);
+	mem_free(formatter->pending);
+	mem_free(formatter->tasks);
+	mem_free(formatter->capture);
+	mem_free(formatter);
+}
+
+/*
+ * formatter_set_source - Give the formatter access to the source tokens
+ * @formatter: Formatter instance
+ * @tokens: Token array the AST was parsed from
+ * @token_count: Number of tokens
+ */
+void formatter_set_source(Formatter *formatter, Token **tokens,
+			  int token_count)
+{
+	if (!formatter)
+		return;
+
+	formatter->tokens = tokens;
+	formatter->token_count = token_count;
+}
+
+/*
+ * formatter_set_cache - Reuse and record per-item output through a cache
+ * @formatter: Formatter instance
+ * @cache: Cache to use, or NULL to disable (requires formatter_set_source)
+ */
+void formatter_set_cache(Formatter *formatter, FormatCache *cache)
+{
+	if (!formatter)
+		return;
+
+	formatter->cache = cache;
+}
+
+/*
+ * formatter_set_comments - Set the table holding the AST's comments
+ * @formatter: Formatter instance
+ * @comments: Comment table filled by the parser (NULL drops comments)
+ */
+void formatter_set_comments(Formatter *formatter, CommentTable *comments)
+{
+	if (!formatter)
+		return;
+
+	formatter->comments = comments;
+}
+
+/*
+ * formatter_set_source_slices - Write output that matches the source as slices
+ * @formatter: Formatter instance
+ * @source: Text the AST was parsed from (must outlive the sink's flush)
+ * @length: Length of @source
+ *
+ * Output is compared with the source as it is produced. While the two
+ * agree nothing is written; the agreeing run is handed to the sink as a
+ * single slice of @source once it ends. After a difference, comparison
+ * resumes at the start of the next top-level item, so a declaration that
+ * is already compliant costs one sink write however many spans it
+ * formats to. This only saves sink work: every item is still formatted
+ * and laid out to be compared, unless a cache replays it.
+ * Formatter setting: call before formatter_format().
+ */
+void formatter_set_source_slices(Formatter *formatter, const char *source,
+				 size_t length)
+{
+	if (!formatter)
+		return;
+
+	formatter->source = source;
+	formatter->source_length = source ? length : 0;
+	formatter->source_pos = 0;
+	formatter->match_start = 0;
+	formatter->matching = source != NULL;
+}
+
+/*
+ * formatter_set_source_map - Record where output text came from
+ * @formatter: Formatter instance
+ * @map: Map to append anchors to, or NULL to disable
+ *
+ * Every token written to the output, and the start of every top-level
+ * item, adds an (output offset, source offset) anchor. Token offsets
+ * come from the lexer; item starts need formatter_set_source_slices() to
+ * locate their line in the source.
+ */
+void formatter_set_source_map(Formatter *formatter, SourceMap *map)
+{
+	if (!formatter)
+		return;
+
+	formatter->source_map = map;
+}
+
+/*
+ * formatter_set_edits - Describe the output as edits to the source
+ * @formatter: Formatter instance
+ * @edits: List to append edits to, or NULL to disable
+ *
+ * Output bytes are compared with the source from the last aligned
+ * offset; the first byte that differs opens an edit, which collects
+ * output until a token or item start anchors the output to the source
+ * again. Needs formatter_set_source_slices() for the source text.
+ */
+void formatter_set_edits(Formatter *formatter, EditList *edits)
+{
+	if (!formatter)
+		return;
+
+	formatter->edits = edits;
+	formatter->edit_pos = 0;
 }
 
 /*
@@ -86,74 +345,599 @@ int formatter_format(Formatter *formatter, ASTNode *ast)
 	if (!formatter || !ast)
 		return (-1);
 
-	format_node(formatter, ast);
+	/* The configuration may have changed since formatter_create() */
+	formatter->layout->width = formatter->max_line_length;
+	formatter->layout->tab_width = formatter->indent_width;
+	formatter->layout->use_tabs = formatter->use_tabs;
+	formatter->layout->space = formatter->max_line_length -
+		formatter->column;
 
-	return (0);
+	push_node(formatter, ast);
+
+	return (format_run(formatter));
+}
+
+/*
+ * Traversal
+ */
+
+/*
+ * push_task - Schedule a unit of formatting work
+ * @fmt: Formatter instance
+ * @kind: What to do when the task is popped
+ * @node: Node the task operates on (may be NULL)
+ * @text: Text the task emits (may be NULL)
+ * @index: Child index for continuation tasks
+ * @flags: Task-specific flags
+ *
+ * Tasks run in LIFO order, so callers push work in reverse.
+ */
+static void push_task(Formatter *fmt, TaskKind kind, ASTNode *node,
+		      const char *text, int index, int flags)
+{
+	FormatTask *task;
+
+	if (fmt->failed)
+		return;
+
+	if (fmt->task_count >= fmt->task_capacity)
+	{
+		int new_capacity = fmt->task_capacity == 0 ?
+			INITIAL_TASK_CAPACITY : fmt->task_capacity * 2;
+		FormatTask *new_tasks = mem_realloc(fmt->tasks,
+			sizeof(FormatTask) * new_capacity, MEM_FORMATTER);
+
+		if (!new_tasks)
+		{
+			fmt->failed = 1;
+			return;
+		}
+		fmt->tasks = new_tasks;
+		fmt->task_capacity = new_capacity;
+	}
+
+	task = &fmt->tasks[fmt->task_count++];
+	timing_count(COUNT_FORMAT_TASKS, 1);
+	task->kind = kind;
+	task->node = node;
+	task->text = text;
+	task->index = index;
+	task->flags = flags;
+}
+
+static void push_node(Formatter *fmt, ASTNode *node)
+{
+	if (node)
+		push_task(fmt, TASK_NODE, node, NULL, 0, 0);
+}
+
+static void push_expr(Formatter *fmt, ASTNode *node)
+{
+	if (node)
+		push_task(fmt, TASK_EXPR, node, NULL, 0, 0);
+}
+
+static void push_text(Formatter *fmt, const char *text)
+{
+	push_task(fmt, TASK_TEXT, NULL, text, 0, 0);
+}
+
+/*
+ * format_run - Execute queued tasks until the stack is empty
+ * @fmt: Formatter instance
+ *
+ * Return: 0 on success, -1 if the task stack could not grow
+ */
+static int format_run(Formatter *fmt)
+{
+	FormatTask task;
+
+	while (fmt->task_count > 0 && !fmt->failed)
+	{
+		task = fmt->tasks[--fmt->task_count];
+		profile_format_task(task.node);
+
+		switch (task.kind)
+		{
+		case TASK_NODE:
+			format_node(fmt, task.node);
+			break;
+		case TASK_EXPR:
+			format_parens(fmt, task.node);
+			format_expression(fmt, task.node);
+			break;
+		case TASK_TEXT:
+			if (task.flags & TEXT_TOKEN)
+				emit_token(fmt, task.node->token);
+			else
+				emit(fmt, task.text);
+			if (task.flags & TEXT_BREAK)
+				emit_break(fmt);
+			break;
+		case TASK_INDENT_TEXT:
+			emit_indent(fmt);
+			emit(fmt, task.text);
+			break;
+		case TASK_SPACED:
+			emit_space(fmt);
+			emit(fmt, task.text);
+			if (task.flags & TEXT_TAIL)
+				layout_tail_break(fmt->layout, 1);
+			else if (task.flags & TEXT_BREAK)
+				emit_break(fmt);
+			else
+				emit_space(fmt);
+			break;
+		case TASK_GROUP_BEGIN:
+			emit_group_begin(fmt);
+			break;
+		case TASK_GROUP_END:
+			emit_group_end(fmt);
+			break;
+		case TASK_NEWLINE:
+			emit_newline(fmt);
+			break;
+		case TASK_INDENT_IN:
+			fmt->indent_level++;
+			break;
+		case TASK_INDENT_OUT:
+			fmt->indent_level--;
+			break;
+		case TASK_BODY:
+			format_body(fmt, task.node);
+			break;
+		case TASK_ELSE:
+			format_else(fmt, task.node);
+			break;
+		case TASK_STMT_END:
+			emit(fmt, ";");
+			emit_trailing_comments(fmt, task.node);
+			emit_newline(fmt);
+			break;
+		case TASK_CLOSE:
+			fmt->indent_level--;
+			if (task.flags & CLOSE_INDENT)
+				emit_indent(fmt);
+			emit(fmt, "}");
+			if (task.flags & CLOSE_NEWLINE)
+				emit_newline(fmt);
+			break;
+		case TASK_ITEMS:
+			profile_format_item(task.index);
+			format_program_item(fmt, task.node, task.index);
+			break;
+		case TASK_STMTS:
+			format_block_stmt(fmt, task.node, task.index, task.flags);
+			break;
+		case TASK_CHILDREN:
+			if (task.index < task.node->child_count)
+			{
+				push_task(fmt, TASK_CHILDREN, task.node, NULL,
+					  task.index + 1, 0);
+				push_node(fmt, task.node->children[task.index]);
+			}
+			break;
+		case TASK_LIST:
+			format_list(fmt, task.node, task.index, task.flags);
+			break;
+		case TASK_CASES:
+			format_case(fmt, task.node, task.index);
+			break;
+		case TASK_VAR_REST:
+			format_var_rest(fmt, task.node, task.index);
+			break;
+		case TASK_TYPEDEF_END:
+			format_typedef_end(fmt, task.node, task.flags);
+			break;
+		case TASK_ITEM_END:
+			layout_flush(fmt->layout);
+			end_item_capture(fmt);
+			break;
+		}
+	}
+
+	layout_flush(fmt->layout);
+	end_match(fmt);
+	edit_anchor(fmt, fmt->source_length);
+	fmt->task_count = 0;
+	fmt->capturing = 0;
+	return (fmt->failed ? -1 : 0);
 }
 
 /*
  * Output helpers
  */
 
+/*
+ * Precomputed indentation, emitted in chunks of up to this many bytes
+ */
+#define INDENT_CHUNK 64
+
+static const char indent_tabs[INDENT_CHUNK + 1] =
+	"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+	"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+	"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+	"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+static const char indent_spaces[INDENT_CHUNK + 1] =
+	"                                "
+	"                                ";
+
+/*
+ * Everything passed to emit() is a string literal, a token lexeme or raw
+ * text owned by the AST, all of which outlive the formatting run, so the
+ * sink may reference it instead of copying (see sink_write_ref).
+ */
 static void emit(Formatter *fmt, const char *str)
 {
-	if (!str)
+	if (str)
+		emit_span(fmt, str, strlen(str));
+}
+
+/*
+ * emit_token - Emit a token's text, anchoring it in the source map
+ * @fmt: Formatter instance
+ * @tok: Token to emit
+ */
+static void emit_token(Formatter *fmt, const Token *tok)
+{
+	if (tok)
+		emit_at(fmt, tok->lexeme, tok->offset);
+}
+
+/*
+ * emit_at - Emit source text, anchoring it in the source map
+ * @fmt: Formatter instance
+ * @str: Text taken from the source
+ * @input: Source offset of @str, or -1 if unknown
+ *
+ * The layout may hold the text back, so the anchor is queued and only
+ * recorded when @str itself reaches output_span().
+ */
+static void emit_at(Formatter *fmt, const char *str, int input)
+{
+	if (!str || !*str)
 		return;
 
-	while (*str)
+	if ((fmt->source_map || fmt->edits) && input >= 0)
 	{
-		emit_char(fmt, *str);
-		str++;
+		if (fmt->pending_count >= fmt->pending_capacity)
+		{
+			int new_capacity = fmt->pending_capacity == 0 ?
+				64 : fmt->pending_capacity * 2;
+			PendingAnchor *new_pending = mem_realloc(fmt->pending,
+				sizeof(PendingAnchor) * new_capacity,
+				MEM_FORMATTER);
+
+			if (!new_pending)
+			{
+				emit(fmt, str);
+				return;
+			}
+			fmt->pending = new_pending;
+			fmt->pending_capacity = new_capacity;
+		}
+		fmt->pending[fmt->pending_count].text = str;
+		fmt->pending[fmt->pending_count].input = input;
+		fmt->pending_count++;
 	}
+
+	emit(fmt, str);
 }
 
-static void emit_char(Formatter *fmt, char c)
+/*
+ * capture_span - Append output to the capture buffer of a cached item
+ * @fmt: Formatter instance
+ * @str: Bytes to append
+ * @len: Number of bytes
+ */
+static void capture_span(Formatter *fmt, const char *str, size_t len)
 {
-	fputc(c, fmt->output);
+	if (fmt->capture_length + len > fmt->capture_capacity)
+	{
+		size_t new_capacity = fmt->capture_capacity == 0 ?
+			256 : fmt->capture_capacity;
+		char *new_capture;
+
+		while (new_capacity < fmt->capture_length + len)
+			new_capacity *= 2;
+		new_capture = mem_realloc(fmt->capture, new_capacity,
+					  MEM_FORMATTER);
+		if (!new_capture)
+		{
+			/* Give up caching this item, output is unaffected */
+			fmt->capturing = 0;
+			return;
+		}
+		fmt->capture = new_capture;
+		fmt->capture_capacity = new_capacity;
+	}
 
-	if (c == '\n')
+	memcpy(fmt->capture + fmt->capture_length, str, len);
+	fmt->capture_length += len;
+}
+
+/*
+ * emit_span - Send a span of output through the layout engine
+ * @fmt: Formatter instance
+ * @str: Bytes to emit (may contain newlines, must outlive the run)
+ * @len: Number of bytes
+ */
+static void emit_span(Formatter *fmt, const char *str, size_t len)
+{
+	if (len == 0)
+		return;
+
+	layout_lines(fmt->layout, str, len);
+	fmt->at_line_start = (str[len - 1] == '\n');
+}
+
+/*
+ * output_span - Send laid-out text to the sink
+ * @ctx: Formatter instance
+ * @str: Bytes to write
+ * @len: Number of bytes
+ *
+ * Line and column are updated once per span: newlines are found with
+ * memchr and only the text after the last one is measured.
+ */
+static void output_span(void *ctx, const char *str, size_t len)
+{
+	Formatter *fmt = ctx;
+	const char *end = str + len;
+	const char *line_start = str;
+	const char *nl;
+	const char *p;
+
+	if (fmt->matching)
+	{
+		if (len <= fmt->source_length - fmt->source_pos &&
+		    memcmp(fmt->source + fmt->source_pos, str, len) == 0)
+			fmt->source_pos += len;
+		else
+			end_match(fmt);
+	}
+	if (!fmt->matching && sink_write_ref(fmt->sink, str, len) < 0)
+		fmt->failed = 1;
+
+	if (fmt->pending_head < fmt->pending_count &&
+	    fmt->pending[fmt->pending_head].text == str)
+	{
+		source_map_add(fmt->source_map, fmt->output_offset,
+			       fmt->pending[fmt->pending_head].input);
+		edit_anchor(fmt, fmt->pending[fmt->pending_head].input);
+		if (++fmt->pending_head == fmt->pending_count)
+			fmt->pending_head = fmt->pending_count = 0;
+	}
+	fmt->output_offset += len;
+	edit_output(fmt, str, len);
+
+	if (fmt->capturing)
+		capture_span(fmt, str, len);
+
+	while ((nl = memchr(line_start, '\n', end - line_start)) != NULL)
 	{
-		fmt->column = 0;
 		fmt->line++;
-		fmt->at_line_start = 1;
+		line_start = nl + 1;
 	}
+	if (line_start != str)
+		fmt->column = 0;
+
+	if (!memchr(line_start, '\t', end - line_start))
+		fmt->column += end - line_start;
 	else
 	{
-		if (c == '\t')
-			fmt->column += fmt->indent_width -
-				(fmt->column % fmt->indent_width);
-		else
-			fmt->column++;
-		fmt->at_line_start = 0;
+		for (p = line_start; p < end; p++)
+		{
+			if (*p == '\t')
+				fmt->column += fmt->indent_width -
+					(fmt->column % fmt->indent_width);
+			else
+				fmt->column++;
+		}
+	}
+}
+
+/*
+ * item_start - Find where a top-level item's output starts in the source
+ * @fmt: Formatter instance
+ * @item: Top-level item
+ * @out: Where to store the source offset
+ *
+ * That is the beginning of the line holding the item's first leading
+ * comment or, without one, its first significant token.
+ *
+ * Return: 0 on success, -1 if the offset is unknown
+ */
+static int item_start(Formatter *fmt, ASTNode *item, size_t *out)
+{
+	Token *first = NULL;
+	int count, index, i;
+	size_t pos;
+
+	count = comment_table_find(fmt->comments, item, COMMENT_LEADING, &index);
+	if (count > 0)
+		first = comment_table_token(fmt->comments, index);
+	else if (fmt->tokens && item->token_start >= 0)
+	{
+		for (i = item->token_start;
+		     i < item->token_end && i < fmt->token_count; i++)
+		{
+			if (fmt->tokens[i]->type != TOK_WHITESPACE &&
+			    fmt->tokens[i]->type != TOK_NEWLINE)
+			{
+				first = fmt->tokens[i];
+				break;
+			}
+		}
+	}
+	if (!first || first->offset < 0 ||
+	    (fmt->source && (size_t)first->offset > fmt->source_length))
+		return (-1);
+
+	pos = first->offset;
+	while (fmt->source && pos > 0 && fmt->source[pos - 1] != '\n')
+		pos--;
+
+	*out = pos;
+	return (0);
+}
+
+/*
+ * begin_item - Note the start of a top-level item's output
+ * @fmt: Formatter instance
+ * @item: Top-level item about to be formatted
+ *
+ * Anchors the item in the source map and, if the output stopped matching
+ * the source in an earlier item, resumes comparing the two. Where
+ * comparison resumes only matters for how much is written as slices:
+ * only output that equals the source is ever replaced by it.
+ */
+static void begin_item(Formatter *fmt, ASTNode *item)
+{
+	size_t pos;
+
+	if (!fmt->source_map && !fmt->edits &&
+	    (!fmt->source || fmt->matching))
+		return;
+	if (item_start(fmt, item, &pos) < 0)
+		return;
+
+	/* Everything before this point has been sent to the layout */
+	layout_flush(fmt->layout);
+
+	if (fmt->source_map)
+		source_map_add(fmt->source_map, fmt->output_offset, pos);
+	edit_anchor(fmt, pos);
+
+	if (fmt->source && !fmt->matching)
+	{
+		fmt->source_pos = pos;
+		fmt->match_start = pos;
+		fmt->matching = 1;
 	}
 }
 
+/*
+ * end_match - Write the matched run of source and stop comparing
+ * @fmt: Formatter instance
+ */
+static void end_match(Formatter *fmt)
+{
+	size_t length = fmt->source_pos - fmt->match_start;
+
+	if (!fmt->matching)
+		return;
+
+	fmt->matching = 0;
+	if (length == 0)
+		return;
+
+	if (sink_write_ref(fmt->sink, fmt->source + fmt->match_start,
+			   length) < 0)
+		fmt->failed = 1;
+	fmt->slice_bytes += length;
+}
+
+/*
+ * edit_anchor - Align the output with a source offset
+ * @fmt: Formatter instance
+ * @input: Source offset of the output about to be written
+ *
+ * Closes the open edit there, or deletes source text that the output
+ * skipped. An anchor behind the source already accounted for (moved
+ * text) is ignored: the open edit keeps collecting output instead.
+ */
+static void edit_anchor(Formatter *fmt, size_t input)
+{
+	if (!fmt->edits || !fmt->source || input > fmt->source_length ||
+	    input < fmt->edit_pos)
+		return;
+
+	if (!fmt->edits->open && input > fmt->edit_pos)
+		edit_list_open(fmt->edits, fmt->edit_pos);
+	edit_list_close(fmt->edits, fmt->source, input);
+	fmt->edit_pos = input;
+}
+
+/*
+ * edit_output - Compare output with the source, or add it to the open edit
+ * @fmt: Formatter instance
+ * @str: Output text
+ * @len: Length of @str
+ */
+static void edit_output(Formatter *fmt, const char *str, size_t len)
+{
+	size_t n = 0;
+	size_t left;
+
+	if (!fmt->edits || !fmt->source)
+		return;
+
+	if (!fmt->edits->open)
+	{
+		left = fmt->source_length - fmt->edit_pos;
+		while (n < len && n < left &&
+		       str[n] == fmt->source[fmt->edit_pos + n])
+			n++;
+		fmt->edit_pos += n;
+		if (n == len)
+			return;
+		edit_list_open(fmt->edits, fmt->edit_pos);
+	}
+	edit_list_insert(fmt->edits, str + n, len - n);
+}
+
 static void emit_newline(Formatter *fmt)
 {
-	emit_char(fmt, '\n');
+	emit_span(fmt, "\n", 1);
 }
 
 static void emit_indent(Formatter *fmt)
 {
-	int i;
+	const char *fill = fmt->use_tabs ? indent_tabs : indent_spaces;
+	size_t width;
 
-	for (i = 0; i < fmt->indent_level; i++)
-	{
-		if (fmt->use_tabs)
-			emit_char(fmt, '\t');
-		else
-		{
-			int j;
+	if (fmt->indent_level <= 0)
+		return;
 
-			for (j = 0; j < fmt->indent_width; j++)
-				emit_char(fmt, ' ');
-		}
+	width = (size_t)fmt->indent_level;
+	if (!fmt->use_tabs)
+		width *= fmt->indent_width;
+
+	while (width > INDENT_CHUNK)
+	{
+		emit_span(fmt, fill, INDENT_CHUNK);
+		width -= INDENT_CHUNK;
 	}
+	emit_span(fmt, fill, width);
 }
 
 static void emit_space(Formatter *fmt)
 {
-	emit_char(fmt, ' ');
+	emit_span(fmt, " ", 1);
+}
+
+/*
+ * emit_break - Emit a space the layout may turn into a line break
+ * @fmt: Formatter instance
+ *
+ * Betty continuation lines start under the first character after the
+ * innermost enclosing group's opening (usually a parenthesis).
+ */
+static void emit_break(Formatter *fmt)
+{
+	layout_break(fmt->layout, 1);
+	fmt->at_line_start = 0;
+}
+
+static void emit_group_begin(Formatter *fmt)
+{
+	layout_begin(fmt->layout);
+}
+
+static void emit_group_end(Formatter *fmt)
+{
+	layout_end(fmt->layout);
 }
 
 /*
@@ -186,13 +970,15 @@ static void format_comment(Formatter *fmt, Token *comment, int inline_comment)
 	{
 		/* Convert C99 to C89 style */
 		emit(fmt, "/*");
-		emit(fmt, text + 2);  /* Skip the // */
+		/* Skip the // */
+		emit_at(fmt, text + 2,
+			comment->offset < 0 ? -1 : comment->offset + 2);
 		emit(fmt, " */");
 	}
 	else
 	{
 		/* Already C89 block comment */
-		emit(fmt, text);
+		emit_token(fmt, comment);
 	}
 
 	if (!inline_comment)
@@ -206,14 +992,14 @@ static void format_comment(Formatter *fmt, Token *comment, int inline_comment)
  */
 static void emit_leading_comments(Formatter *fmt, ASTNode *node)
 {
-	int i;
+	int i, first, count;
 
-	if (!node || node->type == NODE_UNPARSED ||
-	    node->leading_comment_count == 0)
+	if (!node || node->type == NODE_UNPARSED)
 		return;
 
-	for (i = 0; i < node->leading_comment_count; i++)
-		format_comment(fmt, node->leading_comments[i], 0);
+	count = comment_table_find(fmt->comments, node, COMMENT_LEADING, &first);
+	for (i = 0; i < count; i++)
+		format_comment(fmt, comment_table_token(fmt->comments, first + i), 0);
 }
 
 /*
@@ -225,14 +1011,14 @@ static void emit_leading_comments(Formatter *fmt, ASTNode *node)
  */
 static void emit_trailing_comments(Formatter *fmt, ASTNode *node)
 {
-	int i;
+	int i, first, count;
 
-	if (!node || node->type == NODE_UNPARSED ||
-	    node->trailing_comment_count == 0)
+	if (!node || node->type == NODE_UNPARSED)
 		return;
 
-	for (i = 0; i < node->trailing_comment_count; i++)
-		format_comment(fmt, node->trailing_comments[i], 1);
+	count = comment_table_find(fmt->comments, node, COMMENT_TRAILING, &first);
+	for (i = 0; i < count; i++)
+		format_comment(fmt, comment_table_token(fmt->comments, first + i), 1);
 }
 
 /*
@@ -247,7 +1033,7 @@ static void format_node(Formatter *fmt, ASTNode *node)
 	switch (node->type)
 	{
 	case NODE_PROGRAM:
-		format_program(fmt, node);
+		push_task(fmt, TASK_ITEMS, node, NULL, 0, 0);
 		break;
 	case NODE_FUNCTION:
 		format_function(fmt, node);
@@ -293,11 +1079,9 @@ static void format_node(Formatter *fmt, ASTNode *node)
 		break;
 	case NODE_EXPR_STMT:
 		emit_indent(fmt);
+		push_task(fmt, TASK_STMT_END, node, NULL, 0, 0);
 		if (node->child_count > 0)
-			format_expression(fmt, node->children[0]);
-		emit(fmt, ";");
-		emit_trailing_comments(fmt, node);
-		emit_newline(fmt);
+			push_expr(fmt, node->children[0]);
 		break;
 	case NODE_STRUCT:
 		format_struct(fmt, node);
@@ -312,7 +1096,7 @@ static void format_node(Formatter *fmt, ASTNode *node)
 		/* Output preprocessor directive verbatim */
 		if (node->token && node->token->lexeme)
 		{
-			emit(fmt, node->token->lexeme);
+			emit_token(fmt, node->token);
 			emit_newline(fmt);
 		}
 		break;
@@ -341,110 +1125,283 @@ static void format_node(Formatter *fmt, ASTNode *node)
  * Program formatting
  */
 
-static void format_program(Formatter *fmt, ASTNode *node)
+/*
+ * format_program_item - Format the top-level item at @index
+ * @fmt: Formatter instance
+ * @node: NODE_PROGRAM
+ * @index: Index of the item to format
+ *
+ * Separators only depend on the previous item, so each item schedules
+ * the next one after itself.
+ */
+static void format_program_item(Formatter *fmt, ASTNode *node, int index)
 {
-	int i;
-	NodeType prev_type = NODE_PROGRAM;  /* Initial sentinel */
-	ASTNode *prev_child = NULL;
+	ASTNode *child, *prev_child;
+	NodeType prev_type;
+	int need_blank = 0;
+	int prev_is_conditional_start = 0;
+	int curr_is_conditional_end = 0;
 
-	for (i = 0; i < node->child_count; i++)
-	{
-		ASTNode *child = node->children[i];
-		int need_blank = 0;
-		int prev_is_conditional_start = 0;
-		int curr_is_conditional_end = 0;
-
-		/* Check if previous was a conditional compilation start */
-		if (prev_child && prev_type == NODE_PREPROCESSOR &&
-		    prev_child->token && prev_child->token->lexeme)
-		{
-			const char *lex = prev_child->token->lexeme;
-			if (strncmp(lex, "#ifdef", 6) == 0 ||
-			    strncmp(lex, "#ifndef", 7) == 0 ||
-			    strncmp(lex, "#if ", 4) == 0 ||
-			    strncmp(lex, "#if\t", 4) == 0 ||
-			    strncmp(lex, "#else", 5) == 0 ||
-			    strncmp(lex, "#elif", 5) == 0)
-				prev_is_conditional_start = 1;
-		}
+	if (index >= node->child_count)
+		return;
 
-		/* Check if current is a conditional compilation end/else */
-		if (child->type == NODE_PREPROCESSOR &&
-		    child->token && child->token->lexeme)
-		{
-			const char *lex = child->token->lexeme;
-			if (strncmp(lex, "#endif", 6) == 0 ||
-			    strncmp(lex, "#else", 5) == 0 ||
-			    strncmp(lex, "#elif", 5) == 0)
-				curr_is_conditional_end = 1;
-		}
+	child = node->children[index];
+	prev_child = index > 0 ? node->children[index - 1] : NULL;
+	prev_type = prev_child ? prev_child->type : NODE_PROGRAM;
 
-		/* Add blank lines for readability */
-		if (i > 0)
-		{
-			/* No blank line between consecutive preprocessor directives */
-			if (prev_type == NODE_PREPROCESSOR &&
-			    child->type == NODE_PREPROCESSOR)
-				need_blank = 0;
-			/* No blank line after #ifdef/#if/#else before code */
-			else if (prev_is_conditional_start)
-				need_blank = 0;
-			/* No blank line before #endif/#else/#elif after code */
-			else if (curr_is_conditional_end)
-				need_blank = 0;
-			/* Blank line after preprocessor block before code */
-			else if (prev_type == NODE_PREPROCESSOR &&
-				 child->type != NODE_PREPROCESSOR)
-				need_blank = 1;
-			/* Blank line before preprocessor if after code */
-			else if (child->type == NODE_PREPROCESSOR &&
-				 prev_type != NODE_PREPROCESSOR &&
-				 prev_type != NODE_PROGRAM)
-				need_blank = 1;
-			/* Blank line after functions */
-			else if (prev_type == NODE_FUNCTION)
-				need_blank = 1;
-			/* Blank line after struct/enum/typedef definitions */
-			else if (prev_type == NODE_STRUCT || prev_type == NODE_ENUM ||
-				 prev_type == NODE_TYPEDEF)
-				need_blank = 1;
-			/* Blank line after global variable declarations */
-			else if (prev_type == NODE_VAR_DECL || prev_type == NODE_FUNC_PTR)
-				need_blank = 1;
-			/* Blank line before a function if anything is above it */
-			else if (child->type == NODE_FUNCTION)
-				need_blank = 1;
-			/* Blank line before typedef/struct/enum if anything is above */
-			else if (child->type == NODE_TYPEDEF ||
-				 child->type == NODE_STRUCT ||
-				 child->type == NODE_ENUM)
-				need_blank = 1;
-			/* Preserve user-added blank line */
-			else if (child->blank_lines_before > 0)
-				need_blank = 1;
-		}
+	/* Check if previous was a conditional compilation start */
+	if (prev_child && prev_type == NODE_PREPROCESSOR &&
+	    prev_child->token && prev_child->token->lexeme)
+	{
+		const char *lex = prev_child->token->lexeme;
+		if (strncmp(lex, "#ifdef", 6) == 0 ||
+		    strncmp(lex, "#ifndef", 7) == 0 ||
+		    strncmp(lex, "#if ", 4) == 0 ||
+		    strncmp(lex, "#if\t", 4) == 0 ||
+		    strncmp(lex, "#else", 5) == 0 ||
+		    strncmp(lex, "#elif", 5) == 0)
+			prev_is_conditional_start = 1;
+	}
+
+	/* Check if current is a conditional compilation end/else */
+	if (child->type == NODE_PREPROCESSOR &&
+	    child->token && child->token->lexeme)
+	{
+		const char *lex = child->token->lexeme;
+		if (strncmp(lex, "#endif", 6) == 0 ||
+		    strncmp(lex, "#else", 5) == 0 ||
+		    strncmp(lex, "#elif", 5) == 0)
+			curr_is_conditional_end = 1;
+	}
 
-		if (child->type == NODE_UNPARSED)
+	/* Add blank lines for readability */
+	if (index > 0)
+	{
+		/* No blank line between consecutive preprocessor directives */
+		if (prev_type == NODE_PREPROCESSOR &&
+		    child->type == NODE_PREPROCESSOR)
+			need_blank = 0;
+		/* No blank line after #ifdef/#if/#else before code */
+		else if (prev_is_conditional_start)
+			need_blank = 0;
+		/* No blank line before #endif/#else/#elif after code */
+		else if (curr_is_conditional_end)
 			need_blank = 0;
+		/* Blank line after preprocessor block before code */
+		else if (prev_type == NODE_PREPROCESSOR &&
+			 child->type != NODE_PREPROCESSOR)
+			need_blank = 1;
+		/* Blank line before preprocessor if after code */
+		else if (child->type == NODE_PREPROCESSOR &&
+			 prev_type != NODE_PREPROCESSOR &&
+			 prev_type != NODE_PROGRAM)
+			need_blank = 1;
+		/* Blank line after functions */
+		else if (prev_type == NODE_FUNCTION)
+			need_blank = 1;
+		/* Blank line after struct/enum/typedef definitions */
+		else if (prev_type == NODE_STRUCT || prev_type == NODE_ENUM ||
+			 prev_type == NODE_TYPEDEF)
+			need_blank = 1;
+		/* Blank line after global variable declarations */
+		else if (prev_type == NODE_VAR_DECL || prev_type == NODE_FUNC_PTR)
+			need_blank = 1;
+		/* Blank line before a function if anything is above it */
+		else if (child->type == NODE_FUNCTION)
+			need_blank = 1;
+		/* Blank line before typedef/struct/enum if anything is above */
+		else if (child->type == NODE_TYPEDEF ||
+			 child->type == NODE_STRUCT ||
+			 child->type == NODE_ENUM)
+			need_blank = 1;
+		/* Preserve user-added blank line */
+		else if (child->blank_lines_before > 0)
+			need_blank = 1;
+	}
 
-		if (need_blank)
-			emit_newline(fmt);
+	if (child->type == NODE_UNPARSED)
+		need_blank = 0;
 
-		/* Output leading comments */
-		emit_leading_comments(fmt, child);
+	if (need_blank)
+		emit_newline(fmt);
 
-		format_node(fmt, child);
+	begin_item(fmt, child);
+	push_task(fmt, TASK_ITEMS, node, NULL, index + 1, 0);
 
-		/* Add semicolon and newline for standalone struct/enum declarations */
-		if (child->type == NODE_STRUCT || child->type == NODE_ENUM)
+	/* Reuse the item's output from a previous run, or record it */
+	if (fmt->cache && item_hash(fmt, child, &fmt->item_hash) == 0)
+	{
+		const CacheEntry *entry = cache_lookup(fmt->cache, fmt->item_hash);
+
+		if (entry && replay_is_exact(fmt, child, entry))
 		{
-			emit(fmt, ";");
-			emit_newline(fmt);
+			emit_span(fmt, entry->text, entry->length);
+			cache_store(fmt->cache, entry->hash, entry->text,
+				    entry->length);
+			return;
 		}
 
-		prev_type = child->type;
-		prev_child = child;
+		fmt->capturing = 1;
+		fmt->capture_length = 0;
+		push_task(fmt, TASK_ITEM_END, NULL, NULL, 0, 0);
+	}
+
+	/* Output leading comments */
+	emit_leading_comments(fmt, child);
+
+	/* Add semicolon and newline for standalone struct/enum declarations */
+	if (child->type == NODE_STRUCT || child->type == NODE_ENUM)
+	{
+		push_task(fmt, TASK_NEWLINE, NULL, NULL, 0, 0);
+		push_text(fmt, ";");
+	}
+
+	push_node(fmt, child);
+}
+
+/*
+ * ShapeHash - Walker state for hashing the shape of a subtree
+ * @hash: Running hash
+ * @has_raw: Set if the subtree contains raw (unparsed) text
+ */
+typedef struct ShapeHash {
+	uint64_t hash;
+	int has_raw;
+} ShapeHash;
+
+static ASTWalkAction hash_shape(ASTNode *node, int depth, void *ctx)
+{
+	ShapeHash *shape = ctx;
+
+	(void)depth;
+	shape->hash = cache_hash_int(shape->hash, node->type);
+	shape->hash = cache_hash_int(shape->hash, node->child_count);
+	if (node->type == NODE_UNPARSED)
+		shape->has_raw = 1;
+
+	return (AST_WALK_CONTINUE);
+}
+
+/*
+ * item_hash - Compute the structural hash of a top-level item
+ * @fmt: Formatter instance
+ * @node: Top-level item
+ * @out: Where to store the hash
+ *
+ * The hash covers everything the item's output depends on: the output
+ * version and settings, the shape of the subtree (so the same tokens parsed
+ * differently, e.g. because of an earlier typedef, do not collide), the
+ * significant tokens and comments of the item's source span, the line
+ * breaks between them and the comments attached to the item itself.
+ * Horizontal whitespace is only hashed when the item contains raw text,
+ * which is emitted verbatim.
+ *
+ * Return: 0 on success, -1 if the item cannot be cached
+ */
+static int item_hash(Formatter *fmt, ASTNode *node, uint64_t *out)
+{
+	uint64_t hash = CACHE_HASH_INIT;
+	ShapeHash shape;
+	ASTVisitor visitor = {hash_shape, NULL, NULL};
+	int count, first;
+	int i;
+
+	visitor.ctx = &shape;
+
+	if (!fmt->tokens || node->token_start < 0 ||
+	    node->token_end > fmt->token_count ||
+	    node->token_start > node->token_end)
+		return (-1);
+
+	hash = cache_hash_int(hash, FORMATTER_OUTPUT_VERSION);
+	hash = cache_hash_int(hash, fmt->indent_width);
+	hash = cache_hash_int(hash, fmt->use_tabs);
+	hash = cache_hash_int(hash, fmt->max_line_length);
+	hash = cache_hash_int(hash, fmt->indent_level);
+	hash = cache_hash_int(hash, fmt->at_line_start);
+
+	/* Subtree shape, pre-order */
+	shape.hash = hash;
+	shape.has_raw = 0;
+	if (ast_walk(node, &visitor, 1) < 0)
+		return (-1);
+	hash = shape.hash;
+
+	/* Source span */
+	for (i = node->token_start; i < node->token_end; i++)
+	{
+		Token *tok = fmt->tokens[i];
+
+		if (tok->type == TOK_WHITESPACE && !shape.has_raw)
+			continue;
+		hash = cache_hash_int(hash, tok->type);
+		if (tok->type != TOK_NEWLINE)
+			hash = cache_hash_string(hash, tok->lexeme);
 	}
+
+	/* Attached comments (may lie outside the span) */
+	count = comment_table_find(fmt->comments, node, COMMENT_LEADING, &first);
+	for (i = 0; i < count; i++)
+		hash = cache_hash_string(hash,
+			comment_table_token(fmt->comments, first + i)->lexeme);
+	hash = cache_hash_int(hash, -1);
+	count = comment_table_find(fmt->comments, node, COMMENT_TRAILING, &first);
+	for (i = 0; i < count; i++)
+		hash = cache_hash_string(hash,
+			comment_table_token(fmt->comments, first + i)->lexeme);
+
+	*out = hash;
+	return (0);
+}
+
+/*
+ * end_item_capture - Store the captured output of a top-level item
+ * @fmt: Formatter instance
+ */
+static void end_item_capture(Formatter *fmt)
+{
+	if (fmt->capturing)
+		cache_store(fmt->cache, fmt->item_hash, fmt->capture,
+			    fmt->capture_length);
+	fmt->capturing = 0;
+}
+
+/*
+ * replay_is_exact - Check whether cached output can be replayed
+ * @fmt: Formatter instance
+ * @item: Top-level item about to be formatted
+ * @entry: Cache entry of @item
+ *
+ * A replay is one span: it would become a single edit covering the
+ * whole item and would only get the item's start anchor in the source
+ * map. With edits or a source map, only output that already equals the
+ * source is replayed, for which that one edit is empty and the start
+ * anchor maps every byte. Other items are formatted again.
+ *
+ * Return: 1 if the entry may be replayed, 0 otherwise
+ */
+static int replay_is_exact(Formatter *fmt, ASTNode *item,
+			   const CacheEntry *entry)
+{
+	size_t pos;
+
+	if ((!fmt->edits && !fmt->source_map) || !fmt->source)
+		return (1);
+
+	if (fmt->edits)
+		pos = fmt->edit_pos;
+	else if (item_start(fmt, item, &pos) < 0)
+		pos = fmt->source_length + 1;
+
+	if (pos <= fmt->source_length &&
+	    entry->length <= fmt->source_length - pos &&
+	    memcmp(fmt->source + pos, entry->text, entry->length) == 0)
+		return (1);
+
+	/* Count it as formatted, which it now is */
+	fmt->cache->hits--;
+	fmt->cache->misses++;
+	return (0);
 }
 
 /*
@@ -507,7 +1464,7 @@ static void format_function(Formatter *fmt, ASTNode *node)
 			{
 				if (i > 0)
 					emit(fmt, " ");
-				emit(fmt, tok->lexeme);
+				emit_token(fmt, tok);
 				last_was_star = 0;
 			}
 		}
@@ -517,8 +1474,9 @@ static void format_function(Formatter *fmt, ASTNode *node)
 	}
 
 	/* Function name (same line as return type) */
-	emit(fmt, name_token->lexeme);
+	emit_token(fmt, name_token);
 	emit(fmt, "(");
+	emit_group_begin(fmt);
 
 	/* Output parameters */
 	if (func_data && func_data->param_count > 0)
@@ -532,7 +1490,10 @@ static void format_function(Formatter *fmt, ASTNode *node)
 			int last_was_star = 0;
 
 			if (i > 0)
-				emit(fmt, ", ");
+			{
+				emit(fmt, ",");
+				emit_break(fmt);
+			}
 
 			/* Handle variadic parameter (...) */
 			if (param->token && param->token->type == TOK_ELLIPSIS)
@@ -565,7 +1526,7 @@ static void format_function(Formatter *fmt, ASTNode *node)
 						/* Add space before keyword only if not after * */
 						if (j > 0 && !last_was_star)
 							emit(fmt, " ");
-						emit(fmt, tok->lexeme);
+						emit_token(fmt, tok);
 						last_was_star = 0;
 					}
 				}
@@ -578,7 +1539,7 @@ static void format_function(Formatter *fmt, ASTNode *node)
 				if (pdata && pdata->return_type_count > 0 &&
 				    bracket_start != 0 && !last_was_star)
 					emit(fmt, " ");
-				emit(fmt, param->token->lexeme);
+				emit_token(fmt, param->token);
 			}
 
 			/* Output array brackets after name */
@@ -601,6 +1562,7 @@ static void format_function(Formatter *fmt, ASTNode *node)
 		emit(fmt, "void");
 	}
 
+	emit_group_end(fmt);
 	emit(fmt, ")");
 
 	/* Function body or prototype */
@@ -611,52 +1573,13 @@ static void format_function(Formatter *fmt, ASTNode *node)
 		emit_newline(fmt);
 		fmt->indent_level++;
 
-		if (node->children[0]->type == NODE_BLOCK)
-		{
-			ASTNode *block = node->children[0];
-			int j;
-			int had_var_decl = 0;
-			int added_blank = 0;
-
-			for (j = 0; j < block->child_count; j++)
-			{
-				ASTNode *stmt = block->children[j];
-				int is_var_decl = (stmt->type == NODE_VAR_DECL ||
-						   stmt->type == NODE_FUNC_PTR);
-				int need_blank = 0;
-
-				/* Add blank line when transitioning from decls to stmts */
-				if (had_var_decl && !is_var_decl && !added_blank)
-				{
-					need_blank = 1;
-					added_blank = 1;
-				}
-				/* Preserve user-added blank lines (after first decl->stmt transition) */
-				else if (added_blank && stmt->blank_lines_before > 0)
-				{
-					need_blank = 1;
-				}
+		/* The closing brace of a function is never indented */
+		push_task(fmt, TASK_CLOSE, node, NULL, 0, CLOSE_NEWLINE);
 
-				if (need_blank)
-					emit_newline(fmt);
-
-				/* Output leading comments for this statement */
-				emit_leading_comments(fmt, stmt);
-
-				if (is_var_decl)
-					had_var_decl = 1;
-
-				format_node(fmt, stmt);
-			}
-		}
+		if (node->children[0]->type == NODE_BLOCK)
+			push_task(fmt, TASK_STMTS, node->children[0], NULL, 0, 0);
 		else
-		{
-			format_node(fmt, node->children[0]);
-		}
-
-		fmt->indent_level--;
-		emit(fmt, "}");
-		emit_newline(fmt);
+			push_node(fmt, node->children[0]);
 	}
 	else
 	{
@@ -672,10 +1595,6 @@ static void format_function(Formatter *fmt, ASTNode *node)
 
 static void format_block(Formatter *fmt, ASTNode *node)
 {
-	int i;
-	int had_var_decl = 0;
-	int added_blank = 0;
-
 	emit_newline(fmt);
 	emit_indent(fmt);
 	emit(fmt, "{");
@@ -683,42 +1602,55 @@ static void format_block(Formatter *fmt, ASTNode *node)
 
 	fmt->indent_level++;
 
-	for (i = 0; i < node->child_count; i++)
-	{
-		ASTNode *stmt = node->children[i];
-		int is_var_decl = (stmt->type == NODE_VAR_DECL ||
-				   stmt->type == NODE_FUNC_PTR);
-		int need_blank = 0;
-
-		/* Add blank line when transitioning from decls to stmts */
-		if (had_var_decl && !is_var_decl && !added_blank)
-		{
-			need_blank = 1;
-			added_blank = 1;
-		}
-		/* Preserve user-added blank lines */
-		else if (added_blank && stmt->blank_lines_before > 0)
-		{
-			need_blank = 1;
-		}
+	push_task(fmt, TASK_CLOSE, node, NULL, 0, CLOSE_INDENT | CLOSE_NEWLINE);
+	push_task(fmt, TASK_STMTS, node, NULL, 0, 0);
+}
 
-		if (need_blank)
-			emit_newline(fmt);
+/*
+ * format_block_stmt - Format the statement at @index of a block
+ * @fmt: Formatter instance
+ * @node: NODE_BLOCK
+ * @index: Index of the statement to format
+ * @flags: STMTS_* state carried over from the previous statements
+ */
+static void format_block_stmt(Formatter *fmt, ASTNode *node, int index,
+			      int flags)
+{
+	ASTNode *stmt;
+	int is_var_decl;
+	int need_blank = 0;
 
-		/* Output leading comments for this statement */
-		emit_leading_comments(fmt, stmt);
+	if (index >= node->child_count)
+		return;
 
-		if (is_var_decl)
-			had_var_decl = 1;
+	stmt = node->children[index];
+	is_var_decl = (stmt->type == NODE_VAR_DECL ||
+		       stmt->type == NODE_FUNC_PTR);
 
-		format_node(fmt, stmt);
+	/* Add blank line when transitioning from decls to stmts */
+	if ((flags & STMTS_HAD_VAR_DECL) && !is_var_decl &&
+	    !(flags & STMTS_ADDED_BLANK))
+	{
+		need_blank = 1;
+		flags |= STMTS_ADDED_BLANK;
+	}
+	/* Preserve user-added blank lines */
+	else if ((flags & STMTS_ADDED_BLANK) && stmt->blank_lines_before > 0)
+	{
+		need_blank = 1;
 	}
 
-	fmt->indent_level--;
+	if (need_blank)
+		emit_newline(fmt);
+
+	/* Output leading comments for this statement */
+	emit_leading_comments(fmt, stmt);
 
-	emit_indent(fmt);
-	emit(fmt, "}");
-	emit_newline(fmt);
+	if (is_var_decl)
+		flags |= STMTS_HAD_VAR_DECL;
+
+	push_task(fmt, TASK_STMTS, node, NULL, index + 1, flags);
+	push_node(fmt, stmt);
 }
 
 /*
@@ -726,7 +1658,7 @@ static void format_block(Formatter *fmt, ASTNode *node)
  */
 
 /*
- * Helper to output a single variable declaration
+ * Helper to output a single variable declaration (up to its initializer)
  */
 static void format_single_var(Formatter *fmt, VarDeclData *var_data)
 {
@@ -752,7 +1684,7 @@ static void format_single_var(Formatter *fmt, VarDeclData *var_data)
 		{
 			if (i > 0 && !last_was_star)
 				emit(fmt, " ");
-			emit(fmt, tok->lexeme);
+			emit_token(fmt, tok);
 			last_was_star = 0;
 		}
 	}
@@ -762,7 +1694,10 @@ static void format_single_var(Formatter *fmt, VarDeclData *var_data)
 	{
 		if (!last_was_star)
 			emit(fmt, " ");
-		emit(fmt, var_data->name_token->lexeme);
+		/* Further declarators continue under the first */
+		if (var_data->extra_count > 0)
+			emit_group_begin(fmt);
+		emit_token(fmt, var_data->name_token);
 	}
 
 	/* Output array brackets */
@@ -777,25 +1712,17 @@ static void format_single_var(Formatter *fmt, VarDeclData *var_data)
 			else if (tok->type == TOK_RBRACKET)
 				emit(fmt, "]");
 			else
-				emit(fmt, tok->lexeme);
+				emit_token(fmt, tok);
 		}
 	}
-
-	/* Output initialization if present */
-	if (var_data->init_expr)
-	{
-		emit(fmt, " = ");
-		format_expression(fmt, var_data->init_expr);
-	}
 }
 
 /*
- * Helper to output just name, array, and init (no type) for comma-separated vars
+ * Helper to output just name and array (no type) for comma-separated vars
  */
 static void format_extra_var(Formatter *fmt, VarDeclData *var_data)
 {
 	int i;
-	int has_ptr = 0;
 
 	if (!var_data)
 		return;
@@ -804,15 +1731,12 @@ static void format_extra_var(Formatter *fmt, VarDeclData *var_data)
 	for (i = 0; i < var_data->type_count; i++)
 	{
 		if (var_data->type_tokens[i]->type == TOK_STAR)
-		{
 			emit(fmt, "*");
-			has_ptr = 1;
-		}
 	}
 
 	/* Output variable name */
 	if (var_data->name_token)
-		emit(fmt, var_data->name_token->lexeme);
+		emit_token(fmt, var_data->name_token);
 
 	/* Output array brackets */
 	if (var_data->array_count > 0)
@@ -826,24 +1750,14 @@ static void format_extra_var(Formatter *fmt, VarDeclData *var_data)
 			else if (tok->type == TOK_RBRACKET)
 				emit(fmt, "]");
 			else
-				emit(fmt, tok->lexeme);
+				emit_token(fmt, tok);
 		}
 	}
-
-	/* Output initialization if present */
-	if (var_data->init_expr)
-	{
-		emit(fmt, " = ");
-		format_expression(fmt, var_data->init_expr);
-	}
-
-	(void)has_ptr;
 }
 
 static void format_var_decl(Formatter *fmt, ASTNode *node)
 {
 	VarDeclData *var_data = (VarDeclData *)node->data;
-	int i;
 
 	emit_indent(fmt);
 
@@ -851,14 +1765,14 @@ static void format_var_decl(Formatter *fmt, ASTNode *node)
 	{
 		format_single_var(fmt, var_data);
 
-		/* Output extra variables on same line with commas */
-		if (var_data->extra_count > 0)
+		/* Extra variables follow on the same line with commas */
+		push_task(fmt, TASK_VAR_REST, node, NULL, 0, 0);
+
+		/* Output initialization if present */
+		if (var_data->init_expr)
 		{
-			for (i = 0; i < var_data->extra_count; i++)
-			{
-				emit(fmt, ", ");
-				format_extra_var(fmt, var_data->extra_vars[i]);
-			}
+			emit(fmt, " = ");
+			push_expr(fmt, var_data->init_expr);
 		}
 	}
 	else
@@ -867,20 +1781,54 @@ static void format_var_decl(Formatter *fmt, ASTNode *node)
 		Token *type_token = node->token;
 
 		if (type_token && type_token->lexeme)
-			emit(fmt, type_token->lexeme);
+			emit_token(fmt, type_token);
 		emit_space(fmt);
 		emit(fmt, "var");
 
+		push_task(fmt, TASK_STMT_END, node, NULL, 0, 0);
+
 		if (node->child_count > 0)
 		{
 			emit(fmt, " = ");
-			format_expression(fmt, node->children[0]);
+			push_expr(fmt, node->children[0]);
 		}
 	}
+}
+
+/*
+ * format_var_rest - Output extra variable @index, or finish the declaration
+ * @fmt: Formatter instance
+ * @node: NODE_VAR_DECL
+ * @index: Index into the declaration's extra_vars
+ */
+static void format_var_rest(Formatter *fmt, ASTNode *node, int index)
+{
+	VarDeclData *var_data = (VarDeclData *)node->data;
+	VarDeclData *extra;
+
+	if (index >= var_data->extra_count)
+	{
+		if (var_data->extra_count > 0 && var_data->name_token)
+			emit_group_end(fmt);
+		emit(fmt, ";");
+		emit_trailing_comments(fmt, node);
+		emit_newline(fmt);
+		return;
+	}
 
-	emit(fmt, ";");
-	emit_trailing_comments(fmt, node);
-	emit_newline(fmt);
+	extra = var_data->extra_vars[index];
+
+	emit(fmt, ",");
+	emit_break(fmt);
+	format_extra_var(fmt, extra);
+
+	push_task(fmt, TASK_VAR_REST, node, NULL, index + 1, 0);
+
+	if (extra && extra->init_expr)
+	{
+		emit(fmt, " = ");
+		push_expr(fmt, extra->init_expr);
+	}
 }
 
 /*
@@ -908,7 +1856,7 @@ static void emit_func_ptr_content(Formatter *fmt, FuncPtrData *fp_data)
 		{
 			if (need_space)
 				emit_space(fmt);
-			emit(fmt, tok->lexeme);
+			emit_token(fmt, tok);
 			need_space = 1;
 			ends_with_ptr = 0;
 		}
@@ -918,7 +1866,7 @@ static void emit_func_ptr_content(Formatter *fmt, FuncPtrData *fp_data)
 	if (!ends_with_ptr)
 		emit_space(fmt);
 	emit(fmt, "(*");
-	emit(fmt, fp_data->name_token->lexeme);
+	emit_token(fmt, fp_data->name_token);
 	emit(fmt, ")(");
 
 	/* Output parameter tokens */
@@ -943,7 +1891,7 @@ static void emit_func_ptr_content(Formatter *fmt, FuncPtrData *fp_data)
 		{
 			if (need_space)
 				emit_space(fmt);
-			emit(fmt, tok->lexeme);
+			emit_token(fmt, tok);
 			need_space = 1;
 		}
 	}
@@ -960,8 +1908,33 @@ static void format_func_ptr(Formatter *fmt, ASTNode *node)
 	if (fp_data)
 		emit_func_ptr_content(fmt, fp_data);
 
-	emit(fmt, ";");
+	emit(fmt, ";");
+	emit_newline(fmt);
+}
+
+/*
+ * Control statement bodies
+ */
+
+/*
+ * format_body - Format the body of a control statement
+ * @fmt: Formatter instance
+ * @node: Body statement
+ *
+ * Blocks open on the next line; single statements are indented one level.
+ */
+static void format_body(Formatter *fmt, ASTNode *node)
+{
+	if (node->type == NODE_BLOCK)
+	{
+		format_block(fmt, node);
+		return;
+	}
+
 	emit_newline(fmt);
+	fmt->indent_level++;
+	push_task(fmt, TASK_INDENT_OUT, NULL, NULL, 0, 0);
+	push_node(fmt, node);
 }
 
 /*
@@ -972,129 +1945,55 @@ static void format_if(Formatter *fmt, ASTNode *node)
 {
 	emit_indent(fmt);
 	emit(fmt, "if (");
+	emit_group_begin(fmt);
 
-	if (node->child_count > 0)
-		format_expression(fmt, node->children[0]);
-
-	emit(fmt, ")");
-
+	push_task(fmt, TASK_ELSE, node, NULL, 0, 0);
 	if (node->child_count > 1)
-	{
-		ASTNode *then_branch = node->children[1];
-
-		if (then_branch->type == NODE_BLOCK)
-		{
-			format_block(fmt, then_branch);
-		}
-		else
-		{
-			emit_newline(fmt);
-			fmt->indent_level++;
-			format_node(fmt, then_branch);
-			fmt->indent_level--;
-		}
-	}
-
-	if (node->child_count > 2)
-	{
-		ASTNode *else_branch = node->children[2];
-
-		emit_indent(fmt);
-		emit(fmt, "else");
+		push_task(fmt, TASK_BODY, node->children[1], NULL, 0, 0);
+	push_text(fmt, ")");
+	push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
+	if (node->child_count > 0)
+		push_expr(fmt, node->children[0]);
+}
 
-		if (else_branch->type == NODE_IF)
-		{
-			/* Handle else if by removing indent and formatting as "else if" */
-			emit_space(fmt);
-			emit(fmt, "if (");
-			if (else_branch->child_count > 0)
-				format_expression(fmt, else_branch->children[0]);
-			emit(fmt, ")");
+/*
+ * format_else - Format the else branch of an if statement
+ * @fmt: Formatter instance
+ * @node: NODE_IF whose else branch to format
+ *
+ * An else branch that is itself an if is printed as "else if" and its own
+ * else branch is scheduled in turn, so chains of any length are handled
+ * iteratively at a single indentation level.
+ */
+static void format_else(Formatter *fmt, ASTNode *node)
+{
+	ASTNode *else_branch;
 
-			if (else_branch->child_count > 1)
-			{
-				if (else_branch->children[1]->type == NODE_BLOCK)
-					format_block(fmt, else_branch->children[1]);
-				else
-				{
-					emit_newline(fmt);
-					fmt->indent_level++;
-					format_node(fmt, else_branch->children[1]);
-					fmt->indent_level--;
-				}
-			}
+	if (node->child_count <= 2)
+		return;
 
-			/* Recursively handle nested else/else-if */
-			if (else_branch->child_count > 2)
-			{
-				ASTNode *nested_else = else_branch->children[2];
+	else_branch = node->children[2];
 
-				emit_indent(fmt);
-				emit(fmt, "else");
+	emit_indent(fmt);
+	emit(fmt, "else");
 
-				if (nested_else->type == NODE_IF)
-				{
-					/* Recursive call for else-if chains */
-					emit_space(fmt);
-					/* Re-use format_if but skip the "if" part */
-					emit(fmt, "if (");
-					if (nested_else->child_count > 0)
-						format_expression(fmt, nested_else->children[0]);
-					emit(fmt, ")");
-					if (nested_else->child_count > 1)
-					{
-						if (nested_else->children[1]->type == NODE_BLOCK)
-							format_block(fmt, nested_else->children[1]);
-						else
-						{
-							emit_newline(fmt);
-							fmt->indent_level++;
-							format_node(fmt, nested_else->children[1]);
-							fmt->indent_level--;
-						}
-					}
-					/* Handle deeper nesting if needed */
-					if (nested_else->child_count > 2)
-					{
-						/* Just format the else branch directly */
-						emit_indent(fmt);
-						emit(fmt, "else");
-						if (nested_else->children[2]->type == NODE_BLOCK)
-							format_block(fmt, nested_else->children[2]);
-						else
-						{
-							emit_newline(fmt);
-							fmt->indent_level++;
-							format_node(fmt, nested_else->children[2]);
-							fmt->indent_level--;
-						}
-					}
-				}
-				else if (nested_else->type == NODE_BLOCK)
-				{
-					format_block(fmt, nested_else);
-				}
-				else
-				{
-					emit_newline(fmt);
-					fmt->indent_level++;
-					format_node(fmt, nested_else);
-					fmt->indent_level--;
-				}
-			}
-		}
-		else if (else_branch->type == NODE_BLOCK)
-		{
-			format_block(fmt, else_branch);
-		}
-		else
-		{
-			emit_newline(fmt);
-			fmt->indent_level++;
-			format_node(fmt, else_branch);
-			fmt->indent_level--;
-		}
+	if (else_branch->type != NODE_IF)
+	{
+		push_task(fmt, TASK_BODY, else_branch, NULL, 0, 0);
+		return;
 	}
+
+	emit_space(fmt);
+	emit(fmt, "if (");
+	emit_group_begin(fmt);
+
+	push_task(fmt, TASK_ELSE, else_branch, NULL, 0, 0);
+	if (else_branch->child_count > 1)
+		push_task(fmt, TASK_BODY, else_branch->children[1], NULL, 0, 0);
+	push_text(fmt, ")");
+	push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
+	if (else_branch->child_count > 0)
+		push_expr(fmt, else_branch->children[0]);
 }
 
 /*
@@ -1105,24 +2004,14 @@ static void format_while(Formatter *fmt, ASTNode *node)
 {
 	emit_indent(fmt);
 	emit(fmt, "while (");
-
-	if (node->child_count > 0)
-		format_expression(fmt, node->children[0]);
-
-	emit(fmt, ")");
+	emit_group_begin(fmt);
 
 	if (node->child_count > 1)
-	{
-		if (node->children[1]->type == NODE_BLOCK)
-			format_block(fmt, node->children[1]);
-		else
-		{
-			emit_newline(fmt);
-			fmt->indent_level++;
-			format_node(fmt, node->children[1]);
-			fmt->indent_level--;
-		}
-	}
+		push_task(fmt, TASK_BODY, node->children[1], NULL, 0, 0);
+	push_text(fmt, ")");
+	push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
+	if (node->child_count > 0)
+		push_expr(fmt, node->children[0]);
 }
 
 /*
@@ -1133,31 +2022,23 @@ static void format_for(Formatter *fmt, ASTNode *node)
 {
 	emit_indent(fmt);
 	emit(fmt, "for (");
+	emit_group_begin(fmt);
 
-	if (node->child_count > 0 && node->children[0])
-		format_expression(fmt, node->children[0]);
-	emit(fmt, "; ");
+	if (node->child_count > 3)
+		push_task(fmt, TASK_BODY, node->children[3], NULL, 0, 0);
 
-	if (node->child_count > 1 && node->children[1])
-		format_expression(fmt, node->children[1]);
-	emit(fmt, "; ");
+	push_text(fmt, ")");
+	push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
+	if (node->child_count > 2)
+		push_expr(fmt, node->children[2]);
 
-	if (node->child_count > 2 && node->children[2])
-		format_expression(fmt, node->children[2]);
-	emit(fmt, ")");
+	push_task(fmt, TASK_TEXT, NULL, ";", 0, TEXT_BREAK);
+	if (node->child_count > 1)
+		push_expr(fmt, node->children[1]);
 
-	if (node->child_count > 3)
-	{
-		if (node->children[3]->type == NODE_BLOCK)
-			format_block(fmt, node->children[3]);
-		else
-		{
-			emit_newline(fmt);
-			fmt->indent_level++;
-			format_node(fmt, node->children[3]);
-			fmt->indent_level--;
-		}
-	}
+	push_task(fmt, TASK_TEXT, NULL, ";", 0, TEXT_BREAK);
+	if (node->child_count > 0)
+		push_expr(fmt, node->children[0]);
 }
 
 /*
@@ -1169,27 +2050,16 @@ static void format_do_while(Formatter *fmt, ASTNode *node)
 	emit_indent(fmt);
 	emit(fmt, "do");
 
-	if (node->child_count > 0)
-	{
-		if (node->children[0]->type == NODE_BLOCK)
-			format_block(fmt, node->children[0]);
-		else
-		{
-			emit_newline(fmt);
-			fmt->indent_level++;
-			format_node(fmt, node->children[0]);
-			fmt->indent_level--;
-		}
-	}
-
-	emit_indent(fmt);
-	emit(fmt, "while (");
-
+	push_task(fmt, TASK_NEWLINE, NULL, NULL, 0, 0);
+	push_text(fmt, ");");
+	push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
 	if (node->child_count > 1)
-		format_expression(fmt, node->children[1]);
+		push_expr(fmt, node->children[1]);
+	push_task(fmt, TASK_GROUP_BEGIN, NULL, NULL, 0, 0);
+	push_task(fmt, TASK_INDENT_TEXT, NULL, "while (", 0, 0);
 
-	emit(fmt, ");");
-	emit_newline(fmt);
+	if (node->child_count > 0)
+		push_task(fmt, TASK_BODY, node->children[0], NULL, 0, 0);
 }
 
 /*
@@ -1198,65 +2068,70 @@ static void format_do_while(Formatter *fmt, ASTNode *node)
 
 static void format_switch(Formatter *fmt, ASTNode *node)
 {
-	int i;
-
 	emit_indent(fmt);
 	emit(fmt, "switch (");
+	emit_group_begin(fmt);
+
+	push_task(fmt, TASK_NEWLINE, NULL, NULL, 0, 0);
+	push_task(fmt, TASK_INDENT_TEXT, NULL, "}", 0, 0);
+	push_task(fmt, TASK_CASES, node, NULL, 1, 0);
+	push_task(fmt, TASK_NEWLINE, NULL, NULL, 0, 0);
+	push_task(fmt, TASK_INDENT_TEXT, NULL, "{", 0, 0);
+	push_task(fmt, TASK_NEWLINE, NULL, NULL, 0, 0);
+	push_text(fmt, ")");
+	push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
 
 	if (node->child_count > 0)
-		format_expression(fmt, node->children[0]);
+		push_expr(fmt, node->children[0]);
+}
 
-	emit(fmt, ")");
-	emit_newline(fmt);
-	emit_indent(fmt);
-	emit(fmt, "{");
-	emit_newline(fmt);
+/*
+ * format_case - Format the next case label and body of a switch
+ * @fmt: Formatter instance
+ * @node: NODE_SWITCH
+ * @index: Child index to resume scanning for NODE_CASE from
+ */
+static void format_case(Formatter *fmt, ASTNode *node, int index)
+{
+	ASTNode *case_node = NULL;
 
-	for (i = 1; i < node->child_count; i++)
+	while (index < node->child_count)
 	{
-		ASTNode *case_node = node->children[i];
-
+		case_node = node->children[index++];
 		if (case_node->type == NODE_CASE)
-		{
-			int stmt_start = 0;
+			break;
+		case_node = NULL;
+	}
 
-			emit_indent(fmt);
+	if (!case_node)
+		return;
 
-			/* Check if it's 'case' or 'default' by token type */
-			if (case_node->token &&
-			    case_node->token->type == TOK_DEFAULT)
-			{
-				emit(fmt, "default:");
-				stmt_start = 0;
-			}
-			else
-			{
-				emit(fmt, "case ");
-				/* Case value is first child */
-				if (case_node->child_count > 0)
-				{
-					format_expression(fmt, case_node->children[0]);
-					stmt_start = 1;
-				}
-				emit(fmt, ":");
-			}
-			emit_newline(fmt);
+	push_task(fmt, TASK_CASES, node, NULL, index, 0);
 
-			/* Format case body statements */
-			fmt->indent_level++;
-			{
-				int j;
+	emit_indent(fmt);
 
-				for (j = stmt_start; j < case_node->child_count; j++)
-					format_node(fmt, case_node->children[j]);
-			}
-			fmt->indent_level--;
-		}
+	/* Check if it's 'case' or 'default' by token type */
+	if (case_node->token && case_node->token->type == TOK_DEFAULT)
+	{
+		emit(fmt, "default:");
+		emit_newline(fmt);
+		fmt->indent_level++;
+		push_task(fmt, TASK_INDENT_OUT, NULL, NULL, 0, 0);
+		push_task(fmt, TASK_CHILDREN, case_node, NULL, 0, 0);
+		return;
 	}
 
-	emit_indent(fmt);
-	emit(fmt, "}");
-	emit_newline(fmt);
+	emit(fmt, "case ");
+
+	/* Case value is first child, body statements follow */
+	push_task(fmt, TASK_INDENT_OUT, NULL, NULL, 0, 0);
+	push_task(fmt, TASK_CHILDREN, case_node, NULL,
+		  case_node->child_count > 0 ? 1 : 0, 0);
+	push_task(fmt, TASK_INDENT_IN, NULL, NULL, 0, 0);
+	push_task(fmt, TASK_NEWLINE, NULL, NULL, 0, 0);
+	push_text(fmt, ":");
+	if (case_node->child_count > 0)
+		push_expr(fmt, case_node->children[0]);
 }
 
 /*
@@ -1268,16 +2143,39 @@ static void format_return(Formatter *fmt, ASTNode *node)
 	emit_indent(fmt);
 	emit(fmt, "return");
 
+	push_task(fmt, TASK_STMT_END, node, NULL, 0, 0);
+
 	if (node->child_count > 0)
 	{
-		emit(fmt, " (");
-		format_expression(fmt, node->children[0]);
-		emit(fmt, ")");
+		/* The value is parenthesized once, by the source or here */
+		emit(fmt, node->children[0]->parens ? " " : " (");
+		emit_group_begin(fmt);
+		if (!node->children[0]->parens)
+			push_text(fmt, ")");
+		push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
+		push_expr(fmt, node->children[0]);
 	}
+}
 
-	emit(fmt, ";");
-	emit_trailing_comments(fmt, node);
-	emit_newline(fmt);
+/*
+ * format_parens - Open the parentheses the source put around an expression
+ * @fmt: Formatter instance
+ * @node: Expression about to be formatted
+ *
+ * The closing parentheses are queued to follow the expression.
+ */
+static void format_parens(Formatter *fmt, ASTNode *node)
+{
+	int i;
+
+	if (!node)
+		return;
+
+	for (i = 0; i < node->parens; i++)
+	{
+		emit(fmt, "(");
+		push_text(fmt, ")");
+	}
 }
 
 /*
@@ -1286,8 +2184,6 @@ static void format_return(Formatter *fmt, ASTNode *node)
 
 static void format_expression(Formatter *fmt, ASTNode *node)
 {
-	int i;
-
 	if (!node)
 		return;
 
@@ -1295,12 +2191,12 @@ static void format_expression(Formatter *fmt, ASTNode *node)
 	{
 	case NODE_LITERAL:
 		if (node->token && node->token->lexeme)
-			emit(fmt, node->token->lexeme);
+			emit_token(fmt, node->token);
 		break;
 
 	case NODE_IDENTIFIER:
 		if (node->token && node->token->lexeme)
-			emit(fmt, node->token->lexeme);
+			emit_token(fmt, node->token);
 		break;
 
 	case NODE_BINARY:
@@ -1316,22 +2212,25 @@ static void format_expression(Formatter *fmt, ASTNode *node)
 		break;
 
 	case NODE_MEMBER_ACCESS:
-		if (node->child_count > 0)
-			format_expression(fmt, node->children[0]);
 		if (node->token && node->token->lexeme)
 		{
-			emit(fmt, "->");
-			emit(fmt, node->token->lexeme);
+			MemberAccessData *access = node->data;
+
+			push_task(fmt, TASK_TEXT, node, node->token->lexeme, 0,
+				  TEXT_TOKEN);
+			push_text(fmt, access && !access->uses_arrow ? "." : "->");
 		}
+		if (node->child_count > 0)
+			push_expr(fmt, node->children[0]);
 		break;
 
 	case NODE_ARRAY_ACCESS:
-		if (node->child_count > 0)
-			format_expression(fmt, node->children[0]);
-		emit(fmt, "[");
+		push_text(fmt, "]");
 		if (node->child_count > 1)
-			format_expression(fmt, node->children[1]);
-		emit(fmt, "]");
+			push_expr(fmt, node->children[1]);
+		push_text(fmt, "[");
+		if (node->child_count > 0)
+			push_expr(fmt, node->children[0]);
 		break;
 
 	case NODE_CAST:
@@ -1339,10 +2238,10 @@ static void format_expression(Formatter *fmt, ASTNode *node)
 		if (node->data)
 			emit(fmt, (const char *)node->data);
 		else if (node->token && node->token->lexeme)
-			emit(fmt, node->token->lexeme);
+			emit_token(fmt, node->token);
 		emit(fmt, ")");
 		if (node->child_count > 0)
-			format_expression(fmt, node->children[0]);
+			push_expr(fmt, node->children[0]);
 		break;
 
 	case NODE_SIZEOF:
@@ -1350,36 +2249,37 @@ static void format_expression(Formatter *fmt, ASTNode *node)
 		if (node->child_count > 0)
 		{
 			/* sizeof(expression) */
-			format_expression(fmt, node->children[0]);
+			push_text(fmt, ")");
+			push_expr(fmt, node->children[0]);
 		}
-		else if (node->data)
+		else
 		{
 			/* sizeof(type) - raw text stored in data field */
-			emit(fmt, (const char *)node->data);
+			if (node->data)
+				emit(fmt, (const char *)node->data);
+			emit(fmt, ")");
 		}
-		emit(fmt, ")");
 		break;
 
 	case NODE_TERNARY:
-		if (node->child_count > 0)
-			format_expression(fmt, node->children[0]);
-		emit(fmt, " ? ");
-		if (node->child_count > 1)
-			format_expression(fmt, node->children[1]);
-		emit(fmt, " : ");
+		emit_group_begin(fmt);
+		push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
 		if (node->child_count > 2)
-			format_expression(fmt, node->children[2]);
+			push_expr(fmt, node->children[2]);
+		push_task(fmt, TASK_SPACED, NULL, ":", 0, TEXT_BREAK);
+		if (node->child_count > 1)
+			push_expr(fmt, node->children[1]);
+		push_task(fmt, TASK_SPACED, NULL, "?", 0, TEXT_BREAK);
+		if (node->child_count > 0)
+			push_expr(fmt, node->children[0]);
 		break;
 
 	case NODE_INIT_LIST:
 		emit(fmt, "{");
-		for (i = 0; i < node->child_count; i++)
-		{
-			if (i > 0)
-				emit(fmt, ", ");
-			format_expression(fmt, node->children[i]);
-		}
-		emit(fmt, "}");
+		emit_group_begin(fmt);
+		push_text(fmt, "}");
+		push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
+		push_task(fmt, TASK_LIST, node, NULL, 0, 0);
 		break;
 
 	case NODE_TYPE_EXPR:
@@ -1405,14 +2305,14 @@ static void format_expression(Formatter *fmt, ASTNode *node)
 				{
 					if (j > 0 && !last_was_star)
 						emit(fmt, " ");
-					emit(fmt, tok->lexeme);
+					emit_token(fmt, tok);
 					last_was_star = 0;
 				}
 			}
 		}
 		else if (node->token && node->token->lexeme)
 		{
-			emit(fmt, node->token->lexeme);
+			emit_token(fmt, node->token);
 		}
 		break;
 
@@ -1421,6 +2321,28 @@ static void format_expression(Formatter *fmt, ASTNode *node)
 	}
 }
 
+/*
+ * format_list - Output the next element of a comma-separated list
+ * @fmt: Formatter instance
+ * @node: Node whose children form the list
+ * @index: Index of the element to output
+ * @start: Index of the first element (no separator before it)
+ */
+static void format_list(Formatter *fmt, ASTNode *node, int index, int start)
+{
+	if (index >= node->child_count)
+		return;
+
+	if (index > start)
+	{
+		emit(fmt, ",");
+		emit_break(fmt);
+	}
+
+	push_task(fmt, TASK_LIST, node, NULL, index + 1, start);
+	push_expr(fmt, node->children[index]);
+}
+
 /*
  * Binary expression formatting
  */
@@ -1428,19 +2350,38 @@ static void format_expression(Formatter *fmt, ASTNode *node)
 static void format_binary(Formatter *fmt, ASTNode *node)
 {
 	const char *op = "";
+	int flags = TEXT_BREAK;
 
 	if (node->token && node->token->lexeme)
 		op = node->token->lexeme;
 
-	if (node->child_count > 0)
-		format_expression(fmt, node->children[0]);
+	/* Break after the operator, but not after assignments or comparisons */
+	if (node->token &&
+	    ((node->token->type >= TOK_ASSIGN &&
+	      node->token->type <= TOK_RSHIFT_ASSIGN) ||
+	     (node->token->type >= TOK_EQUAL &&
+	      node->token->type <= TOK_GREATER_EQUAL)))
+		flags = 0;
 
-	emit_space(fmt);
-	emit(fmt, op);
-	emit_space(fmt);
+	if (flags & TEXT_BREAK)
+	{
+		emit_group_begin(fmt);
+		push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
+	}
+
+	/* Rather break earlier than leave "2;" alone on a line */
+	if ((flags & TEXT_BREAK) && node->child_count > 1 &&
+	    node->children[1]->child_count == 0 && node->children[1]->token &&
+	    node->children[1]->token->length <= SHORT_OPERAND)
+		flags |= TEXT_TAIL;
 
 	if (node->child_count > 1)
-		format_expression(fmt, node->children[1]);
+		push_expr(fmt, node->children[1]);
+
+	push_task(fmt, TASK_SPACED, NULL, op, 0, flags);
+
+	if (node->child_count > 0)
+		push_expr(fmt, node->children[0]);
 }
 
 /*
@@ -1454,9 +2395,18 @@ static void format_unary(Formatter *fmt, ASTNode *node)
 	if (node->token && node->token->lexeme)
 		op = node->token->lexeme;
 
+	/* Postfix ++ and -- follow their operand */
+	if (node->data && ((UnaryData *)node->data)->is_postfix)
+	{
+		push_text(fmt, op);
+		if (node->child_count > 0)
+			push_expr(fmt, node->children[0]);
+		return;
+	}
+
 	emit(fmt, op);
 	if (node->child_count > 0)
-		format_expression(fmt, node->children[0]);
+		push_expr(fmt, node->children[0]);
 }
 
 /*
@@ -1465,29 +2415,28 @@ static void format_unary(Formatter *fmt, ASTNode *node)
 
 static void format_call(Formatter *fmt, ASTNode *node)
 {
-	int i;
 	int arg_start = 0;
 
+	push_text(fmt, ")");
+	push_task(fmt, TASK_GROUP_END, NULL, NULL, 0, 0);
+
 	if (node->token && node->token->lexeme)
 	{
-		emit(fmt, node->token->lexeme);
-	}
-	else if (node->child_count > 0)
-	{
-		format_expression(fmt, node->children[0]);
-		arg_start = 1;
+		emit_token(fmt, node->token);
+		emit(fmt, "(");
+		emit_group_begin(fmt);
+		push_task(fmt, TASK_LIST, node, NULL, 0, 0);
+		return;
 	}
 
-	emit(fmt, "(");
-
-	for (i = arg_start; i < node->child_count; i++)
-	{
-		if (i > arg_start)
-			emit(fmt, ", ");
-		format_expression(fmt, node->children[i]);
-	}
+	if (node->child_count > 0)
+		arg_start = 1;
 
-	emit(fmt, ")");
+	push_task(fmt, TASK_LIST, node, NULL, arg_start, arg_start);
+	push_task(fmt, TASK_GROUP_BEGIN, NULL, NULL, 0, 0);
+	push_text(fmt, "(");
+	if (arg_start)
+		push_expr(fmt, node->children[0]);
 }
 
 /*
@@ -1496,14 +2445,12 @@ static void format_call(Formatter *fmt, ASTNode *node)
 
 static void format_struct(Formatter *fmt, ASTNode *node)
 {
-	int i;
-
 	emit(fmt, "struct");
 
 	if (node->token && node->token->lexeme)
 	{
 		emit_space(fmt);
-		emit(fmt, node->token->lexeme);
+		emit_token(fmt, node->token);
 	}
 
 	/* If struct has members (body), format them */
@@ -1514,14 +2461,8 @@ static void format_struct(Formatter *fmt, ASTNode *node)
 		emit_newline(fmt);
 		fmt->indent_level++;
 
-		for (i = 0; i < node->child_count; i++)
-		{
-			format_node(fmt, node->children[i]);
-		}
-
-		fmt->indent_level--;
-		emit_indent(fmt);
-		emit(fmt, "}");
+		push_task(fmt, TASK_CLOSE, node, NULL, 0, CLOSE_INDENT);
+		push_task(fmt, TASK_CHILDREN, node, NULL, 0, 0);
 	}
 }
 
@@ -1548,9 +2489,13 @@ static void format_typedef(Formatter *fmt, ASTNode *node)
 		emit_newline(fmt);
 		return;
 	}
-	/* If has struct/enum child, format it */
+	/* If has struct/enum child, format it before the alias */
 	else if (node->child_count > 0)
-		format_node(fmt, node->children[0]);
+	{
+		push_task(fmt, TASK_TYPEDEF_END, node, NULL, 0, 0);
+		push_node(fmt, node->children[0]);
+		return;
+	}
 	else if (td_data && td_data->base_type_count > 0)
 	{
 		/* Check if we have a pointer */
@@ -1573,17 +2518,28 @@ static void format_typedef(Formatter *fmt, ASTNode *node)
 			{
 				if (i > 0)
 					emit_space(fmt);
-				emit(fmt, tok->lexeme);
+				emit_token(fmt, tok);
 			}
 		}
 	}
 
+	format_typedef_end(fmt, node, has_ptr);
+}
+
+/*
+ * format_typedef_end - Output the typedef alias and terminating semicolon
+ * @fmt: Formatter instance
+ * @node: NODE_TYPEDEF
+ * @has_ptr: 1 if the base type ended with a pointer
+ */
+static void format_typedef_end(Formatter *fmt, ASTNode *node, int has_ptr)
+{
 	if (node->token && node->token->lexeme)
 	{
 		/* Add space before alias unless we just emitted a pointer */
 		if (!has_ptr)
 			emit_space(fmt);
-		emit(fmt, node->token->lexeme);
+		emit_token(fmt, node->token);
 	}
 
 	emit(fmt, ";");
@@ -1603,7 +2559,7 @@ static void format_enum(Formatter *fmt, ASTNode *node)
 	if (node->token && node->token->lexeme)
 	{
 		emit_space(fmt);
-		emit(fmt, node->token->lexeme);
+		emit_token(fmt, node->token);
 	}
 
 	/* If enum has values, format them */
@@ -1620,16 +2576,16 @@ static void format_enum(Formatter *fmt, ASTNode *node)
 			/* Emit enum value name */
 			if (node->children[i]->token && node->children[i]->token->lexeme)
 			{
-				emit(fmt, node->children[i]->token->lexeme);
+				emit_token(fmt, node->children[i]->token);
 			}
 
 			/* If it has an initializer value */
-			if (node->children[i]->child_count > 0 && 
+			if (node->children[i]->child_count > 0 &&
 			    node->children[i]->children[0]->token &&
 			    node->children[i]->children[0]->token->lexeme)
 			{
 				emit(fmt, " = ");
-				emit(fmt, node->children[i]->children[0]->token->lexeme);
+				emit_token(fmt, node->children[i]->children[0]->token);
 			}
 
 			/* Add comma except for last element */
@@ -1642,4 +2598,4 @@ static void format_enum(Formatter *fmt, ASTNode *node)
 		emit_indent(fmt);
 		emit(fmt, "}");
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,622 @@
+#include "../include/json.h"
+#include "../include/stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Parser state
+ */
+typedef struct JsonParser {
+	const char *p;
+	const char *end;
+	int failed;
+} JsonParser;
+
+static void parse_value(JsonParser *parser, JsonValue *out, int depth);
+static void free_members(JsonValue *value);
+
+static void skip_space(JsonParser *parser)
+{
+	while (parser->p < parser->end &&
+	       (*parser->p == ' ' || *parser->p == '\t' ||
+		*parser->p == '\n' || *parser->p == '\r'))
+		parser->p++;
+}
+
+/*
+ * append_bytes - Append to a growable string buffer
+ * @buffer: Buffer (reallocated as needed)
+ * @length: Bytes used
+ * @capacity: Bytes allocated
+ * @data: Bytes to append
+ * @count: Number of bytes
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int append_bytes(char **buffer, size_t *length, size_t *capacity,
+			const char *data, size_t count)
+{
+	if (*length + count + 1 > *capacity)
+	{
+		size_t new_capacity = *capacity ? *capacity * 2 : 32;
+		char *new_buffer;
+
+		while (new_capacity < *length + count + 1)
+			new_capacity *= 2;
+		new_buffer = mem_realloc(*buffer, new_capacity, MEM_SERVER);
+		if (!new_buffer)
+			return (-1);
+		*buffer = new_buffer;
+		*capacity = new_capacity;
+	}
+
+	memcpy(*buffer + *length, data, count);
+	*length += count;
+	(*buffer)[*length] = '\0';
+	return (0);
+}
+
+/*
+ * parse_hex4 - Read the four hex digits of a \u escape
+ * @parser: Parser state (at the first digit)
+ *
+ * Return: Code unit, or -1 if the digits are invalid
+ */
+static long parse_hex4(JsonParser *parser)
+{
+	long value = 0;
+	int i;
+	char c;
+
+	if (parser->end - parser->p < 4)
+		return (-1);
+
+	for (i = 0; i < 4; i++)
+	{
+		c = *parser->p++;
+		value <<= 4;
+		if (c >= '0' && c <= '9')
+			value |= c - '0';
+		else if (c >= 'a' && c <= 'f')
+			value |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			value |= c - 'A' + 10;
+		else
+			return (-1);
+	}
+
+	return (value);
+}
+
+/*
+ * encode_utf8 - Encode a code point as UTF-8
+ * @code: Code point
+ * @out: Buffer of at least 4 bytes
+ *
+ * Return: Number of bytes written
+ */
+static size_t encode_utf8(long code, char *out)
+{
+	if (code < 0x80)
+	{
+		out[0] = code;
+		return (1);
+	}
+	if (code < 0x800)
+	{
+		out[0] = 0xc0 | (code >> 6);
+		out[1] = 0x80 | (code & 0x3f);
+		return (2);
+	}
+	if (code < 0x10000)
+	{
+		out[0] = 0xe0 | (code >> 12);
+		out[1] = 0x80 | ((code >> 6) & 0x3f);
+		out[2] = 0x80 | (code & 0x3f);
+		return (3);
+	}
+	out[0] = 0xf0 | (code >> 18);
+	out[1] = 0x80 | ((code >> 12) & 0x3f);
+	out[2] = 0x80 | ((code >> 6) & 0x3f);
+	out[3] = 0x80 | (code & 0x3f);
+	return (4);
+}
+
+/*
+ * parse_escape - Decode one escape sequence
+ * @parser: Parser state (just after the backslash)
+ * @out: Buffer of at least 4 bytes
+ *
+ * Return: Number of bytes written, or 0 on error
+ */
+static size_t parse_escape(JsonParser *parser, char *out)
+{
+	const char *simple = "\"\"\\\\//b\bf\fn\nr\rt\t";
+	const char *s;
+	long code, low;
+
+	if (parser->p >= parser->end)
+		return (0);
+
+	for (s = simple; *s; s += 2)
+	{
+		if (*parser->p == s[0])
+		{
+			parser->p++;
+			out[0] = s[1];
+			return (1);
+		}
+	}
+	if (*parser->p++ != 'u')
+		return (0);
+
+	code = parse_hex4(parser);
+	if (code < 0)
+		return (0);
+
+	/* A high surrogate must be followed by the \u of its low half */
+	if (code >= 0xd800 && code <= 0xdbff)
+	{
+		if (parser->end - parser->p < 2 || parser->p[0] != '\\' ||
+		    parser->p[1] != 'u')
+			return (0);
+		parser->p += 2;
+		low = parse_hex4(parser);
+		if (low < 0xdc00 || low > 0xdfff)
+			return (0);
+		code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+	}
+	else if (code >= 0xdc00 && code <= 0xdfff)
+		return (0);
+
+	return (encode_utf8(code, out));
+}
+
+/*
+ * parse_string - Parse a string literal
+ * @parser: Parser state (at the opening quote)
+ * @length: Where to store the decoded length
+ *
+ * Return: Decoded string (caller must mem_free), or NULL on error
+ */
+static char *parse_string(JsonParser *parser, size_t *length)
+{
+	char *buffer = NULL;
+	size_t capacity = 0;
+	const char *run;
+	char escaped[4];
+	size_t count;
+
+	*length = 0;
+	parser->p++;
+	if (append_bytes(&buffer, length, &capacity, "", 0) < 0)
+		return (NULL);
+
+	while (parser->p < parser->end && *parser->p != '"')
+	{
+		/* Copy the run up to the next quote or escape in one go */
+		run = parser->p;
+		while (parser->p < parser->end && *parser->p != '"' &&
+		       *parser->p != '\\' && (unsigned char)*parser->p >= 0x20)
+			parser->p++;
+		if (append_bytes(&buffer, length, &capacity, run,
+				 parser->p - run) < 0)
+			break;
+
+		if (parser->p < parser->end && *parser->p == '\\')
+		{
+			parser->p++;
+			count = parse_escape(parser, escaped);
+			if (count == 0 ||
+			    append_bytes(&buffer, length, &capacity, escaped,
+					 count) < 0)
+				break;
+		}
+		else if (parser->p < parser->end && *parser->p != '"')
+			break;  /* Unescaped control character */
+	}
+
+	if (parser->p >= parser->end || *parser->p != '"')
+	{
+		mem_free(buffer);
+		return (NULL);
+	}
+	parser->p++;
+
+	return (buffer);
+}
+
+/*
+ * add_member - Append a parsed value to an array or object
+ * @container: Array or object
+ * @key: Member name for objects (ownership taken), NULL for arrays
+ * @value: Parsed value (copied)
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int add_member(JsonValue *container, char *key, JsonValue *value)
+{
+	if (container->count >= container->capacity)
+	{
+		int new_capacity = container->capacity ?
+			container->capacity * 2 : 4;
+		JsonValue *new_items = mem_realloc(container->items,
+			sizeof(JsonValue) * new_capacity, MEM_SERVER);
+		char **new_keys;
+
+		if (!new_items)
+			return (-1);
+		container->items = new_items;
+
+		if (container->type == JSON_OBJECT)
+		{
+			new_keys = mem_realloc(container->keys,
+				sizeof(char *) * new_capacity, MEM_SERVER);
+			if (!new_keys)
+				return (-1);
+			container->keys = new_keys;
+		}
+		container->capacity = new_capacity;
+	}
+
+	if (container->type == JSON_OBJECT)
+		container->keys[container->count] = key;
+	container->items[container->count++] = *value;
+	return (0);
+}
+
+/*
+ * parse_container - Parse the members of an array or object
+ * @parser: Parser state (at the opening bracket)
+ * @out: Value to fill (type already set)
+ * @depth: Nesting depth of @out
+ */
+static void parse_container(JsonParser *parser, JsonValue *out, int depth)
+{
+	char close = out->type == JSON_OBJECT ? '}' : ']';
+	char *key = NULL;
+	size_t key_length;
+	JsonValue member;
+
+	parser->p++;
+	skip_space(parser);
+	if (parser->p < parser->end && *parser->p == close)
+	{
+		parser->p++;
+		return;
+	}
+
+	while (!parser->failed)
+	{
+		skip_space(parser);
+		if (out->type == JSON_OBJECT)
+		{
+			if (parser->p >= parser->end || *parser->p != '"')
+				break;
+			key = parse_string(parser, &key_length);
+			skip_space(parser);
+			if (!key || parser->p >= parser->end || *parser->p != ':')
+				break;
+			parser->p++;
+		}
+
+		parse_value(parser, &member, depth + 1);
+		if (parser->failed || add_member(out, key, &member) < 0)
+		{
+			if (!parser->failed)
+				free_members(&member);
+			break;
+		}
+		key = NULL;
+
+		skip_space(parser);
+		if (parser->p < parser->end && *parser->p == ',')
+		{
+			parser->p++;
+			continue;
+		}
+		if (parser->p < parser->end && *parser->p == close)
+		{
+			parser->p++;
+			return;
+		}
+		break;
+	}
+
+	mem_free(key);
+	parser->failed = 1;
+}
+
+/*
+ * parse_value - Parse any JSON value
+ * @parser: Parser state
+ * @out: Value to fill (left empty on error)
+ * @depth: Nesting depth of @out
+ */
+static void parse_value(JsonParser *parser, JsonValue *out, int depth)
+{
+	char *number_end;
+	char buffer[64];
+	size_t length;
+
+	memset(out, 0, sizeof(*out));
+	skip_space(parser);
+	if (parser->p >= parser->end || depth > JSON_MAX_DEPTH)
+	{
+		parser->failed = 1;
+		return;
+	}
+
+	switch (*parser->p)
+	{
+	case '{':
+	case '[':
+		out->type = *parser->p == '{' ? JSON_OBJECT : JSON_ARRAY;
+		parse_container(parser, out, depth);
+		if (parser->failed)
+		{
+			free_members(out);
+			memset(out, 0, sizeof(*out));
+		}
+		return;
+	case '"':
+		out->type = JSON_STRING;
+		out->string = parse_string(parser, &out->length);
+		if (!out->string)
+			parser->failed = 1;
+		return;
+	}
+
+	if (parser->end - parser->p >= 4 && !memcmp(parser->p, "null", 4))
+	{
+		parser->p += 4;
+		return;
+	}
+	if (parser->end - parser->p >= 4 && !memcmp(parser->p, "true", 4))
+	{
+		out->type = JSON_BOOL;
+		out->boolean = 1;
+		parser->p += 4;
+		return;
+	}
+	if (parser->end - parser->p >= 5 && !memcmp(parser->p, "false", 5))
+	{
+		out->type = JSON_BOOL;
+		parser->p += 5;
+		return;
+	}
+
+	/* Numbers: strtod needs a terminated copy */
+	length = 0;
+	while (parser->p + length < parser->end && length < sizeof(buffer) - 1 &&
+	       strchr("+-0123456789.eE", parser->p[length]))
+		length++;
+	memcpy(buffer, parser->p, length);
+	buffer[length] = '\0';
+	out->number = strtod(buffer, &number_end);
+	if (length == 0 || number_end != buffer + length)
+	{
+		parser->failed = 1;
+		return;
+	}
+	out->type = JSON_NUMBER;
+	parser->p += length;
+}
+
+/*
+ * json_parse - Parse a JSON document
+ * @text: Document text
+ * @length: Length of @text
+ *
+ * Return: Parsed value (free with json_free), or NULL if @text is not a
+ * single valid JSON value
+ */
+JsonValue *json_parse(const char *text, size_t length)
+{
+	JsonParser parser;
+	JsonValue *value;
+
+	value = mem_alloc(sizeof(JsonValue), MEM_SERVER);
+	if (!value)
+		return (NULL);
+
+	parser.p = text;
+	parser.end = text + length;
+	parser.failed = 0;
+
+	parse_value(&parser, value, 1);
+	skip_space(&parser);
+	if (!parser.failed && parser.p != parser.end)
+	{
+		free_members(value);
+		parser.failed = 1;
+	}
+	if (parser.failed)
+	{
+		mem_free(value);
+		return (NULL);
+	}
+
+	return (value);
+}
+
+static void free_members(JsonValue *value)
+{
+	int i;
+
+	for (i = 0; i < value->count; i++)
+	{
+		free_members(&value->items[i]);
+		if (value->keys)
+			mem_free(value->keys[i]);
+	}
+	mem_free(value->items);
+	mem_free(value->keys);
+	mem_free(value->string);
+}
+
+/*
+ * json_free - Free a parsed JSON document
+ * @value: Value returned by json_parse()
+ */
+void json_free(JsonValue *value)
+{
+	if (!value)
+		return;
+
+	free_members(value);
+	mem_free(value);
+}
+
+/*
+ * json_get - Look up an object member
+ * @object: Object to search
+ * @key: Member name
+ *
+ * Return: Member value, or NULL if @object is not an object or lacks @key
+ */
+const JsonValue *json_get(const JsonValue *object, const char *key)
+{
+	int i;
+
+	if (!object || object->type != JSON_OBJECT)
+		return (NULL);
+
+	for (i = 0; i < object->count; i++)
+	{
+		if (strcmp(object->keys[i], key) == 0)
+			return (&object->items[i]);
+	}
+
+	return (NULL);
+}
+
+/*
+ * json_index - Get an array element
+ * @array: Array
+ * @index: Element index
+ *
+ * Return: Element, or NULL if @array is not an array or too short
+ */
+const JsonValue *json_index(const JsonValue *array, int index)
+{
+	if (!array || array->type != JSON_ARRAY || index < 0 ||
+	    index >= array->count)
+		return (NULL);
+
+	return (&array->items[index]);
+}
+
+/*
+ * json_string - Get the text of a string value
+ * @value: Value
+ *
+ * Return: String, or NULL if @value is not a string
+ */
+const char *json_string(const JsonValue *value)
+{
+	if (!value || value->type != JSON_STRING)
+		return (NULL);
+
+	return (value->string);
+}
+
+/*
+ * json_long - Get a number as an integer
+ * @value: Value
+ * @fallback: Result when @value is not a number
+ *
+ * Return: Integer value
+ */
+long json_long(const JsonValue *value, long fallback)
+{
+	if (!value || value->type != JSON_NUMBER)
+		return (fallback);
+
+	return ((long)value->number);
+}
+
+/*
+ * json_write_string - Write text as a JSON string literal
+ * @fp: Output stream
+ * @text: Text to write (UTF-8)
+ * @length: Length of @text
+ */
+void json_write_string(FILE *fp, const char *text, size_t length)
+{
+	const char *run = text;
+	const char *end = text + length;
+	unsigned char c;
+
+	fputc('"', fp);
+	for (; text < end; text++)
+	{
+		c = *text;
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+
+		fwrite(run, 1, text - run, fp);
+		run = text + 1;
+		if (c == '"' || c == '\\')
+			fprintf(fp, "\\%c", c);
+		else if (c == '\n')
+			fputs("\\n", fp);
+		else if (c == '\t')
+			fputs("\\t", fp);
+		else
+			fprintf(fp, "\\u%04x", c);
+	}
+	fwrite(run, 1, end - run, fp);
+	fputc('"', fp);
+}
+
+/*
+ * json_write_value - Write a parsed value back as JSON
+ * @fp: Output stream
+ * @value: Value (NULL writes null)
+ */
+void json_write_value(FILE *fp, const JsonValue *value)
+{
+	int i;
+
+	if (!value || value->type == JSON_NULL)
+	{
+		fputs("null", fp);
+		return;
+	}
+
+	switch (value->type)
+	{
+	case JSON_BOOL:
+		fputs(value->boolean ? "true" : "false", fp);
+		break;
+	case JSON_NUMBER:
+		if (value->number == (double)(long)value->number)
+			fprintf(fp, "%ld", (long)value->number);
+		else
+			fprintf(fp, "%.17g", value->number);
+		break;
+	case JSON_STRING:
+		json_write_string(fp, value->string, value->length);
+		break;
+	case JSON_ARRAY:
+	case JSON_OBJECT:
+		fputc(value->type == JSON_ARRAY ? '[' : '{', fp);
+		for (i = 0; i < value->count; i++)
+		{
+			if (i > 0)
+				fputc(',', fp);
+			if (value->type == JSON_OBJECT)
+			{
+				json_write_string(fp, value->keys[i],
+						  strlen(value->keys[i]));
+				fputc(':', fp);
+			}
+			json_write_value(fp, &value->items[i]);
+		}
+		fputc(value->type == JSON_ARRAY ? ']' : '}', fp);
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,713 @@
+#define _GNU_SOURCE
+#include "../include/layout.h"
+#include "../include/stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_RING_CAPACITY 256
+#define INITIAL_STACK_CAPACITY 64
+#define FILL_CHUNK 32
+
+static const char fill_tabs[FILL_CHUNK + 1] =
+	"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+static const char fill_spaces[FILL_CHUNK + 1] =
+	"                                ";
+
+static LayoutToken *token_at(Layout *layout, long pos);
+static long add_token(Layout *layout, LayoutKind kind, const char *text,
+		      int length, int size);
+static void add_break(Layout *layout, int blank, int tail);
+static void scan_push(Layout *layout, long pos);
+static void close_groups(Layout *layout);
+static void check_stream(Layout *layout);
+static void advance_left(Layout *layout, int flush);
+static void print_token(Layout *layout, LayoutToken *token);
+static void write_fill(Layout *layout, const char *fill, int count);
+static int text_width(Layout *layout, const char *text, int length, int col);
+static void track_indent(Layout *layout, const char *text, int length,
+			 int col);
+static int segment_width(Layout *layout, int *complete);
+static LayoutBlock *breaking_block(Layout *layout, LayoutToken *token);
+static int idle(Layout *layout);
+static void fail(Layout *layout);
+
+/*
+ * layout_create - Create a layout engine
+ * @width: Maximum line length
+ * @tab_width: Columns per tab
+ * @use_tabs: Indent continuation lines with tabs (then spaces)
+ * @write: Receives the laid-out text
+ * @write_ctx: Passed to @write
+ *
+ * Return: Pointer to new layout engine, or NULL on failure
+ */
+Layout *layout_create(int width, int tab_width, int use_tabs,
+		      LayoutWriteFn write, void *write_ctx)
+{
+	Layout *layout;
+
+	if (!write || width <= 0 || tab_width <= 0)
+		return (NULL);
+
+	layout = mem_alloc(sizeof(Layout), MEM_FORMATTER);
+	if (!layout)
+		return (NULL);
+
+	layout->width = width;
+	layout->tab_width = tab_width;
+	layout->use_tabs = use_tabs;
+	layout->write = write;
+	layout->write_ctx = write_ctx;
+
+	layout->ring = mem_alloc(sizeof(LayoutToken) * INITIAL_RING_CAPACITY,
+				 MEM_FORMATTER);
+	layout->scan = mem_alloc(sizeof(long) * INITIAL_STACK_CAPACITY,
+				 MEM_FORMATTER);
+	layout->blocks = mem_alloc(sizeof(LayoutBlock) * INITIAL_STACK_CAPACITY,
+				   MEM_FORMATTER);
+	if (!layout->ring || !layout->scan || !layout->blocks)
+	{
+		layout_destroy(layout);
+		return (NULL);
+	}
+
+	layout->ring_capacity = INITIAL_RING_CAPACITY;
+	layout->left = 0;
+	layout->right = 0;
+	layout->left_total = 1;
+	layout->right_total = 1;
+	layout->scan_bottom = 0;
+	layout->scan_top = 0;
+	layout->scan_capacity = INITIAL_STACK_CAPACITY;
+	layout->block_count = 0;
+	layout->block_capacity = INITIAL_STACK_CAPACITY;
+	layout->space = width;
+	layout->line_indent = 0;
+	layout->line_blank = 1;
+	layout->failed = 0;
+
+	return (layout);
+}
+
+/*
+ * layout_destroy - Free layout engine memory (does not flush)
+ * @layout: Layout engine to destroy
+ */
+void layout_destroy(Layout *layout)
+{
+	if (!layout)
+		return;
+
+	mem_free(layout->ring);
+	mem_free(layout->scan);
+	mem_free(layout->blocks);
+	mem_free(layout);
+}
+
+/*
+ * Scanning: tokens are sized as they arrive. The size of a group is its
+ * flat width and the size of a break is its blank plus the flat width up
+ * to the end of its group, both extended by the text that follows the
+ * group up to the next break: a call that only fits without its ");" does
+ * not fit.
+ */
+
+/*
+ * layout_text - Add unbreakable text
+ * @layout: Layout engine
+ * @text: Text without newlines (must stay valid until printed)
+ * @length: Length of @text
+ */
+void layout_text(Layout *layout, const char *text, size_t length)
+{
+	LayoutToken token;
+	int col, width;
+
+	if (length == 0)
+		return;
+
+	col = layout->width - layout->space +
+		(int)(layout->right_total - layout->left_total);
+	width = text_width(layout, text, (int)length, col);
+
+	if (layout->failed || idle(layout))
+	{
+		/* Nothing undecided ahead of it: print straight away */
+		token.kind = LAYOUT_TEXT;
+		token.text = text;
+		token.length = (int)length;
+		token.size = width;
+		print_token(layout, &token);
+		return;
+	}
+
+	if (add_token(layout, LAYOUT_TEXT, text, (int)length, width) < 0)
+		return;
+	layout->right_total += width;
+	check_stream(layout);
+}
+
+/*
+ * layout_break - Add a blank that may become a line break
+ * @layout: Layout engine
+ * @blank: Width of the blank when the break is not taken
+ */
+void layout_break(Layout *layout, int blank)
+{
+	add_break(layout, blank, 0);
+}
+
+/*
+ * layout_tail_break - Add a break before the short end of a group
+ * @layout: Layout engine
+ * @blank: Width of the blank when the break is not taken
+ *
+ * The text after the break, up to the next break, also counts towards
+ * the breaks before it, so an earlier break is taken rather than leaving
+ * that text alone on a line. It is still taken when nothing else fits.
+ */
+void layout_tail_break(Layout *layout, int blank)
+{
+	add_break(layout, blank, 1);
+}
+
+/*
+ * add_break - Add a break
+ * @layout: Layout engine
+ * @blank: Width of the blank when the break is not taken
+ * @tail: Leave the groups and breaks before it open, see close_groups()
+ */
+static void add_break(Layout *layout, int blank, int tail)
+{
+	long pos;
+
+	if (layout->failed)
+	{
+		write_fill(layout, fill_spaces, blank);
+		layout->space -= blank;
+		return;
+	}
+
+	if (!tail)
+		close_groups(layout);
+	if (idle(layout))
+	{
+		layout->left = layout->right = 0;
+		layout->left_total = layout->right_total = 1;
+	}
+	else if (!tail && layout->scan_top > layout->scan_bottom)
+	{
+		LayoutToken *top = token_at(layout,
+					   layout->scan[layout->scan_top - 1]);
+
+		if (top->kind == LAYOUT_BREAK)
+		{
+			top->size += layout->right_total;
+			layout->scan_top--;
+		}
+	}
+
+	pos = add_token(layout, LAYOUT_BREAK, NULL, blank,
+			-(int)layout->right_total);
+	if (pos < 0)
+		return;
+	scan_push(layout, pos);
+	layout->right_total += blank;
+	check_stream(layout);
+}
+
+/*
+ * layout_begin - Open a group
+ * @layout: Layout engine
+ */
+void layout_begin(Layout *layout)
+{
+	long pos;
+
+	if (layout->failed)
+		return;
+
+	close_groups(layout);
+	if (idle(layout))
+	{
+		layout->left = layout->right = 0;
+		layout->left_total = layout->right_total = 1;
+	}
+
+	pos = add_token(layout, LAYOUT_BEGIN, NULL, 0,
+			-(int)layout->right_total);
+	if (pos >= 0)
+		scan_push(layout, pos);
+}
+
+/*
+ * layout_end - Close the innermost group
+ * @layout: Layout engine
+ */
+void layout_end(Layout *layout)
+{
+	LayoutToken token;
+	long pos;
+
+	if (layout->failed || idle(layout))
+	{
+		token.kind = LAYOUT_END;
+		token.text = NULL;
+		token.length = 0;
+		token.size = 0;
+		print_token(layout, &token);
+		return;
+	}
+
+	/* Sized at the next break, see close_groups() */
+	pos = add_token(layout, LAYOUT_END, NULL, 0, 0);
+	if (pos >= 0)
+		scan_push(layout, pos);
+}
+
+/*
+ * close_groups - Size the groups closed since the last break
+ * @layout: Layout engine
+ *
+ * Each closed group left its LAYOUT_END on the scan stack, above its
+ * last break and its LAYOUT_BEGIN (either may already have been forced
+ * out from the bottom). Groups are only sized here, at the next break,
+ * so a group closed early still counts the text that follows the groups
+ * around it, such as the ")" after "b" in "f(a, g(b))". A tail break
+ * sits above the ENDs of the groups before it and is sized with them.
+ */
+static void close_groups(Layout *layout)
+{
+	LayoutToken *open;
+	int closed = 0;
+
+	while (layout->scan_top > layout->scan_bottom)
+	{
+		open = token_at(layout, layout->scan[layout->scan_top - 1]);
+		if (open->kind == LAYOUT_END)
+			closed++;
+		else if (closed == 0)
+			break;
+		else
+		{
+			open->size += layout->right_total;
+			if (open->kind == LAYOUT_BEGIN)
+				closed--;
+		}
+		layout->scan_top--;
+	}
+
+	if (layout->scan_top == layout->scan_bottom)
+	{
+		layout->scan_bottom = layout->scan_top = 0;
+		advance_left(layout, 0);
+	}
+}
+
+/*
+ * layout_flush - Print everything still buffered
+ * @layout: Layout engine
+ *
+ * Whatever is still undecided fits on the current line, otherwise it
+ * would already have been forced out.
+ */
+void layout_flush(Layout *layout)
+{
+	long pos;
+
+	for (pos = layout->left; pos < layout->right; pos++)
+	{
+		LayoutToken *token = token_at(layout, pos);
+
+		if (token->size < 0)
+			token->size = 0;
+	}
+	layout->scan_bottom = layout->scan_top = 0;
+	advance_left(layout, 1);
+	layout->left = layout->right = 0;
+	layout->left_total = layout->right_total = 1;
+}
+
+/*
+ * layout_lines - Add text that may contain hard line breaks
+ * @layout: Layout engine
+ * @text: Text (must stay valid until printed)
+ * @length: Length of @text
+ *
+ * A hard line break settles everything before it, so text containing one
+ * is written in a single piece. Open groups stay open, so their
+ * continuation column still applies after it.
+ */
+void layout_lines(Layout *layout, const char *text, size_t length)
+{
+	const char *last;
+
+	last = length ? memrchr(text, '\n', length) : NULL;
+	if (!last)
+	{
+		layout_text(layout, text, length);
+		return;
+	}
+
+	layout_flush(layout);
+	layout->write(layout->write_ctx, text, length);
+	last++;
+	layout->space = layout->width -
+		text_width(layout, last, (int)(text + length - last), 0);
+	layout->line_indent = 0;
+	layout->line_blank = 1;
+	track_indent(layout, last, (int)(text + length - last), 0);
+}
+
+/*
+ * Printing
+ */
+
+static void check_stream(Layout *layout)
+{
+	long left;
+
+	while (layout->right_total - layout->left_total > layout->space)
+	{
+		if (layout->scan_top > layout->scan_bottom &&
+		    layout->scan[layout->scan_bottom] == layout->left)
+		{
+			token_at(layout, layout->left)->size = LAYOUT_INFINITY;
+			layout->scan_bottom++;
+			if (layout->scan_bottom == layout->scan_top)
+				layout->scan_bottom = layout->scan_top = 0;
+		}
+
+		left = layout->left;
+		advance_left(layout, 0);
+		if (layout->left == layout->right || layout->left == left)
+			break;
+	}
+}
+
+/*
+ * advance_left - Print buffered tokens whose layout is decided
+ * @layout: Layout engine
+ * @flush: Nothing more follows on the line
+ *
+ * A line break waits until the text after it is known to fit at its
+ * group's column or not (see print_token()), which takes at most a line
+ * of lookahead.
+ */
+static void advance_left(Layout *layout, int flush)
+{
+	LayoutBlock *block;
+	int width, complete;
+
+	while (layout->left < layout->right)
+	{
+		LayoutToken *token = token_at(layout, layout->left);
+
+		if (token->size < 0)
+			break;
+		if (token->kind == LAYOUT_BREAK && !flush)
+		{
+			block = breaking_block(layout, token);
+			width = segment_width(layout, &complete);
+			if (block && !complete &&
+			    block->indent + width <= layout->width)
+				break;
+		}
+
+		print_token(layout, token);
+		if (token->kind == LAYOUT_TEXT || token->kind == LAYOUT_BREAK)
+			layout->left_total += token->kind == LAYOUT_TEXT ?
+				token->size : token->length;
+		layout->left++;
+	}
+}
+
+static void print_token(Layout *layout, LayoutToken *token)
+{
+	LayoutBlock *block;
+	int col = layout->width - layout->space;
+
+	switch (token->kind)
+	{
+	case LAYOUT_TEXT:
+		layout->write(layout->write_ctx, token->text, token->length);
+		layout->space -= text_width(layout, token->text, token->length,
+					    col);
+		if (layout->line_blank)
+			track_indent(layout, token->text, token->length, col);
+		break;
+
+	case LAYOUT_BEGIN:
+		if (layout->block_count >= layout->block_capacity)
+		{
+			int new_capacity = layout->block_capacity * 2;
+			LayoutBlock *new_blocks = mem_realloc(layout->blocks,
+				sizeof(LayoutBlock) * new_capacity, MEM_FORMATTER);
+
+			if (!new_blocks)
+			{
+				fail(layout);
+				return;
+			}
+			layout->blocks = new_blocks;
+			layout->block_capacity = new_capacity;
+		}
+		block = &layout->blocks[layout->block_count++];
+		block->indent = col;
+		block->broken = token->size > layout->space;
+		break;
+
+	case LAYOUT_END:
+		if (layout->block_count > 0)
+			layout->block_count--;
+		break;
+
+	case LAYOUT_BREAK:
+		block = breaking_block(layout, token);
+		if (block)
+		{
+			/* No room at the group's column: indent one level */
+			if (block->indent + segment_width(layout, NULL) >
+			    layout->width &&
+			    layout->line_indent + layout->tab_width < block->indent)
+				block->indent = layout->line_indent +
+					layout->tab_width;
+			layout->write(layout->write_ctx, "\n", 1);
+			if (layout->use_tabs)
+			{
+				write_fill(layout, fill_tabs,
+					   block->indent / layout->tab_width);
+				write_fill(layout, fill_spaces,
+					   block->indent % layout->tab_width);
+			}
+			else
+			{
+				write_fill(layout, fill_spaces, block->indent);
+			}
+			layout->space = layout->width - block->indent;
+		}
+		else
+		{
+			write_fill(layout, fill_spaces, token->length);
+			layout->space -= token->length;
+		}
+		break;
+	}
+}
+
+/*
+ * Helpers
+ */
+
+static LayoutToken *token_at(Layout *layout, long pos)
+{
+	return (&layout->ring[pos & (layout->ring_capacity - 1)]);
+}
+
+/*
+ * add_token - Append a token to the ring of undecided tokens
+ * @layout: Layout engine
+ * @kind: Token kind
+ * @text: Text (LAYOUT_TEXT only)
+ * @length: Text length or blank width
+ * @size: Initial size
+ *
+ * Return: Stream position of the token, or -1 on error
+ */
+static long add_token(Layout *layout, LayoutKind kind, const char *text,
+		      int length, int size)
+{
+	LayoutToken *token;
+
+	if (layout->right - layout->left >= layout->ring_capacity)
+	{
+		int new_capacity = layout->ring_capacity * 2;
+		LayoutToken *new_ring;
+		long pos;
+
+		new_ring = mem_alloc(sizeof(LayoutToken) * new_capacity,
+				     MEM_FORMATTER);
+		if (!new_ring)
+		{
+			fail(layout);
+			return (-1);
+		}
+		for (pos = layout->left; pos < layout->right; pos++)
+			new_ring[pos & (new_capacity - 1)] = *token_at(layout, pos);
+		mem_free(layout->ring);
+		layout->ring = new_ring;
+		layout->ring_capacity = new_capacity;
+	}
+
+	token = token_at(layout, layout->right);
+	token->kind = kind;
+	token->text = text;
+	token->length = length;
+	token->size = size;
+
+	return (layout->right++);
+}
+
+static void scan_push(Layout *layout, long pos)
+{
+	if (layout->scan_top >= layout->scan_capacity)
+	{
+		if (layout->scan_bottom > 0)
+		{
+			/* Reclaim entries popped from the bottom */
+			memmove(layout->scan, layout->scan + layout->scan_bottom,
+				sizeof(long) *
+				(layout->scan_top - layout->scan_bottom));
+			layout->scan_top -= layout->scan_bottom;
+			layout->scan_bottom = 0;
+		}
+		else
+		{
+			int new_capacity = layout->scan_capacity * 2;
+			long *new_scan = mem_realloc(layout->scan,
+				sizeof(long) * new_capacity, MEM_FORMATTER);
+
+			if (!new_scan)
+			{
+				fail(layout);
+				return;
+			}
+			layout->scan = new_scan;
+			layout->scan_capacity = new_capacity;
+		}
+	}
+
+	layout->scan[layout->scan_top++] = pos;
+}
+
+static void write_fill(Layout *layout, const char *fill, int count)
+{
+	while (count > FILL_CHUNK)
+	{
+		layout->write(layout->write_ctx, fill, FILL_CHUNK);
+		count -= FILL_CHUNK;
+	}
+	if (count > 0)
+		layout->write(layout->write_ctx, fill, count);
+}
+
+/*
+ * text_width - Columns taken by text starting at a given column
+ */
+static int text_width(Layout *layout, const char *text, int length, int col)
+{
+	int i, end = col;
+
+	if (!memchr(text, '\t', length))
+		return (length);
+
+	for (i = 0; i < length; i++)
+	{
+		if (text[i] == '\t')
+			end += layout->tab_width - (end % layout->tab_width);
+		else
+			end++;
+	}
+
+	return (end - col);
+}
+
+/*
+ * track_indent - Extend the current line's indentation by printed text
+ * @layout: Layout engine
+ * @text: Text printed while the line held nothing but blanks
+ * @length: Length of @text
+ * @col: Column the text starts at
+ */
+static void track_indent(Layout *layout, const char *text, int length,
+			 int col)
+{
+	int i = 0;
+
+	while (i < length && (text[i] == ' ' || text[i] == '\t'))
+		i++;
+	layout->line_indent = col + text_width(layout, text, i, col);
+	if (i < length)
+		layout->line_blank = 0;
+}
+
+/*
+ * segment_width - Width of the text after the break being printed
+ * @layout: Layout engine
+ * @complete: If not NULL, set to whether a later break is buffered
+ *
+ * The text up to the next break of any group, which the line needs
+ * whichever breaks are taken (a forced break has no exact size). Only
+ * buffered text is counted.
+ *
+ * Return: Width in columns
+ */
+static int segment_width(Layout *layout, int *complete)
+{
+	long pos;
+	int width = 0;
+
+	if (complete)
+		*complete = 0;
+	for (pos = layout->left + 1; pos < layout->right; pos++)
+	{
+		LayoutToken *token = token_at(layout, pos);
+
+		if (token->kind == LAYOUT_BREAK)
+		{
+			if (complete)
+				*complete = 1;
+			break;
+		}
+		if (token->kind == LAYOUT_TEXT)
+			width += token->size;
+	}
+
+	return (width);
+}
+
+/*
+ * breaking_block - Find whether a break is printed as a newline
+ * @layout: Layout engine
+ * @token: Decided break at the left end of the buffer
+ *
+ * Return: The group it breaks, or NULL if it prints as a blank
+ */
+static LayoutBlock *breaking_block(Layout *layout, LayoutToken *token)
+{
+	LayoutBlock *block;
+
+	if (layout->block_count == 0)
+		return (NULL);
+	block = &layout->blocks[layout->block_count - 1];
+	if (!block->broken || token->size <= layout->space ||
+	    block->indent >= layout->width - layout->space)
+		return (NULL);
+
+	return (block);
+}
+
+/*
+ * idle - Whether nothing is buffered or undecided
+ */
+static int idle(Layout *layout)
+{
+	return (layout->scan_top == layout->scan_bottom &&
+		layout->left == layout->right);
+}
+
+/*
+ * fail - Give up on layout after an allocation error
+ * @layout: Layout engine
+ *
+ * Buffered tokens are printed flat and later ones go straight through,
+ * so no output is lost.
+ */
+static void fail(Layout *layout)
+{
+	if (layout->failed)
+		return;
+
+	layout->failed = 1;
+	layout_flush(layout);
+}
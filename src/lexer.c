@@ -1,6 +1,7 @@
 #define _POSIX_C_SOURCE 200809L
 #include "../include/lexer.h"
 #include "../include/utils.h"
+#include "../include/stats.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -19,6 +20,7 @@ static void scan_number(Lexer *lexer);
 static void scan_string(Lexer *lexer);
 static void scan_char(Lexer *lexer);
 static void scan_comment(Lexer *lexer);
+static void skip_comment_text(Lexer *lexer, int block);
 static void scan_preprocessor(Lexer *lexer);
 static TokenType keyword_type(const char *text);
 
@@ -35,14 +37,14 @@ Lexer *lexer_create(const char *source)
 	if (!source)
 		return (NULL);
 
-	lexer = malloc(sizeof(Lexer));
+	lexer = mem_alloc(sizeof(Lexer), MEM_LEXER);
 	if (!lexer)
 		return (NULL);
 
-	lexer->source = strdup(source);
+	lexer->source = mem_strdup(source, MEM_LEXER);
 	if (!lexer->source)
 	{
-		free(lexer);
+		mem_free(lexer);
 		return (NULL);
 	}
 
@@ -54,15 +56,18 @@ Lexer *lexer_create(const char *source)
 	lexer->last_column = 1;
 
 	lexer->token_capacity = 256;
-	lexer->tokens = malloc(sizeof(Token *) * lexer->token_capacity);
+	lexer->tokens = mem_alloc(sizeof(Token *) * lexer->token_capacity,
+				  MEM_LEXER);
 	if (!lexer->tokens)
 	{
-		free(lexer->source);
-		free(lexer);
+		mem_free(lexer->source);
+		mem_free(lexer);
 		return (NULL);
 	}
 
 	lexer->token_count = 0;
+	lexer->streamed = 0;
+	lexer->stream_ended = 0;
 	lexer->error_count = 0;
 
 	return (lexer);
@@ -79,12 +84,12 @@ void lexer_destroy(Lexer *lexer)
 	if (!lexer)
 		return;
 
-	for (i = 0; i < lexer->token_count; i++)
+	for (i = lexer->streamed; i < lexer->token_count; i++)
 		token_destroy(lexer->tokens[i]);
 
-	free(lexer->tokens);
-	free(lexer->source);
-	free(lexer);
+	mem_free(lexer->tokens);
+	mem_free(lexer->source);
+	mem_free(lexer);
 }
 
 /*
@@ -179,15 +184,14 @@ static int add_token(Lexer *lexer, TokenType type, int start, int length)
 	Token *token;
 	Token **new_tokens;
 	int new_capacity;
-	char *lexeme;
 	int line = lexer->last_line;
 	int column = lexer->last_column;
 
 	if (lexer->token_count >= lexer->token_capacity)
 	{
 		new_capacity = lexer->token_capacity * 2;
-		new_tokens = realloc(lexer->tokens,
-				     sizeof(Token *) * new_capacity);
+		new_tokens = mem_realloc(lexer->tokens,
+				     sizeof(Token *) * new_capacity, MEM_LEXER);
 		if (!new_tokens)
 			return (-1);
 
@@ -195,18 +199,11 @@ static int add_token(Lexer *lexer, TokenType type, int start, int length)
 		lexer->token_capacity = new_capacity;
 	}
 
-	lexeme = malloc(length + 1);
-	if (!lexeme)
-		return (-1);
-
-	memcpy(lexeme, &lexer->source[start], length);
-	lexeme[length] = '\0';
-
-	token = token_create(type, lexeme, line, column);
-	free(lexeme);
-
+	token = token_create_len(type, &lexer->source[start], length,
+				 line, column);
 	if (!token)
 		return (-1);
+	token->offset = start;
 
 	lexer->tokens[lexer->token_count++] = token;
 	return (0);
@@ -283,7 +280,7 @@ static void scan_identifier(Lexer *lexer)
 		advance(lexer);
 
 	length = lexer->pos - start;
-	text = malloc(length + 1);
+	text = mem_alloc(length + 1, MEM_LEXER);
 	if (!text)
 	{
 		lexer->error_count++;
@@ -294,7 +291,7 @@ static void scan_identifier(Lexer *lexer)
 	text[length] = '\0';
 
 	type = keyword_type(text);
-	free(text);
+	mem_free(text);
 
 	add_token(lexer, type, start, length);
 }
@@ -461,6 +458,62 @@ static void scan_char(Lexer *lexer)
 	add_token(lexer, TOK_CHAR, start, lexer->pos - start);
 }
 
+/*
+ * skip_comment_text - Consume the body of a comment in one step
+ * @lexer: Lexer instance
+ * @block: 1 for a block comment (ends after the closing star-slash),
+ *         0 for a line comment (ends before the newline)
+ *
+ * The end is found with memchr instead of a peek/advance loop per byte.
+ * Line, column and the last-character position come out the same as if
+ * each character had been advanced over.
+ */
+static void skip_comment_text(Lexer *lexer, int block)
+{
+	const char *cur = lexer->source + lexer->pos;
+	const char *limit = lexer->source + lexer->source_len;
+	const char *stop = limit;
+	const char *star = cur;
+	const char *nl;
+	const char *last_nl = NULL;
+
+	if (!block)
+	{
+		nl = memchr(cur, '\n', limit - cur);
+		if (nl)
+			stop = nl;
+	}
+	else
+	{
+		while ((star = memchr(star, '*', limit - star)) != NULL)
+		{
+			if (star + 1 < limit && star[1] == '/')
+			{
+				stop = star + 2;
+				break;
+			}
+			star++;
+		}
+
+		for (nl = cur; (nl = memchr(nl, '\n', stop - nl)) != NULL; nl++)
+		{
+			lexer->line++;
+			last_nl = nl;
+		}
+	}
+
+	if (stop == cur)
+		return;
+
+	if (last_nl)
+		lexer->column = 1 + (stop - (last_nl + 1));
+	else
+		lexer->column += stop - cur;
+	lexer->pos = stop - lexer->source;
+	lexer->last_line = lexer->line;
+	lexer->last_column = lexer->column - 1;
+}
+
 /*
  * scan_comment - Scan line or block comment
  * @lexer: Lexer instance
@@ -478,9 +531,7 @@ static void scan_comment(Lexer *lexer)
 		type = TOK_COMMENT_LINE;
 		advance(lexer); /* consume second / */
 
-		while (!is_at_end(lexer) && peek(lexer) != '\n')
-			advance(lexer);
-
+		skip_comment_text(lexer, 0);
 		add_token(lexer, type, start, lexer->pos - start);
 	}
 	else if (peek(lexer) == '*')
@@ -489,24 +540,7 @@ static void scan_comment(Lexer *lexer)
 		type = TOK_COMMENT_BLOCK;
 		advance(lexer); /* consume * */
 
-		while (!is_at_end(lexer))
-		{
-			if (peek(lexer) == '*' && peek_next(lexer) == '/')
-			{
-				advance(lexer); /* consume * */
-				advance(lexer); /* consume / */
-				break;
-			}
-
-			if (peek(lexer) == '\n')
-			{
-				lexer->line++;
-				lexer->column = 0;
-			}
-
-			advance(lexer);
-		}
-
+		skip_comment_text(lexer, 1);
 		add_token(lexer, type, start, lexer->pos - start);
 	}
 	else if (peek(lexer) == '=')
@@ -799,6 +833,54 @@ int lexer_tokenize(Lexer *lexer)
 	return (lexer->error_count > 0 ? -1 : 0);
 }
 
+/*
+ * lexer_next - Scan the next token without keeping it
+ * @lexer: Lexer instance (not also used with lexer_tokenize())
+ *
+ * Memory stays bounded by the largest token rather than growing with
+ * the file: the token array only holds what one scan step produced.
+ * The last token returned is TOK_EOF.
+ *
+ * Return: Token for the caller to destroy, or NULL after TOK_EOF or on a
+ * lexical error
+ */
+Token *lexer_next(Lexer *lexer)
+{
+	Token *token;
+
+	if (!lexer)
+		return (NULL);
+
+	while (lexer->streamed >= lexer->token_count)
+	{
+		/* Every token so far was handed out; reuse the array */
+		lexer->token_count = 0;
+		lexer->streamed = 0;
+		if (lexer->stream_ended || lexer->error_count > 0)
+			return (NULL);
+
+		if (is_at_end(lexer))
+		{
+			if (add_token(lexer, TOK_EOF, lexer->pos, 0) < 0)
+				return (NULL);
+		}
+		else
+		{
+			int start = lexer->pos;
+
+			scan_token(lexer);
+			/* A step that neither moved nor produced ran out of memory */
+			if (lexer->pos == start && lexer->token_count == 0)
+				return (NULL);
+		}
+	}
+
+	token = lexer->tokens[lexer->streamed++];
+	if (token->type == TOK_EOF)
+		lexer->stream_ended = 1;
+	return (token);
+}
+
 /*
  * lexer_get_tokens - Get token array
  * @lexer: Lexer instance
@@ -0,0 +1,336 @@
+#include "../include/lint.h"
+#include "../include/stats.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_LINT_CAPACITY 32
+#define TAB_WIDTH 8
+
+/*
+ * lint_report_create - Create an empty lint report
+ *
+ * Return: Pointer to new report, or NULL on failure
+ */
+LintReport *lint_report_create(void)
+{
+	return (mem_calloc(1, sizeof(LintReport), MEM_OUTPUT));
+}
+
+/*
+ * lint_report_destroy - Free lint report memory
+ * @report: Report to destroy
+ */
+void lint_report_destroy(LintReport *report)
+{
+	if (!report)
+		return;
+
+	mem_free(report->items);
+	mem_free(report);
+}
+
+/*
+ * lint_add - Record a diagnostic
+ * @report: Lint report
+ * @line: Line of the input
+ * @column: Byte column of the input
+ * @format: printf format of the message
+ */
+static void lint_add(LintReport *report, int line, int column,
+		     const char *format, ...)
+{
+	LintDiagnostic *item;
+	va_list args;
+
+	if (report->failed)
+		return;
+
+	if (report->count >= report->capacity)
+	{
+		int new_capacity = report->capacity == 0 ?
+			INITIAL_LINT_CAPACITY : report->capacity * 2;
+		LintDiagnostic *new_items = mem_realloc(report->items,
+			sizeof(LintDiagnostic) * new_capacity, MEM_OUTPUT);
+
+		if (!new_items)
+		{
+			report->failed = 1;
+			return;
+		}
+		report->items = new_items;
+		report->capacity = new_capacity;
+	}
+
+	item = &report->items[report->count++];
+	item->line = line;
+	item->column = column;
+	va_start(args, format);
+	vsnprintf(item->message, sizeof(item->message), format, args);
+	va_end(args);
+}
+
+/*
+ * check_line_lengths - Report lines wider than LINT_MAX_COLUMNS
+ * @report: Lint report
+ * @tokens: Tokens of the file (lossless, so their text is the file)
+ * @token_count: Number of tokens
+ *
+ * Tabs advance to the next multiple of TAB_WIDTH; UTF-8 continuation
+ * bytes and carriage returns take no width. The diagnostic points at the
+ * first byte past the limit.
+ */
+static void check_line_lengths(LintReport *report, Token **tokens,
+			       int token_count)
+{
+	int line = 1, column = 0, width = 0, over = 0;
+	int i, j;
+
+	for (i = 0; i < token_count; i++)
+	{
+		const char *text = tokens[i]->lexeme;
+
+		for (j = 0; text && j < tokens[i]->length; j++)
+		{
+			unsigned char c = (unsigned char)text[j];
+
+			if (c == '\n')
+			{
+				if (width > LINT_MAX_COLUMNS)
+					lint_add(report, line, over,
+						 "line over %d columns (%d)",
+						 LINT_MAX_COLUMNS, width);
+				line++;
+				column = 0;
+				width = 0;
+				over = 0;
+				continue;
+			}
+			column++;
+			if (c == '\t')
+				width += TAB_WIDTH - width % TAB_WIDTH;
+			else if ((c & 0xC0) != 0x80 && c != '\r')
+				width++;
+			if (width > LINT_MAX_COLUMNS && over == 0)
+				over = column;
+		}
+	}
+	if (width > LINT_MAX_COLUMNS)
+		lint_add(report, line, over, "line over %d columns (%d)",
+			 LINT_MAX_COLUMNS, width);
+}
+
+/*
+ * find_body - Find the braces of a function definition's body
+ * @tokens: Tokens of the file
+ * @token_count: Number of tokens
+ * @func: NODE_FUNCTION with a body
+ * @open: Gets the index of the opening brace
+ * @close: Gets the index of the matching closing brace
+ *
+ * Return: 0 on success, -1 if the braces are not in the token stream
+ */
+static int find_body(Token **tokens, int token_count, ASTNode *func,
+		     int *open, int *close)
+{
+	int start = 0, end = token_count;
+	int i, depth = 0;
+
+	/* Top-level items know their span; otherwise search the file */
+	if (func->token_end > func->token_start &&
+	    func->token_end <= token_count)
+	{
+		start = func->token_start;
+		end = func->token_end;
+	}
+	i = start;
+	while (i < end && tokens[i] != func->token)
+		i++;
+	while (i < end && tokens[i]->type != TOK_LBRACE)
+		i++;
+	*open = i;
+
+	for (; i < end; i++)
+	{
+		if (tokens[i]->type == TOK_LBRACE)
+			depth++;
+		else if (tokens[i]->type == TOK_RBRACE && --depth == 0)
+		{
+			*close = i;
+			return (0);
+		}
+	}
+
+	return (-1);
+}
+
+/*
+ * check_functions - Report long functions and too many of them
+ * @report: Lint report
+ * @tokens: Tokens of the file
+ * @token_count: Number of tokens
+ * @program: Program node
+ *
+ * A function's length is the number of lines between the lines of its
+ * braces. Prototypes do not count towards the number of functions.
+ */
+static void check_functions(LintReport *report, Token **tokens,
+			    int token_count, ASTNode *program)
+{
+	int defined = 0;
+	int i, open, close, lines;
+
+	for (i = 0; i < program->child_count; i++)
+	{
+		ASTNode *func = program->children[i];
+
+		if (func->type != NODE_FUNCTION || func->child_count == 0 ||
+		    !func->token)
+			continue;
+
+		if (++defined == LINT_MAX_FUNCTIONS + 1)
+			lint_add(report, func->token->line,
+				 token_start_column(func->token),
+				 "more than %d functions in the file",
+				 LINT_MAX_FUNCTIONS);
+
+		if (find_body(tokens, token_count, func, &open, &close) != 0)
+			continue;
+		lines = tokens[close]->line - tokens[open]->line - 1;
+		if (lines > LINT_MAX_FUNCTION_LINES)
+			lint_add(report, func->token->line,
+				 token_start_column(func->token),
+				 "function '%s' has %d lines (more than %d)",
+				 func->token->lexeme, lines,
+				 LINT_MAX_FUNCTION_LINES);
+	}
+}
+
+/*
+ * is_declaration - Whether a block item declares rather than executes
+ */
+static int is_declaration(const ASTNode *node)
+{
+	switch (node->type)
+	{
+	case NODE_VAR_DECL:
+	case NODE_STRUCT:
+	case NODE_TYPEDEF:
+	case NODE_ENUM:
+	case NODE_FUNC_PTR:
+		return (1);
+	default:
+		return (0);
+	}
+}
+
+/*
+ * check_block - Report declarations that follow statements in a block
+ * @node: Node entered by the walk
+ * @depth: Depth of the node (unused)
+ * @ctx: Lint report
+ *
+ * Return: AST_WALK_CONTINUE
+ */
+static ASTWalkAction check_block(ASTNode *node, int depth, void *ctx)
+{
+	LintReport *report = ctx;
+	int i, statements = 0;
+
+	(void)depth;
+	if (node->type != NODE_BLOCK)
+		return (AST_WALK_CONTINUE);
+
+	for (i = 0; i < node->child_count; i++)
+	{
+		ASTNode *child = node->children[i];
+
+		/* Directives and unparsed text neither declare nor execute */
+		if (child->type == NODE_PREPROCESSOR ||
+		    child->type == NODE_UNPARSED)
+			continue;
+		if (!is_declaration(child))
+			statements++;
+		else if (statements > 0 && child->token)
+			lint_add(report, child->token->line,
+				 token_start_column(child->token),
+				 "declaration after a statement");
+	}
+
+	return (AST_WALK_CONTINUE);
+}
+
+/*
+ * compare_diagnostics - qsort order: line, column, then message
+ */
+static int compare_diagnostics(const void *a, const void *b)
+{
+	const LintDiagnostic *x = a, *y = b;
+
+	if (x->line != y->line)
+		return (x->line < y->line ? -1 : 1);
+	if (x->column != y->column)
+		return (x->column < y->column ? -1 : 1);
+	return (strcmp(x->message, y->message));
+}
+
+/*
+ * lint_check - Check a parsed file against the Betty rules
+ * @report: Lint report to fill
+ * @tokens: Tokens the AST was parsed from
+ * @token_count: Number of tokens
+ * @ast: Program node
+ *
+ * Checks line lengths, function lengths, the number of functions and
+ * declarations mixed with code, using the parse the formatter works
+ * from rather than one of its own.
+ *
+ * Return: Number of diagnostics, or -1 on allocation failure
+ */
+int lint_check(LintReport *report, Token **tokens, int token_count,
+	       ASTNode *ast)
+{
+	ASTVisitor visitor = {check_block, NULL, NULL};
+
+	if (!report || !ast)
+		return (-1);
+
+	visitor.ctx = report;
+	check_line_lengths(report, tokens, token_count);
+	check_functions(report, tokens, token_count, ast);
+	ast_walk(ast, &visitor, 1);
+
+	if (report->failed)
+		return (-1);
+	if (report->count > 1)
+		qsort(report->items, report->count, sizeof(LintDiagnostic),
+		      compare_diagnostics);
+
+	return (report->count);
+}
+
+/*
+ * lint_report_write - Print the diagnostics of a file
+ * @report: Checked lint report
+ * @source_path: File the positions refer to
+ * @fp: Stream
+ *
+ * One "file:line:col: lint: message" line per diagnostic.
+ *
+ * Return: Number of diagnostics written, or -1 on error
+ */
+int lint_report_write(const LintReport *report, const char *source_path,
+		      FILE *fp)
+{
+	int i;
+
+	if (!report || report->failed)
+		return (-1);
+
+	for (i = 0; i < report->count; i++)
+		fprintf(fp, "%s:%d:%d: lint: %s\n", source_path,
+			report->items[i].line, report->items[i].column,
+			report->items[i].message);
+
+	return (ferror(fp) ? -1 : report->count);
+}
@@ -0,0 +1,1017 @@
+#define _GNU_SOURCE
+#include "../include/lsp.h"
+#include "../include/formatter.h"
+#include "../include/json.h"
+#include "../include/sink.h"
+#include "../include/stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define MAX_HEADER_LINE 256
+#define INITIAL_LINE_CAPACITY 256
+
+/* JSON-RPC error codes */
+#define RPC_PARSE_ERROR -32700
+#define RPC_INVALID_REQUEST -32600
+#define RPC_METHOD_NOT_FOUND -32601
+#define RPC_INVALID_PARAMS -32602
+#define RPC_SERVER_NOT_INITIALIZED -32002
+
+/*
+ * Method handler
+ * Writes the result of a request to @result (discarded for
+ * notifications). Returns 0 on success or a JSON-RPC error code.
+ */
+typedef int (*LspHandler)(LspServer *server, const JsonValue *params,
+			  FILE *result);
+
+typedef struct {
+	const char *method;
+	LspHandler handler;
+} LspMethod;
+
+static int handle_initialize(LspServer *server, const JsonValue *params,
+			     FILE *result);
+static int handle_initialized(LspServer *server, const JsonValue *params,
+			      FILE *result);
+static int handle_shutdown(LspServer *server, const JsonValue *params,
+			   FILE *result);
+static int handle_exit(LspServer *server, const JsonValue *params,
+		       FILE *result);
+static int handle_did_open(LspServer *server, const JsonValue *params,
+			   FILE *result);
+static int handle_did_change(LspServer *server, const JsonValue *params,
+			     FILE *result);
+static int handle_did_close(LspServer *server, const JsonValue *params,
+			    FILE *result);
+static int handle_formatting(LspServer *server, const JsonValue *params,
+			     FILE *result);
+static int handle_range_formatting(LspServer *server,
+				   const JsonValue *params, FILE *result);
+static int handle_on_type_formatting(LspServer *server,
+				     const JsonValue *params, FILE *result);
+
+static const LspMethod methods[] = {
+	{"initialize", handle_initialize},
+	{"initialized", handle_initialized},
+	{"shutdown", handle_shutdown},
+	{"exit", handle_exit},
+	{"textDocument/didOpen", handle_did_open},
+	{"textDocument/didChange", handle_did_change},
+	{"textDocument/didClose", handle_did_close},
+	{"textDocument/formatting", handle_formatting},
+	{"textDocument/rangeFormatting", handle_range_formatting},
+	{"textDocument/onTypeFormatting", handle_on_type_formatting},
+	{NULL, NULL}
+};
+
+/*
+ * read_message - Read the next message body from the client
+ * @server: Server instance
+ * @length: Set to the body length
+ *
+ * Messages are a "Content-Length: N" header block, an empty line and N
+ * bytes of JSON. Other headers are ignored.
+ *
+ * Return: 0 on success, -1 at end of input or on a malformed header
+ */
+static int read_message(LspServer *server, size_t *length)
+{
+	char line[MAX_HEADER_LINE];
+	long content_length = -1;
+
+	while (fgets(line, sizeof(line), server->in))
+	{
+		if (strcmp(line, "\r\n") == 0 || strcmp(line, "\n") == 0)
+		{
+			if (content_length < 0)
+				return (-1);
+			break;
+		}
+		if (strncasecmp(line, "Content-Length:", 15) == 0)
+			content_length = strtol(line + 15, NULL, 10);
+	}
+	if (content_length < 0)
+		return (-1);
+
+	if ((size_t)content_length + 1 > server->body_capacity)
+	{
+		char *body = mem_realloc(server->body, content_length + 1,
+					 MEM_SERVER);
+
+		if (!body)
+			return (-1);
+		server->body = body;
+		server->body_capacity = content_length + 1;
+	}
+
+	if (fread(server->body, 1, content_length, server->in) !=
+	    (size_t)content_length)
+		return (-1);
+	server->body[content_length] = '\0';
+	*length = content_length;
+
+	return (0);
+}
+
+/*
+ * send_message - Write a message to the client
+ * @server: Server instance
+ * @body: JSON text
+ * @length: Length of @body
+ */
+static void send_message(LspServer *server, const char *body, size_t length)
+{
+	fprintf(server->out, "Content-Length: %lu\r\n\r\n",
+		(unsigned long)length);
+	fwrite(body, 1, length, server->out);
+	fflush(server->out);
+}
+
+/*
+ * error_text - Describe a JSON-RPC error code
+ * @code: Error code
+ *
+ * Return: Message text
+ */
+static const char *error_text(int code)
+{
+	switch (code)
+	{
+	case RPC_PARSE_ERROR:
+		return ("parse error");
+	case RPC_INVALID_REQUEST:
+		return ("invalid request");
+	case RPC_METHOD_NOT_FOUND:
+		return ("method not found");
+	case RPC_INVALID_PARAMS:
+		return ("invalid params");
+	case RPC_SERVER_NOT_INITIALIZED:
+		return ("server not initialized");
+	default:
+		return ("internal error");
+	}
+}
+
+/*
+ * send_response - Answer a request
+ * @server: Server instance
+ * @id: Request id (NULL when it could not be read)
+ * @code: 0 for a result, otherwise a JSON-RPC error code
+ * @result: Result JSON (used when @code is 0)
+ * @length: Length of @result
+ */
+static void send_response(LspServer *server, const JsonValue *id, int code,
+			  const char *result, size_t length)
+{
+	char *buffer = NULL;
+	size_t size = 0;
+	FILE *fp = open_memstream(&buffer, &size);
+
+	if (!fp)
+		return;
+
+	fputs("{\"jsonrpc\":\"2.0\",\"id\":", fp);
+	if (id)
+		json_write_value(fp, id);
+	else
+		fputs("null", fp);
+
+	if (code == 0)
+	{
+		fputs(",\"result\":", fp);
+		if (length > 0)
+			fwrite(result, 1, length, fp);
+		else
+			fputs("null", fp);
+	}
+	else
+	{
+		const char *message = error_text(code);
+
+		fprintf(fp, ",\"error\":{\"code\":%d,\"message\":", code);
+		json_write_string(fp, message, strlen(message));
+		fputc('}', fp);
+	}
+	fputc('}', fp);
+
+	if (fclose(fp) == 0)
+		send_message(server, buffer, size);
+	free(buffer);
+}
+
+/*
+ * log_message - Send a line to the client's log (window/logMessage)
+ * @server: Server instance
+ * @text: Message text
+ */
+static void log_message(LspServer *server, const char *text)
+{
+	char *buffer = NULL;
+	size_t size = 0;
+	FILE *fp = open_memstream(&buffer, &size);
+
+	if (!fp)
+		return;
+
+	fputs("{\"jsonrpc\":\"2.0\",\"method\":\"window/logMessage\","
+	      "\"params\":{\"type\":4,\"message\":", fp);
+	json_write_string(fp, text, strlen(text));
+	fputs("}}", fp);
+
+	if (fclose(fp) == 0)
+		send_message(server, buffer, size);
+	free(buffer);
+}
+
+/*
+ * handle_message - Dispatch one request or notification
+ * @server: Server instance
+ * @message: Parsed message
+ */
+static void handle_message(LspServer *server, const JsonValue *message)
+{
+	const JsonValue *id = json_get(message, "id");
+	const char *method = json_string(json_get(message, "method"));
+	const LspMethod *entry;
+	char *result = NULL;
+	size_t length = 0;
+	FILE *fp;
+	int code;
+
+	/* Responses to server requests (none are sent) */
+	if (!method)
+	{
+		if (id && !json_get(message, "result") &&
+		    !json_get(message, "error"))
+			send_response(server, id, RPC_INVALID_REQUEST, NULL, 0);
+		return;
+	}
+
+	for (entry = methods; entry->method; entry++)
+		if (strcmp(entry->method, method) == 0)
+			break;
+
+	if (!entry->handler)
+	{
+		/* Unknown notifications are ignored */
+		if (id)
+			send_response(server, id, RPC_METHOD_NOT_FOUND, NULL, 0);
+		return;
+	}
+
+	if (!server->initialized && entry->handler != handle_initialize &&
+	    entry->handler != handle_exit)
+	{
+		if (id)
+			send_response(server, id, RPC_SERVER_NOT_INITIALIZED,
+				      NULL, 0);
+		return;
+	}
+	if (server->shutdown && entry->handler != handle_exit)
+	{
+		if (id)
+			send_response(server, id, RPC_INVALID_REQUEST, NULL, 0);
+		return;
+	}
+
+	fp = open_memstream(&result, &length);
+	if (!fp)
+		return;
+	code = entry->handler(server, json_get(message, "params"), fp);
+	if (fclose(fp) != 0)
+		length = 0;
+
+	if (id)
+		send_response(server, id, code, result, length);
+	free(result);
+}
+
+/*
+ * find_document - Look up an open document
+ * @server: Server instance
+ * @params: Request parameters holding textDocument.uri
+ *
+ * Return: The document, or NULL if it is not open
+ */
+static LspDocument *find_document(LspServer *server, const JsonValue *params)
+{
+	const char *uri = json_string(json_get(json_get(params,
+		"textDocument"), "uri"));
+	LspDocument *doc;
+
+	if (!uri)
+		return (NULL);
+
+	for (doc = server->documents; doc; doc = doc->next)
+		if (strcmp(doc->uri, uri) == 0)
+			return (doc);
+
+	return (NULL);
+}
+
+/*
+ * release_tree - Drop the tokens, tree and edits of a document
+ * @doc: Document whose text changed
+ *
+ * The per-item cache is kept: declarations that did not change are
+ * reused from it the next time the document is formatted.
+ */
+static void release_tree(LspDocument *doc)
+{
+	ast_node_destroy(doc->ast);
+	parser_destroy(doc->parser);
+	lexer_destroy(doc->lexer);
+	edit_list_destroy(doc->edits);
+	doc->ast = NULL;
+	doc->parser = NULL;
+	doc->lexer = NULL;
+	doc->edits = NULL;
+}
+
+/*
+ * destroy_document - Free a document
+ * @doc: Document to free
+ */
+static void destroy_document(LspDocument *doc)
+{
+	release_tree(doc);
+	cache_close(doc->cache);
+	mem_free(doc->lines);
+	mem_free(doc->text);
+	mem_free(doc->uri);
+	mem_free(doc);
+}
+
+/*
+ * index_lines - Record where each line of a document starts
+ * @doc: Document
+ *
+ * Return: 0 on success, -1 on allocation failure
+ */
+static int index_lines(LspDocument *doc)
+{
+	const char *p = doc->text;
+	const char *end = doc->text + doc->length;
+
+	doc->line_count = 0;
+	for (;;)
+	{
+		if (doc->line_count >= doc->line_capacity)
+		{
+			int new_capacity = doc->line_capacity == 0 ?
+				INITIAL_LINE_CAPACITY : doc->line_capacity * 2;
+			size_t *new_lines = mem_realloc(doc->lines,
+				sizeof(size_t) * new_capacity, MEM_SERVER);
+
+			if (!new_lines)
+				return (-1);
+			doc->lines = new_lines;
+			doc->line_capacity = new_capacity;
+		}
+		doc->lines[doc->line_count++] = p - doc->text;
+
+		p = memchr(p, '\n', end - p);
+		if (!p)
+			break;
+		p++;
+	}
+
+	return (0);
+}
+
+/*
+ * replace_text - Replace a byte range of a document's text
+ * @doc: Document
+ * @start: First replaced byte
+ * @end: End of the replaced bytes
+ * @text: New text
+ * @length: Length of @text
+ *
+ * Return: 0 on success, -1 on allocation failure
+ */
+static int replace_text(LspDocument *doc, size_t start, size_t end,
+			const char *text, size_t length)
+{
+	size_t new_length = doc->length - (end - start) + length;
+
+	if (new_length + 1 > doc->capacity)
+	{
+		size_t new_capacity = doc->capacity ? doc->capacity : 1024;
+		char *new_text;
+
+		while (new_capacity < new_length + 1)
+			new_capacity *= 2;
+		new_text = mem_realloc(doc->text, new_capacity, MEM_SERVER);
+		if (!new_text)
+			return (-1);
+		doc->text = new_text;
+		doc->capacity = new_capacity;
+	}
+
+	/* Move the tail, including the terminating NUL */
+	memmove(doc->text + start + length, doc->text + end,
+		doc->length - end + 1);
+	memcpy(doc->text + start, text, length);
+	doc->length = new_length;
+
+	release_tree(doc);
+
+	return (index_lines(doc));
+}
+
+/*
+ * utf8_length - Length of the UTF-8 sequence a byte starts
+ * @c: Lead byte
+ *
+ * Return: Sequence length (1 for stray continuation bytes)
+ */
+static size_t utf8_length(unsigned char c)
+{
+	if (c >= 0xF0)
+		return (4);
+	if (c >= 0xE0)
+		return (3);
+	if (c >= 0xC0)
+		return (2);
+	return (1);
+}
+
+/*
+ * position_offset - Convert an LSP position to a byte offset
+ * @doc: Document
+ * @position: {"line":N,"character":N} with UTF-16 character units
+ *
+ * Positions past the end of a line or of the document are clamped.
+ *
+ * Return: Byte offset into the document text
+ */
+static size_t position_offset(const LspDocument *doc,
+			      const JsonValue *position)
+{
+	long line = json_long(json_get(position, "line"), 0);
+	long character = json_long(json_get(position, "character"), 0);
+	size_t offset, end;
+	long units = 0;
+
+	if (line < 0)
+		return (0);
+	if (line >= doc->line_count)
+		return (doc->length);
+
+	offset = doc->lines[line];
+	end = line + 1 < doc->line_count ? doc->lines[line + 1] - 1 :
+		doc->length;
+
+	while (offset < end && units < character)
+	{
+		size_t length = utf8_length(doc->text[offset]);
+
+		units += length == 4 ? 2 : 1;
+		offset += length;
+	}
+
+	return (offset < end ? offset : end);
+}
+
+/*
+ * write_position - Write a byte offset as an LSP position
+ * @fp: Output stream
+ * @doc: Document
+ * @offset: Byte offset into the document text
+ */
+static void write_position(FILE *fp, const LspDocument *doc, size_t offset)
+{
+	int low = 0, high = doc->line_count - 1;
+	long units = 0;
+	size_t p;
+
+	/* Last line starting at or before the offset */
+	while (low < high)
+	{
+		int mid = (low + high + 1) / 2;
+
+		if (doc->lines[mid] <= offset)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	for (p = doc->lines[low]; p < offset; p++)
+	{
+		unsigned char c = doc->text[p];
+
+		if ((c & 0xC0) != 0x80)
+			units += c >= 0xF0 ? 2 : 1;
+	}
+
+	fprintf(fp, "{\"line\":%d,\"character\":%ld}", low, units);
+}
+
+/*
+ * parse_document - Bring a document's tokens and tree up to date
+ * @doc: Document
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int parse_document(LspDocument *doc)
+{
+	if (doc->ast)
+		return (0);
+
+	release_tree(doc);
+	doc->lexer = lexer_create(doc->text);
+	if (!doc->lexer || lexer_tokenize(doc->lexer) < 0)
+	{
+		release_tree(doc);
+		return (-1);
+	}
+
+	doc->parser = parser_create(lexer_get_tokens(doc->lexer),
+				    lexer_get_token_count(doc->lexer));
+	if (doc->parser)
+		doc->ast = parser_parse(doc->parser);
+	if (!doc->ast)
+	{
+		release_tree(doc);
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*
+ * format_document - Compute the formatting edits of a document
+ * @server: Server instance
+ * @doc: Document
+ *
+ * Edits are kept until the text changes. Top-level items whose tokens
+ * did not change since the last run are copied from the document's
+ * cache instead of being formatted again.
+ *
+ * Return: Edit list, or NULL on error
+ */
+static EditList *format_document(LspServer *server, LspDocument *doc)
+{
+	OutputSink *sink;
+	Formatter *formatter;
+	EditList *edits;
+	char message[128];
+	int result = -1;
+
+	if (doc->edits)
+		return (doc->edits);
+	if (parse_document(doc) != 0)
+		return (NULL);
+
+	edits = edit_list_create();
+	sink = sink_create_compare(doc->text, doc->length);
+	formatter = sink ? formatter_create(sink) : NULL;
+	if (edits && formatter)
+	{
+		doc->cache->hits = 0;
+		doc->cache->misses = 0;
+		formatter_set_source(formatter, lexer_get_tokens(doc->lexer),
+				     lexer_get_token_count(doc->lexer));
+		formatter_set_cache(formatter, doc->cache);
+		formatter_set_comments(formatter, doc->parser->comments);
+		formatter_set_source_slices(formatter, doc->text, doc->length);
+		formatter_set_edits(formatter, edits);
+		result = formatter_format(formatter, doc->ast);
+	}
+	formatter_destroy(formatter);
+	sink_destroy(sink);
+
+	if (result != 0 || edits->failed)
+	{
+		edit_list_destroy(edits);
+		return (NULL);
+	}
+
+	cache_commit(doc->cache);
+	doc->edits = edits;
+
+	snprintf(message, sizeof(message),
+		 "%s: formatted %d of %d declarations", doc->uri,
+		 doc->cache->misses, doc->cache->hits + doc->cache->misses);
+	log_message(server, message);
+
+	return (edits);
+}
+
+/*
+ * write_edits - Write the edits touching a byte range as TextEdit[]
+ * @fp: Output stream
+ * @doc: Document the edits apply to
+ * @edits: Formatting edits
+ * @start: Start of the range
+ * @end: End of the range
+ */
+static void write_edits(FILE *fp, const LspDocument *doc,
+			const EditList *edits, size_t start, size_t end)
+{
+	int i, written = 0;
+
+	fputc('[', fp);
+	for (i = 0; i < edits->count; i++)
+	{
+		const TextEdit *edit = &edits->edits[i];
+
+		if (edit->offset > end ||
+		    edit->offset + edit->delete_length < start)
+			continue;
+
+		fputs(written++ ? ",{\"range\":{\"start\":" :
+		      "{\"range\":{\"start\":", fp);
+		write_position(fp, doc, edit->offset);
+		fputs(",\"end\":", fp);
+		write_position(fp, doc, edit->offset + edit->delete_length);
+		fputs("},\"newText\":", fp);
+		json_write_string(fp, edits->text + edit->insert,
+				  edit->insert_length);
+		fputc('}', fp);
+	}
+	fputc(']', fp);
+}
+
+/*
+ * item_range - Find the top-level item around a byte offset
+ * @doc: Parsed document
+ * @offset: Byte offset
+ * @start: Set to the start of the item's source text
+ * @end: Set to the end of the item's source text
+ *
+ * An offset between items belongs to the item before it, which is where
+ * the character that triggered on-type formatting was typed.
+ *
+ * Return: 0 on success, -1 if no item starts before @offset
+ */
+static int item_range(const LspDocument *doc, size_t offset, size_t *start,
+		      size_t *end)
+{
+	Token **tokens = lexer_get_tokens(doc->lexer);
+	int i, found = -1;
+
+	for (i = 0; i < doc->ast->child_count; i++)
+	{
+		const ASTNode *item = doc->ast->children[i];
+
+		if (item->token_end <= item->token_start)
+			continue;
+		if ((size_t)tokens[item->token_start]->offset > offset)
+			break;
+		found = i;
+	}
+	if (found < 0)
+		return (-1);
+
+	{
+		const ASTNode *item = doc->ast->children[found];
+		const Token *last = tokens[item->token_end - 1];
+
+		*start = tokens[item->token_start]->offset;
+		*end = (size_t)last->offset + last->length;
+	}
+
+	return (0);
+}
+
+/*
+ * handle_initialize - Answer the initialize request
+ * @server: Server instance
+ * @params: Client capabilities (unused)
+ * @result: Result stream
+ *
+ * Return: 0
+ */
+static int handle_initialize(LspServer *server, const JsonValue *params,
+			     FILE *result)
+{
+	(void)params;
+
+	server->initialized = 1;
+	fputs("{\"capabilities\":{"
+	      "\"textDocumentSync\":{\"openClose\":true,\"change\":2},"
+	      "\"documentFormattingProvider\":true,"
+	      "\"documentRangeFormattingProvider\":true,"
+	      "\"documentOnTypeFormattingProvider\":"
+	      "{\"firstTriggerCharacter\":\"}\","
+	      "\"moreTriggerCharacter\":[\";\",\"\\n\"]}},"
+	      "\"serverInfo\":{\"name\":\"betty-fmt\"}}", result);
+
+	return (0);
+}
+
+/*
+ * handle_initialized - Accept the initialized notification
+ * @server: Server instance (unused)
+ * @params: Parameters (unused)
+ * @result: Result stream (unused)
+ *
+ * Return: 0
+ */
+static int handle_initialized(LspServer *server, const JsonValue *params,
+			      FILE *result)
+{
+	(void)server;
+	(void)params;
+	(void)result;
+
+	return (0);
+}
+
+/*
+ * handle_shutdown - Answer the shutdown request
+ * @server: Server instance
+ * @params: Parameters (unused)
+ * @result: Result stream
+ *
+ * Return: 0
+ */
+static int handle_shutdown(LspServer *server, const JsonValue *params,
+			   FILE *result)
+{
+	(void)params;
+
+	server->shutdown = 1;
+	fputs("null", result);
+
+	return (0);
+}
+
+/*
+ * handle_exit - Accept the exit notification
+ * @server: Server instance
+ * @params: Parameters (unused)
+ * @result: Result stream (unused)
+ *
+ * Return: 0
+ */
+static int handle_exit(LspServer *server, const JsonValue *params,
+		       FILE *result)
+{
+	(void)params;
+	(void)result;
+
+	server->exited = 1;
+
+	return (0);
+}
+
+/*
+ * handle_did_open - Start tracking a document
+ * @server: Server instance
+ * @params: textDocument {uri, version, text}
+ * @result: Result stream (unused)
+ *
+ * Return: 0 on success, RPC_INVALID_PARAMS on error
+ */
+static int handle_did_open(LspServer *server, const JsonValue *params,
+			   FILE *result)
+{
+	const JsonValue *item = json_get(params, "textDocument");
+	const JsonValue *text = json_get(item, "text");
+	const char *uri = json_string(json_get(item, "uri"));
+	LspDocument *doc;
+
+	(void)result;
+
+	if (!uri || !json_string(text))
+		return (RPC_INVALID_PARAMS);
+
+	/* Reopening replaces the document */
+	doc = find_document(server, params);
+	if (!doc)
+	{
+		doc = mem_calloc(1, sizeof(LspDocument), MEM_SERVER);
+		if (!doc)
+			return (RPC_INVALID_PARAMS);
+		doc->uri = mem_strdup(uri, MEM_SERVER);
+		doc->text = mem_calloc(1, 1, MEM_SERVER);
+		doc->capacity = 1;
+		doc->cache = cache_create();
+		if (!doc->uri || !doc->text || !doc->cache)
+		{
+			destroy_document(doc);
+			return (RPC_INVALID_PARAMS);
+		}
+		doc->next = server->documents;
+		server->documents = doc;
+	}
+
+	doc->version = json_long(json_get(item, "version"), 0);
+
+	return (replace_text(doc, 0, doc->length, text->string,
+			     text->length) == 0 ? 0 : RPC_INVALID_PARAMS);
+}
+
+/*
+ * handle_did_change - Apply edits made in the client
+ * @server: Server instance
+ * @params: textDocument {uri, version}, contentChanges [{range?, text}]
+ * @result: Result stream (unused)
+ *
+ * Changes apply in order; one without a range replaces the whole text.
+ * The document is only parsed again when it is next formatted.
+ *
+ * Return: 0 on success, RPC_INVALID_PARAMS on error
+ */
+static int handle_did_change(LspServer *server, const JsonValue *params,
+			     FILE *result)
+{
+	LspDocument *doc = find_document(server, params);
+	const JsonValue *changes = json_get(params, "contentChanges");
+	int i;
+
+	(void)result;
+
+	if (!doc || !changes || changes->type != JSON_ARRAY)
+		return (RPC_INVALID_PARAMS);
+
+	for (i = 0; i < changes->count; i++)
+	{
+		const JsonValue *change = json_index(changes, i);
+		const JsonValue *text = json_get(change, "text");
+		const JsonValue *range = json_get(change, "range");
+		size_t start = 0, end = doc->length;
+
+		if (!json_string(text))
+			return (RPC_INVALID_PARAMS);
+		if (range)
+		{
+			start = position_offset(doc, json_get(range, "start"));
+			end = position_offset(doc, json_get(range, "end"));
+			if (end < start)
+				return (RPC_INVALID_PARAMS);
+		}
+
+		if (replace_text(doc, start, end, text->string,
+				 text->length) != 0)
+			return (RPC_INVALID_PARAMS);
+	}
+
+	doc->version = json_long(json_get(json_get(params, "textDocument"),
+					  "version"), doc->version);
+
+	return (0);
+}
+
+/*
+ * handle_did_close - Stop tracking a document
+ * @server: Server instance
+ * @params: textDocument {uri}
+ * @result: Result stream (unused)
+ *
+ * Return: 0
+ */
+static int handle_did_close(LspServer *server, const JsonValue *params,
+			    FILE *result)
+{
+	LspDocument *doc = find_document(server, params);
+	LspDocument **link;
+
+	(void)result;
+
+	for (link = &server->documents; *link; link = &(*link)->next)
+	{
+		if (*link == doc)
+		{
+			*link = doc->next;
+			destroy_document(doc);
+			break;
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * handle_formatting - Format a whole document
+ * @server: Server instance
+ * @params: textDocument {uri}
+ * @result: Result stream
+ *
+ * Return: 0 on success, RPC_INVALID_PARAMS for an unknown document
+ */
+static int handle_formatting(LspServer *server, const JsonValue *params,
+			     FILE *result)
+{
+	LspDocument *doc = find_document(server, params);
+	EditList *edits;
+
+	if (!doc)
+		return (RPC_INVALID_PARAMS);
+
+	edits = format_document(server, doc);
+	if (edits)
+		write_edits(result, doc, edits, 0, doc->length);
+	else
+		fputs("null", result);
+
+	return (0);
+}
+
+/*
+ * handle_range_formatting - Format part of a document
+ * @server: Server instance
+ * @params: textDocument {uri}, range
+ * @result: Result stream
+ *
+ * The whole document is formatted; edits touching the range are sent.
+ *
+ * Return: 0 on success, RPC_INVALID_PARAMS for an unknown document
+ */
+static int handle_range_formatting(LspServer *server,
+				   const JsonValue *params, FILE *result)
+{
+	LspDocument *doc = find_document(server, params);
+	const JsonValue *range = json_get(params, "range");
+	EditList *edits;
+
+	if (!doc || !range)
+		return (RPC_INVALID_PARAMS);
+
+	edits = format_document(server, doc);
+	if (edits)
+		write_edits(result, doc, edits,
+			    position_offset(doc, json_get(range, "start")),
+			    position_offset(doc, json_get(range, "end")));
+	else
+		fputs("null", result);
+
+	return (0);
+}
+
+/*
+ * handle_on_type_formatting - Format the item a character was typed in
+ * @server: Server instance
+ * @params: textDocument {uri}, position, ch
+ * @result: Result stream
+ *
+ * Return: 0 on success, RPC_INVALID_PARAMS for an unknown document
+ */
+static int handle_on_type_formatting(LspServer *server,
+				     const JsonValue *params, FILE *result)
+{
+	LspDocument *doc = find_document(server, params);
+	EditList *edits;
+	size_t start, end;
+
+	if (!doc)
+		return (RPC_INVALID_PARAMS);
+
+	edits = format_document(server, doc);
+	if (edits && item_range(doc, position_offset(doc,
+			json_get(params, "position")), &start, &end) == 0)
+		write_edits(result, doc, edits, start, end);
+	else if (edits)
+		fputs("[]", result);
+	else
+		fputs("null", result);
+
+	return (0);
+}
+
+/*
+ * lsp_run - Serve the language server protocol
+ * @in: Stream messages are read from
+ * @out: Stream messages are written to
+ *
+ * Return: 0 after shutdown and exit, 1 if the client exited without
+ * shutting down or the input ended
+ */
+int lsp_run(FILE *in, FILE *out)
+{
+	LspServer server;
+	LspDocument *doc;
+	size_t length;
+
+	memset(&server, 0, sizeof(server));
+	server.in = in;
+	server.out = out;
+
+	while (!server.exited && read_message(&server, &length) == 0)
+	{
+		JsonValue *message = json_parse(server.body, length);
+
+		if (!message)
+			send_response(&server, NULL, RPC_PARSE_ERROR, NULL, 0);
+		else if (message->type != JSON_OBJECT)
+			send_response(&server, NULL, RPC_INVALID_REQUEST,
+				      NULL, 0);
+		else
+			handle_message(&server, message);
+		json_free(message);
+	}
+
+	while (server.documents)
+	{
+		doc = server.documents;
+		server.documents = doc->next;
+		destroy_document(doc);
+	}
+	mem_free(server.body);
+
+	return (server.shutdown && server.exited ? 0 : 1);
+}
@@ -2,18 +2,42 @@
 #include "../include/lexer.h"
 #include "../include/parser.h"
 #include "../include/formatter.h"
+#include "../include/cache.h"
+#include "../include/sink.h"
+#include "../include/source_map.h"
+#include "../include/edits.h"
+#include "../include/lint.h"
+#include "../include/verify.h"
+#include "../include/lsp.h"
 #include "../include/utils.h"
+#include "../include/stats.h"
+#include "../include/timings.h"
+#include "../include/trace.h"
+#include "../include/profile.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+/* --verify levels */
+#define VERIFY_TOKENS 1      /* Output lexes to the same tokens */
+#define VERIFY_IDEMPOTENT 2  /* ... and formatting it changes nothing */
+
 /* Options structure */
 typedef struct {
 	int in_place;      /* -i: modify files in place */
 	int check_only;    /* -c: check if formatted (don't modify) */
 	int show_diff;     /* -d: show diff of changes */
 	char *output_file; /* -o: output to specific file */
+	char *cache_dir;   /* --cache: per-declaration output cache */
+	int stats;         /* --stats: report memory use per file */
+	char *source_map;  /* --source-map: write offset anchors to FILE */
+	int verify;        /* --verify: VERIFY_* level, 0 to trust the output */
+	int edits;         /* --edits=json: print edits instead of the output */
+	int timings;       /* --timings: report time per phase per file */
+	char *trace;       /* --trace: write a trace-event timeline to FILE */
+	int profile;       /* --profile-constructs: constructs to list, or 0 */
+	int lint;          /* --lint: report Betty style violations */
 } Options;
 
 /**
@@ -28,6 +52,21 @@ static void print_usage(const char *program)
 	printf("  -o, --output FILE   Write to FILE instead of stdout\n");
 	printf("  -c, --check         Check if files are formatted (exit 1 if not)\n");
 	printf("  -d, --diff          Show diff of changes\n");
+	printf("      --cache DIR     Reuse unchanged declarations cached in DIR\n");
+	printf("      --stats         Report memory use per subsystem (STATS=1 builds)\n");
+	printf("      --timings       Report time per phase (TIMINGS=1 builds)\n");
+	printf("      --trace=FILE    Write a Chrome trace of files and phases"
+	       " (TIMINGS=1 builds)\n");
+	printf("      --profile-constructs[=N]\n");
+	printf("                      List the N costliest functions and declarations\n");
+	printf("      --source-map FILE\n");
+	printf("                      Write output-to-source offset anchors (JSON)\n");
+	printf("      --verify[=idempotent]\n");
+	printf("                      Refuse output whose tokens differ from the input\n");
+	printf("      --edits=json    Print the changes as source edits (JSON)\n");
+	printf("      --lint          Report Betty style violations (exit 1 if any)\n");
+	printf("                      in the output; alone or with -c, in the input\n");
+	printf("      --lsp           Serve formatting over the language server protocol\n");
 	printf("  -h, --help          Show this help message\n");
 	printf("  -v, --version       Show version\n\n");
 	printf("Examples:\n");
@@ -46,65 +85,230 @@ static void print_version(void)
 }
 
 /**
- * format_to_string - Format source code and return as string
- * @source: Source code to format
- * @out_len: Output parameter for result length
+ * write_source_map - Save the source map of a formatted file
+ * @path: Map file to write
+ * @filename: Formatted file the map describes
+ * @map: Source map
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int write_source_map(const char *path, const char *filename,
+			    const SourceMap *map)
+{
+	FILE *fp;
+	int result;
+
+	fp = fopen(path, "w");
+	if (!fp)
+		return (-1);
+
+	result = source_map_write(map, filename, fp);
+	if (fclose(fp) != 0)
+		result = -1;
+
+	return (result);
+}
+
+/**
+ * lex_source - Tokenize source code
+ * @source: Source code
  *
- * Return: Formatted string (caller must free), or NULL on error
+ * Return: Lexer holding the tokens (caller must destroy), or NULL on error
  */
-static char *format_to_string(const char *source, size_t *out_len)
+static Lexer *lex_source(const char *source)
 {
 	Lexer *lexer;
-	Parser *parser;
-	char *result = NULL;
-	FILE *mem_stream;
-	size_t size = 0;
 
+	timing_begin(TIME_LEX);
 	lexer = lexer_create(source);
-	if (!lexer)
-		return (NULL);
-
-	if (lexer_tokenize(lexer) < 0)
+	if (lexer && lexer_tokenize(lexer) < 0)
 	{
 		lexer_destroy(lexer);
-		return (NULL);
+		lexer = NULL;
 	}
+	timing_end(TIME_LEX);
+	if (!lexer)
+		return (NULL);
+	stats_end_phase("lex");
+
+	return (lexer);
+}
+
+/**
+ * format_source - Format source code into an output sink
+ * @lexer: Tokens of the source
+ * @source: Source code to format
+ * @cache: Per-declaration output cache, or NULL
+ * @map: Source map to fill, or NULL
+ * @edits: Edit list to fill, or NULL
+ * @lint: Lint report to fill from the same parse, or NULL
+ * @sink: Destination of the formatted output, or NULL to stop after
+ *        parsing and linting
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int format_source(Lexer *lexer, const char *source, FormatCache *cache,
+			 SourceMap *map, EditList *edits, LintReport *lint,
+			 OutputSink *sink)
+{
+	Parser *parser;
+	int result = -1;
 
 	parser = parser_create(lexer_get_tokens(lexer),
 			       lexer_get_token_count(lexer));
 	if (!parser)
-	{
-		lexer_destroy(lexer);
-		return (NULL);
-	}
+		return (-1);
 
-	/* Parse and format to memory stream */
+	/* Parse, lint and format into the sink */
 	{
-		ASTNode *ast = parser_parse(parser);
-
-		if (ast)
+		ASTNode *ast;
+		int linted = 0;
+
+		timing_begin(TIME_PARSE);
+		ast = parser_parse(parser);
+		timing_end(TIME_PARSE);
+		stats_end_phase("parse");
+		if (ast && lint)
 		{
-			mem_stream = open_memstream(&result, &size);
-			if (mem_stream)
-			{
-				Formatter *formatter = formatter_create(mem_stream);
+			timing_begin(TIME_LINT);
+			linted = lint_check(lint, lexer_get_tokens(lexer),
+					    lexer_get_token_count(lexer), ast);
+			timing_end(TIME_LINT);
+			stats_end_phase("lint");
+		}
+		if (ast && !sink && linted >= 0)
+			result = 0;
+		else if (ast && linted >= 0)
+		{
+			Formatter *formatter = formatter_create(sink);
 
-				if (formatter)
-				{
-					formatter_format(formatter, ast);
-					formatter_destroy(formatter);
-				}
-				fclose(mem_stream);
+			if (formatter)
+			{
+				formatter_set_source(formatter,
+					lexer_get_tokens(lexer),
+					lexer_get_token_count(lexer));
+				formatter_set_cache(formatter, cache);
+				formatter_set_comments(formatter,
+						       parser->comments);
+				formatter_set_source_slices(formatter, source,
+							    strlen(source));
+				formatter_set_source_map(formatter, map);
+				formatter_set_edits(formatter, edits);
+				timing_begin(TIME_FORMAT);
+				result = formatter_format(formatter, ast);
+				formatter_destroy(formatter);
+
+				/* The sink may still reference tokens and AST text */
+				if (result == 0)
+					result = sink_flush(sink);
+				timing_end(TIME_FORMAT);
 			}
-			ast_node_destroy(ast);
+			stats_end_phase("format");
 		}
+		ast_node_destroy(ast);
 	}
 
 	parser_destroy(parser);
-	lexer_destroy(lexer);
+	stats_end_phase("cleanup");
 
-	if (out_len)
-		*out_len = size;
+	return (result);
+}
+
+/**
+ * verify_output - Check that formatting only changed the layout
+ * @filename: Formatted file (for messages)
+ * @source: Original source
+ * @lexer: Tokens of the original source
+ * @formatted: Formatted output
+ * @length: Length of the formatted output
+ * @level: VERIFY_TOKENS or VERIFY_IDEMPOTENT
+ *
+ * Return: 0 if the output is safe to use, -1 if not
+ */
+static int verify_output(const char *filename, const char *source,
+			 Lexer *lexer, const char *formatted, size_t length,
+			 int level)
+{
+	VerifyResult check;
+	Lexer *output;
+	OutputSink *sink;
+	int status;
+
+	/* Unchanged output is equivalent, and formatting it gives it again */
+	if (strcmp(source, formatted) == 0)
+		return (0);
+
+	output = lex_source(formatted);
+	if (!output)
+	{
+		fprintf(stderr, "%s: verify: output does not lex\n", filename);
+		return (-1);
+	}
+
+	if (verify_tokens(lexer_get_tokens(lexer), lexer_get_token_count(lexer),
+			  lexer_get_tokens(output),
+			  lexer_get_token_count(output), &check) != 0)
+	{
+		fprintf(stderr, "%s:%d:%d: verify: %s: '%s' became '%s' "
+			"(output %d:%d)\n", filename, check.input_line,
+			check.input_column, check.reason, check.input_text,
+			check.output_text, check.output_line,
+			check.output_column);
+		lexer_destroy(output);
+		return (-1);
+	}
+	stats_end_phase("verify");
+
+	status = 0;
+	if (level >= VERIFY_IDEMPOTENT)
+	{
+		/* Formatting the output again must reproduce it byte for byte */
+		sink = sink_create_compare(formatted, length);
+		status = sink ? format_source(output, formatted, NULL, NULL,
+					      NULL, NULL, sink) : -1;
+		if (status == 0 && !sink_matches(sink))
+		{
+			fprintf(stderr, "%s: verify: output changes when "
+				"formatted again\n", filename);
+			status = -1;
+		}
+		else if (status < 0)
+			fprintf(stderr, "Error: Could not reformat '%s'\n",
+				filename);
+		sink_destroy(sink);
+	}
+	lexer_destroy(output);
+
+	return (status);
+}
+
+/**
+ * format_to_string - Format source code and return as string
+ * @lexer: Tokens of the source
+ * @source: Source code to format
+ * @cache: Per-declaration output cache, or NULL
+ * @map: Source map to fill, or NULL
+ * @edits: Edit list to fill, or NULL
+ * @lint: Lint report to fill, or NULL
+ * @out_len: Output parameter for result length
+ *
+ * Return: Formatted string (caller must mem_free), or NULL on error
+ */
+static char *format_to_string(Lexer *lexer, const char *source,
+			      FormatCache *cache, SourceMap *map,
+			      EditList *edits, LintReport *lint,
+			      size_t *out_len)
+{
+	OutputSink *sink;
+	char *result = NULL;
+
+	sink = sink_create_memory();
+	if (!sink)
+		return (NULL);
+
+	if (format_source(lexer, source, cache, map, edits, lint, sink) == 0)
+		result = sink_take_buffer(sink, out_len);
+	sink_destroy(sink);
 
 	return (result);
 }
@@ -120,23 +324,50 @@ static char *format_to_string(const char *source, size_t *out_len)
 static int do_write_file(const char *filename, const char *content, size_t len)
 {
 	FILE *fp;
+	int result = 0;
 
+	timing_begin(TIME_WRITE);
 	fp = fopen(filename, "w");
 	if (!fp)
 	{
 		fprintf(stderr, "Error: Could not open '%s' for writing\n", filename);
-		return (-1);
+		result = -1;
 	}
-
-	if (fwrite(content, 1, len, fp) != len)
+	else if (fwrite(content, 1, len, fp) != len)
 	{
 		fprintf(stderr, "Error: Failed to write to '%s'\n", filename);
-		fclose(fp);
-		return (-1);
+		result = -1;
+	}
+	if (fp && fclose(fp) != 0 && result == 0)
+	{
+		fprintf(stderr, "Error: Failed to write to '%s'\n", filename);
+		result = -1;
 	}
+	timing_end(TIME_WRITE);
 
-	fclose(fp);
-	return (0);
+	return (result);
+}
+
+/**
+ * lint_text - Check formatted output against the lint rules
+ * @text: Formatted text
+ * @lint: Lint report to fill
+ *
+ * The output is lexed and parsed again, so that positions, line lengths
+ * and function lengths are those of the text being written.
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int lint_text(const char *text, LintReport *lint)
+{
+	Lexer *lexer = lex_source(text);
+	int status = -1;
+
+	if (lexer)
+		status = format_source(lexer, text, NULL, NULL, NULL, lint,
+				       NULL);
+	lexer_destroy(lexer);
+	return (status);
 }
 
 /**
@@ -144,34 +375,159 @@ static int do_write_file(const char *filename, const char *content, size_t len)
  * @filename: File to process
  * @opts: Processing options
  *
- * Return: 0 on success, 1 if needs formatting (check mode), -1 on error
+ * Return: 0 on success, 1 if needs formatting (check mode) or breaks a
+ * lint rule, -1 on error
  */
 static int process_file(const char *filename, Options *opts)
 {
 	char *source;
-	char *formatted;
-	size_t formatted_len;
+	char *formatted = NULL;
+	size_t formatted_len = 0;
 	int result = 0;
+	int status = -1;
+	int lint_only = opts->lint && !opts->check_only && !opts->show_diff &&
+		!opts->in_place && !opts->output_file;
+	int lint_output = opts->lint && !lint_only && !opts->check_only;
+	int in_memory = !lint_only && (opts->verify || lint_output ||
+		(!opts->check_only &&
+		 (opts->show_diff || opts->in_place || opts->output_file)));
+	FormatCache *cache = NULL;
+	SourceMap *map = NULL;
+	EditList *edits = NULL;
+	LintReport *lint = NULL;
+	OutputSink *sink = NULL;
+	Lexer *lexer;
 
+	if (opts->timings)
+		timings_reset();
+	timing_begin(TIME_READ);
 	source = read_file(filename);
+	timing_end(TIME_READ);
 	if (!source)
 	{
 		fprintf(stderr, "Error: Could not read file '%s'\n", filename);
 		return (-1);
 	}
 
-	formatted = format_to_string(source, &formatted_len);
-	if (!formatted)
+	if (opts->stats)
+		stats_reset();
+	if (opts->cache_dir && !lint_only)
+	{
+		cache = cache_open(opts->cache_dir, filename);
+		if (!cache)
+			fprintf(stderr, "Warning: Could not open cache for '%s'\n",
+				filename);
+		stats_end_phase("cache load");
+	}
+	if (opts->source_map)
+		map = source_map_create();
+	if (opts->edits)
+		edits = edit_list_create();
+	if (opts->lint)
+		lint = lint_report_create();
+	if ((opts->source_map && !map) || (opts->edits && !edits) ||
+	    (opts->lint && !lint))
 	{
-		fprintf(stderr, "Error: Failed to format '%s'\n", filename);
+		fprintf(stderr, "Error: Out of memory\n");
+		source_map_destroy(map);
+		edit_list_destroy(edits);
+		cache_close(cache);
 		free(source);
 		return (-1);
 	}
 
+	/*
+	 * Check mode only compares and plain output goes straight to stdout;
+	 * the other modes and verification need the formatted text in memory.
+	 * Lint on its own stops after the parse it checks. Lint with -c
+	 * checks the input as it stands; lint with output checks the output.
+	 */
+	lexer = lex_source(source);
+	if (lexer && opts->profile)
+		profile_begin_file(filename, lexer_get_tokens(lexer));
+	if (lexer && in_memory)
+	{
+		formatted = format_to_string(lexer, source, cache, map, edits,
+					     lint_output ? NULL : lint,
+					     &formatted_len);
+		profile_end_file();
+		if (formatted)
+			status = 0;
+		if (formatted && lint_output)
+			status = lint_text(formatted, lint);
+		if (formatted && opts->verify)
+		{
+			timing_begin(TIME_VERIFY);
+			status = verify_output(filename, source, lexer,
+					       formatted, formatted_len,
+					       opts->verify);
+			timing_end(TIME_VERIFY);
+		}
+	}
+	else if (lexer && lint_only)
+	{
+		status = format_source(lexer, source, NULL, NULL, NULL, lint,
+				       NULL);
+		profile_end_file();
+	}
+	else if (lexer)
+	{
+		if (opts->check_only || opts->edits)
+			sink = sink_create_compare(source, strlen(source));
+		else
+		{
+			fflush(stdout);
+			sink = sink_create_gather(STDOUT_FILENO);
+		}
+		if (sink)
+			status = format_source(lexer, source, cache, map,
+					       edits, lint, sink);
+		profile_end_file();
+	}
+	lexer_destroy(lexer);
+
+	if (cache)
+	{
+		if (status == 0 && cache_save(cache) < 0)
+			fprintf(stderr, "Warning: Could not write cache for '%s'\n",
+				filename);
+		cache_close(cache);
+		stats_end_phase("cache save");
+	}
+	if (opts->stats)
+		stats_report(stderr, filename, strlen(source));
+	if (status < 0)
+	{
+		if (lint_only)
+			fprintf(stderr, "Error: Failed to check '%s'\n", filename);
+		else if (!formatted)
+			fprintf(stderr, "Error: Failed to format '%s'\n", filename);
+		if (opts->timings)
+			timings_report(stderr, filename, strlen(source));
+		source_map_destroy(map);
+		edit_list_destroy(edits);
+		lint_report_destroy(lint);
+		sink_destroy(sink);
+		mem_free(formatted);
+		free(source);
+		return (-1);
+	}
+
+	if (map)
+	{
+		if (write_source_map(opts->source_map, filename, map) < 0)
+		{
+			fprintf(stderr, "Error: Could not write source map '%s'\n",
+				opts->source_map);
+			result = -1;
+		}
+		source_map_destroy(map);
+	}
+
 	/* Check mode: compare and report */
 	if (opts->check_only)
 	{
-		if (strcmp(source, formatted) != 0)
+		if (sink ? !sink_matches(sink) : strcmp(source, formatted) != 0)
 		{
 			printf("%s: needs formatting\n", filename);
 			result = 1;
@@ -235,13 +591,53 @@ static int process_file(const char *filename, Options *opts)
 		if (do_write_file(opts->output_file, formatted, formatted_len) < 0)
 			result = -1;
 	}
-	/* Default: print to stdout */
-	else
+	/* Edits mode: the changes instead of the output */
+	else if (opts->edits)
+	{
+		timing_begin(TIME_WRITE);
+		status = edit_list_write(edits, filename, stdout);
+		timing_end(TIME_WRITE);
+		if (status < 0)
+		{
+			fprintf(stderr, "Error: Could not write edits for '%s'\n",
+				filename);
+			result = -1;
+		}
+	}
+	/* Verified output to stdout */
+	else if (formatted)
 	{
-		printf("%s", formatted);
+		timing_begin(TIME_WRITE);
+		if (fwrite(formatted, 1, formatted_len, stdout) != formatted_len)
+			result = -1;
+		timing_end(TIME_WRITE);
+	}
+	/* Default: already written to stdout */
+
+	/* Style diagnostics come after the output of the mode */
+	if (lint)
+	{
+		int count;
+
+		timing_begin(TIME_WRITE);
+		count = lint_report_write(lint, filename, stdout);
+		timing_end(TIME_WRITE);
+		if (count < 0)
+		{
+			fprintf(stderr, "Error: Could not write lint results for "
+				"'%s'\n", filename);
+			result = -1;
+		}
+		else if (count > 0 && result == 0)
+			result = 1;
+		lint_report_destroy(lint);
 	}
 
-	free(formatted);
+	if (opts->timings)
+		timings_report(stderr, filename, strlen(source));
+	edit_list_destroy(edits);
+	sink_destroy(sink);
+	mem_free(formatted);
 	free(source);
 
 	return (result);
@@ -252,13 +648,15 @@ static int process_file(const char *filename, Options *opts)
  * @argc: Argument count
  * @argv: Argument vector
  *
- * Return: 0 on success, 1 on error or if files need formatting (check mode)
+ * Return: 0 on success, 1 on error, if files need formatting (check mode)
+ * or if they break lint rules
  */
 int main(int argc, char **argv)
 {
-	Options opts = {0, 0, 0, NULL};
+	Options opts = {0, 0, 0, NULL, NULL, 0, NULL, 0, 0, 0, NULL, 0, 0};
 	int i;
 	int file_count = 0;
+	int queued;
 	int error_count = 0;
 	int needs_format = 0;
 
@@ -282,6 +680,10 @@ int main(int argc, char **argv)
 			print_version();
 			return (0);
 		}
+		else if (strcmp(argv[i], "--lsp") == 0)
+		{
+			return (lsp_run(stdin, stdout));
+		}
 		else if (strcmp(argv[i], "-i") == 0 ||
 			 strcmp(argv[i], "--in-place") == 0)
 		{
@@ -310,8 +712,132 @@ int main(int argc, char **argv)
 				return (1);
 			}
 		}
+		else if (strcmp(argv[i], "--cache") == 0)
+		{
+			if (i + 1 < argc)
+			{
+				opts.cache_dir = argv[++i];
+			}
+			else
+			{
+				fprintf(stderr, "Error: --cache requires a directory\n");
+				return (1);
+			}
+		}
+		else if (strcmp(argv[i], "--source-map") == 0)
+		{
+			if (i + 1 < argc)
+			{
+				opts.source_map = argv[++i];
+			}
+			else
+			{
+				fprintf(stderr, "Error: --source-map requires a filename\n");
+				return (1);
+			}
+		}
+		else if (strcmp(argv[i], "--verify") == 0)
+		{
+			opts.verify = VERIFY_TOKENS;
+		}
+		else if (strcmp(argv[i], "--verify=idempotent") == 0)
+		{
+			opts.verify = VERIFY_IDEMPOTENT;
+		}
+		else if (strcmp(argv[i], "--edits=json") == 0)
+		{
+			opts.edits = 1;
+		}
+		else if (strcmp(argv[i], "--lint") == 0)
+		{
+			opts.lint = 1;
+		}
+		else if (strcmp(argv[i], "--stats") == 0)
+		{
+			if (!STATS_ENABLED)
+			{
+				fprintf(stderr, "Error: --stats needs a build with "
+					"statistics (make STATS=1)\n");
+				return (1);
+			}
+			opts.stats = 1;
+		}
+		else if (strcmp(argv[i], "--timings") == 0)
+		{
+			if (!TIMINGS_ENABLED)
+			{
+				fprintf(stderr, "Error: --timings needs a build with "
+					"timings (make TIMINGS=1)\n");
+				return (1);
+			}
+			opts.timings = 1;
+		}
+		else if (strncmp(argv[i], "--trace=", 8) == 0)
+		{
+			if (!TRACE_ENABLED)
+			{
+				fprintf(stderr, "Error: --trace needs a build with "
+					"timings (make TIMINGS=1)\n");
+				return (1);
+			}
+			opts.trace = argv[i] + 8;
+		}
+		else if (strcmp(argv[i], "--profile-constructs") == 0 ||
+			 strncmp(argv[i], "--profile-constructs=", 21) == 0)
+		{
+			if (!PROFILE_ENABLED)
+			{
+				fprintf(stderr, "Error: --profile-constructs needs a "
+					"build with timings (make TIMINGS=1)\n");
+				return (1);
+			}
+			opts.profile = argv[i][20] == '=' ? atoi(argv[i] + 21) : 10;
+			if (opts.profile <= 0)
+			{
+				fprintf(stderr, "Error: Invalid construct count '%s'\n",
+					argv[i] + 21);
+				return (1);
+			}
+		}
+		else if (argv[i][0] != '-')
+		{
+			file_count++;
+		}
 	}
 
+	/* One map file describes one input */
+	if (opts.source_map && file_count > 1)
+	{
+		fprintf(stderr, "Error: --source-map takes a single input file\n");
+		return (1);
+	}
+	if (opts.edits && (opts.in_place || opts.check_only ||
+			   opts.show_diff || opts.output_file))
+	{
+		fprintf(stderr, "Error: --edits replaces the output; it cannot be "
+			"used with -i, -c, -d or -o\n");
+		return (1);
+	}
+	if (opts.edits && opts.lint)
+	{
+		fprintf(stderr, "Error: --lint cannot be used with --edits\n");
+		return (1);
+	}
+	if (opts.source_map && opts.lint && !opts.in_place &&
+	    !opts.check_only && !opts.show_diff && !opts.output_file)
+	{
+		fprintf(stderr, "Error: --lint alone does not format; "
+			"--source-map needs -i, -c, -d or -o\n");
+		return (1);
+	}
+	if (opts.trace && trace_open(opts.trace) != 0)
+	{
+		fprintf(stderr, "Error: Could not start trace\n");
+		return (1);
+	}
+	queued = file_count;
+	file_count = 0;
+
 	/* Second pass: process files */
 	for (i = 1; i < argc; i++)
 	{
@@ -321,13 +847,19 @@ int main(int argc, char **argv)
 		if (argv[i][0] == '-')
 		{
 			if (strcmp(argv[i], "-o") == 0 ||
-			    strcmp(argv[i], "--output") == 0)
-				i++; /* Skip the output filename too */
+			    strcmp(argv[i], "--output") == 0 ||
+			    strcmp(argv[i], "--cache") == 0 ||
+			    strcmp(argv[i], "--source-map") == 0)
+				i++; /* Skip the option argument too */
 			continue;
 		}
 
 		file_count++;
+		trace_counter("queue", queued--);
+		trace_memory();
+		trace_begin(argv[i], "file");
 		ret = process_file(argv[i], &opts);
+		trace_end(argv[i], "file");
 
 		if (ret < 0)
 			error_count++;
@@ -335,17 +867,26 @@ int main(int argc, char **argv)
 			needs_format++;
 	}
 
+	trace_counter("queue", 0);
+	trace_memory();
+	if (trace_close() != 0)
+		error_count++;
+
 	if (file_count == 0)
 	{
 		fprintf(stderr, "Error: No input files\n");
 		return (1);
 	}
+	if (opts.timings)
+		timings_report_total(stderr);
+	if (opts.profile)
+		profile_report(stderr, opts.profile);
 
 	if (error_count > 0)
 		return (1);
 
-	/* In check mode, return 1 if any files need formatting */
-	if (opts.check_only && needs_format > 0)
+	/* In check and lint modes, return 1 if any file needs work */
+	if ((opts.check_only || opts.lint) && needs_format > 0)
 		return (1);
 
 	return (0);
@@ -1,9 +1,26 @@
 #include "../include/parser.h"
 #include "../include/symbol_table.h"
+#include "../include/stats.h"
+#include "../include/timings.h"
+#include "../include/profile.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
+/*
+ * StatementState - Bookkeeping for one statement being parsed
+ * @start: Token index the statement (and any raw capture) starts at
+ * @errors: Parser error count when the statement began
+ * @comments: Comments collected before the statement (token indices)
+ * @comment_count: Number of saved comments
+ */
+typedef struct StatementState {
+	int start;
+	int errors;
+	int *comments;
+	int comment_count;
+} StatementState;
+
 /* Forward declarations */
 static Token *peek(Parser *parser);
 static Token *advance(Parser *parser);
@@ -15,12 +32,17 @@ static int is_at_end(Parser *parser);
 static ASTNode *parse_program(Parser *parser);
 static ASTNode *parse_function(Parser *parser);
 static ASTNode *parse_statement(Parser *parser);
+static Token *statement_begin(Parser *parser, StatementState *state);
+static ASTNode *statement_end(Parser *parser, ASTNode *node,
+			      StatementState *state);
 static ASTNode *parse_block(Parser *parser);
 static ASTNode *parse_expression(Parser *parser);
 static ASTNode *parse_expression_precedence(Parser *parser, int min_precedence);
 static ASTNode *parse_primary(Parser *parser);
 static ASTNode *parse_postfix(Parser *parser);
 static ASTNode *parse_unary(Parser *parser);
+static ASTNode *parse_unary_operand(Parser *parser);
+static ASTNode *parse_if_head(Parser *parser);
 static ASTNode *parse_if_statement(Parser *parser);
 static ASTNode *parse_while_statement(Parser *parser);
 static ASTNode *parse_for_statement(Parser *parser);
@@ -38,6 +60,9 @@ static int looks_like_type_in_parens(Parser *parser, int start_index,
 	int *closing_index);
 static void skip_gnu_attributes(Parser *parser);
 static void clear_pending_comments(Parser *parser);
+static void rewind_parser(Parser *parser, int index);
+static int enter_nesting(Parser *parser);
+static void skip_nested(Parser *parser);
 static void add_unparsed_child(Parser *parser, ASTNode *parent, int start_index);
 static char *copy_token_text(Parser *parser, int start_index, int end_index);
 static int token_allowed_in_type(Token *token);
@@ -60,7 +85,7 @@ Parser *parser_create(Token **tokens, int token_count)
 	if (!tokens || token_count <= 0)
 		return (NULL);
 
-	parser = malloc(sizeof(Parser));
+	parser = mem_alloc(sizeof(Parser), MEM_PARSER);
 	if (!parser)
 		return (NULL);
 
@@ -69,6 +94,7 @@ Parser *parser_create(Token **tokens, int token_count)
 	parser->current = 0;
 	parser->error_count = 0;
 	parser->whitespace_start = 0;
+	parser->depth = 0;
 	parser->symbols = symbol_table_create(NULL);
 
 	/* Add common C library typedefs */
@@ -114,6 +140,15 @@ Parser *parser_create(Token **tokens, int token_count)
 		symbol_add(parser->symbols, "NodeType", SYM_TYPEDEF);
 	}
 
+	parser->comments = comment_table_create(tokens, token_count);
+	if (!parser->comments)
+	{
+		if (parser->symbols)
+			symbol_table_destroy(parser->symbols);
+		mem_free(parser);
+		return (NULL);
+	}
+
 	/* Initialize comment buffer */
 	parser->pending_comments = NULL;
 	parser->pending_comment_count = 0;
@@ -134,8 +169,9 @@ void parser_destroy(Parser *parser)
 	if (parser->symbols)
 		symbol_table_destroy(parser->symbols);
 
-	free(parser->pending_comments);
-	free(parser);
+	comment_table_destroy(parser->comments);
+	mem_free(parser->pending_comments);
+	mem_free(parser);
 }
 
 /*
@@ -174,11 +210,16 @@ static Token *peek_ahead(Parser *parser, int n)
 		    t->type != TOK_COMMENT_LINE && t->type != TOK_COMMENT_BLOCK)
 		{
 			if (count == n)
+			{
+				timing_count(COUNT_TOKENS_VISITED,
+					     pos - parser->current);
 				return (t);
+			}
 			count++;
 		}
 		pos++;
 	}
+	timing_count(COUNT_TOKENS_VISITED, pos - parser->current);
 	return (NULL);
 }
 
@@ -223,6 +264,73 @@ static void clear_pending_comments(Parser *parser)
 	parser->pending_comment_count = 0;
 }
 
+/*
+ * rewind_parser - Backtrack after a speculative parse
+ * @parser: Parser instance
+ * @index: Token index to resume from (not after the current one)
+ */
+static void rewind_parser(Parser *parser, int index)
+{
+	timing_count(COUNT_REWINDS, 1);
+	timing_count(COUNT_REWOUND_TOKENS, parser->current - index);
+	parser->current = index;
+}
+
+/*
+ * enter_nesting - Go one level deeper, unless that is too deep
+ * @parser: Parser instance
+ *
+ * Past PARSER_MAX_DEPTH an error is reported instead, which turns the
+ * enclosing statement or item into raw text. Callers that got 0 call
+ * parser->depth-- on the way out.
+ *
+ * Return: 0 on success, -1 if nested too deeply
+ */
+static int enter_nesting(Parser *parser)
+{
+	Token *token;
+
+	if (parser->depth < PARSER_MAX_DEPTH)
+	{
+		parser->depth++;
+		return (0);
+	}
+
+	token = peek(parser);
+	fprintf(stderr, "Parse error (line %d): nested deeper than %d levels\n",
+		token ? token->line : 0, PARSER_MAX_DEPTH);
+	parser->error_count++;
+	return (-1);
+}
+
+/*
+ * skip_nested - Skip a parenthesized or braced group without parsing it
+ * @parser: Parser instance
+ *
+ * Used where enter_nesting() refused to go deeper, so that the levels
+ * above still find their closing tokens. Does nothing unless the current
+ * token opens a group.
+ */
+static void skip_nested(Parser *parser)
+{
+	Token *token = peek(parser);
+	TokenType open, close;
+	int count = 0;
+
+	if (!token || (token->type != TOK_LPAREN && token->type != TOK_LBRACE))
+		return;
+
+	open = token->type;
+	close = open == TOK_LPAREN ? TOK_RPAREN : TOK_RBRACE;
+	while ((token = advance(parser)) != NULL)
+	{
+		if (token->type == open)
+			count++;
+		else if (token->type == close && --count == 0)
+			break;
+	}
+}
+
 /*
  * create_unparsed_node - Build a NODE_UNPARSED covering [start_index, end_index)
  * @parser: Parser instance
@@ -257,7 +365,7 @@ static ASTNode *create_unparsed_node(Parser *parser, int start_index, int end_in
 			total += strlen(t->lexeme);
 	}
 
-	buffer = malloc(total + 1);
+	buffer = mem_alloc(total + 1, MEM_PARSER);
 	if (!buffer)
 		return (NULL);
 
@@ -275,10 +383,10 @@ static ASTNode *create_unparsed_node(Parser *parser, int start_index, int end_in
 	}
 	*cursor = '\0';
 
-	segment = malloc(sizeof(RawSegmentData));
+	segment = mem_alloc(sizeof(RawSegmentData), MEM_PARSER);
 	if (!segment)
 	{
-		free(buffer);
+		mem_free(buffer);
 		return (NULL);
 	}
 
@@ -292,12 +400,13 @@ static ASTNode *create_unparsed_node(Parser *parser, int start_index, int end_in
 	node = ast_node_create(NODE_UNPARSED, start_token);
 	if (!node)
 	{
-		free(buffer);
-		free(segment);
+		mem_free(buffer);
+		mem_free(segment);
 		return (NULL);
 	}
 
 	node->data = segment;
+	timing_count(COUNT_UNPARSED, 1);
 	return (node);
 }
 
@@ -311,6 +420,7 @@ static ASTNode *create_unparsed_node(Parser *parser, int start_index, int end_in
 static ASTNode *recover_top_level(Parser *parser, int start_index)
 {
 	Token *t;
+	ASTNode *raw;
 	int brace_depth = 0;
 
 	if (!parser)
@@ -318,6 +428,8 @@ static ASTNode *recover_top_level(Parser *parser, int start_index)
 	if (start_index < 0 || start_index >= parser->token_count)
 		start_index = parser->current;
 
+	timing_begin(TIME_RECOVERY);
+
 	while (!is_at_end(parser))
 	{
 		t = peek(parser);
@@ -355,7 +467,10 @@ static ASTNode *recover_top_level(Parser *parser, int start_index)
 	if (parser->current <= start_index && !is_at_end(parser))
 		advance(parser);
 
-	return (create_unparsed_node(parser, start_index, parser->current));
+	raw = create_unparsed_node(parser, start_index, parser->current);
+	timing_end(TIME_RECOVERY);
+
+	return (raw);
 }
 
 /*
@@ -368,6 +483,7 @@ static ASTNode *recover_top_level(Parser *parser, int start_index)
 static ASTNode *recover_statement(Parser *parser, int start_index)
 {
 	Token *t;
+	ASTNode *raw;
 	int brace_depth = 0;
 
 	if (!parser)
@@ -375,6 +491,8 @@ static ASTNode *recover_statement(Parser *parser, int start_index)
 	if (start_index < 0 || start_index >= parser->token_count)
 		start_index = parser->current;
 
+	timing_begin(TIME_RECOVERY);
+
 	while (!is_at_end(parser))
 	{
 		t = peek(parser);
@@ -414,7 +532,10 @@ static ASTNode *recover_statement(Parser *parser, int start_index)
 	if (parser->current <= start_index && !is_at_end(parser))
 		advance(parser);
 
-	return (create_unparsed_node(parser, start_index, parser->current));
+	raw = create_unparsed_node(parser, start_index, parser->current);
+	timing_end(TIME_RECOVERY);
+
+	return (raw);
 }
 
 /*
@@ -425,6 +546,7 @@ static ASTNode *recover_statement(Parser *parser, int start_index)
 static ASTNode *recover_enum_entry(Parser *parser, int start_index)
 {
 	Token *t;
+	ASTNode *raw;
 	int brace_depth = 0;
 	int paren_depth = 0;
 
@@ -433,6 +555,8 @@ static ASTNode *recover_enum_entry(Parser *parser, int start_index)
 	if (start_index < 0 || start_index >= parser->token_count)
 		start_index = parser->current;
 
+	timing_begin(TIME_RECOVERY);
+
 	while (!is_at_end(parser))
 	{
 		t = peek(parser);
@@ -465,7 +589,10 @@ static ASTNode *recover_enum_entry(Parser *parser, int start_index)
 	if (parser->current <= start_index && !is_at_end(parser))
 		advance(parser);
 
-	return (create_unparsed_node(parser, start_index, parser->current));
+	raw = create_unparsed_node(parser, start_index, parser->current);
+	timing_end(TIME_RECOVERY);
+
+	return (raw);
 }
 
 /*
@@ -521,7 +648,7 @@ static char *copy_token_text(Parser *parser, int start_index, int end_index)
 			total += strlen(tok->lexeme);
 	}
 
-	buffer = malloc(total + 1);
+	buffer = mem_alloc(total + 1, MEM_PARSER);
 	if (!buffer)
 		return (NULL);
 
@@ -591,7 +718,7 @@ static int looks_like_type_in_parens(Parser *parser, int start_index,
 	int *closing_index)
 {
 	int i;
-	int saw_content = 0;
+	int saw_name = 0;
 	int looks_like_type = 1;
 	Token *prev_non_ws = NULL;
 
@@ -617,7 +744,12 @@ static int looks_like_type_in_parens(Parser *parser, int start_index,
 		    inner->type != TOK_COMMENT_LINE &&
 		    inner->type != TOK_COMMENT_BLOCK)
 		{
-			saw_content = 1;
+			/* Sizes and * only follow a name: (1) is a value */
+			if (inner->type != TOK_INTEGER &&
+			    inner->type != TOK_STAR &&
+			    inner->type != TOK_LBRACKET &&
+			    inner->type != TOK_RBRACKET)
+				saw_name = 1;
 
 			if (inner->type == TOK_IDENTIFIER)
 			{
@@ -647,7 +779,7 @@ static int looks_like_type_in_parens(Parser *parser, int start_index,
 		}
 	}
 
-	if (!looks_like_type || !saw_content ||
+	if (!looks_like_type || !saw_name ||
 	    i >= parser->token_count ||
 	    parser->tokens[i]->type != TOK_RPAREN)
 		return (0);
@@ -726,6 +858,7 @@ static Token *advance(Parser *parser)
 	if (is_at_end(parser))
 		return (NULL);
 	token = parser->tokens[parser->current++];
+	timing_count(COUNT_TOKENS_VISITED, 1);
 	/* Track line of last significant token for trailing comments */
 	if (token && token->type != TOK_WHITESPACE && token->type != TOK_NEWLINE)
 		parser->last_token_line = token->line;
@@ -816,22 +949,22 @@ static Token *expect(Parser *parser, TokenType type)
 /*
  * add_pending_comment - Add a comment to the pending buffer
  * @parser: Parser instance
- * @comment: Comment token to add
+ * @token_index: Index of the comment token to add
  */
-static void add_pending_comment(Parser *parser, Token *comment)
+static void add_pending_comment(Parser *parser, int token_index)
 {
 	if (parser->pending_comment_count >= parser->pending_comment_capacity)
 	{
 		int new_cap = parser->pending_comment_capacity == 0
 			? 4 : parser->pending_comment_capacity * 2;
-		Token **new_buf = realloc(parser->pending_comments,
-			sizeof(Token *) * new_cap);
+		int *new_buf = mem_realloc(parser->pending_comments,
+			sizeof(int) * new_cap, MEM_PARSER);
 		if (!new_buf)
 			return;
 		parser->pending_comments = new_buf;
 		parser->pending_comment_capacity = new_cap;
 	}
-	parser->pending_comments[parser->pending_comment_count++] = comment;
+	parser->pending_comments[parser->pending_comment_count++] = token_index;
 }
 
 /*
@@ -847,7 +980,8 @@ static void attach_pending_comments(Parser *parser, ASTNode *node)
 		return;
 
 	for (i = 0; i < parser->pending_comment_count; i++)
-		ast_node_add_leading_comment(node, parser->pending_comments[i]);
+		comment_table_add(parser->comments, node, COMMENT_LEADING,
+				  parser->pending_comments[i]);
 
 	parser->pending_comment_count = 0;
 }
@@ -880,7 +1014,8 @@ static void collect_trailing_comments(Parser *parser, ASTNode *node)
 			 token->line == parser->last_token_line)
 		{
 			/* Comment on same line - it's a trailing comment */
-			ast_node_add_trailing_comment(node, token);
+			comment_table_add(parser->comments, node, COMMENT_TRAILING,
+					  parser->current);
 			advance(parser);
 		}
 		else
@@ -919,7 +1054,7 @@ static int skip_whitespace(Parser *parser)
 		else if (token->type == TOK_COMMENT_LINE ||
 			 token->type == TOK_COMMENT_BLOCK)
 		{
-			add_pending_comment(parser, token);
+			add_pending_comment(parser, parser->current);
 			advance(parser);
 		}
 		else
@@ -1050,7 +1185,7 @@ static ASTNode *parse_primary(Parser *parser)
 		int type_capacity = 4;
 		FunctionData *type_data;
 
-		type_tokens = malloc(sizeof(Token *) * type_capacity);
+		type_tokens = mem_alloc(sizeof(Token *) * type_capacity, MEM_PARSER);
 		if (!type_tokens)
 			return (NULL);
 
@@ -1065,8 +1200,8 @@ static ASTNode *parse_primary(Parser *parser)
 			if (type_count >= type_capacity)
 			{
 				type_capacity *= 2;
-				type_tokens = realloc(type_tokens,
-					sizeof(Token *) * type_capacity);
+				type_tokens = mem_realloc(type_tokens,
+					sizeof(Token *) * type_capacity, MEM_PARSER);
 			}
 			type_tokens[type_count++] = advance(parser);
 			skip_whitespace(parser);
@@ -1075,12 +1210,12 @@ static ASTNode *parse_primary(Parser *parser)
 		node = ast_node_create(NODE_TYPE_EXPR, type_tokens[0]);
 		if (!node)
 		{
-			free(type_tokens);
+			mem_free(type_tokens);
 			return (NULL);
 		}
 
 		/* Store type tokens in data */
-		type_data = malloc(sizeof(FunctionData));
+		type_data = mem_alloc(sizeof(FunctionData), MEM_PARSER);
 		if (type_data)
 		{
 			type_data->return_type_tokens = type_tokens;
@@ -1091,7 +1226,7 @@ static ASTNode *parse_primary(Parser *parser)
 		}
 		else
 		{
-			free(type_tokens);
+			mem_free(type_tokens);
 		}
 
 		return (node);
@@ -1194,6 +1329,8 @@ static ASTNode *parse_primary(Parser *parser)
 
 		/* Regular parenthesized expression */
 		node = parse_expression(parser);
+		if (node)
+			node->parens++;
 		skip_whitespace(parser);
 		expect(parser, TOK_RPAREN);
 		return (node);
@@ -1292,7 +1429,7 @@ static ASTNode *parse_postfix(Parser *parser)
 			member = ast_node_create(NODE_MEMBER_ACCESS, name_token);
 			if (!member)
 				return (NULL);
-			access_data = malloc(sizeof(MemberAccessData));
+			access_data = mem_alloc(sizeof(MemberAccessData), MEM_PARSER);
 			if (access_data)
 			{
 				access_data->uses_arrow = (token->type == TOK_ARROW);
@@ -1311,7 +1448,7 @@ static ASTNode *parse_postfix(Parser *parser)
 				UnaryData *unary_data;
 
 				advance(parser);
-				unary_data = malloc(sizeof(UnaryData));
+				unary_data = mem_alloc(sizeof(UnaryData), MEM_PARSER);
 				if (unary_data)
 				{
 					unary_data->is_postfix = 1;
@@ -1330,8 +1467,39 @@ static ASTNode *parse_postfix(Parser *parser)
 
 /*
  * parse_unary - Parse unary expression
+ *
+ * Every operand, parenthesized expression and cast passes through here,
+ * so this is where expression nesting is limited.
  */
 static ASTNode *parse_unary(Parser *parser)
+{
+	ASTNode *node;
+
+	if (enter_nesting(parser) != 0)
+	{
+		/* Skip the operand, so the levels above do not retry it */
+		skip_whitespace(parser);
+		while (peek(parser) && is_unary_operator(peek(parser)->type))
+		{
+			advance(parser);
+			skip_whitespace(parser);
+		}
+		if (match(parser, TOK_LPAREN))
+			skip_nested(parser);
+		else
+			advance(parser);
+		return (NULL);
+	}
+
+	node = parse_unary_operand(parser);
+	parser->depth--;
+	return (node);
+}
+
+/*
+ * parse_unary_operand - Parse unary expression, one level of nesting
+ */
+static ASTNode *parse_unary_operand(Parser *parser)
 {
 	Token *token;
 	ASTNode *node, *operand;
@@ -1533,6 +1701,12 @@ static ASTNode *parse_initializer(Parser *parser)
 	/* Check for brace-enclosed initializer list: {1, 2, 3} */
 	if (match(parser, TOK_LBRACE))
 	{
+		if (enter_nesting(parser) != 0)
+		{
+			skip_nested(parser);
+			return (NULL);
+		}
+
 		init = ast_node_create(NODE_INIT_LIST, peek(parser));
 		advance(parser); /* consume { */
 		skip_whitespace(parser);
@@ -1540,10 +1714,13 @@ static ASTNode *parse_initializer(Parser *parser)
 		/* Parse initializer elements */
 		while (!is_at_end(parser) && !match(parser, TOK_RBRACE))
 		{
+			int elem_start = parser->current;
 			ASTNode *elem = parse_initializer(parser); /* recursive for nested */
 
 			if (elem)
 				ast_node_add_child(init, elem);
+			else if (parser->current == elem_start)
+				break;
 
 			skip_whitespace(parser);
 			if (match(parser, TOK_COMMA))
@@ -1556,6 +1733,7 @@ static ASTNode *parse_initializer(Parser *parser)
 		if (match(parser, TOK_RBRACE))
 			advance(parser);
 
+		parser->depth--;
 		return (init);
 	}
 
@@ -1610,7 +1788,7 @@ static ASTNode *parse_func_ptr_decl(Parser *parser, Token **type_tokens,
 	skip_whitespace(parser);
 
 	/* Collect parameter tokens until matching ')' */
-	param_tokens = malloc(sizeof(Token *) * param_capacity);
+	param_tokens = mem_alloc(sizeof(Token *) * param_capacity, MEM_PARSER);
 	paren_depth = 1;
 
 	while (!is_at_end(parser) && paren_depth > 0)
@@ -1629,8 +1807,8 @@ static ASTNode *parse_func_ptr_decl(Parser *parser, Token **type_tokens,
 		if (param_count >= param_capacity)
 		{
 			param_capacity *= 2;
-			param_tokens = realloc(param_tokens,
-					       sizeof(Token *) * param_capacity);
+			param_tokens = mem_realloc(param_tokens,
+					       sizeof(Token *) * param_capacity, MEM_PARSER);
 		}
 		param_tokens[param_count++] = advance(parser);
 		skip_whitespace(parser);
@@ -1642,7 +1820,7 @@ static ASTNode *parse_func_ptr_decl(Parser *parser, Token **type_tokens,
 
 	node = ast_node_create(NODE_FUNC_PTR, type_tokens[0]);
 
-	fp_data = malloc(sizeof(FuncPtrData));
+	fp_data = mem_alloc(sizeof(FuncPtrData), MEM_PARSER);
 	if (fp_data)
 	{
 		fp_data->return_type_tokens = type_tokens;
@@ -1654,7 +1832,7 @@ static ASTNode *parse_func_ptr_decl(Parser *parser, Token **type_tokens,
 	}
 	else
 	{
-		free(param_tokens);
+		mem_free(param_tokens);
 	}
 
 	return (node);
@@ -1681,7 +1859,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 	if (!type_token)
 		return (NULL);
 
-	type_tokens = malloc(sizeof(Token *) * type_capacity);
+	type_tokens = mem_alloc(sizeof(Token *) * type_capacity, MEM_PARSER);
 	if (!type_tokens)
 		return (NULL);
 
@@ -1698,7 +1876,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			if (type_count >= type_capacity)
 			{
 				type_capacity *= 2;
-				type_tokens = realloc(type_tokens, sizeof(Token *) * type_capacity);
+				type_tokens = mem_realloc(type_tokens, sizeof(Token *) * type_capacity, MEM_PARSER);
 			}
 			type_tokens[type_count++] = advance(parser);
 			skip_whitespace(parser);
@@ -1710,7 +1888,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			if (type_count >= type_capacity)
 			{
 				type_capacity *= 2;
-				type_tokens = realloc(type_tokens, sizeof(Token *) * type_capacity);
+				type_tokens = mem_realloc(type_tokens, sizeof(Token *) * type_capacity, MEM_PARSER);
 			}
 			type_tokens[type_count++] = advance(parser);
 			skip_whitespace(parser);
@@ -1723,7 +1901,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 				if (type_count >= type_capacity)
 				{
 					type_capacity *= 2;
-					type_tokens = realloc(type_tokens, sizeof(Token *) * type_capacity);
+					type_tokens = mem_realloc(type_tokens, sizeof(Token *) * type_capacity, MEM_PARSER);
 				}
 				type_tokens[type_count++] = advance(parser);
 				skip_whitespace(parser);
@@ -1737,7 +1915,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			if (type_count >= type_capacity)
 			{
 				type_capacity *= 2;
-				type_tokens = realloc(type_tokens, sizeof(Token *) * type_capacity);
+				type_tokens = mem_realloc(type_tokens, sizeof(Token *) * type_capacity, MEM_PARSER);
 			}
 			type_tokens[type_count++] = advance(parser);
 			skip_whitespace(parser);
@@ -1759,7 +1937,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 	}
 	else
 	{
-		free(type_tokens);
+		mem_free(type_tokens);
 		return (NULL);
 	}
 
@@ -1771,7 +1949,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 		if (type_count >= type_capacity)
 		{
 			type_capacity *= 2;
-			type_tokens = realloc(type_tokens, sizeof(Token *) * type_capacity);
+			type_tokens = mem_realloc(type_tokens, sizeof(Token *) * type_capacity, MEM_PARSER);
 		}
 		type_tokens[type_count++] = advance(parser);
 		skip_whitespace(parser);
@@ -1795,7 +1973,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 				ASTNode *fp_node;
 
 				/* This looks like a function pointer */
-				parser->current = saved_pos;
+				rewind_parser(parser, saved_pos);
 				fp_node = parse_func_ptr_decl(parser, type_tokens,
 							     type_count);
 				/* Consume the semicolon after func ptr decl */
@@ -1804,13 +1982,13 @@ static ASTNode *parse_var_declaration(Parser *parser)
 				return (fp_node);
 			}
 		}
-		parser->current = saved_pos;
+		rewind_parser(parser, saved_pos);
 	}
 
 	name_token = expect(parser, TOK_IDENTIFIER);
 	if (!name_token)
 	{
-		free(type_tokens);
+		mem_free(type_tokens);
 		return (NULL);
 	}
 
@@ -1818,13 +1996,13 @@ static ASTNode *parse_var_declaration(Parser *parser)
 	skip_whitespace(parser);
 
 	/* Handle array declarations: int arr[] or int arr[10] */
-	array_tokens = malloc(sizeof(Token *) * array_capacity);
+	array_tokens = mem_alloc(sizeof(Token *) * array_capacity, MEM_PARSER);
 	while (match(parser, TOK_LBRACKET))
 	{
 		if (array_count >= array_capacity)
 		{
 			array_capacity *= 2;
-			array_tokens = realloc(array_tokens, sizeof(Token *) * array_capacity);
+			array_tokens = mem_realloc(array_tokens, sizeof(Token *) * array_capacity, MEM_PARSER);
 		}
 		array_tokens[array_count++] = advance(parser); /* [ */
 		skip_whitespace(parser);
@@ -1835,7 +2013,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			if (array_count >= array_capacity)
 			{
 				array_capacity *= 2;
-				array_tokens = realloc(array_tokens, sizeof(Token *) * array_capacity);
+				array_tokens = mem_realloc(array_tokens, sizeof(Token *) * array_capacity, MEM_PARSER);
 			}
 			array_tokens[array_count++] = advance(parser);
 			skip_whitespace(parser);
@@ -1846,7 +2024,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			if (array_count >= array_capacity)
 			{
 				array_capacity *= 2;
-				array_tokens = realloc(array_tokens, sizeof(Token *) * array_capacity);
+				array_tokens = mem_realloc(array_tokens, sizeof(Token *) * array_capacity, MEM_PARSER);
 			}
 			array_tokens[array_count++] = advance(parser); /* ] */
 		}
@@ -1854,7 +2032,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 	}
 
 	/* Create VarDeclData */
-	var_data = malloc(sizeof(VarDeclData));
+	var_data = mem_alloc(sizeof(VarDeclData), MEM_PARSER);
 	if (var_data)
 	{
 		var_data->type_tokens = type_tokens;
@@ -1869,8 +2047,8 @@ static ASTNode *parse_var_declaration(Parser *parser)
 	}
 	else
 	{
-		free(type_tokens);
-		free(array_tokens);
+		mem_free(type_tokens);
+		mem_free(array_tokens);
 	}
 
 	/* Check for initialization */
@@ -1894,7 +2072,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 	if (match(parser, TOK_COMMA) && var_data)
 	{
 		int extra_capacity = 4;
-		VarDeclData **extras = malloc(sizeof(VarDeclData *) * extra_capacity);
+		VarDeclData **extras = mem_alloc(sizeof(VarDeclData *) * extra_capacity, MEM_PARSER);
 		int extra_count = 0;
 
 		while (match(parser, TOK_COMMA))
@@ -1910,7 +2088,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			skip_whitespace(parser);
 
 			/* Copy base type tokens, then add any pointers */
-			extra_type_tokens = malloc(sizeof(Token *) * (type_count + 4));
+			extra_type_tokens = mem_alloc(sizeof(Token *) * (type_count + 4), MEM_PARSER);
 			for (i = 0; i < type_count; i++)
 			{
 				/* Copy type but stop at pointers */
@@ -1929,7 +2107,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			name_token = expect(parser, TOK_IDENTIFIER);
 			if (!name_token)
 			{
-				free(extra_type_tokens);
+				mem_free(extra_type_tokens);
 				break;
 			}
 
@@ -1940,7 +2118,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			{
 				int arr_cap = 4;
 
-				extra_arr_tokens = malloc(sizeof(Token *) * arr_cap);
+				extra_arr_tokens = mem_alloc(sizeof(Token *) * arr_cap, MEM_PARSER);
 				while (match(parser, TOK_LBRACKET))
 				{
 					extra_arr_tokens[extra_arr_count++] = advance(parser);
@@ -1951,8 +2129,8 @@ static ASTNode *parse_var_declaration(Parser *parser)
 						if (extra_arr_count >= arr_cap)
 						{
 							arr_cap *= 2;
-							extra_arr_tokens = realloc(extra_arr_tokens,
-								sizeof(Token *) * arr_cap);
+							extra_arr_tokens = mem_realloc(extra_arr_tokens,
+								sizeof(Token *) * arr_cap, MEM_PARSER);
 						}
 						extra_arr_tokens[extra_arr_count++] = advance(parser);
 						skip_whitespace(parser);
@@ -1965,7 +2143,7 @@ static ASTNode *parse_var_declaration(Parser *parser)
 			}
 
 			/* Create extra VarDeclData */
-			extra = malloc(sizeof(VarDeclData));
+			extra = mem_alloc(sizeof(VarDeclData), MEM_PARSER);
 			if (extra)
 			{
 				extra->type_tokens = extra_type_tokens;
@@ -1988,14 +2166,14 @@ static ASTNode *parse_var_declaration(Parser *parser)
 				if (extra_count >= extra_capacity)
 				{
 					extra_capacity *= 2;
-					extras = realloc(extras, sizeof(VarDeclData *) * extra_capacity);
+					extras = mem_realloc(extras, sizeof(VarDeclData *) * extra_capacity, MEM_PARSER);
 				}
 				extras[extra_count++] = extra;
 			}
 			else
 			{
-				free(extra_type_tokens);
-				free(extra_arr_tokens);
+				mem_free(extra_type_tokens);
+				mem_free(extra_arr_tokens);
 			}
 
 			skip_whitespace(parser);
@@ -2011,11 +2189,14 @@ static ASTNode *parse_var_declaration(Parser *parser)
 }
 
 /*
- * parse_if_statement - Parse if statement
+ * parse_if_head - Parse "if (condition) statement" without any else branch
+ * @parser: Parser instance
+ *
+ * Return: NODE_IF with condition and then-branch children, or NULL
  */
-static ASTNode *parse_if_statement(Parser *parser)
+static ASTNode *parse_if_head(Parser *parser)
 {
-	ASTNode *node, *condition, *then_branch, *else_branch;
+	ASTNode *node, *condition, *then_branch;
 
 	advance(parser); /* consume 'if' */
 	skip_whitespace(parser);
@@ -2042,18 +2223,103 @@ static ASTNode *parse_if_statement(Parser *parser)
 	if (then_branch)
 		ast_node_add_child(node, then_branch);
 
-	skip_whitespace(parser);
+	return (node);
+}
+
+/*
+ * parse_if_statement - Parse if statement
+ * @parser: Parser instance
+ *
+ * Else-if chains are parsed in a loop rather than by recursing through
+ * parse_statement, so arbitrarily long chains use constant stack depth.
+ * Each "else if" still gets its own statement frame (comments, error
+ * recovery), finished innermost-first exactly as the recursion would.
+ *
+ * Return: NODE_IF, or NULL on error
+ */
+static ASTNode *parse_if_statement(Parser *parser)
+{
+	ASTNode **chain;
+	StatementState *frames;
+	ASTNode *node, *else_branch;
+	int count = 1, capacity = 8;
+	int i;
+
+	node = parse_if_head(parser);
+	if (!node)
+		return (NULL);
+
+	chain = mem_alloc(sizeof(ASTNode *) * capacity, MEM_PARSER);
+	frames = mem_alloc(sizeof(StatementState) * capacity, MEM_PARSER);
+	if (!chain || !frames)
+	{
+		mem_free(chain);
+		mem_free(frames);
+		chain = NULL;
+		frames = NULL;
+	}
+	if (chain)
+		chain[0] = node;
 
-	/* Check for else */
-	if (match(parser, TOK_ELSE))
+	while (node)
 	{
+		skip_whitespace(parser);
+
+		/* Check for else */
+		if (!match(parser, TOK_ELSE))
+			break;
+
 		advance(parser);
 		skip_whitespace(parser);
-		else_branch = parse_statement(parser);
+
+		if (!chain || !match(parser, TOK_IF))
+		{
+			else_branch = parse_statement(parser);
+			if (else_branch)
+				ast_node_add_child(node, else_branch);
+			break;
+		}
+
+		if (count >= capacity)
+		{
+			ASTNode **new_chain;
+			StatementState *new_frames;
+
+			capacity *= 2;
+			new_chain = mem_realloc(chain, sizeof(ASTNode *) * capacity, MEM_PARSER);
+			if (new_chain)
+				chain = new_chain;
+			new_frames = mem_realloc(frames, sizeof(StatementState) * capacity, MEM_PARSER);
+			if (new_frames)
+				frames = new_frames;
+			if (!new_chain || !new_frames)
+			{
+				/* Out of memory: finish this chain recursively */
+				capacity /= 2;
+				else_branch = parse_statement(parser);
+				if (else_branch)
+					ast_node_add_child(node, else_branch);
+				break;
+			}
+		}
+
+		statement_begin(parser, &frames[count]);
+		node = parse_if_head(parser);
+		chain[count++] = node;
+	}
+
+	/* Finish the else-if frames innermost-first and link them up */
+	for (i = count - 1; chain && i > 0; i--)
+	{
+		else_branch = statement_end(parser, chain[i], &frames[i]);
 		if (else_branch)
-			ast_node_add_child(node, else_branch);
+			ast_node_add_child(chain[i - 1], else_branch);
 	}
 
+	node = chain ? chain[0] : node;
+	mem_free(chain);
+	mem_free(frames);
+
 	return (node);
 }
 
@@ -2394,34 +2660,13 @@ static ASTNode *parse_statement(Parser *parser)
 {
 	Token *token;
 	ASTNode *node = NULL;
-	Token **saved_comments = NULL;
-	int saved_count = 0;
-	int i;
-	int statement_start = parser->whitespace_start;
-	int start_errors = parser->error_count;
-
-	if (statement_start < 0 || statement_start >= parser->token_count)
-		statement_start = parser->current;
-	else if (statement_start > parser->current)
-		statement_start = parser->current;
-
-	skip_whitespace(parser);
-	token = peek(parser);
+	StatementState state;
 
+	token = statement_begin(parser, &state);
 	if (!token)
 		return (NULL);
-
-	if (parser->pending_comment_count > 0)
-	{
-		saved_count = parser->pending_comment_count;
-		saved_comments = malloc(sizeof(Token *) * saved_count);
-		if (saved_comments)
-		{
-			for (i = 0; i < saved_count; i++)
-				saved_comments[i] = parser->pending_comments[i];
-		}
-		parser->pending_comment_count = 0;
-	}
+	if (enter_nesting(parser) != 0)
+		return (statement_end(parser, NULL, &state));
 
 	if (token->type == TOK_IF)
 		node = parse_if_statement(parser);
@@ -2519,29 +2764,102 @@ static ASTNode *parse_statement(Parser *parser)
 		}
 	}
 
-	if (!node || parser->error_count > start_errors)
+	parser->depth--;
+	return (statement_end(parser, node, &state));
+}
+
+/*
+ * statement_begin - Open a statement frame
+ * @parser: Parser instance
+ * @state: Frame to fill in
+ *
+ * Records where the statement starts (for raw recovery) and the error
+ * count, skips leading whitespace and takes ownership of any comments
+ * pending before the statement.
+ *
+ * Return: First token of the statement, or NULL at end of input
+ */
+static Token *statement_begin(Parser *parser, StatementState *state)
+{
+	Token *token;
+	int i;
+
+	state->start = parser->whitespace_start;
+	state->errors = parser->error_count;
+	state->comments = NULL;
+	state->comment_count = 0;
+
+	if (state->start < 0 || state->start >= parser->token_count)
+		state->start = parser->current;
+	else if (state->start > parser->current)
+		state->start = parser->current;
+
+	skip_whitespace(parser);
+	token = peek(parser);
+
+	if (!token)
+		return (NULL);
+
+	profile_statement_begin();
+	if (parser->pending_comment_count > 0)
+	{
+		state->comment_count = parser->pending_comment_count;
+		state->comments = mem_alloc(sizeof(int) * state->comment_count, MEM_PARSER);
+		if (state->comments)
+		{
+			for (i = 0; i < state->comment_count; i++)
+				state->comments[i] = parser->pending_comments[i];
+		}
+		parser->pending_comment_count = 0;
+	}
+
+	return (token);
+}
+
+/*
+ * statement_end - Close a statement frame
+ * @parser: Parser instance
+ * @node: Parsed statement, or NULL if parsing failed
+ * @state: Frame opened by statement_begin
+ *
+ * On failure (or if errors were reported while parsing) the statement is
+ * replaced by a raw capture starting at the frame's start. Otherwise the
+ * saved comments become leading comments and trailing comments on the
+ * same line are attached.
+ *
+ * Return: Final statement node
+ */
+static ASTNode *statement_end(Parser *parser, ASTNode *node,
+			      StatementState *state)
+{
+	int i;
+
+	if (!node || parser->error_count > state->errors)
 	{
 		ASTNode *raw;
 
-		parser->error_count = start_errors;
+		parser->error_count = state->errors;
 		if (node)
 			ast_node_destroy(node);
-		raw = recover_statement(parser, statement_start);
+		raw = recover_statement(parser, state->start);
 
-		if (saved_comments)
-			free(saved_comments);
+		if (state->comments)
+			mem_free(state->comments);
 		clear_pending_comments(parser);
+		profile_statement_end(raw);
 		return (raw);
 	}
 
-	if (saved_comments)
+	if (state->comments)
 	{
-		for (i = 0; i < saved_count; i++)
-			ast_node_add_leading_comment(node, saved_comments[i]);
-		free(saved_comments);
+		for (i = 0; i < state->comment_count; i++)
+			comment_table_add(parser->comments, node, COMMENT_LEADING,
+					  state->comments[i]);
+		mem_free(state->comments);
 	}
 
 	collect_trailing_comments(parser, node);
+	profile_statement_end(node);
 	return (node);
 }
 
@@ -2881,7 +3199,7 @@ static ASTNode *parse_typedef(Parser *parser)
 	else
 	{
 		/* Regular typedef - store base type tokens */
-		Token **base_tokens = malloc(sizeof(Token *) * 16);
+		Token **base_tokens = mem_alloc(sizeof(Token *) * 16, MEM_PARSER);
 		int base_count = 0;
 		int base_capacity = 16;
 		TypedefData *td_data;
@@ -2892,8 +3210,8 @@ static ASTNode *parse_typedef(Parser *parser)
 			if (base_count >= base_capacity)
 			{
 				base_capacity *= 2;
-				base_tokens = realloc(base_tokens,
-						      sizeof(Token *) * base_capacity);
+				base_tokens = mem_realloc(base_tokens,
+						      sizeof(Token *) * base_capacity, MEM_PARSER);
 			}
 			base_tokens[base_count++] = advance(parser);
 			skip_whitespace(parser);
@@ -2905,8 +3223,8 @@ static ASTNode *parse_typedef(Parser *parser)
 			if (base_count >= base_capacity)
 			{
 				base_capacity *= 2;
-				base_tokens = realloc(base_tokens,
-						      sizeof(Token *) * base_capacity);
+				base_tokens = mem_realloc(base_tokens,
+						      sizeof(Token *) * base_capacity, MEM_PARSER);
 			}
 			base_tokens[base_count++] = advance(parser);
 			skip_whitespace(parser);
@@ -2924,7 +3242,7 @@ static ASTNode *parse_typedef(Parser *parser)
 				/* This is a function pointer typedef */
 				ASTNode *fp_node;
 
-				parser->current = saved_pos;
+				rewind_parser(parser, saved_pos);
 				fp_node = parse_func_ptr_decl(parser, base_tokens,
 							      base_count);
 				if (fp_node)
@@ -2947,7 +3265,7 @@ static ASTNode *parse_typedef(Parser *parser)
 					return (node);
 				}
 			}
-			parser->current = saved_pos;
+			rewind_parser(parser, saved_pos);
 		}
 
 		/* Regular typedef processing */
@@ -2972,7 +3290,7 @@ static ASTNode *parse_typedef(Parser *parser)
 				if (base_count >= base_capacity)
 				{
 					base_capacity *= 2;
-					base_tokens = realloc(base_tokens, sizeof(Token *) * base_capacity);
+					base_tokens = mem_realloc(base_tokens, sizeof(Token *) * base_capacity, MEM_PARSER);
 				}
 				base_tokens[base_count++] = alias_token;
 			}
@@ -2982,7 +3300,7 @@ static ASTNode *parse_typedef(Parser *parser)
 				if (base_count >= base_capacity)
 				{
 					base_capacity *= 2;
-					base_tokens = realloc(base_tokens, sizeof(Token *) * base_capacity);
+					base_tokens = mem_realloc(base_tokens, sizeof(Token *) * base_capacity, MEM_PARSER);
 				}
 				base_tokens[base_count++] = peek(parser);
 				advance(parser);
@@ -2991,7 +3309,7 @@ static ASTNode *parse_typedef(Parser *parser)
 		}
 
 		/* Store typedef data */
-		td_data = malloc(sizeof(TypedefData));
+		td_data = mem_alloc(sizeof(TypedefData), MEM_PARSER);
 		td_data->base_type_tokens = base_tokens;
 		td_data->base_type_count = base_count;
 		node->data = td_data;
@@ -3036,14 +3354,14 @@ static ASTNode *parse_parameter(Parser *parser)
 		return (param);
 	}
 
-	type_tokens = malloc(sizeof(Token *) * type_capacity);
+	type_tokens = mem_alloc(sizeof(Token *) * type_capacity, MEM_PARSER);
 	if (!type_tokens)
 		return (NULL);
 
 	type_start = peek(parser);
 	if (!type_start)
 	{
-		free(type_tokens);
+		mem_free(type_tokens);
 		return (NULL);
 	}
 
@@ -3074,8 +3392,8 @@ static ASTNode *parse_parameter(Parser *parser)
 					if (type_count >= type_capacity)
 					{
 						type_capacity *= 2;
-						type_tokens = realloc(type_tokens,
-							sizeof(Token *) * type_capacity);
+						type_tokens = mem_realloc(type_tokens,
+							sizeof(Token *) * type_capacity, MEM_PARSER);
 					}
 					type_tokens[type_count++] = advance(parser);
 					skip_whitespace(parser);
@@ -3084,8 +3402,8 @@ static ASTNode *parse_parameter(Parser *parser)
 						if (type_count >= type_capacity)
 						{
 							type_capacity *= 2;
-							type_tokens = realloc(type_tokens,
-								sizeof(Token *) * type_capacity);
+							type_tokens = mem_realloc(type_tokens,
+								sizeof(Token *) * type_capacity, MEM_PARSER);
 						}
 						type_tokens[type_count++] = advance(parser);
 					}
@@ -3099,7 +3417,7 @@ static ASTNode *parse_parameter(Parser *parser)
 		if (type_count >= type_capacity)
 		{
 			type_capacity *= 2;
-			type_tokens = realloc(type_tokens, sizeof(Token *) * type_capacity);
+			type_tokens = mem_realloc(type_tokens, sizeof(Token *) * type_capacity, MEM_PARSER);
 		}
 		type_tokens[type_count++] = advance(parser);
 		skip_whitespace(parser);
@@ -3107,20 +3425,20 @@ static ASTNode *parse_parameter(Parser *parser)
 
 	if (type_count == 0 && !name)
 	{
-		free(type_tokens);
+		mem_free(type_tokens);
 		return (NULL);
 	}
 
 	param = ast_node_create(NODE_PARAM, name);
 	if (!param)
 	{
-		free(type_tokens);
+		mem_free(type_tokens);
 		return (NULL);
 	}
 
 	/* Store type tokens in data field */
 	{
-		FunctionData *pdata = malloc(sizeof(FunctionData));
+		FunctionData *pdata = mem_alloc(sizeof(FunctionData), MEM_PARSER);
 
 		if (pdata)
 		{
@@ -3132,7 +3450,7 @@ static ASTNode *parse_parameter(Parser *parser)
 		}
 		else
 		{
-			free(type_tokens);
+			mem_free(type_tokens);
 		}
 	}
 
@@ -3161,7 +3479,7 @@ static ASTNode *parse_function(Parser *parser)
 	skip_whitespace(parser);
 	start_pos = parser->current;
 
-	return_type_tokens = malloc(sizeof(Token *) * return_type_capacity);
+	return_type_tokens = mem_alloc(sizeof(Token *) * return_type_capacity, MEM_PARSER);
 	if (!return_type_tokens)
 		return (NULL);
 
@@ -3175,8 +3493,8 @@ static ASTNode *parse_function(Parser *parser)
 		if (return_type_count >= return_type_capacity)
 		{
 			return_type_capacity *= 2;
-			return_type_tokens = realloc(return_type_tokens,
-				sizeof(Token *) * return_type_capacity);
+			return_type_tokens = mem_realloc(return_type_tokens,
+				sizeof(Token *) * return_type_capacity, MEM_PARSER);
 		}
 		return_type_tokens[return_type_count++] = advance(parser);
 		skip_whitespace(parser);
@@ -3197,15 +3515,15 @@ static ASTNode *parse_function(Parser *parser)
 		if (return_type_count >= return_type_capacity)
 		{
 			return_type_capacity *= 2;
-			return_type_tokens = realloc(return_type_tokens,
-				sizeof(Token *) * return_type_capacity);
+			return_type_tokens = mem_realloc(return_type_tokens,
+				sizeof(Token *) * return_type_capacity, MEM_PARSER);
 		}
 		return_type_tokens[return_type_count++] = advance(parser);
 	}
 	else
 	{
-		free(return_type_tokens);
-		parser->current = start_pos;
+		mem_free(return_type_tokens);
+		rewind_parser(parser, start_pos);
 		return (NULL);
 	}
 
@@ -3219,8 +3537,8 @@ static ASTNode *parse_function(Parser *parser)
 		if (return_type_count >= return_type_capacity)
 		{
 			return_type_capacity *= 2;
-			return_type_tokens = realloc(return_type_tokens,
-				sizeof(Token *) * return_type_capacity);
+			return_type_tokens = mem_realloc(return_type_tokens,
+				sizeof(Token *) * return_type_capacity, MEM_PARSER);
 		}
 		return_type_tokens[return_type_count++] = advance(parser);
 		skip_whitespace(parser);
@@ -3236,8 +3554,8 @@ static ASTNode *parse_function(Parser *parser)
 			if (return_type_count >= return_type_capacity)
 			{
 				return_type_capacity *= 2;
-				return_type_tokens = realloc(return_type_tokens,
-					sizeof(Token *) * return_type_capacity);
+				return_type_tokens = mem_realloc(return_type_tokens,
+					sizeof(Token *) * return_type_capacity, MEM_PARSER);
 			}
 			return_type_tokens[return_type_count++] = advance(parser);
 			skip_whitespace(parser);
@@ -3250,8 +3568,8 @@ static ASTNode *parse_function(Parser *parser)
 		if (return_type_count >= return_type_capacity)
 		{
 			return_type_capacity *= 2;
-			return_type_tokens = realloc(return_type_tokens,
-				sizeof(Token *) * return_type_capacity);
+			return_type_tokens = mem_realloc(return_type_tokens,
+				sizeof(Token *) * return_type_capacity, MEM_PARSER);
 		}
 		return_type_tokens[return_type_count++] = advance(parser);
 		skip_whitespace(parser);
@@ -3260,8 +3578,8 @@ static ASTNode *parse_function(Parser *parser)
 	/* Check for function name */
 	if (!match(parser, TOK_IDENTIFIER))
 	{
-		free(return_type_tokens);
-		parser->current = start_pos;
+		mem_free(return_type_tokens);
+		rewind_parser(parser, start_pos);
 		return (NULL);
 	}
 
@@ -3271,16 +3589,16 @@ static ASTNode *parse_function(Parser *parser)
 	/* Check for opening parenthesis - if not present, it's not a function */
 	if (!match(parser, TOK_LPAREN))
 	{
-		free(return_type_tokens);
-		parser->current = start_pos;
+		mem_free(return_type_tokens);
+		rewind_parser(parser, start_pos);
 		return (NULL);
 	}
 
 	func = ast_node_create(NODE_FUNCTION, name);
 	if (!func)
 	{
-		free(return_type_tokens);
-		parser->current = start_pos;
+		mem_free(return_type_tokens);
+		rewind_parser(parser, start_pos);
 		return (NULL);
 	}
 
@@ -3291,12 +3609,12 @@ static ASTNode *parse_function(Parser *parser)
 	skip_whitespace(parser);
 
 	/* Parse parameters */
-	params = malloc(sizeof(ASTNode *) * param_capacity);
+	params = mem_alloc(sizeof(ASTNode *) * param_capacity, MEM_PARSER);
 	if (!params)
 	{
-		free(return_type_tokens);
+		mem_free(return_type_tokens);
 		ast_node_destroy(func);
-		parser->current = start_pos;
+		rewind_parser(parser, start_pos);
 		return (NULL);
 	}
 
@@ -3309,7 +3627,7 @@ static ASTNode *parse_function(Parser *parser)
 			if (param_count >= param_capacity)
 			{
 				param_capacity *= 2;
-				params = realloc(params, sizeof(ASTNode *) * param_capacity);
+				params = mem_realloc(params, sizeof(ASTNode *) * param_capacity, MEM_PARSER);
 			}
 			params[param_count++] = param;
 		}
@@ -3324,10 +3642,12 @@ static ASTNode *parse_function(Parser *parser)
 
 	if (!match(parser, TOK_RPAREN))
 	{
-		free(return_type_tokens);
-		free(params);
+		mem_free(return_type_tokens);
+		while (param_count > 0)
+			ast_node_destroy(params[--param_count]);
+		mem_free(params);
 		ast_node_destroy(func);
-		parser->current = start_pos;
+		rewind_parser(parser, start_pos);
 		return (NULL);
 	}
 	advance(parser); /* consume ) */
@@ -3335,7 +3655,7 @@ static ASTNode *parse_function(Parser *parser)
 	skip_whitespace(parser);
 
 	/* Store function signature data */
-	func_data = malloc(sizeof(FunctionData));
+	func_data = mem_alloc(sizeof(FunctionData), MEM_PARSER);
 	if (func_data)
 	{
 		func_data->return_type_tokens = return_type_tokens;
@@ -3346,8 +3666,10 @@ static ASTNode *parse_function(Parser *parser)
 	}
 	else
 	{
-		free(return_type_tokens);
-		free(params);
+		mem_free(return_type_tokens);
+		while (param_count > 0)
+			ast_node_destroy(params[--param_count]);
+		mem_free(params);
 	}
 
 	skip_gnu_attributes(parser);
@@ -3368,6 +3690,23 @@ static ASTNode *parse_function(Parser *parser)
 	return (func);
 }
 
+/*
+ * mark_item_spans - Record the token span of newly added top-level items
+ * @program: Program node
+ * @marked: Number of children already marked (updated)
+ * @start: First token index of the span
+ * @end: Token index one past the span
+ */
+static void mark_item_spans(ASTNode *program, int *marked, int start, int end)
+{
+	for (; *marked < program->child_count; (*marked)++)
+	{
+		program->children[*marked]->token_start = start;
+		program->children[*marked]->token_end = end;
+		profile_item_parsed(program->children[*marked], *marked);
+	}
+}
+
 /*
  * parse_program - Parse entire program
  * @parser: Parser instance
@@ -3379,6 +3718,8 @@ static ASTNode *parse_program(Parser *parser)
 	ASTNode *program, *func;
 	int blank_lines;
 	int start_errors;
+	int item_start = 0;
+	int marked = 0;
 
 	program = ast_node_create(NODE_PROGRAM, NULL);
 	if (!program)
@@ -3386,9 +3727,12 @@ static ASTNode *parse_program(Parser *parser)
 
 	while (!is_at_end(parser))
 	{
+		mark_item_spans(program, &marked, item_start, parser->current);
 		blank_lines = skip_whitespace(parser);
 		int section_start = parser->whitespace_start;
 
+		item_start = section_start;
+
 		if (is_at_end(parser))
 			break;
 
@@ -3551,6 +3895,8 @@ static ASTNode *parse_program(Parser *parser)
 		skip_whitespace(parser);
 	}
 
+	mark_item_spans(program, &marked, item_start, parser->current);
+
 	return (program);
 }
 
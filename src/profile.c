@@ -0,0 +1,579 @@
+#define _GNU_SOURCE
+#include "../include/profile.h"
+
+#ifdef BETTY_TIMINGS
+
+#include "../include/stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_FRAMES 256
+#define NAME_LENGTH 32
+#define INITIAL_PROFILE_CAPACITY 256
+
+/*
+ * Cost - Resources used by a stretch of work
+ * @ns: Nanoseconds
+ * @allocs: Allocations and reallocations (STATS=1 builds)
+ * @bytes: Bytes allocated (STATS=1 builds)
+ */
+typedef struct Cost {
+	unsigned long long ns;
+	unsigned long allocs;
+	size_t bytes;
+} Cost;
+
+/*
+ * ProfileEntry - One top-level item, or one statement-level recovery
+ * @file: Input file (the caller's string, which outlives the report)
+ * @line: Line of the first token
+ * @type: Node type
+ * @name: Start of the node's token text
+ * @parse: Parse cost, including everything nested in the item
+ * @format: Format cost, likewise
+ * @parse_hot: Inner node type with the most parse self-cost
+ * @format_hot: Inner node type with the most format self-cost
+ */
+typedef struct ProfileEntry {
+	const char *file;
+	int line;
+	NodeType type;
+	char name[NAME_LENGTH];
+	Cost parse;
+	Cost format;
+	NodeType parse_hot;
+	NodeType format_hot;
+} ProfileEntry;
+
+/*
+ * EntryList - Growable array of entries
+ */
+typedef struct EntryList {
+	ProfileEntry *entries;
+	int count;
+	int capacity;
+} EntryList;
+
+/*
+ * Frame - An open statement
+ * @self: Cost charged to the statement itself, not to nested ones
+ * @begin: Sample taken when the statement opened
+ */
+typedef struct Frame {
+	Cost self;
+	Cost begin;
+} Frame;
+
+static int active;
+static const char *current_file;
+static Token **current_tokens;
+
+static EntryList items;    /* Top-level items of every file */
+static EntryList regions;  /* Statements the parser had to recover */
+static int file_base;      /* Index in items of the file's first item */
+static int failed;
+
+/* Self-cost per node type over all files */
+static Cost parse_types[NODE_TYPE_COUNT];
+static Cost format_types[NODE_TYPE_COUNT];
+
+/* Parse side: the item being parsed and its open statements */
+static Frame frames[MAX_FRAMES];
+static int depth;
+static Cost item_begin;
+static Cost item_self;
+static Cost item_types[NODE_TYPE_COUNT];
+
+/* Format side: the item being formatted and the node of the last task */
+static int format_index = -1;
+static Cost format_begin;
+static NodeType format_owner;
+static Cost format_item_types[NODE_TYPE_COUNT];
+
+static Cost last;  /* When the last stretch was charged */
+
+/*
+ * sample - Read the clock and the allocation counters
+ */
+static Cost sample(void)
+{
+	struct timespec ts;
+	StatsTotals totals;
+	Cost now;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	stats_totals(&totals);
+	now.ns = (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	now.allocs = totals.allocs;
+	now.bytes = totals.bytes;
+	return (now);
+}
+
+static Cost cost_between(const Cost *from, const Cost *to)
+{
+	Cost delta;
+
+	delta.ns = to->ns - from->ns;
+	delta.allocs = to->allocs - from->allocs;
+	delta.bytes = to->bytes - from->bytes;
+	return (delta);
+}
+
+static void cost_add(Cost *total, const Cost *amount)
+{
+	total->ns += amount->ns;
+	total->allocs += amount->allocs;
+	total->bytes += amount->bytes;
+}
+
+/*
+ * charge - Add the time since the last charge to a cost
+ * @to: Cost the stretch belongs to
+ * @now: Current sample
+ */
+static void charge(Cost *to, const Cost *now)
+{
+	Cost delta = cost_between(&last, now);
+
+	cost_add(to, &delta);
+	last = *now;
+}
+
+/*
+ * hottest - Find the node type with the largest cost
+ * @types: Cost per node type
+ * @own: Type of the item itself, which is not "inside" it (nor is the
+ *        program, which owns the step between two items)
+ *
+ * Return: Hottest type, or @own if nothing nested cost anything
+ */
+static NodeType hottest(const Cost *types, NodeType own)
+{
+	NodeType best = own;
+	unsigned long long best_ns = 0;
+	int i;
+
+	for (i = 0; i < NODE_TYPE_COUNT; i++)
+	{
+		if ((NodeType)i != own && i != NODE_PROGRAM &&
+		    types[i].ns > best_ns)
+		{
+			best = (NodeType)i;
+			best_ns = types[i].ns;
+		}
+	}
+	return (best);
+}
+
+/*
+ * add_entry - Make room for an entry
+ * @list: List to grow
+ * @index: Index the entry goes to (at most one past the end)
+ *
+ * Return: Zeroed entry, or NULL if out of memory (profiling stops)
+ */
+static ProfileEntry *add_entry(EntryList *list, int index)
+{
+	if (failed || index < 0 || index > list->count)
+		return (NULL);
+
+	if (index == list->count)
+	{
+		if (list->count >= list->capacity)
+		{
+			int new_capacity = list->capacity == 0 ?
+				INITIAL_PROFILE_CAPACITY : list->capacity * 2;
+			ProfileEntry *new_entries = realloc(list->entries,
+				sizeof(ProfileEntry) * new_capacity);
+
+			if (!new_entries)
+			{
+				failed = 1;
+				return (NULL);
+			}
+			list->entries = new_entries;
+			list->capacity = new_capacity;
+		}
+		list->count++;
+	}
+
+	memset(&list->entries[index], 0, sizeof(ProfileEntry));
+	return (&list->entries[index]);
+}
+
+/*
+ * describe - Fill in where an entry is and what it is
+ * @entry: Entry to fill in
+ * @node: Its node (may be NULL)
+ */
+static void describe(ProfileEntry *entry, const ASTNode *node)
+{
+	const Token *token = node ? node->token : NULL;
+	int i;
+
+	entry->file = current_file;
+	entry->type = node ? node->type : NODE_UNPARSED;
+	entry->parse_hot = entry->type;
+	entry->format_hot = entry->type;
+
+	/* The span of a top-level item starts at its leading whitespace */
+	if (node && current_tokens && node->token_end > node->token_start)
+	{
+		for (i = node->token_start; i < node->token_end; i++)
+		{
+			TokenType type = current_tokens[i]->type;
+
+			if (type != TOK_WHITESPACE && type != TOK_NEWLINE &&
+			    type != TOK_COMMENT_LINE && type != TOK_COMMENT_BLOCK)
+			{
+				if (!token)
+					token = current_tokens[i];
+				entry->line = current_tokens[i]->line;
+				break;
+			}
+		}
+	}
+	if (entry->line == 0 && token)
+		entry->line = token->line;
+
+	if (token && token->lexeme)
+	{
+		for (i = 0; i < NAME_LENGTH - 1 && token->lexeme[i] &&
+		     token->lexeme[i] != '\n'; i++)
+			entry->name[i] = token->lexeme[i];
+		entry->name[i] = '\0';
+	}
+}
+
+/*
+ * profile_begin_file - Start recording the parse and format of a file
+ * @filename: Name shown in the report (must stay valid until then)
+ * @tokens: Tokens of the file, for the line numbers of items
+ */
+void profile_begin_file(const char *filename, Token **tokens)
+{
+	current_file = filename;
+	current_tokens = tokens;
+	file_base = items.count;
+	depth = 0;
+	format_index = -1;
+	format_owner = NODE_PROGRAM;
+	memset(&item_self, 0, sizeof(item_self));
+	memset(item_types, 0, sizeof(item_types));
+	memset(format_item_types, 0, sizeof(format_item_types));
+	last = sample();
+	item_begin = last;
+	active = 1;
+}
+
+/*
+ * profile_end_file - Stop recording
+ *
+ * Verification re-parses and re-formats the output after this, and must
+ * not be charged to the input's items.
+ */
+void profile_end_file(void)
+{
+	if (!active)
+		return;
+
+	profile_format_item(-1);
+	active = 0;
+	current_tokens = NULL;
+}
+
+/*
+ * profile_statement_begin - A statement starts parsing
+ */
+void profile_statement_begin(void)
+{
+	Cost now;
+
+	if (!active)
+		return;
+
+	now = sample();
+	if (depth == 0)
+		charge(&item_self, &now);
+	else
+		charge(&frames[(depth < MAX_FRAMES ? depth : MAX_FRAMES) - 1].self,
+		       &now);
+	if (depth < MAX_FRAMES)
+	{
+		memset(&frames[depth].self, 0, sizeof(Cost));
+		frames[depth].begin = now;
+	}
+	depth++;
+}
+
+/*
+ * profile_statement_end - A statement finished parsing
+ * @node: Resulting node (NULL or NODE_UNPARSED if it was recovered)
+ */
+void profile_statement_end(const ASTNode *node)
+{
+	NodeType type = node ? node->type : NODE_UNPARSED;
+	ProfileEntry *region;
+	Frame *frame;
+	Cost now;
+
+	if (!active || depth == 0)
+		return;
+
+	now = sample();
+	depth--;
+	if (depth >= MAX_FRAMES)
+	{
+		charge(&frames[MAX_FRAMES - 1].self, &now);
+		return;
+	}
+
+	frame = &frames[depth];
+	charge(&frame->self, &now);
+	cost_add(&item_types[type], &frame->self);
+	cost_add(&parse_types[type], &frame->self);
+
+	if (type == NODE_UNPARSED)
+	{
+		region = add_entry(&regions, regions.count);
+		if (region)
+		{
+			describe(region, node);
+			region->parse = cost_between(&frame->begin, &now);
+		}
+	}
+}
+
+/*
+ * profile_item_parsed - A top-level item was added to the program
+ * @item: The item, with its token span set
+ * @index: Its index among the program's children
+ *
+ * Everything parsed since the previous item is charged to this one.
+ */
+void profile_item_parsed(const ASTNode *item, int index)
+{
+	ProfileEntry *entry;
+	Cost now;
+
+	if (!active)
+		return;
+
+	now = sample();
+	charge(&item_self, &now);
+	depth = 0;
+
+	entry = add_entry(&items, file_base + index);
+	if (entry)
+	{
+		describe(entry, item);
+		entry->parse = cost_between(&item_begin, &now);
+		entry->parse_hot = hottest(item_types, item->type);
+	}
+	cost_add(&parse_types[item->type], &item_self);
+
+	memset(&item_self, 0, sizeof(item_self));
+	memset(item_types, 0, sizeof(item_types));
+	item_begin = now;
+}
+
+/*
+ * profile_format_task - The formatter pops its next task
+ * @node: Node of the task (NULL for plain text, charged like the last)
+ *
+ * The time since the previous task is that task's self-cost.
+ */
+void profile_format_task(const ASTNode *node)
+{
+	Cost now, delta;
+
+	if (!active)
+		return;
+
+	now = sample();
+	delta = cost_between(&last, &now);
+	cost_add(&format_types[format_owner], &delta);
+	cost_add(&format_item_types[format_owner], &delta);
+	last = now;
+
+	if (node)
+		format_owner = node->type;
+}
+
+/*
+ * profile_format_item - The formatter moves on to another top-level item
+ * @index: Index of the item among the program's children (-1 when done)
+ */
+void profile_format_item(int index)
+{
+	ProfileEntry *entry;
+	Cost now;
+
+	if (!active)
+		return;
+
+	now = sample();
+	if (format_index >= 0 && file_base + format_index < items.count)
+	{
+		entry = &items.entries[file_base + format_index];
+		entry->format = cost_between(&format_begin, &now);
+		entry->format_hot = hottest(format_item_types, entry->type);
+	}
+
+	memset(format_item_types, 0, sizeof(format_item_types));
+	format_index = index >= 0 && file_base + index < items.count ?
+		index : -1;
+	format_begin = now;
+}
+
+static unsigned long long entry_ns(const ProfileEntry *entry)
+{
+	return (entry->parse.ns + entry->format.ns);
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+	unsigned long long left = entry_ns(*(ProfileEntry *const *)a);
+	unsigned long long right = entry_ns(*(ProfileEntry *const *)b);
+
+	return (left < right ? 1 : left > right ? -1 : 0);
+}
+
+/*
+ * print_entries - Print the most expensive entries
+ * @out: Stream to print to
+ * @list: Entries, most expensive first
+ * @count: Number of entries
+ * @top: Maximum number to print
+ */
+static void print_entries(FILE *out, ProfileEntry **list, int count, int top)
+{
+	int i;
+
+	fprintf(out, "%9s %9s", "parse ms", "format ms");
+	if (STATS_ENABLED)
+		fprintf(out, " %8s %9s", "allocs", "KB");
+	fprintf(out, "  %s\n", "construct (hottest inside: parse / format)");
+
+	for (i = 0; i < count && i < top; i++)
+	{
+		const ProfileEntry *entry = list[i];
+
+		fprintf(out, "%9.3f %9.3f", entry->parse.ns / 1e6,
+			entry->format.ns / 1e6);
+		if (STATS_ENABLED)
+			fprintf(out, " %8lu %9.1f",
+				entry->parse.allocs + entry->format.allocs,
+				(entry->parse.bytes + entry->format.bytes) / 1024.0);
+		fprintf(out, "  %s:%d %s %s", entry->file ? entry->file : "-",
+			entry->line, ast_node_type_name(entry->type),
+			entry->name);
+		if (entry->parse_hot != entry->type ||
+		    entry->format_hot != entry->type)
+			fprintf(out, " (%s / %s)",
+				entry->parse_hot != entry->type ?
+				ast_node_type_name(entry->parse_hot) : "-",
+				entry->format_hot != entry->type ?
+				ast_node_type_name(entry->format_hot) : "-");
+		fputc('\n', out);
+	}
+}
+
+/*
+ * print_types - Print the self-cost of each node type
+ * @out: Stream to print to
+ */
+static void print_types(FILE *out)
+{
+	int i;
+
+	fprintf(out, "%-14s %9s %9s", "node type", "parse ms", "format ms");
+	if (STATS_ENABLED)
+		fprintf(out, " %8s %9s", "allocs", "KB");
+	fputc('\n', out);
+
+	for (i = 0; i < NODE_TYPE_COUNT; i++)
+	{
+		if (parse_types[i].ns == 0 && format_types[i].ns == 0)
+			continue;
+
+		fprintf(out, "%-14s %9.3f %9.3f", ast_node_type_name(i),
+			parse_types[i].ns / 1e6, format_types[i].ns / 1e6);
+		if (STATS_ENABLED)
+			fprintf(out, " %8lu %9.1f",
+				parse_types[i].allocs + format_types[i].allocs,
+				(parse_types[i].bytes + format_types[i].bytes) / 1024.0);
+		fputc('\n', out);
+	}
+}
+
+/*
+ * profile_report - Print the constructs that cost the most
+ * @out: Stream to print to
+ * @top: Number of constructs and recovery regions to list
+ *
+ * Recovered code (NODE_UNPARSED, top-level or statement) is listed apart
+ * from the parsed constructs. The recorded profile is released.
+ */
+void profile_report(FILE *out, int top)
+{
+	ProfileEntry **parsed, **recovered;
+	int parsed_count = 0, recovered_count = 0;
+	unsigned long long recovered_ns = 0;
+	int i;
+
+	parsed = malloc(sizeof(*parsed) * (items.count + 1));
+	recovered = malloc(sizeof(*recovered) *
+		(items.count + regions.count + 1));
+	if (!parsed || !recovered)
+	{
+		fprintf(out, "Error: Out of memory for the construct profile\n");
+		free(parsed);
+		free(recovered);
+		return;
+	}
+
+	for (i = 0; i < items.count; i++)
+	{
+		if (items.entries[i].type == NODE_UNPARSED)
+			recovered[recovered_count++] = &items.entries[i];
+		else
+			parsed[parsed_count++] = &items.entries[i];
+	}
+	for (i = 0; i < regions.count; i++)
+		recovered[recovered_count++] = &regions.entries[i];
+	for (i = 0; i < recovered_count; i++)
+		recovered_ns += entry_ns(recovered[i]);
+
+	qsort(parsed, parsed_count, sizeof(*parsed), compare_entries);
+	qsort(recovered, recovered_count, sizeof(*recovered), compare_entries);
+
+	fprintf(out, "=== Construct profile: top %d of %d constructs ===\n",
+		top < parsed_count ? top : parsed_count, parsed_count);
+	print_entries(out, parsed, parsed_count, top);
+
+	fprintf(out, "\n=== Self time per node type ===\n");
+	print_types(out);
+
+	fprintf(out, "\n=== Recovery regions: %d, %.3f ms ===\n",
+		recovered_count, recovered_ns / 1e6);
+	if (recovered_count > 0)
+		print_entries(out, recovered, recovered_count, top);
+	if (failed)
+		fprintf(out, "(profile truncated: out of memory)\n");
+
+	free(parsed);
+	free(recovered);
+	free(items.entries);
+	free(regions.entries);
+	memset(&items, 0, sizeof(items));
+	memset(&regions, 0, sizeof(regions));
+}
+
+#else
+
+/* ISO C forbids an empty translation unit */
+typedef int profile_disabled_t;
+
+#endif /* BETTY_TIMINGS */
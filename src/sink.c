@@ -0,0 +1,481 @@
+#define _GNU_SOURCE
+#include "../include/sink.h"
+#include "../include/stats.h"
+#include "../include/timings.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define INITIAL_MEMORY_CAPACITY 4096
+
+/*
+ * Gather sink tuning: borrowed spans shorter than GATHER_MIN_REF are
+ * cheaper to copy than to give their own iovec, and pending output is
+ * written once GATHER_MAX_SEGMENTS segments have accumulated.
+ */
+#define GATHER_MIN_REF 64
+#define GATHER_CHUNK_SIZE 65536
+#define GATHER_MAX_SEGMENTS 4096
+#define GATHER_IOV_BATCH 1024
+
+static OutputSink *sink_new(SinkKind kind);
+static int memory_reserve(OutputSink *sink, size_t extra);
+static int gather_copy(OutputSink *sink, const char *data, size_t length);
+static int gather_ref(OutputSink *sink, const char *data, size_t length);
+static int gather_flush(OutputSink *sink);
+
+/*
+ * sink_new - Allocate a sink with every backend field cleared
+ * @kind: Backend
+ *
+ * Return: Pointer to new sink, or NULL on failure
+ */
+static OutputSink *sink_new(SinkKind kind)
+{
+	OutputSink *sink;
+
+	sink = mem_alloc(sizeof(OutputSink), MEM_OUTPUT);
+	if (!sink)
+		return (NULL);
+
+	sink->kind = kind;
+	sink->buffer = NULL;
+	sink->length = 0;
+	sink->capacity = 0;
+	sink->fd = -1;
+	sink->segments = NULL;
+	sink->segment_count = 0;
+	sink->segment_capacity = 0;
+	sink->chunks = NULL;
+	sink->expected = NULL;
+	sink->expected_length = 0;
+	sink->mismatch = 0;
+	sink->written = 0;
+	sink->failed = 0;
+
+	return (sink);
+}
+
+/*
+ * sink_create_memory - Create a sink collecting output in memory
+ *
+ * Return: Pointer to new sink, or NULL on failure
+ */
+OutputSink *sink_create_memory(void)
+{
+	return (sink_new(SINK_MEMORY));
+}
+
+/*
+ * sink_create_compare - Create a sink checking output against a text
+ * @expected: Text the output should equal (must outlive the sink)
+ * @length: Length of @expected
+ *
+ * Return: Pointer to new sink, or NULL on failure
+ */
+OutputSink *sink_create_compare(const char *expected, size_t length)
+{
+	OutputSink *sink;
+
+	if (!expected)
+		return (NULL);
+
+	sink = sink_new(SINK_COMPARE);
+	if (!sink)
+		return (NULL);
+
+	sink->expected = expected;
+	sink->expected_length = length;
+
+	return (sink);
+}
+
+/*
+ * sink_create_gather - Create a sink writing to a descriptor with writev
+ * @fd: Open descriptor (not closed by the sink)
+ *
+ * Output is kept as a list of segments. Spans passed to sink_write_ref()
+ * are referenced in place instead of being copied; everything else is
+ * copied into a small arena. sink_flush() hands the list to writev().
+ *
+ * Return: Pointer to new sink, or NULL on failure
+ */
+OutputSink *sink_create_gather(int fd)
+{
+	OutputSink *sink;
+
+	if (fd < 0)
+		return (NULL);
+
+	sink = sink_new(SINK_GATHER);
+	if (!sink)
+		return (NULL);
+
+	sink->segments = mem_alloc(sizeof(SinkSegment) * GATHER_MAX_SEGMENTS,
+				   MEM_OUTPUT);
+	if (!sink->segments)
+	{
+		mem_free(sink);
+		return (NULL);
+	}
+	sink->segment_capacity = GATHER_MAX_SEGMENTS;
+	sink->fd = fd;
+
+	return (sink);
+}
+
+/*
+ * sink_destroy - Free sink memory (does not flush)
+ * @sink: Sink to destroy
+ */
+void sink_destroy(OutputSink *sink)
+{
+	SinkChunk *chunk, *next;
+
+	if (!sink)
+		return;
+
+	for (chunk = sink->chunks; chunk; chunk = next)
+	{
+		next = chunk->next;
+		mem_free(chunk);
+	}
+	mem_free(sink->segments);
+	mem_free(sink->buffer);
+	mem_free(sink);
+}
+
+/*
+ * memory_reserve - Make room for more bytes in a memory sink
+ * @sink: Memory sink
+ * @extra: Bytes about to be appended (plus a terminating NUL)
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int memory_reserve(OutputSink *sink, size_t extra)
+{
+	size_t needed = sink->length + extra + 1;
+	size_t new_capacity;
+	char *new_buffer;
+
+	if (needed <= sink->capacity)
+		return (0);
+
+	new_capacity = sink->capacity == 0 ?
+		INITIAL_MEMORY_CAPACITY : sink->capacity;
+	while (new_capacity < needed)
+		new_capacity *= 2;
+
+	new_buffer = mem_realloc(sink->buffer, new_capacity, MEM_OUTPUT);
+	if (!new_buffer)
+		return (-1);
+
+	sink->buffer = new_buffer;
+	sink->capacity = new_capacity;
+	return (0);
+}
+
+/*
+ * gather_copy - Copy a span into the gather sink's arena
+ * @sink: Gather sink
+ * @data: Bytes to copy
+ * @length: Number of bytes
+ *
+ * Consecutive copies extend the same segment.
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int gather_copy(OutputSink *sink, const char *data, size_t length)
+{
+	SinkChunk *chunk;
+	SinkSegment *last;
+	char *dest;
+
+	/* Flushing resets the arena, so never do it with a copy in flight */
+	if (sink->segment_count >= sink->segment_capacity &&
+	    gather_flush(sink) < 0)
+		return (-1);
+
+	/* A full arena is written out and reused rather than grown */
+	chunk = sink->chunks;
+	if (chunk && chunk->size - chunk->used < length &&
+	    gather_flush(sink) < 0)
+		return (-1);
+
+	if (!chunk || chunk->size - chunk->used < length)
+	{
+		size_t size = length > GATHER_CHUNK_SIZE ?
+			length : GATHER_CHUNK_SIZE;
+
+		chunk = mem_alloc(sizeof(SinkChunk) + size, MEM_OUTPUT);
+		if (!chunk)
+			return (-1);
+		chunk->next = sink->chunks;
+		chunk->used = 0;
+		chunk->size = size;
+		sink->chunks = chunk;
+	}
+
+	dest = chunk->data + chunk->used;
+	memcpy(dest, data, length);
+	chunk->used += length;
+
+	last = sink->segment_count > 0 ?
+		&sink->segments[sink->segment_count - 1] : NULL;
+	if (last && last->data + last->length == dest)
+	{
+		last->length += length;
+		return (0);
+	}
+
+	sink->segments[sink->segment_count].data = dest;
+	sink->segments[sink->segment_count].length = length;
+	sink->segment_count++;
+
+	return (0);
+}
+
+/*
+ * gather_ref - Reference a span in place from the gather sink
+ * @sink: Gather sink
+ * @data: Bytes to reference (must stay valid until the next flush)
+ * @length: Number of bytes
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int gather_ref(OutputSink *sink, const char *data, size_t length)
+{
+	SinkSegment *last;
+
+	if (length < GATHER_MIN_REF)
+		return (gather_copy(sink, data, length));
+
+	if (sink->segment_count >= sink->segment_capacity &&
+	    gather_flush(sink) < 0)
+		return (-1);
+
+	last = sink->segment_count > 0 ?
+		&sink->segments[sink->segment_count - 1] : NULL;
+	if (last && last->data + last->length == data)
+	{
+		last->length += length;
+		return (0);
+	}
+
+	sink->segments[sink->segment_count].data = data;
+	sink->segments[sink->segment_count].length = length;
+	sink->segment_count++;
+
+	return (0);
+}
+
+/*
+ * gather_flush - Write all pending segments and reset the arena
+ * @sink: Gather sink
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int gather_flush(OutputSink *sink)
+{
+	struct iovec iov[GATHER_IOV_BATCH];
+	SinkChunk *chunk, *next;
+	int done = 0;
+
+	while (done < sink->segment_count)
+	{
+		int count = sink->segment_count - done;
+		int i;
+		ssize_t n;
+
+		if (count > GATHER_IOV_BATCH)
+			count = GATHER_IOV_BATCH;
+		for (i = 0; i < count; i++)
+		{
+			iov[i].iov_base = (void *)sink->segments[done + i].data;
+			iov[i].iov_len = sink->segments[done + i].length;
+		}
+
+		timing_begin(TIME_WRITE);
+		n = writev(sink->fd, iov, count);
+		timing_end(TIME_WRITE);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return (-1);
+		}
+
+		/* Skip fully written segments, trim a partially written one */
+		for (i = 0; i < count && (size_t)n >= iov[i].iov_len; i++)
+			n -= iov[i].iov_len;
+		done += i;
+		if (i < count)
+		{
+			sink->segments[done].data += n;
+			sink->segments[done].length -= n;
+		}
+	}
+	sink->segment_count = 0;
+
+	/* Keep the newest chunk for reuse */
+	if (sink->chunks)
+	{
+		for (chunk = sink->chunks->next; chunk; chunk = next)
+		{
+			next = chunk->next;
+			mem_free(chunk);
+		}
+		sink->chunks->next = NULL;
+		sink->chunks->used = 0;
+	}
+
+	return (0);
+}
+
+/*
+ * sink_write - Append a span of output
+ * @sink: Sink instance
+ * @data: Bytes to append
+ * @length: Number of bytes
+ *
+ * Return: 0 on success, -1 on error (the sink stays failed)
+ */
+int sink_write(OutputSink *sink, const char *data, size_t length)
+{
+	if (!sink || sink->failed)
+		return (-1);
+	if (length == 0)
+		return (0);
+
+	timing_count(COUNT_BYTES_EMITTED, length);
+	switch (sink->kind)
+	{
+	case SINK_MEMORY:
+		if (memory_reserve(sink, length) < 0)
+		{
+			sink->failed = 1;
+			return (-1);
+		}
+		memcpy(sink->buffer + sink->length, data, length);
+		sink->length += length;
+		sink->buffer[sink->length] = '\0';
+		break;
+
+	case SINK_COMPARE:
+		if (!sink->mismatch &&
+		    (sink->written + length > sink->expected_length ||
+		     memcmp(sink->expected + sink->written, data, length) != 0))
+			sink->mismatch = 1;
+		break;
+
+	case SINK_GATHER:
+		if (gather_copy(sink, data, length) < 0)
+		{
+			sink->failed = 1;
+			return (-1);
+		}
+		break;
+	}
+
+	sink->written += length;
+	return (0);
+}
+
+/*
+ * sink_write_ref - Append a span the sink may reference instead of copy
+ * @sink: Sink instance
+ * @data: Bytes to append, valid until the next sink_flush()
+ * @length: Number of bytes
+ *
+ * Only the gather sink keeps the reference; other backends copy as usual.
+ *
+ * Return: 0 on success, -1 on error (the sink stays failed)
+ */
+int sink_write_ref(OutputSink *sink, const char *data, size_t length)
+{
+	if (!sink || sink->kind != SINK_GATHER)
+		return (sink_write(sink, data, length));
+
+	if (sink->failed)
+		return (-1);
+	if (length == 0)
+		return (0);
+
+	timing_count(COUNT_BYTES_EMITTED, length);
+	if (gather_ref(sink, data, length) < 0)
+	{
+		sink->failed = 1;
+		return (-1);
+	}
+
+	sink->written += length;
+	return (0);
+}
+
+/*
+ * sink_flush - Write out anything a gather sink still holds
+ * @sink: Sink instance
+ *
+ * Return: 0 on success, -1 on error
+ */
+int sink_flush(OutputSink *sink)
+{
+	if (!sink || sink->failed)
+		return (-1);
+
+	if (sink->kind == SINK_GATHER && gather_flush(sink) < 0)
+	{
+		sink->failed = 1;
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*
+ * sink_take_buffer - Take ownership of a memory sink's output
+ * @sink: Memory sink
+ * @length: Output parameter for the output length (may be NULL)
+ *
+ * The sink is left empty. Free the result with mem_free().
+ *
+ * Return: NUL-terminated output, or NULL on error
+ */
+char *sink_take_buffer(OutputSink *sink, size_t *length)
+{
+	char *buffer;
+
+	if (!sink || sink->kind != SINK_MEMORY || sink->failed)
+		return (NULL);
+
+	/* Empty output still yields an empty string */
+	if (memory_reserve(sink, 0) < 0)
+		return (NULL);
+
+	buffer = sink->buffer;
+	buffer[sink->length] = '\0';
+	if (length)
+		*length = sink->length;
+
+	sink->buffer = NULL;
+	sink->length = 0;
+	sink->capacity = 0;
+
+	return (buffer);
+}
+
+/*
+ * sink_matches - Check whether a compare sink saw exactly the expected text
+ * @sink: Compare sink
+ *
+ * Return: 1 if the output equals the expected text, 0 otherwise
+ */
+int sink_matches(const OutputSink *sink)
+{
+	if (!sink || sink->kind != SINK_COMPARE || sink->failed)
+		return (0);
+
+	return (!sink->mismatch && sink->written == sink->expected_length);
+}
@@ -0,0 +1,157 @@
+#include "../include/source_map.h"
+#include "../include/stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_ANCHOR_CAPACITY 256
+
+/*
+ * source_map_create - Create an empty source map
+ *
+ * Return: Pointer to new source map, or NULL on failure
+ */
+SourceMap *source_map_create(void)
+{
+	SourceMap *map;
+
+	map = mem_alloc(sizeof(SourceMap), MEM_OUTPUT);
+	if (!map)
+		return (NULL);
+
+	map->anchors = NULL;
+	map->count = 0;
+	map->capacity = 0;
+
+	return (map);
+}
+
+/*
+ * source_map_destroy - Free source map memory
+ * @map: Source map to destroy
+ */
+void source_map_destroy(SourceMap *map)
+{
+	if (!map)
+		return;
+
+	mem_free(map->anchors);
+	mem_free(map);
+}
+
+/*
+ * source_map_add - Append an anchor
+ * @map: Source map
+ * @output: Offset in the formatted output (not below the last anchor's)
+ * @input: Offset of the same text in the source
+ *
+ * An anchor identical to the previous one is dropped.
+ *
+ * Return: 0 on success, -1 on error
+ */
+int source_map_add(SourceMap *map, size_t output, size_t input)
+{
+	SourceAnchor *last;
+
+	if (!map)
+		return (-1);
+
+	if (map->count > 0)
+	{
+		last = &map->anchors[map->count - 1];
+		if (output < last->output)
+			return (-1);
+		if (output == last->output && input == last->input)
+			return (0);
+	}
+
+	if (map->count >= map->capacity)
+	{
+		int new_capacity = map->capacity == 0 ?
+			INITIAL_ANCHOR_CAPACITY : map->capacity * 2;
+		SourceAnchor *new_anchors = mem_realloc(map->anchors,
+			sizeof(SourceAnchor) * new_capacity, MEM_OUTPUT);
+
+		if (!new_anchors)
+			return (-1);
+		map->anchors = new_anchors;
+		map->capacity = new_capacity;
+	}
+
+	map->anchors[map->count].output = output;
+	map->anchors[map->count].input = input;
+	map->count++;
+
+	return (0);
+}
+
+/*
+ * source_map_input - Map an output offset back to the source
+ * @map: Source map
+ * @output: Offset in the formatted output
+ *
+ * Binary search for the last anchor at or before @output; the offset
+ * keeps its distance from that anchor.
+ *
+ * Return: Source offset (@output itself if the map has no anchor before it)
+ */
+size_t source_map_input(const SourceMap *map, size_t output)
+{
+	int low = 0, high, mid;
+
+	if (!map || map->count == 0 || output < map->anchors[0].output)
+		return (output);
+
+	high = map->count - 1;
+	while (low < high)
+	{
+		mid = low + (high - low + 1) / 2;
+		if (map->anchors[mid].output <= output)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	return (map->anchors[low].input + (output - map->anchors[low].output));
+}
+
+/*
+ * source_map_write - Write a source map as JSON
+ * @map: Source map
+ * @source_path: Name of the formatted file (recorded in the map)
+ * @fp: Output stream
+ *
+ * Format: {"version":1,"source":"<path>","anchors":[o0,i0,o1,i1,...]}
+ * with anchors flattened into (output, input) pairs in output order.
+ *
+ * Return: 0 on success, -1 on error
+ */
+int source_map_write(const SourceMap *map, const char *source_path,
+		     FILE *fp)
+{
+	const char *p;
+	int i;
+
+	if (!map || !fp)
+		return (-1);
+
+	fputs("{\"version\":1,\"source\":\"", fp);
+	for (p = source_path ? source_path : ""; *p; p++)
+	{
+		if (*p == '"' || *p == '\\')
+			fputc('\\', fp);
+		if ((unsigned char)*p < 0x20)
+			fprintf(fp, "\\u%04x", (unsigned char)*p);
+		else
+			fputc(*p, fp);
+	}
+	fputs("\",\"anchors\":[", fp);
+
+	for (i = 0; i < map->count; i++)
+		fprintf(fp, "%s%lu,%lu", i > 0 ? "," : "",
+			(unsigned long)map->anchors[i].output,
+			(unsigned long)map->anchors[i].input);
+
+	fputs("]}\n", fp);
+
+	return (ferror(fp) ? -1 : 0);
+}
@@ -0,0 +1,333 @@
+#include "../include/stats.h"
+
+#ifdef BETTY_STATS
+
+#define MAX_PHASES 16
+
+/*
+ * BlockHeader - Prefix of every counted allocation
+ * @size: Requested size of the block
+ * @subsystem: Subsystem the block is charged to
+ *
+ * The union keeps the user pointer aligned for any type.
+ */
+typedef union BlockHeader {
+	struct {
+		size_t size;
+		MemSubsystem subsystem;
+	} info;
+	long double align_ld;
+	void *align_ptr;
+	long long align_ll;
+} BlockHeader;
+
+typedef struct SubsystemStats {
+	unsigned long allocs;
+	unsigned long reallocs;
+	unsigned long frees;
+	size_t bytes;
+	size_t live;
+	size_t peak;
+} SubsystemStats;
+
+typedef struct PhaseStats {
+	const char *name;
+	unsigned long allocs;
+	size_t bytes;
+	size_t peak;
+} PhaseStats;
+
+static const char *subsystem_names[MEM_SUBSYSTEM_COUNT] = {
+	"lexer", "tokens", "parser", "ast", "symbols", "comments",
+	"formatter", "cache", "output", "server"
+};
+
+static SubsystemStats subsystems[MEM_SUBSYSTEM_COUNT];
+static size_t total_live;
+static size_t total_peak;
+
+static PhaseStats phases[MAX_PHASES];
+static int phase_count;
+static unsigned long phase_allocs;
+static size_t phase_bytes;
+static size_t phase_peak;
+
+/*
+ * charge - Account for a new block
+ */
+static void charge(MemSubsystem subsystem, size_t size)
+{
+	SubsystemStats *s = &subsystems[subsystem];
+
+	s->allocs++;
+	s->bytes += size;
+	s->live += size;
+	if (s->live > s->peak)
+		s->peak = s->live;
+
+	total_live += size;
+	if (total_live > total_peak)
+		total_peak = total_live;
+
+	phase_allocs++;
+	phase_bytes += size;
+	if (total_live > phase_peak)
+		phase_peak = total_live;
+}
+
+/*
+ * discharge - Account for a released block
+ */
+static void discharge(MemSubsystem subsystem, size_t size)
+{
+	subsystems[subsystem].frees++;
+	subsystems[subsystem].live -= size;
+	total_live -= size;
+}
+
+/*
+ * mem_alloc - Allocate memory charged to a subsystem
+ * @size: Bytes to allocate
+ * @subsystem: Subsystem to charge
+ *
+ * Return: Pointer to memory, or NULL on failure
+ */
+void *mem_alloc(size_t size, MemSubsystem subsystem)
+{
+	BlockHeader *header;
+
+	header = malloc(sizeof(BlockHeader) + size);
+	if (!header)
+		return (NULL);
+
+	header->info.size = size;
+	header->info.subsystem = subsystem;
+	charge(subsystem, size);
+
+	return (header + 1);
+}
+
+/*
+ * mem_calloc - Allocate zeroed memory charged to a subsystem
+ * @count: Number of elements
+ * @size: Size of each element
+ * @subsystem: Subsystem to charge
+ *
+ * Return: Pointer to memory, or NULL on failure
+ */
+void *mem_calloc(size_t count, size_t size, MemSubsystem subsystem)
+{
+	void *ptr;
+
+	if (size != 0 && count > (size_t)-1 / size)
+		return (NULL);
+
+	ptr = mem_alloc(count * size, subsystem);
+	if (ptr)
+		memset(ptr, 0, count * size);
+
+	return (ptr);
+}
+
+/*
+ * mem_realloc - Resize a counted block
+ * @ptr: Block to resize (NULL allocates)
+ * @size: New size
+ * @subsystem: Subsystem to charge if @ptr is NULL
+ *
+ * An existing block stays charged to the subsystem that allocated it.
+ *
+ * Return: Pointer to resized memory, or NULL on failure (@ptr untouched)
+ */
+void *mem_realloc(void *ptr, size_t size, MemSubsystem subsystem)
+{
+	BlockHeader *header, *new_header;
+	size_t old_size;
+
+	if (!ptr)
+		return (mem_alloc(size, subsystem));
+
+	header = (BlockHeader *)ptr - 1;
+	old_size = header->info.size;
+	subsystem = header->info.subsystem;
+
+	new_header = realloc(header, sizeof(BlockHeader) + size);
+	if (!new_header)
+		return (NULL);
+
+	/* Counted as a resize, not as a free plus a new block */
+	new_header->info.size = size;
+	discharge(subsystem, old_size);
+	charge(subsystem, size);
+	subsystems[subsystem].frees--;
+	subsystems[subsystem].allocs--;
+	subsystems[subsystem].reallocs++;
+
+	return (new_header + 1);
+}
+
+/*
+ * mem_strdup - Duplicate a string into a counted block
+ * @str: String to copy
+ * @subsystem: Subsystem to charge
+ *
+ * Return: Copy of @str, or NULL on failure
+ */
+char *mem_strdup(const char *str, MemSubsystem subsystem)
+{
+	size_t len;
+	char *copy;
+
+	if (!str)
+		return (NULL);
+
+	len = strlen(str) + 1;
+	copy = mem_alloc(len, subsystem);
+	if (copy)
+		memcpy(copy, str, len);
+
+	return (copy);
+}
+
+/*
+ * mem_free - Release a counted block
+ * @ptr: Block to free (may be NULL)
+ */
+void mem_free(void *ptr)
+{
+	BlockHeader *header;
+
+	if (!ptr)
+		return;
+
+	header = (BlockHeader *)ptr - 1;
+	discharge(header->info.subsystem, header->info.size);
+	free(header);
+}
+
+/*
+ * stats_reset - Start a new measurement (e.g. for the next input file)
+ *
+ * Blocks that are still live stay accounted as live.
+ */
+void stats_reset(void)
+{
+	int i;
+
+	for (i = 0; i < MEM_SUBSYSTEM_COUNT; i++)
+	{
+		subsystems[i].allocs = 0;
+		subsystems[i].reallocs = 0;
+		subsystems[i].frees = 0;
+		subsystems[i].bytes = 0;
+		subsystems[i].peak = subsystems[i].live;
+	}
+	total_peak = total_live;
+
+	phase_count = 0;
+	phase_allocs = 0;
+	phase_bytes = 0;
+	phase_peak = total_live;
+}
+
+/*
+ * stats_end_phase - Close the current pipeline phase
+ * @name: Name of the phase that just finished (static string)
+ */
+void stats_end_phase(const char *name)
+{
+	if (phase_count < MAX_PHASES)
+	{
+		phases[phase_count].name = name;
+		phases[phase_count].allocs = phase_allocs;
+		phases[phase_count].bytes = phase_bytes;
+		phases[phase_count].peak = phase_peak;
+		phase_count++;
+	}
+
+	phase_allocs = 0;
+	phase_bytes = 0;
+	phase_peak = total_live;
+}
+
+/*
+ * stats_totals - Read the allocation totals since the last reset
+ * @totals: Filled with the counts of all subsystems together
+ */
+void stats_totals(StatsTotals *totals)
+{
+	int i;
+
+	memset(totals, 0, sizeof(*totals));
+	for (i = 0; i < MEM_SUBSYSTEM_COUNT; i++)
+	{
+		totals->allocs += subsystems[i].allocs + subsystems[i].reallocs;
+		totals->bytes += subsystems[i].bytes;
+	}
+	totals->peak = total_peak;
+}
+
+static double per_input(size_t bytes, size_t input_bytes)
+{
+	return (input_bytes ? (double)bytes / (double)input_bytes : 0.0);
+}
+
+/*
+ * stats_report - Print allocation statistics since the last reset
+ * @out: Stream to print to
+ * @label: Name of the measured input
+ * @input_bytes: Size of the input, for the bytes-per-input-byte ratios
+ */
+void stats_report(FILE *out, const char *label, size_t input_bytes)
+{
+	SubsystemStats total = {0, 0, 0, 0, 0, 0};
+	int i;
+
+	fprintf(out, "=== Memory statistics: %s (%lu input bytes) ===\n",
+		label ? label : "-", (unsigned long)input_bytes);
+	fprintf(out, "%-10s %10s %9s %10s %12s %12s %10s %8s %8s\n",
+		"subsystem", "allocs", "reallocs", "frees", "bytes",
+		"peak live", "live", "B/in", "peak/in");
+
+	for (i = 0; i < MEM_SUBSYSTEM_COUNT; i++)
+	{
+		SubsystemStats *s = &subsystems[i];
+
+		fprintf(out, "%-10s %10lu %9lu %10lu %12lu %12lu %10lu %8.2f %8.2f\n",
+			subsystem_names[i], s->allocs, s->reallocs, s->frees,
+			(unsigned long)s->bytes, (unsigned long)s->peak,
+			(unsigned long)s->live, per_input(s->bytes, input_bytes),
+			per_input(s->peak, input_bytes));
+
+		total.allocs += s->allocs;
+		total.reallocs += s->reallocs;
+		total.frees += s->frees;
+		total.bytes += s->bytes;
+	}
+
+	fprintf(out, "%-10s %10lu %9lu %10lu %12lu %12lu %10lu %8.2f %8.2f\n",
+		"total", total.allocs, total.reallocs, total.frees,
+		(unsigned long)total.bytes,
+		(unsigned long)total_peak, (unsigned long)total_live,
+		per_input(total.bytes, input_bytes),
+		per_input(total_peak, input_bytes));
+
+	if (phase_count > 0)
+	{
+		fprintf(out, "\n%-10s %10s %12s %12s %8s\n",
+			"phase", "allocs", "bytes", "peak live", "peak/in");
+		for (i = 0; i < phase_count; i++)
+			fprintf(out, "%-10s %10lu %12lu %12lu %8.2f\n",
+				phases[i].name, phases[i].allocs,
+				(unsigned long)phases[i].bytes,
+				(unsigned long)phases[i].peak,
+				per_input(phases[i].peak, input_bytes));
+	}
+}
+
+#else
+
+/* ISO C forbids an empty translation unit */
+typedef int stats_disabled_t;
+
+#endif /* BETTY_STATS */
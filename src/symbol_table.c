@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 200809L
 #include "symbol_table.h"
+#include "stats.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -33,7 +34,7 @@ SymbolTable *symbol_table_create(SymbolTable *parent)
 	SymbolTable *table;
 	int i;
 
-	table = malloc(sizeof(SymbolTable));
+	table = mem_alloc(sizeof(SymbolTable), MEM_SYMBOLS);
 	if (!table)
 		return (NULL);
 
@@ -65,13 +66,13 @@ void symbol_table_destroy(SymbolTable *table)
 		while (sym)
 		{
 			next = sym->next;
-			free(sym->name);
-			free(sym);
+			mem_free(sym->name);
+			mem_free(sym);
 			sym = next;
 		}
 	}
 
-	free(table);
+	mem_free(table);
 }
 
 /**
@@ -97,14 +98,14 @@ void symbol_add(SymbolTable *table, const char *name, SymbolKind kind)
 	}
 
 	/* Create new symbol */
-	sym = malloc(sizeof(Symbol));
+	sym = mem_alloc(sizeof(Symbol), MEM_SYMBOLS);
 	if (!sym)
 		return;
 
-	sym->name = strdup(name);
+	sym->name = mem_strdup(name, MEM_SYMBOLS);
 	if (!sym->name)
 	{
-		free(sym);
+		mem_free(sym);
 		return;
 	}
 
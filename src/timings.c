@@ -0,0 +1,231 @@
+#define _GNU_SOURCE
+#include "../include/timings.h"
+#include "../include/trace.h"
+
+#ifdef BETTY_TIMINGS
+
+#include <time.h>
+
+#define MAX_NESTING 16
+
+/*
+ * TimingSet - Accumulated figures of one file or of all files
+ * @ns: Nanoseconds charged to each phase
+ * @spans: Number of spans of each phase
+ * @counters: Event counters
+ * @wall: Nanoseconds from reset to report
+ * @bytes: Input bytes
+ */
+typedef struct TimingSet {
+	unsigned long long ns[TIME_PHASE_COUNT];
+	unsigned long spans[TIME_PHASE_COUNT];
+	unsigned long counters[TIME_COUNTER_COUNT];
+	unsigned long long wall;
+	size_t bytes;
+} TimingSet;
+
+static const char *phase_names[TIME_PHASE_COUNT] = {
+	"read", "lex", "parse", "recovery", "lint", "format", "verify",
+	"write"
+};
+
+static const char *counter_names[TIME_COUNTER_COUNT] = {
+	"speculation rewinds", "tokens rewound", "unparsed fallbacks",
+	"bytes emitted", "tokens visited", "format tasks"
+};
+
+static TimingSet current;
+static TimingSet total;
+static int file_count;
+
+/* Open spans, innermost last; only the innermost one is running */
+static TimingPhase stack[MAX_NESTING];
+static int depth;
+static unsigned long long resumed;  /* When the innermost span last ran */
+static unsigned long long started;  /* When the current file was reset */
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+/*
+ * timing_begin - Open a span of a phase
+ * @phase: Phase starting now
+ *
+ * The enclosing span stops accumulating until this one ends, except
+ * that everything inside a verify span counts as verify. A trace, if
+ * one is recording, gets the span under its own name.
+ */
+void timing_begin(TimingPhase phase)
+{
+	unsigned long long t = now_ns();
+	TimingPhase requested = phase;
+	TimingPhase outer = depth > 0 && depth <= MAX_NESTING ?
+		stack[depth - 1] : phase;
+
+	if (depth > 0)
+		current.ns[outer] += t - resumed;
+
+	/* Re-lexing and re-formatting for verification is verification */
+	if (depth > 0 && outer == TIME_VERIFY)
+		phase = TIME_VERIFY;
+	else
+		current.spans[phase]++;
+
+	if (depth < MAX_NESTING)
+		stack[depth] = phase;
+	depth++;
+	resumed = t;
+
+	if (trace_active())
+		trace_begin(phase_names[requested], "phase");
+}
+
+/*
+ * timing_end - Close the innermost span
+ * @phase: Phase ending now (must be the innermost open one)
+ */
+void timing_end(TimingPhase phase)
+{
+	unsigned long long t = now_ns();
+
+	if (trace_active())
+		trace_end(phase_names[phase], "phase");
+
+	if (depth == 0)
+		return;
+	depth--;
+	if (depth < MAX_NESTING)
+		current.ns[stack[depth]] += t - resumed;
+	else
+		current.ns[phase] += t - resumed;
+	resumed = t;
+}
+
+/*
+ * timing_count - Add to an event counter
+ * @counter: Counter
+ * @amount: Number of events
+ */
+void timing_count(TimingCounter counter, unsigned long amount)
+{
+	/* Only the main pass counts, not its verification */
+	if (depth > 0 && depth <= MAX_NESTING && stack[depth - 1] == TIME_VERIFY)
+		return;
+
+	current.counters[counter] += amount;
+}
+
+/*
+ * timings_counter - Read an event counter of the current file
+ * @counter: Counter
+ *
+ * Return: Events counted since the last timings_reset()
+ */
+unsigned long timings_counter(TimingCounter counter)
+{
+	return (current.counters[counter]);
+}
+
+/*
+ * timings_reset - Start timing the next file
+ */
+void timings_reset(void)
+{
+	TimingSet empty = {{0}, {0}, {0}, 0, 0};
+
+	current = empty;
+	depth = 0;
+	started = now_ns();
+}
+
+/*
+ * print_set - Print one timing table
+ * @out: Stream to print to
+ * @set: Figures to print
+ */
+static void print_set(FILE *out, const TimingSet *set)
+{
+	unsigned long long phases = 0;
+	double wall_ms = set->wall / 1e6;
+	int i;
+
+	fprintf(out, "%-20s %10s %7s %8s\n", "phase", "ms", "%", "spans");
+	for (i = 0; i < TIME_PHASE_COUNT; i++)
+	{
+		phases += set->ns[i];
+		fprintf(out, "%-20s %10.3f %6.1f%% %8lu\n", phase_names[i],
+			set->ns[i] / 1e6,
+			set->wall ? 100.0 * set->ns[i] / set->wall : 0.0,
+			set->spans[i]);
+	}
+	if (set->wall > phases)
+		fprintf(out, "%-20s %10.3f %6.1f%%\n", "other",
+			(set->wall - phases) / 1e6,
+			100.0 * (set->wall - phases) / set->wall);
+	fprintf(out, "%-20s %10.3f %6.1f%% %8s %.2f MB/s\n", "total", wall_ms,
+		100.0, "", wall_ms > 0 ? set->bytes / 1e3 / wall_ms : 0.0);
+
+	fputc('\n', out);
+	for (i = 0; i < TIME_COUNTER_COUNT; i++)
+		fprintf(out, "%-20s %10lu\n", counter_names[i],
+			set->counters[i]);
+}
+
+/*
+ * timings_report - Print the timings of the current file
+ * @out: Stream to print to
+ * @label: Name of the file
+ * @input_bytes: Size of the file
+ *
+ * The figures are also added to the aggregate.
+ */
+void timings_report(FILE *out, const char *label, size_t input_bytes)
+{
+	int i;
+
+	current.wall = now_ns() - started;
+	current.bytes = input_bytes;
+
+	fprintf(out, "=== Timings: %s (%lu input bytes) ===\n",
+		label ? label : "-", (unsigned long)input_bytes);
+	print_set(out, &current);
+
+	for (i = 0; i < TIME_PHASE_COUNT; i++)
+	{
+		total.ns[i] += current.ns[i];
+		total.spans[i] += current.spans[i];
+	}
+	for (i = 0; i < TIME_COUNTER_COUNT; i++)
+		total.counters[i] += current.counters[i];
+	total.wall += current.wall;
+	total.bytes += current.bytes;
+	file_count++;
+}
+
+/*
+ * timings_report_total - Print the aggregate of all reported files
+ * @out: Stream to print to
+ *
+ * Nothing is printed for a single file (its own table is the total).
+ */
+void timings_report_total(FILE *out)
+{
+	if (file_count < 2)
+		return;
+
+	fprintf(out, "=== Timings: all %d files (%lu input bytes) ===\n",
+		file_count, (unsigned long)total.bytes);
+	print_set(out, &total);
+}
+
+#else
+
+/* ISO C forbids an empty translation unit */
+typedef int timings_disabled_t;
+
+#endif /* BETTY_TIMINGS */
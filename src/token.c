@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 200809L
 #include "../include/token.h"
+#include "../include/stats.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -16,15 +17,53 @@ Token *token_create(TokenType type, const char *lexeme, int line, int column)
 {
 	Token *token;
 
-	token = malloc(sizeof(Token));
+	token = mem_alloc(sizeof(Token), MEM_TOKENS);
 	if (!token)
 		return (NULL);
 
 	token->type = type;
-	token->lexeme = lexeme ? strdup(lexeme) : NULL;
+	token->lexeme = lexeme ? mem_strdup(lexeme, MEM_TOKENS) : NULL;
 	token->line = line;
 	token->column = column;
 	token->length = lexeme ? strlen(lexeme) : 0;
+	token->offset = -1;
+
+	return (token);
+}
+
+/*
+ * token_create_len - Create a token from a slice of text
+ * @type: Token type
+ * @text: Start of the token text (copied, need not be NUL-terminated)
+ * @length: Length of the token text
+ * @line: Line number
+ * @column: Column number
+ *
+ * Return: Pointer to new token, or NULL on failure
+ */
+Token *token_create_len(TokenType type, const char *text, int length,
+			int line, int column)
+{
+	Token *token;
+
+	token = mem_alloc(sizeof(Token), MEM_TOKENS);
+	if (!token)
+		return (NULL);
+
+	token->lexeme = mem_alloc(length + 1, MEM_TOKENS);
+	if (!token->lexeme)
+	{
+		mem_free(token);
+		return (NULL);
+	}
+	memcpy(token->lexeme, text, length);
+	token->lexeme[length] = '\0';
+
+	token->type = type;
+	token->line = line;
+	token->column = column;
+	token->length = length;
+	token->offset = -1;
 
 	return (token);
 }
@@ -38,8 +77,8 @@ void token_destroy(Token *token)
 	if (!token)
 		return;
 
-	free(token->lexeme);
-	free(token);
+	mem_free(token->lexeme);
+	mem_free(token);
 }
 
 /*
@@ -76,3 +115,50 @@ const char *token_type_to_string(TokenType type)
 
 	return (names[type]);
 }
+
+/*
+ * token_start_column - Column of the first character of a one-line token
+ * @token: Token without newlines (identifiers, keywords, punctuation)
+ *
+ * Return: 1-based byte column where the token starts
+ */
+int token_start_column(const Token *token)
+{
+	return (token->column - token->length + 1);
+}
+
+/*
+ * token_start - Line and column of the first character of a token
+ * @tokens: Lossless token array of a text
+ * @index: Index of the token
+ * @line: Gets the 1-based line
+ * @column: Gets the 1-based byte column
+ *
+ * Tokens record where they end. One that spans lines, such as a block
+ * comment, starts right after the token before it.
+ */
+void token_start(Token **tokens, int index, int *line, int *column)
+{
+	const Token *token = tokens[index];
+	const Token *prev;
+
+	if (!token->lexeme || !memchr(token->lexeme, '\n', token->length))
+	{
+		*line = token->line;
+		*column = token_start_column(token);
+		return;
+	}
+
+	*line = 1;
+	*column = 1;
+	if (index == 0)
+		return;
+	prev = tokens[index - 1];
+	if (prev->length > 0 && prev->lexeme[prev->length - 1] == '\n')
+		*line = prev->line + 1;
+	else
+	{
+		*line = prev->line;
+		*column = prev->column + 1;
+	}
+}
@@ -0,0 +1,257 @@
+#define _GNU_SOURCE
+#include "../include/trace.h"
+
+#ifdef BETTY_TIMINGS
+
+#include "../include/json.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INITIAL_TRACE_CAPACITY 1024
+
+/*
+ * TraceEvent - One recorded event
+ * @name: Span or counter name
+ * @category: Span category (NULL for counters)
+ * @ns: Nanoseconds since the trace was opened
+ * @value: Counter value
+ * @type: 'B' (span begins), 'E' (span ends) or 'C' (counter)
+ */
+typedef struct TraceEvent {
+	const char *name;
+	const char *category;
+	unsigned long long ns;
+	double value;
+	char type;
+} TraceEvent;
+
+/*
+ * TraceBuffer - Recorded events
+ * @events: Events in time order
+ * @count: Number of events
+ * @capacity: Allocated length of @events
+ * @tid: Thread id written to the trace
+ * @thread_name: Name shown for the thread
+ *
+ * The formatter is single-threaded, so there is one buffer, written as
+ * the "main" thread, and nothing locks it. Recording from other threads
+ * is not supported.
+ */
+typedef struct TraceBuffer {
+	TraceEvent *events;
+	int count;
+	int capacity;
+	int tid;
+	const char *thread_name;
+} TraceBuffer;
+
+static TraceBuffer main_buffer = {NULL, 0, 0, 1, "main"};
+static char *trace_path;
+static unsigned long long origin;
+static int failed;
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+/*
+ * record - Append an event to the trace buffer
+ */
+static void record(char type, const char *name, const char *category,
+		   double value)
+{
+	TraceBuffer *buffer = &main_buffer;
+	TraceEvent *event;
+
+	if (!trace_path || failed)
+		return;
+
+	if (buffer->count >= buffer->capacity)
+	{
+		int new_capacity = buffer->capacity == 0 ?
+			INITIAL_TRACE_CAPACITY : buffer->capacity * 2;
+		TraceEvent *new_events = realloc(buffer->events,
+			sizeof(TraceEvent) * new_capacity);
+
+		/* Drop the rest rather than write a trace with holes */
+		if (!new_events)
+		{
+			failed = 1;
+			return;
+		}
+		buffer->events = new_events;
+		buffer->capacity = new_capacity;
+	}
+
+	event = &buffer->events[buffer->count++];
+	event->ns = now_ns() - origin;
+	event->type = type;
+	event->name = name;
+	event->category = category;
+	event->value = value;
+}
+
+/*
+ * trace_open - Start recording a trace
+ * @path: File the trace is written to by trace_close()
+ *
+ * Return: 0 on success, -1 on error
+ */
+int trace_open(const char *path)
+{
+	free(trace_path);
+	trace_path = strdup(path);
+	if (!trace_path)
+		return (-1);
+
+	main_buffer.count = 0;
+	failed = 0;
+	origin = now_ns();
+	return (0);
+}
+
+/*
+ * trace_active - Check whether a trace is being recorded
+ *
+ * Return: 1 if so, 0 otherwise
+ */
+int trace_active(void)
+{
+	return (trace_path != NULL);
+}
+
+/*
+ * trace_begin - Record the start of a span
+ * @name: Span name
+ * @category: Span category
+ */
+void trace_begin(const char *name, const char *category)
+{
+	record('B', name, category, 0.0);
+}
+
+/*
+ * trace_end - Record the end of the innermost span
+ * @name: Span name (must match trace_begin())
+ * @category: Span category
+ */
+void trace_end(const char *name, const char *category)
+{
+	record('E', name, category, 0.0);
+}
+
+/*
+ * trace_counter - Record a sample of a counter track
+ * @name: Counter name
+ * @value: Value from now on
+ */
+void trace_counter(const char *name, double value)
+{
+	record('C', name, NULL, value);
+}
+
+/*
+ * trace_memory - Sample the resident set size into the "rss_kb" track
+ */
+void trace_memory(void)
+{
+	unsigned long pages, resident;
+	FILE *fp;
+
+	if (!trace_path)
+		return;
+
+	fp = fopen("/proc/self/statm", "r");
+	if (!fp)
+		return;
+	if (fscanf(fp, "%lu %lu", &pages, &resident) == 2)
+		trace_counter("rss_kb", resident * (sysconf(_SC_PAGESIZE) / 1024.0));
+	fclose(fp);
+}
+
+/*
+ * write_buffer - Write the events of the buffer
+ * @fp: Output stream
+ * @buffer: Buffer
+ * @pid: Process id for the events
+ */
+static void write_buffer(FILE *fp, const TraceBuffer *buffer, long pid)
+{
+	int i;
+
+	fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,"
+		"\"tid\":%d,\"args\":{\"name\":\"%s\"}}", pid, buffer->tid,
+		buffer->thread_name);
+
+	for (i = 0; i < buffer->count; i++)
+	{
+		const TraceEvent *event = &buffer->events[i];
+
+		fputs(",\n{\"name\":", fp);
+		json_write_string(fp, event->name, strlen(event->name));
+		if (event->category)
+			fprintf(fp, ",\"cat\":\"%s\"", event->category);
+		fprintf(fp, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%ld,\"tid\":%d",
+			event->type, event->ns / 1e3, pid, buffer->tid);
+		if (event->type == 'C')
+			fprintf(fp, ",\"args\":{\"value\":%.0f}", event->value);
+		fputc('}', fp);
+	}
+}
+
+/*
+ * trace_close - Write the recorded trace and stop recording
+ *
+ * Return: 0 on success, -1 if the trace could not be written
+ */
+int trace_close(void)
+{
+	long pid = (long)getpid();
+	FILE *fp;
+	int result = 0;
+
+	if (!trace_path)
+		return (0);
+
+	fp = fopen(trace_path, "w");
+	if (!fp)
+	{
+		fprintf(stderr, "Error: Could not write '%s'\n", trace_path);
+		result = -1;
+	}
+	else
+	{
+		fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+			"\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,"
+			"\"args\":{\"name\":\"betty-fmt\"}}", pid);
+		write_buffer(fp, &main_buffer, pid);
+		fputs("\n]}\n", fp);
+		if (fclose(fp) != 0)
+			result = -1;
+	}
+	if (failed)
+		fprintf(stderr, "Warning: Trace truncated (out of memory)\n");
+
+	free(main_buffer.events);
+	main_buffer.events = NULL;
+	main_buffer.count = 0;
+	main_buffer.capacity = 0;
+	free(trace_path);
+	trace_path = NULL;
+
+	return (result);
+}
+
+#else
+
+/* ISO C forbids an empty translation unit */
+typedef int trace_disabled_t;
+
+#endif /* BETTY_TIMINGS */
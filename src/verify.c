@@ -0,0 +1,382 @@
+#include "../include/verify.h"
+#include "../include/cache.h"
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Token stream of one lexed text
+ * Code tokens and comments are read by separate cursors: the formatter
+ * may move a comment past code, but never reorders either sequence.
+ */
+typedef struct VerifyStream {
+	Token **tokens;
+	int count;
+	int code;     /* Next token the code cursor looks at */
+	int comment;  /* Next token the comment cursor looks at */
+
+	/* Return statement being read (return_length < 0 outside one) */
+	int return_pos;     /* Code tokens read since the return keyword */
+	int return_length;  /* Code tokens between the return and its ; */
+	int return_layers;  /* 1 if parentheses wrap the whole value */
+} VerifyStream;
+
+/*
+ * is_code - Check whether a token takes part in the code comparison
+ * @type: Token type
+ *
+ * Return: 1 for code tokens, 0 for layout, comments and end of input
+ */
+static int is_code(TokenType type)
+{
+	return (type != TOK_WHITESPACE && type != TOK_NEWLINE &&
+		type != TOK_COMMENT_LINE && type != TOK_COMMENT_BLOCK &&
+		type != TOK_EOF);
+}
+
+/*
+ * scan_return - Measure the return statement starting at the code cursor
+ * @stream: Stream positioned just after a return keyword
+ *
+ * Counts the code tokens up to the terminating ; and whether a pair of
+ * parentheses wraps the whole value: `return x;` and `return (x);` are
+ * the same statement, but `return ((x));` is not, so at most one pair is
+ * dropped. A pair wraps the value when it opens in the run of leading (
+ * and closes at a new lowest depth in the final run of ).
+ */
+static void scan_return(VerifyStream *stream)
+{
+	int i;
+	int length = 0;
+	int depth = 0;
+	int leading = 0;
+	int lowest = 0;
+	int closing = 0;  /* Final run of ) each closing a leading ( */
+	int in_leading = 1;
+	Token *token;
+
+	for (i = stream->code; i < stream->count; i++)
+	{
+		token = stream->tokens[i];
+		if (!is_code(token->type))
+			continue;
+		if (depth == 0 && token->type == TOK_SEMICOLON)
+			break;
+
+		length++;
+		if (token->type == TOK_LPAREN)
+		{
+			depth++;
+			if (in_leading)
+				lowest = ++leading;
+			closing = 0;
+			continue;
+		}
+
+		in_leading = 0;
+		if (token->type == TOK_RPAREN)
+		{
+			depth--;
+			if (depth < lowest)
+			{
+				lowest = depth;
+				closing++;
+			}
+			else
+				closing = 0;
+		}
+		else
+			closing = 0;
+	}
+
+	/* Without a ; the statement is compared as written */
+	if (i == stream->count)
+		closing = 0;
+
+	stream->return_pos = 0;
+	stream->return_length = length;
+	stream->return_layers = closing > 0 && leading > 0 ? 1 : 0;
+}
+
+/*
+ * next_code - Read the next code token
+ * @stream: Token stream
+ *
+ * Return: Next code token, or NULL at the end of the text
+ */
+static Token *next_code(VerifyStream *stream)
+{
+	Token *token;
+	int pos;
+
+	while (stream->code < stream->count)
+	{
+		token = stream->tokens[stream->code++];
+		if (!is_code(token->type))
+			continue;
+
+		/* Drop the parentheses wrapping a return value */
+		if (stream->return_length >= 0)
+		{
+			pos = stream->return_pos++;
+			if (pos == stream->return_length)
+				stream->return_length = -1;
+			else if (pos < stream->return_layers ||
+				 pos >= stream->return_length -
+				 stream->return_layers)
+				continue;
+		}
+
+		if (token->type == TOK_RETURN)
+			scan_return(stream);
+		return (token);
+	}
+
+	return (NULL);
+}
+
+/*
+ * next_comment - Read the next comment
+ * @stream: Token stream
+ *
+ * Return: Next comment token, or NULL at the end of the text
+ */
+static Token *next_comment(VerifyStream *stream)
+{
+	Token *token;
+
+	while (stream->comment < stream->count)
+	{
+		token = stream->tokens[stream->comment++];
+		if (token->type == TOK_COMMENT_LINE ||
+		    token->type == TOK_COMMENT_BLOCK)
+			return (token);
+	}
+
+	return (NULL);
+}
+
+/*
+ * code_length - Length of a code token's text that must be kept
+ * @token: Code token
+ *
+ * Directives are copied verbatim, but trailing blanks are not kept.
+ *
+ * Return: Significant length
+ */
+static int code_length(const Token *token)
+{
+	int length = token->length;
+
+	if (token->type == TOK_PREPROCESSOR)
+	{
+		while (length > 0 && (token->lexeme[length - 1] == ' ' ||
+				      token->lexeme[length - 1] == '\t'))
+			length--;
+	}
+
+	return (length);
+}
+
+/*
+ * same_code - Compare two code tokens
+ * @a: Source token
+ * @b: Output token
+ *
+ * Return: 1 if they are the same token, 0 if not
+ */
+static int same_code(const Token *a, const Token *b)
+{
+	int length = code_length(a);
+
+	return (a->type == b->type && length == code_length(b) &&
+		memcmp(a->lexeme, b->lexeme, length) == 0);
+}
+
+/*
+ * hash_comment - Hash the text of a comment
+ * @token: Line or block comment
+ *
+ * `// text` and `/\* text *\/` hash alike. Runs of blanks and newlines
+ * count as one space and the ends are trimmed, so reindenting a comment
+ * does not change it.
+ *
+ * Return: Comment hash
+ */
+static uint64_t hash_comment(const Token *token)
+{
+	const char *text = token->lexeme + 2;
+	const char *end = token->lexeme + token->length;
+	uint64_t hash = CACHE_HASH_INIT;
+	int blank = 0;
+
+	if (token->type == TOK_COMMENT_BLOCK && end - text >= 2 &&
+	    end[-2] == '*' && end[-1] == '/')
+		end -= 2;
+
+	while (text < end && strchr(" \t\r\n", *text))
+		text++;
+	while (end > text && strchr(" \t\r\n", end[-1]))
+		end--;
+
+	for (; text < end; text++)
+	{
+		if (strchr(" \t\r\n", *text))
+		{
+			blank = 1;
+			continue;
+		}
+		if (blank)
+			hash = cache_hash_bytes(hash, " ", 1);
+		hash = cache_hash_bytes(hash, text, 1);
+		blank = 0;
+	}
+
+	return (hash);
+}
+
+/*
+ * copy_text - Keep the start of a token's text for a message
+ * @buffer: Destination (VerifyResult text field)
+ * @token: Token, or NULL for end of text
+ */
+static void copy_text(char buffer[32], const Token *token)
+{
+	const char *text = token ? token->lexeme : "end of file";
+	size_t length = strcspn(text, "\n");
+
+	if (length > 31)
+		length = 31;
+	memcpy(buffer, text, length);
+	buffer[length] = '\0';
+}
+
+/*
+ * report - Record the first difference
+ * @result: Verification result
+ * @reason: What differs
+ * @in: Source stream
+ * @a: Index of the source token, or -1 past its end
+ * @out: Output stream
+ * @b: Index of the output token, or -1 past its end
+ *
+ * Positions are where the tokens start.
+ *
+ * Return: 1 (texts differ)
+ */
+static int report(VerifyResult *result, const char *reason,
+		  VerifyStream *in, int a, VerifyStream *out, int b)
+{
+	result->reason = reason;
+	if (a >= 0)
+		token_start(in->tokens, a, &result->input_line,
+			    &result->input_column);
+	if (b >= 0)
+		token_start(out->tokens, b, &result->output_line,
+			    &result->output_column);
+	copy_text(result->input_text, a >= 0 ? in->tokens[a] : NULL);
+	copy_text(result->output_text, b >= 0 ? out->tokens[b] : NULL);
+
+	return (1);
+}
+
+/*
+ * compare_streams - Compare two token streams
+ * @in: Source stream
+ * @out: Output stream
+ * @result: Verification result
+ *
+ * Return: 0 if equivalent, 1 if not
+ */
+static int compare_streams(VerifyStream *in, VerifyStream *out,
+			   VerifyResult *result)
+{
+	Token *a;
+	Token *b;
+
+	for (;;)
+	{
+		a = next_code(in);
+		b = next_code(out);
+		if (!a || !b)
+		{
+			if (a)
+				return (report(result, "code missing from output",
+					       in, in->code - 1, out, -1));
+			if (b)
+				return (report(result, "code added to output",
+					       in, -1, out, out->code - 1));
+			break;
+		}
+		if (!same_code(a, b))
+			return (report(result, "code differs", in,
+				       in->code - 1, out, out->code - 1));
+		result->tokens++;
+	}
+
+	for (;;)
+	{
+		a = next_comment(in);
+		b = next_comment(out);
+		if (!a || !b)
+		{
+			if (a)
+				return (report(result, "comment missing from output",
+					       in, in->comment - 1, out, -1));
+			if (b)
+				return (report(result, "comment added to output",
+					       in, -1, out, out->comment - 1));
+			break;
+		}
+		if (hash_comment(a) != hash_comment(b))
+			return (report(result, "comment differs", in,
+				       in->comment - 1, out, out->comment - 1));
+		result->comments++;
+	}
+
+	return (0);
+}
+
+/*
+ * stream_init - Start reading a token array
+ * @stream: Stream to set up
+ * @tokens: Lexed text
+ * @count: Number of tokens
+ */
+static void stream_init(VerifyStream *stream, Token **tokens, int count)
+{
+	stream->tokens = tokens;
+	stream->count = count;
+	stream->code = 0;
+	stream->comment = 0;
+	stream->return_pos = 0;
+	stream->return_length = -1;
+	stream->return_layers = 0;
+}
+
+/*
+ * verify_tokens - Check that formatting only changed the layout
+ * @source: Tokens of the original source
+ * @source_count: Number of source tokens
+ * @output: Tokens of the formatted text
+ * @output_count: Number of output tokens
+ * @result: Filled with counts and the first difference
+ *
+ * Code tokens are compared one by one, then the comments by hash.
+ * Whitespace may differ everywhere, comments may move and change between
+ * the // and block forms, and a return value may gain or lose its
+ * parentheses. No syntax tree is built.
+ *
+ * Return: 0 if equivalent, 1 if not
+ */
+int verify_tokens(Token **source, int source_count, Token **output,
+		  int output_count, VerifyResult *result)
+{
+	VerifyStream in;
+	VerifyStream out;
+
+	memset(result, 0, sizeof(*result));
+	stream_init(&in, source, source_count);
+	stream_init(&out, output, output_count);
+
+	return (compare_streams(&in, &out, result));
+}
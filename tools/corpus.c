@@ -0,0 +1,838 @@
+/*
+ * corpus.c - Deterministic synthetic C sources for benchmarks and tests
+ *
+ * A seeded generator writes top-level items in a chosen mix until the
+ * source reaches the requested size, and collects the matching header:
+ * struct definitions, typedefs and the prototype of every function.
+ * Squeezed items lose their Betty spacing and tab indentation, so the
+ * formatter has real work to do on them.
+ */
+#include "corpus.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_BODY_STATEMENTS 8
+#define INITIALIZER_PER_LINE 8
+
+static const char *kind_names[CORPUS_KIND_COUNT] = {
+	"functions", "structs", "typedefs", "funcptrs", "preprocessor",
+	"initializers", "unparsable"
+};
+
+/*
+ * Buffer - Growable text
+ * @failed: Set once an allocation fails; later writes are ignored
+ */
+typedef struct Buffer {
+	char *text;
+	size_t length;
+	size_t capacity;
+	int failed;
+} Buffer;
+
+/*
+ * Generator - State of one generation run
+ * @opts: Settings
+ * @state: Random state
+ * @source: Source text
+ * @header: Header text (declarations go to @source if there is none)
+ * @item: Item being written, before squeezing
+ * @serial: Number of items of each kind so far (used in names)
+ * @function: Serial of the function being written
+ * @after_if: The last statement written was an if without an else
+ */
+typedef struct Generator {
+	const CorpusOptions *opts;
+	unsigned long long state;
+	Buffer source;
+	Buffer header;
+	Buffer item;
+	int serial[CORPUS_KIND_COUNT];
+	int function;
+	int after_if;
+} Generator;
+
+static void statement(Generator *gen, int depth);
+static void bare_statement(Generator *gen, int depth);
+
+/*
+ * put - Append formatted text to a buffer
+ */
+static void put(Buffer *buffer, const char *format, ...)
+{
+	va_list args;
+	int needed;
+
+	if (buffer->failed)
+		return;
+
+	va_start(args, format);
+	needed = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+	if (needed < 0)
+	{
+		buffer->failed = 1;
+		return;
+	}
+
+	if (buffer->length + needed + 1 > buffer->capacity)
+	{
+		size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+		char *text;
+
+		while (buffer->length + needed + 1 > capacity)
+			capacity *= 2;
+		text = realloc(buffer->text, capacity);
+		if (!text)
+		{
+			buffer->failed = 1;
+			return;
+		}
+		buffer->text = text;
+		buffer->capacity = capacity;
+	}
+
+	va_start(args, format);
+	vsnprintf(buffer->text + buffer->length, needed + 1, format, args);
+	va_end(args);
+	buffer->length += needed;
+}
+
+/*
+ * next - Next random number (splitmix64)
+ */
+static unsigned long long next(Generator *gen)
+{
+	unsigned long long z = (gen->state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return (z ^ (z >> 31));
+}
+
+/*
+ * roll - Random number in [0, limit)
+ */
+static int roll(Generator *gen, int limit)
+{
+	return (limit > 0 ? (int)(next(gen) % (unsigned long long)limit) : 0);
+}
+
+/*
+ * chance - True with the given percentage
+ */
+static int chance(Generator *gen, int percent)
+{
+	return (roll(gen, 100) < percent);
+}
+
+/*
+ * declarations - Buffer that takes struct definitions and typedefs
+ */
+static Buffer *declarations(Generator *gen)
+{
+	return (gen->opts->header ? &gen->header : &gen->item);
+}
+
+/*
+ * indent - Start a line at a nesting depth
+ */
+static void indent(Generator *gen, int depth)
+{
+	int i;
+
+	for (i = 0; i < depth; i++)
+		put(&gen->item, "\t");
+}
+
+/*
+ * expression - Write a random expression over the function's locals
+ * @gen: Generator
+ * @depth: Levels of operators left
+ */
+static void expression(Generator *gen, int depth)
+{
+	static const char *leaves[] = {"a", "b", "total", "i", "j"};
+	static const char *operators[] = {
+		"+", "-", "*", "/", "%", "&", "|", "^", "<<", ">>"
+	};
+
+	if (depth <= 0 || chance(gen, 35))
+	{
+		if (chance(gen, 30))
+			put(&gen->item, "%d", roll(gen, 1000));
+		else
+			put(&gen->item, "%s", leaves[roll(gen, 5)]);
+		return;
+	}
+
+	switch (roll(gen, 6))
+	{
+	case 0:
+		put(&gen->item, "(");
+		expression(gen, depth - 1);
+		put(&gen->item, ")");
+		break;
+	case 1:
+		if (gen->function > 0)
+		{
+			put(&gen->item, "fn_%d(", roll(gen, gen->function));
+			expression(gen, depth - 1);
+			put(&gen->item, ", ");
+			expression(gen, depth - 1);
+			put(&gen->item, ")");
+			break;
+		}
+		/* Fall through */
+	default:
+		expression(gen, depth - 1);
+		put(&gen->item, " %s ", operators[roll(gen, 10)]);
+		expression(gen, depth - 1);
+		break;
+	}
+}
+
+/*
+ * condition - Write a random condition
+ */
+static void condition(Generator *gen)
+{
+	static const char *comparisons[] = {"<", ">", "<=", ">=", "==", "!="};
+
+	switch (roll(gen, 4))
+	{
+	case 0:
+		put(&gen->item, "!");
+		expression(gen, 0);
+		break;
+	case 1:
+		expression(gen, 1);
+		put(&gen->item, " %s %d && ", comparisons[roll(gen, 6)],
+		    roll(gen, 100));
+		expression(gen, 0);
+		break;
+	default:
+		expression(gen, 1);
+		put(&gen->item, " %s ", comparisons[roll(gen, 6)]);
+		expression(gen, 1);
+		break;
+	}
+}
+
+/*
+ * body - Write a braced block of statements
+ * @gen: Generator
+ * @depth: Depth of the statements inside
+ */
+static void body(Generator *gen, int depth)
+{
+	int count = 1 + roll(gen, 3);
+
+	indent(gen, depth - 1);
+	put(&gen->item, "{\n");
+	while (count-- > 0)
+		statement(gen, depth);
+	indent(gen, depth - 1);
+	put(&gen->item, "}\n");
+}
+
+/*
+ * simple_statement - Write an assignment or call statement
+ */
+static void simple_statement(Generator *gen, int depth)
+{
+	static const char *assignments[] = {"=", "+=", "-=", "^=", "|="};
+
+	indent(gen, depth);
+	if (chance(gen, 15))
+		put(&gen->item, "%s++;", roll(gen, 2) ? "total" : "j");
+	else
+	{
+		put(&gen->item, "%s %s ", roll(gen, 4) ? "total" : "j",
+		    assignments[roll(gen, 5)]);
+		expression(gen, 3);
+		put(&gen->item, ";");
+	}
+	if (chance(gen, gen->opts->comments / 4))
+		put(&gen->item, " /* step %d */", roll(gen, 100));
+	put(&gen->item, "\n");
+}
+
+/*
+ * statement - Write one statement, sometimes after a comment line
+ * @gen: Generator
+ * @depth: Depth of the statement (1 for the function body)
+ */
+static void statement(Generator *gen, int depth)
+{
+	if (!gen->after_if && chance(gen, gen->opts->comments / 2))
+	{
+		indent(gen, depth);
+		put(&gen->item, "/* Stage %d of the computation */\n",
+		    roll(gen, 50));
+	}
+	bare_statement(gen, depth);
+}
+
+/*
+ * bare_statement - Write one statement, nesting while depth allows
+ * @gen: Generator
+ * @depth: Depth of the statement (1 for the function body)
+ *
+ * Case labels are followed by bare statements, and no comment follows
+ * an if without an else: the formatter drops the first and hoists the
+ * second above the if (see STATUS.md).
+ */
+static void bare_statement(Generator *gen, int depth)
+{
+	int kind = depth <= gen->opts->nesting ? roll(gen, 10) : 0;
+	int i, cases;
+
+	switch (kind)
+	{
+	case 4:
+		indent(gen, depth);
+		put(&gen->item, "if (");
+		condition(gen);
+		put(&gen->item, ")\n");
+		body(gen, depth + 1);
+		if (chance(gen, 50))
+		{
+			indent(gen, depth);
+			put(&gen->item, "else if (");
+			condition(gen);
+			put(&gen->item, ")\n");
+			body(gen, depth + 1);
+		}
+		if (chance(gen, 50))
+		{
+			indent(gen, depth);
+			put(&gen->item, "else\n");
+			body(gen, depth + 1);
+			break;
+		}
+		gen->after_if = 1;
+		return;
+	case 5:
+		indent(gen, depth);
+		put(&gen->item, "for (i = 0; i < ");
+		expression(gen, 1);
+		put(&gen->item, "; i++)\n");
+		body(gen, depth + 1);
+		break;
+	case 6:
+		indent(gen, depth);
+		put(&gen->item, "while (");
+		condition(gen);
+		put(&gen->item, ")\n");
+		body(gen, depth + 1);
+		break;
+	case 7:
+		indent(gen, depth);
+		put(&gen->item, "do {\n");
+		statement(gen, depth + 1);
+		indent(gen, depth);
+		put(&gen->item, "} while (");
+		condition(gen);
+		put(&gen->item, ");\n");
+		break;
+	case 8:
+		indent(gen, depth);
+		put(&gen->item, "switch (");
+		expression(gen, 1);
+		put(&gen->item, ")\n");
+		indent(gen, depth);
+		put(&gen->item, "{\n");
+		cases = 1 + roll(gen, 4);
+		for (i = 0; i < cases; i++)
+		{
+			indent(gen, depth);
+			put(&gen->item, "case %d:\n", i);
+			bare_statement(gen, depth + 1);
+			indent(gen, depth + 1);
+			put(&gen->item, "break;\n");
+		}
+		indent(gen, depth);
+		put(&gen->item, "default:\n");
+		bare_statement(gen, depth + 1);
+		indent(gen, depth);
+		put(&gen->item, "}\n");
+		break;
+	default:
+		simple_statement(gen, depth);
+		break;
+	}
+	gen->after_if = 0;
+}
+
+/*
+ * write_function - Write a documented function
+ */
+static void write_function(Generator *gen)
+{
+	int serial = gen->serial[CORPUS_FUNCTION];
+	int count = 2 + roll(gen, MAX_BODY_STATEMENTS - 1);
+	int record = gen->serial[CORPUS_STRUCT];
+
+	if (chance(gen, gen->opts->comments))
+		put(&gen->item, "/**\n * fn_%d - Combine two values\n"
+		    " * @a: First value\n * @b: Second value\n *\n"
+		    " * Return: The combination\n */\n", serial);
+	put(&gen->item, "int fn_%d(int a, int b)\n{\n\tint total = 0;\n"
+	    "\tint i = 0;\n\tint j = a;\n", serial);
+	if (record > 0)
+		put(&gen->item, "\tstruct rec_%d *item = NULL;\n",
+		    roll(gen, record));
+	put(&gen->item, "\n");
+
+	while (count-- > 0)
+		statement(gen, 1);
+
+	if (record > 0 && chance(gen, 50))
+		put(&gen->item, "\tif (item && item->next)\n"
+		    "\t\ttotal += item->next->id;\n");
+	put(&gen->item, "\treturn (total + i - j);\n}\n");
+
+	if (gen->opts->header)
+		put(&gen->header, "int fn_%d(int a, int b);\n", serial);
+	gen->function = serial + 1;
+}
+
+/*
+ * write_struct - Write a documented struct definition
+ */
+static void write_struct(Generator *gen)
+{
+	int serial = gen->serial[CORPUS_STRUCT];
+	Buffer *out = declarations(gen);
+
+	if (chance(gen, gen->opts->comments))
+		put(out, "/**\n * struct rec_%d - Record %d\n * @id: Identifier\n"
+		    " * @name: Name\n * @data: Payload\n * @next: Next record\n"
+		    " */\n", serial, serial);
+	put(out, "struct rec_%d\n{\n\tint id;\n\tchar *name;\n"
+	    "\tlong data[%d];\n\tstruct rec_%d *next;\n};\n",
+	    serial, 1 + roll(gen, 16), serial);
+	if (out != &gen->item)
+		put(out, "\n");
+}
+
+/*
+ * write_typedef - Write a scalar typedef or a typedef'd struct
+ */
+static void write_typedef(Generator *gen)
+{
+	static const char *scalars[] = {
+		"unsigned long", "int", "char *", "const char *", "long long"
+	};
+	int serial = gen->serial[CORPUS_TYPEDEF];
+	Buffer *out = declarations(gen);
+
+	if (chance(gen, 50))
+		put(out, "typedef %s alias_%d_t;\n", scalars[roll(gen, 5)],
+		    serial);
+	else
+		put(out, "typedef struct pair_%d\n{\n\tint key;\n"
+		    "\tint value;\n} pair_%d_t;\n", serial, serial);
+	if (out != &gen->item)
+		put(out, "\n");
+}
+
+/*
+ * write_func_ptr - Write a function pointer typedef and variable
+ */
+static void write_func_ptr(Generator *gen)
+{
+	int serial = gen->serial[CORPUS_FUNC_PTR];
+	Buffer *out = declarations(gen);
+
+	put(out, "typedef int (*handler_%d_t)(int, void *);\n", serial);
+	if (out != &gen->item)
+		put(out, "\n");
+	put(&gen->item, "static int (*dispatch_%d)(int a, int b);\n", serial);
+}
+
+/*
+ * write_preprocessor - Write a conditional block of macros
+ */
+static void write_preprocessor(Generator *gen)
+{
+	int serial = gen->serial[CORPUS_PREPROCESSOR];
+
+	put(&gen->item, "#ifdef FEATURE_%d\n#define LIMIT_%d %d\n"
+	    "#define SCALE_%d(x) ((x) * %d)\n#else\n#define LIMIT_%d %d\n"
+	    "#define SCALE_%d(x) (x)\n#endif\n", serial, serial,
+	    roll(gen, 1000), serial, 2 + roll(gen, 8), serial,
+	    roll(gen, 100), serial);
+}
+
+/*
+ * write_initializer - Write an array with a giant initializer
+ */
+static void write_initializer(Generator *gen)
+{
+	int serial = gen->serial[CORPUS_INITIALIZER];
+	int count = gen->opts->initializer > 0 ? gen->opts->initializer : 1;
+	int strings = chance(gen, 25);
+	int i;
+
+	if (strings)
+		put(&gen->item, "static const char *const names_%d[] = {",
+		    serial);
+	else
+		put(&gen->item, "static const int table_%d[] = {", serial);
+
+	for (i = 0; i < count; i++)
+	{
+		if (i % INITIALIZER_PER_LINE == 0)
+			put(&gen->item, "\n\t");
+		else
+			put(&gen->item, " ");
+		if (strings)
+			put(&gen->item, "\"w%d\"", roll(gen, 100000));
+		else
+			put(&gen->item, "%d", roll(gen, 100000) - 50000);
+		if (i + 1 < count)
+			put(&gen->item, ",");
+	}
+	put(&gen->item, "\n};\n");
+}
+
+/*
+ * write_unparsable - Write code the parser must capture raw
+ *
+ * Each shape is a single broken construct that ends within a few
+ * tokens; see STATUS.md for the shapes that still recover slowly.
+ */
+static void write_unparsable(Generator *gen)
+{
+	int serial = gen->serial[CORPUS_UNPARSABLE];
+
+	switch (roll(gen, 3))
+	{
+	case 0:
+		put(&gen->item, "int broken_%d(int a)\n{\n\treturn (a + );\n"
+		    "}\n", serial);
+		break;
+	case 1:
+		put(&gen->item, "garbage_%d ) ( ;\n", serial);
+		break;
+	default:
+		put(&gen->item, "int knr_%d(a, b)\nint a;\nint b;\n{\n"
+		    "\treturn (a * b);\n}\n", serial);
+		break;
+	}
+}
+
+/*
+ * squeeze - Copy an item without Betty spacing
+ * @out: Destination
+ * @text: Item text
+ *
+ * Indentation becomes two spaces per level and blanks next to operators
+ * and punctuation go, outside comments, strings and directives.
+ */
+static void squeeze(Buffer *out, const char *text)
+{
+	static const char *tight = "=+-*/%<>&|^!,;(){}[]?:";
+	int comment = 0, string = 0, directive = 0, line_start = 1;
+	const char *p;
+
+	for (p = text; *p; p++)
+	{
+		if (line_start)
+		{
+			directive = *p == '#';
+			while (*p == '\t')
+			{
+				put(out, "  ");
+				p++;
+			}
+			line_start = 0;
+			if (!*p)
+				break;
+		}
+
+		if (comment || directive)
+		{
+			if (comment && p[0] == '*' && p[1] == '/')
+			{
+				put(out, "*/");
+				p++;
+				comment = 0;
+				continue;
+			}
+		}
+		else if (string)
+		{
+			if (*p == '\\' && p[1])
+			{
+				put(out, "%c%c", p[0], p[1]);
+				p++;
+				continue;
+			}
+			string = *p != '"';
+		}
+		else if (p[0] == '/' && p[1] == '*')
+		{
+			put(out, "/*");
+			p++;
+			comment = 1;
+			continue;
+		}
+		else if (*p == '"')
+			string = 1;
+		else if (*p == ' ' && out->length > 0 &&
+			 (strchr(tight, out->text[out->length - 1]) ||
+			  (p[1] && strchr(tight, p[1]))))
+			continue;
+
+		put(out, "%c", *p);
+		if (*p == '\n')
+			line_start = 1;
+	}
+}
+
+/*
+ * pick - Choose the kind of the next item by weight
+ *
+ * Return: Kind, or -1 if every weight is zero
+ */
+static int pick(Generator *gen)
+{
+	int total = 0, value, i;
+
+	for (i = 0; i < CORPUS_KIND_COUNT; i++)
+		total += gen->opts->weights[i] > 0 ? gen->opts->weights[i] : 0;
+	if (total == 0)
+		return (-1);
+
+	value = roll(gen, total);
+	for (i = 0; i < CORPUS_KIND_COUNT; i++)
+	{
+		if (gen->opts->weights[i] <= 0)
+			continue;
+		if (value < gen->opts->weights[i])
+			return (i);
+		value -= gen->opts->weights[i];
+	}
+	return (CORPUS_FUNCTION);
+}
+
+/*
+ * guard_name - Write the include guard macro of a header
+ */
+static void guard_name(Buffer *out, const char *header)
+{
+	const char *base = strrchr(header, '/');
+	const char *p;
+
+	for (p = base ? base + 1 : header; *p; p++)
+	{
+		if ((*p >= 'a' && *p <= 'z'))
+			put(out, "%c", *p - 'a' + 'A');
+		else if ((*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9'))
+			put(out, "%c", *p);
+		else
+			put(out, "_");
+	}
+}
+
+/*
+ * corpus_defaults - Settings for realistic code
+ * @opts: Settings to fill in
+ *
+ * Mostly functions, some declarations, no broken code, half the items
+ * squeezed; 1 MB from seed 1.
+ */
+void corpus_defaults(CorpusOptions *opts)
+{
+	static const int weights[CORPUS_KIND_COUNT] = {16, 3, 3, 1, 1, 1, 0};
+
+	memset(opts, 0, sizeof(*opts));
+	opts->seed = 1;
+	opts->bytes = 1024 * 1024;
+	memcpy(opts->weights, weights, sizeof(weights));
+	opts->comments = 40;
+	opts->squeeze = 50;
+	opts->nesting = 3;
+	opts->initializer = 64;
+}
+
+/*
+ * corpus_preset - Apply a named mix
+ * @opts: Settings to change (seed, size and header are kept)
+ * @name: "realistic" or "adversarial"
+ *
+ * The adversarial mix favours what costs the formatter most: giant
+ * initializers, deep nesting, broken code and no spacing at all.
+ *
+ * Return: 0 on success, -1 for an unknown name
+ */
+int corpus_preset(CorpusOptions *opts, const char *name)
+{
+	static const int adversarial[CORPUS_KIND_COUNT] = {6, 1, 1, 2, 2, 3, 2};
+	CorpusOptions defaults;
+
+	corpus_defaults(&defaults);
+	defaults.seed = opts->seed;
+	defaults.bytes = opts->bytes;
+	defaults.header = opts->header;
+
+	if (strcmp(name, "adversarial") == 0)
+	{
+		memcpy(defaults.weights, adversarial, sizeof(adversarial));
+		defaults.comments = 60;
+		defaults.squeeze = 100;
+		defaults.nesting = 8;
+		defaults.initializer = 2048;
+	}
+	else if (strcmp(name, "realistic") != 0)
+		return (-1);
+
+	*opts = defaults;
+	return (0);
+}
+
+/*
+ * corpus_set_mix - Set item weights from "kind=weight,..."
+ * @opts: Settings to change
+ * @spec: Comma-separated pairs; kinds not named keep their weight
+ *
+ * Kinds are functions, structs, typedefs, funcptrs, preprocessor,
+ * initializers and unparsable.
+ *
+ * Return: 0 on success, -1 on a malformed spec
+ */
+int corpus_set_mix(CorpusOptions *opts, const char *spec)
+{
+	const char *p = spec;
+	int i;
+
+	while (*p)
+	{
+		const char *equals = strchr(p, '=');
+		char *end;
+		long weight;
+
+		if (!equals)
+			return (-1);
+		for (i = 0; i < CORPUS_KIND_COUNT; i++)
+			if (strlen(kind_names[i]) == (size_t)(equals - p) &&
+			    strncmp(kind_names[i], p, equals - p) == 0)
+				break;
+		if (i == CORPUS_KIND_COUNT)
+			return (-1);
+
+		weight = strtol(equals + 1, &end, 10);
+		if (end == equals + 1 || weight < 0 || weight > 1000 ||
+		    (*end != ',' && *end != '\0'))
+			return (-1);
+		opts->weights[i] = (int)weight;
+		p = *end == ',' ? end + 1 : end;
+	}
+
+	return (0);
+}
+
+/*
+ * corpus_generate - Generate a source file and its header
+ * @opts: Settings
+ * @source: Set to the source text (caller frees)
+ * @header: Set to the header text if opts->header is set, else NULL
+ *          (caller frees; may be NULL when no header is wanted)
+ *
+ * Return: 0 on success, -1 on allocation failure or if no kind has weight
+ */
+int corpus_generate(const CorpusOptions *opts, char **source, char **header)
+{
+	Generator gen;
+	const char *base;
+	int kind;
+
+	memset(&gen, 0, sizeof(gen));
+	gen.opts = opts;
+	gen.state = opts->seed;
+	*source = NULL;
+	if (header)
+		*header = NULL;
+	if (pick(&gen) < 0 || (opts->header && !header))
+		return (-1);
+
+	put(&gen.source, "#include <stdlib.h>\n");
+	if (opts->header)
+	{
+		base = strrchr(opts->header, '/');
+		put(&gen.source, "#include \"%s\"\n", base ? base + 1 : opts->header);
+		put(&gen.header, "#ifndef ");
+		guard_name(&gen.header, opts->header);
+		put(&gen.header, "\n#define ");
+		guard_name(&gen.header, opts->header);
+		put(&gen.header, "\n\n#include <stddef.h>\n\n");
+	}
+
+	/* Declarations moved to the header count towards the size too */
+	while (gen.source.length + gen.header.length < opts->bytes &&
+	       !gen.source.failed && !gen.item.failed && !gen.header.failed)
+	{
+		kind = pick(&gen);
+		gen.item.length = 0;
+		if (gen.item.text)
+			gen.item.text[0] = '\0';
+
+		switch (kind)
+		{
+		case CORPUS_STRUCT:
+			write_struct(&gen);
+			break;
+		case CORPUS_TYPEDEF:
+			write_typedef(&gen);
+			break;
+		case CORPUS_FUNC_PTR:
+			write_func_ptr(&gen);
+			break;
+		case CORPUS_PREPROCESSOR:
+			write_preprocessor(&gen);
+			break;
+		case CORPUS_INITIALIZER:
+			write_initializer(&gen);
+			break;
+		case CORPUS_UNPARSABLE:
+			write_unparsable(&gen);
+			break;
+		default:
+			write_function(&gen);
+			break;
+		}
+		gen.serial[kind]++;
+
+		if (gen.item.length > 0)
+		{
+			put(&gen.source, "\n");
+			if (chance(&gen, opts->squeeze))
+				squeeze(&gen.source, gen.item.text);
+			else
+				put(&gen.source, "%s", gen.item.text);
+		}
+	}
+
+	if (opts->header)
+		put(&gen.header, "#endif\n");
+
+	free(gen.item.text);
+	if (gen.source.failed || gen.item.failed || gen.header.failed)
+	{
+		free(gen.source.text);
+		free(gen.header.text);
+		return (-1);
+	}
+
+	*source = gen.source.text;
+	if (header)
+		*header = gen.header.text;
+	else
+		free(gen.header.text);
+	return (0);
+}
@@ -0,0 +1,54 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stddef.h>
+
+/*
+ * Top-level items the generator mixes
+ *   CORPUS_FUNCTION     - documented function with nested control flow
+ *   CORPUS_STRUCT       - struct definition (in the header if there is one)
+ *   CORPUS_TYPEDEF      - scalar or struct typedef
+ *   CORPUS_FUNC_PTR     - function pointer typedef and variable
+ *   CORPUS_PREPROCESSOR - #ifdef/#else/#endif block of macros
+ *   CORPUS_INITIALIZER  - array with a giant brace initializer
+ *   CORPUS_UNPARSABLE   - code the parser has to recover from
+ */
+typedef enum {
+	CORPUS_FUNCTION,
+	CORPUS_STRUCT,
+	CORPUS_TYPEDEF,
+	CORPUS_FUNC_PTR,
+	CORPUS_PREPROCESSOR,
+	CORPUS_INITIALIZER,
+	CORPUS_UNPARSABLE,
+	CORPUS_KIND_COUNT
+} CorpusKind;
+
+/*
+ * Generator settings
+ * @seed: Seed; equal settings always give the same text
+ * @bytes: Size the source grows to (it stops at the first item past it)
+ * @weights: Relative frequency of each CorpusKind
+ * @comments: Percentage of items and statements with a comment
+ * @squeeze: Percentage of items written without Betty spacing
+ * @nesting: Deepest nesting of statements in function bodies
+ * @initializer: Elements in each giant initializer
+ * @header: File name of the matching header, or NULL for none
+ */
+typedef struct CorpusOptions {
+	unsigned long seed;
+	size_t bytes;
+	int weights[CORPUS_KIND_COUNT];
+	int comments;
+	int squeeze;
+	int nesting;
+	int initializer;
+	const char *header;
+} CorpusOptions;
+
+void corpus_defaults(CorpusOptions *opts);
+int corpus_preset(CorpusOptions *opts, const char *name);
+int corpus_set_mix(CorpusOptions *opts, const char *spec);
+int corpus_generate(const CorpusOptions *opts, char **source, char **header);
+
+#endif /* CORPUS_H */
@@ -1,74 +1,34 @@
 /*
  * dump_ast.c - Debug tool to print parser AST output
+ *
+ * --format=json|ndjson|bin writes the tree during a single ast_walk()
+ * into a large stdio buffer, without building the output in memory.
  */
 #include "../include/lexer.h"
 #include "../include/parser.h"
 #include "../include/token.h"
+#include "../include/json.h"
 #include "../include/utils.h"
+#include "dump_format.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*
- * node_type_to_string - Convert NodeType to string
+ * print_node - Walker callback printing one node of the AST
  */
-static const char *node_type_to_string(NodeType type)
-{
-	switch (type)
-	{
-	case NODE_PROGRAM: return "PROGRAM";
-	case NODE_FUNCTION: return "FUNCTION";
-	case NODE_VAR_DECL: return "VAR_DECL";
-	case NODE_STRUCT: return "STRUCT";
-	case NODE_TYPEDEF: return "TYPEDEF";
-	case NODE_ENUM: return "ENUM";
-	case NODE_BLOCK: return "BLOCK";
-	case NODE_IF: return "IF";
-	case NODE_WHILE: return "WHILE";
-	case NODE_FOR: return "FOR";
-	case NODE_DO_WHILE: return "DO_WHILE";
-	case NODE_SWITCH: return "SWITCH";
-	case NODE_CASE: return "CASE";
-	case NODE_RETURN: return "RETURN";
-	case NODE_BREAK: return "BREAK";
-	case NODE_CONTINUE: return "CONTINUE";
-	case NODE_GOTO: return "GOTO";
-	case NODE_LABEL: return "LABEL";
-	case NODE_EXPR_STMT: return "EXPR_STMT";
-	case NODE_BINARY: return "BINARY";
-	case NODE_UNARY: return "UNARY";
-	case NODE_CALL: return "CALL";
-	case NODE_LITERAL: return "LITERAL";
-	case NODE_IDENTIFIER: return "IDENTIFIER";
-	case NODE_MEMBER_ACCESS: return "MEMBER_ACCESS";
-	case NODE_ARRAY_ACCESS: return "ARRAY_ACCESS";
-	case NODE_CAST: return "CAST";
-	case NODE_SIZEOF: return "SIZEOF";
-	case NODE_TERNARY: return "TERNARY";
-	case NODE_FUNC_PTR: return "FUNC_PTR";
-	case NODE_PREPROCESSOR: return "PREPROCESSOR";
-	case NODE_TYPE_EXPR: return "TYPE_EXPR";
-	case NODE_INIT_LIST: return "INIT_LIST";
-	case NODE_UNPARSED: return "UNPARSED";
-	default: return "UNKNOWN";
-	}
-}
-
-/*
- * print_ast - Recursively print AST
- */
-static void print_ast(ASTNode *node, int depth)
+static ASTWalkAction print_node(ASTNode *node, int depth, void *ctx)
 {
 	int i;
 
-	if (!node)
-		return;
+	(void)ctx;
 
 	/* Print indentation */
 	for (i = 0; i < depth; i++)
 		printf("  ");
 
 	/* Print node type */
-	printf("%s", node_type_to_string(node->type));
+	printf("%s", ast_node_type_name(node->type));
 
 	/* Print token info if present */
 	if (node->token && node->token->lexeme)
@@ -80,13 +40,219 @@ static void print_ast(ASTNode *node, int depth)
 
 	printf("\n");
 
-	/* Recursively print children */
-	for (i = 0; i < node->child_count; i++)
-		print_ast(node->children[i], depth + 1);
+	return (AST_WALK_CONTINUE);
 }
 
 /*
- * main - Parse a file and print AST
+ * print_ast - Print AST depth-first (pre-order)
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int print_ast(ASTNode *root)
+{
+	ASTVisitor printer = {print_node, NULL, NULL};
+
+	return (ast_walk(root, &printer, 1) < 0 ? -1 : 0);
+}
+
+/*
+ * DumpState - Walker context of the machine-readable formats
+ * @format: Output format
+ * @next_id: Pre-order number of the next node
+ * @parents: Id of the open node at each depth (ndjson)
+ * @parent_capacity: Allocated length of @parents
+ * @first: The next node is the first child of its parent (json)
+ * @failed: Out of memory
+ */
+typedef struct DumpState {
+	DumpFormat format;
+	long next_id;
+	long *parents;
+	int parent_capacity;
+	int first;
+	int failed;
+} DumpState;
+
+/*
+ * write_node_fields - Write the JSON fields common to json and ndjson
+ */
+static void write_node_fields(const ASTNode *node)
+{
+	printf("\"type\":\"%s\"", ast_node_type_name(node->type));
+	if (node->token)
+	{
+		const char *text = node->token->lexeme ?
+			node->token->lexeme : "";
+
+		printf(",\"line\":%d,\"col\":%d,\"offset\":%d,\"text\":",
+		       node->token->line, node->token->column,
+		       node->token->offset);
+		json_write_string(stdout, text, strlen(text));
+	}
+	if (node->token_end > node->token_start)
+		printf(",\"tokens\":[%d,%d]", node->token_start,
+		       node->token_end);
+}
+
+/*
+ * enter_node - Walker callback writing a node before its children
+ */
+static ASTWalkAction enter_node(ASTNode *node, int depth, void *ctx)
+{
+	DumpState *state = ctx;
+	long id = state->next_id++;
+
+	if (state->format == DUMP_BIN)
+	{
+		const Token *t = node->token;
+
+		dump_write_u16(stdout, node->type);
+		dump_write_u32(stdout, depth);
+		dump_write_u32(stdout, node->child_count);
+		dump_write_u32(stdout, t ? t->line : 0);
+		dump_write_u32(stdout, t ? t->column : 0);
+		dump_write_u32(stdout, t ? (unsigned long)t->offset : 0xffffffffUL);
+		dump_write_text(stdout, t ? t->lexeme : NULL);
+	}
+	else if (state->format == DUMP_NDJSON)
+	{
+		if (depth >= state->parent_capacity)
+		{
+			int capacity = state->parent_capacity * 2 + 64;
+			long *parents = realloc(state->parents,
+						sizeof(long) * capacity);
+
+			if (!parents)
+			{
+				state->failed = 1;
+				return (AST_WALK_STOP);
+			}
+			state->parents = parents;
+			state->parent_capacity = capacity;
+		}
+		state->parents[depth] = id;
+		printf("{\"id\":%ld,\"parent\":%ld,\"depth\":%d,", id,
+		       depth > 0 ? state->parents[depth - 1] : -1L, depth);
+		write_node_fields(node);
+		fputs("}\n", stdout);
+	}
+	else
+	{
+		fputs(state->first ? "\n" : ",\n", stdout);
+		putchar('{');
+		write_node_fields(node);
+		fputs(",\"children\":[", stdout);
+		state->first = 1;
+	}
+
+	return (AST_WALK_CONTINUE);
+}
+
+/*
+ * leave_node - Walker callback closing a node (json only)
+ */
+static ASTWalkAction leave_node(ASTNode *node, int depth, void *ctx)
+{
+	DumpState *state = ctx;
+
+	(void)node;
+	(void)depth;
+
+	fputs("]}", stdout);
+	state->first = 0;
+	return (AST_WALK_CONTINUE);
+}
+
+/*
+ * write_ast - Write the AST as json, ndjson or bin
+ * @root: Tree
+ * @path: Input file name
+ * @format: Output format
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int write_ast(ASTNode *root, const char *path, DumpFormat format)
+{
+	DumpState state = {DUMP_JSON, 0, NULL, 0, 1, 0};
+	ASTVisitor writer = {enter_node, NULL, NULL};
+	int i, result;
+
+	state.format = format;
+	writer.ctx = &state;
+	if (format == DUMP_JSON)
+		writer.leave = leave_node;
+
+	dump_begin_output(stdout);
+	if (format == DUMP_BIN)
+	{
+		dump_write_bin_header(stdout, "BFAS", NODE_TYPE_COUNT);
+		for (i = 0; i < NODE_TYPE_COUNT; i++)
+			dump_write_name(stdout, ast_node_type_name(i));
+	}
+	else if (format == DUMP_JSON)
+	{
+		fputs("{\"file\":", stdout);
+		json_write_string(stdout, path, strlen(path));
+		fputs(",\"ast\":[", stdout);
+	}
+
+	result = ast_walk(root, &writer, 1) < 0 || state.failed ? -1 : 0;
+	free(state.parents);
+
+	if (format == DUMP_JSON)
+		fputs("\n]}\n", stdout);
+	if (dump_end_output(stdout) != 0)
+		result = -1;
+	return (result);
+}
+
+/*
+ * count_node - Walker callback tallying nodes by type
+ */
+static ASTWalkAction count_node(ASTNode *node, int depth, void *ctx)
+{
+	unsigned long *counts = ctx;
+
+	(void)depth;
+
+	if ((int)node->type >= 0 && (int)node->type < NODE_TYPE_COUNT)
+		counts[node->type]++;
+
+	return (AST_WALK_CONTINUE);
+}
+
+/*
+ * print_counts - Print the number of nodes of each type
+ *
+ * Return: 0 on success, -1 on error
+ */
+static int print_counts(ASTNode *root)
+{
+	unsigned long counts[NODE_TYPE_COUNT] = {0};
+	unsigned long total = 0;
+	ASTVisitor counter = {count_node, NULL, NULL};
+	int i;
+
+	counter.ctx = counts;
+	if (ast_walk(root, &counter, 1) < 0)
+		return (-1);
+
+	for (i = 0; i < NODE_TYPE_COUNT; i++)
+	{
+		if (counts[i] == 0)
+			continue;
+		printf("%-14s %10lu\n", ast_node_type_name(i), counts[i]);
+		total += counts[i];
+	}
+	printf("%-14s %10lu\n", "total", total);
+	printf("%-14s %10lu\n", "node bytes",
+	       (unsigned long)(total * sizeof(ASTNode)));
+
+	return (0);
+}
+
+/*
+ * main - Parse a file and print AST (or node counts with --counts)
  */
 int main(int argc, char **argv)
 {
@@ -94,17 +260,26 @@ int main(int argc, char **argv)
 	Lexer *lexer;
 	Parser *parser;
 	ASTNode *ast;
+	const char *path;
+	DumpFormat format = DUMP_TEXT;
+	int counts_only = 0, status = 0;
 
-	if (argc != 2)
+	if (argc == 3 && strcmp(argv[1], "--counts") == 0)
+		counts_only = 1;
+	else if (argc == 3 && dump_parse_format(argv[1], &format))
+		;
+	else if (argc != 2)
 	{
-		fprintf(stderr, "Usage: %s <file.c>\n", argv[0]);
+		fprintf(stderr, "Usage: %s [--counts | --format=text|json|ndjson"
+			"|bin] <file.c>\n", argv[0]);
 		return (1);
 	}
+	path = argv[argc - 1];
 
-	source = read_file(argv[1]);
+	source = read_file(path);
 	if (!source)
 	{
-		fprintf(stderr, "Error: Could not read file '%s'\n", argv[1]);
+		fprintf(stderr, "Error: Could not read file '%s'\n", path);
 		return (1);
 	}
 
@@ -134,12 +309,39 @@ int main(int argc, char **argv)
 		return (1);
 	}
 
-	printf("=== AST for %s ===\n\n", argv[1]);
+	/* The lexer keeps its own copy */
+	free(source);
+
+	if (format != DUMP_TEXT)
+	{
+		ast = parser_parse(parser);
+		if (!ast)
+		{
+			fprintf(stderr, "Error: Failed to parse (errors: %d)\n",
+				parser->error_count);
+			status = 1;
+		}
+		else if (write_ast(ast, path, format) < 0)
+		{
+			fprintf(stderr, "Error: Could not write AST\n");
+			status = 1;
+		}
+		ast_node_destroy(ast);
+		parser_destroy(parser);
+		lexer_destroy(lexer);
+		return (status);
+	}
+
+	if (counts_only)
+		printf("=== Node counts for %s ===\n\n", path);
+	else
+		printf("=== AST for %s ===\n\n", path);
 
 	ast = parser_parse(parser);
 	if (ast)
 	{
-		print_ast(ast, 0);
+		if ((counts_only ? print_counts(ast) : print_ast(ast)) < 0)
+			fprintf(stderr, "Error: Out of memory while walking AST\n");
 		ast_node_destroy(ast);
 	}
 	else
@@ -149,7 +351,6 @@ int main(int argc, char **argv)
 
 	parser_destroy(parser);
 	lexer_destroy(lexer);
-	free(source);
 
 	return (0);
 }
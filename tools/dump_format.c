@@ -0,0 +1,116 @@
+/*
+ * dump_format.c - Output formats shared by dump_tokens and dump_ast
+ */
+#include "dump_format.h"
+#include <string.h>
+
+/* Large enough that writes reach the kernel in big blocks */
+#define DUMP_BUFFER_SIZE (1 << 20)
+
+/*
+ * dump_parse_format - Parse a --format=NAME option
+ * @arg: Command line argument
+ * @format: Set to the format on success
+ *
+ * Return: 1 if @arg is a valid --format option, 0 otherwise
+ */
+int dump_parse_format(const char *arg, DumpFormat *format)
+{
+	static const struct {
+		const char *name;
+		DumpFormat format;
+	} names[] = {
+		{"text", DUMP_TEXT}, {"json", DUMP_JSON},
+		{"ndjson", DUMP_NDJSON}, {"bin", DUMP_BIN}
+	};
+	size_t i;
+
+	if (strncmp(arg, "--format=", 9) != 0)
+		return (0);
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+		if (strcmp(arg + 9, names[i].name) == 0)
+		{
+			*format = names[i].format;
+			return (1);
+		}
+	return (0);
+}
+
+/*
+ * dump_begin_output - Give an output stream a large buffer
+ * @fp: Stream (before anything is written to it)
+ */
+void dump_begin_output(FILE *fp)
+{
+	setvbuf(fp, NULL, _IOFBF, DUMP_BUFFER_SIZE);
+}
+
+/*
+ * dump_end_output - Flush an output stream
+ * @fp: Stream
+ *
+ * Return: 0 on success, -1 if a write failed
+ */
+int dump_end_output(FILE *fp)
+{
+	return (fflush(fp) != 0 || ferror(fp) ? -1 : 0);
+}
+
+/*
+ * dump_write_u16 - Write a 16-bit little-endian integer
+ */
+void dump_write_u16(FILE *fp, unsigned int value)
+{
+	putc(value & 0xff, fp);
+	putc((value >> 8) & 0xff, fp);
+}
+
+/*
+ * dump_write_u32 - Write a 32-bit little-endian integer
+ */
+void dump_write_u32(FILE *fp, unsigned long value)
+{
+	putc(value & 0xff, fp);
+	putc((value >> 8) & 0xff, fp);
+	putc((value >> 16) & 0xff, fp);
+	putc((value >> 24) & 0xff, fp);
+}
+
+/*
+ * dump_write_bin_header - Start a binary dump
+ * @fp: Stream
+ * @magic: Four-byte file type
+ * @type_count: Number of type names that follow (written by the caller
+ * with dump_write_name(), in type order)
+ */
+void dump_write_bin_header(FILE *fp, const char *magic, int type_count)
+{
+	fwrite(magic, 1, 4, fp);
+	dump_write_u32(fp, DUMP_BIN_VERSION);
+	dump_write_u16(fp, type_count);
+}
+
+/*
+ * dump_write_name - Write a short name (u8 length, then the bytes)
+ */
+void dump_write_name(FILE *fp, const char *name)
+{
+	size_t length = strlen(name);
+
+	if (length > 255)
+		length = 255;
+	putc((int)length, fp);
+	fwrite(name, 1, length, fp);
+}
+
+/*
+ * dump_write_text - Write a text field (u32 length, then the bytes)
+ * @text: Text, NULL for none
+ */
+void dump_write_text(FILE *fp, const char *text)
+{
+	size_t length = text ? strlen(text) : 0;
+
+	dump_write_u32(fp, length);
+	fwrite(text ? text : "", 1, length, fp);
+}
@@ -0,0 +1,32 @@
+#ifndef DUMP_FORMAT_H
+#define DUMP_FORMAT_H
+
+#include <stdio.h>
+
+/*
+ * Output formats of the dump tools
+ *   DUMP_TEXT   - human-readable listing (the default)
+ *   DUMP_JSON   - one JSON document
+ *   DUMP_NDJSON - one JSON object per line
+ *   DUMP_BIN    - little-endian records, see STATUS.md
+ */
+typedef enum {
+	DUMP_TEXT,
+	DUMP_JSON,
+	DUMP_NDJSON,
+	DUMP_BIN
+} DumpFormat;
+
+#define DUMP_BIN_VERSION 1
+
+int dump_parse_format(const char *arg, DumpFormat *format);
+void dump_begin_output(FILE *fp);
+int dump_end_output(FILE *fp);
+
+void dump_write_u16(FILE *fp, unsigned int value);
+void dump_write_u32(FILE *fp, unsigned long value);
+void dump_write_bin_header(FILE *fp, const char *magic, int type_count);
+void dump_write_name(FILE *fp, const char *name);
+void dump_write_text(FILE *fp, const char *text);
+
+#endif /* DUMP_FORMAT_H */
@@ -1,11 +1,95 @@
 /*
  * dump_tokens.c - Debug tool to print lexer token output
+ *
+ * --format=json|ndjson|bin streams the tokens through lexer_next(), so
+ * memory stays flat however large the input is.
  */
 #include "../include/lexer.h"
 #include "../include/token.h"
+#include "../include/json.h"
 #include "../include/utils.h"
+#include "dump_format.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+/*
+ * write_token - Write one token in a machine-readable format
+ * @t: Token
+ * @index: Position in the stream
+ * @format: DUMP_JSON, DUMP_NDJSON or DUMP_BIN
+ */
+static void write_token(const Token *t, long index, DumpFormat format)
+{
+	const char *text = t->lexeme ? t->lexeme : "";
+
+	if (format == DUMP_BIN)
+	{
+		dump_write_u16(stdout, t->type);
+		dump_write_u32(stdout, t->line);
+		dump_write_u32(stdout, t->column);
+		dump_write_u32(stdout, t->offset);
+		dump_write_text(stdout, t->lexeme);
+		return;
+	}
+
+	if (format == DUMP_JSON)
+		fputs(index > 0 ? ",\n" : "\n", stdout);
+	printf("{\"i\":%ld,\"type\":\"%s\",\"line\":%d,\"col\":%d,"
+	       "\"offset\":%d,\"text\":", index, token_type_to_string(t->type),
+	       t->line, t->column, t->offset);
+	json_write_string(stdout, text, strlen(text));
+	fputs(format == DUMP_NDJSON ? "}\n" : "}", stdout);
+}
+
+/*
+ * stream_tokens - Scan and write tokens one at a time
+ * @lexer: Fresh lexer
+ * @path: Input file name
+ * @format: Output format
+ *
+ * Return: 0 on success, 1 on a lexical or write error
+ */
+static int stream_tokens(Lexer *lexer, const char *path, DumpFormat format)
+{
+	Token *t;
+	long count = 0;
+	int i;
+
+	dump_begin_output(stdout);
+	if (format == DUMP_BIN)
+	{
+		dump_write_bin_header(stdout, "BFTK", TOK_ERROR + 1);
+		for (i = 0; i <= TOK_ERROR; i++)
+			dump_write_name(stdout, token_type_to_string(i));
+	}
+	else if (format == DUMP_JSON)
+	{
+		fputs("{\"file\":", stdout);
+		json_write_string(stdout, path, strlen(path));
+		fputs(",\"tokens\":[", stdout);
+	}
+
+	while ((t = lexer_next(lexer)) != NULL)
+	{
+		write_token(t, count++, format);
+		token_destroy(t);
+	}
+
+	if (format == DUMP_JSON)
+		printf("\n],\"count\":%ld}\n", count);
+	if (dump_end_output(stdout) != 0)
+	{
+		fprintf(stderr, "Error: Could not write output\n");
+		return (1);
+	}
+	if (lexer->error_count > 0)
+	{
+		fprintf(stderr, "Error: Tokenization failed\n");
+		return (1);
+	}
+	return (0);
+}
 
 /*
  * main - Tokenize a file and print all tokens
@@ -17,20 +101,27 @@
 int main(int argc, char **argv)
 {
 	char *source;
+	const char *path;
 	Lexer *lexer;
 	Token **tokens;
-	int count, i;
+	DumpFormat format = DUMP_TEXT;
+	int count, i, status;
 
-	if (argc != 2)
+	if (argc == 3 && dump_parse_format(argv[1], &format))
+		path = argv[2];
+	else if (argc == 2)
+		path = argv[1];
+	else
 	{
-		fprintf(stderr, "Usage: %s <file.c>\n", argv[0]);
+		fprintf(stderr, "Usage: %s [--format=text|json|ndjson|bin]"
+			" <file.c>\n", argv[0]);
 		return (1);
 	}
 
-	source = read_file(argv[1]);
+	source = read_file(path);
 	if (!source)
 	{
-		fprintf(stderr, "Error: Could not read file '%s'\n", argv[1]);
+		fprintf(stderr, "Error: Could not read file '%s'\n", path);
 		return (1);
 	}
 
@@ -42,6 +133,15 @@ int main(int argc, char **argv)
 		return (1);
 	}
 
+	if (format != DUMP_TEXT)
+	{
+		/* The lexer keeps its own copy */
+		free(source);
+		status = stream_tokens(lexer, path, format);
+		lexer_destroy(lexer);
+		return (status);
+	}
+
 	if (lexer_tokenize(lexer) < 0)
 	{
 		fprintf(stderr, "Error: Tokenization failed\n");
@@ -53,7 +153,7 @@ int main(int argc, char **argv)
 	tokens = lexer_get_tokens(lexer);
 	count = lexer_get_token_count(lexer);
 
-	printf("=== Tokens for %s ===\n", argv[1]);
+	printf("=== Tokens for %s ===\n", path);
 	printf("Total tokens: %d\n\n", count);
 
 	for (i = 0; i < count; i++)
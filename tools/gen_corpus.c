@@ -0,0 +1,213 @@
+/*
+ * gen_corpus.c - Write synthetic C sources (see corpus.c)
+ *
+ * One file goes to stdout or -o, with its header at --header; with
+ * --out DIR, --files N source/header pairs go to DIR, file i seeded
+ * with seed + i. The same settings always produce the same bytes.
+ */
+#include "corpus.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define MAX_PATH_LENGTH 4096
+
+/*
+ * usage - Print command line help
+ */
+static void usage(const char *program)
+{
+	fprintf(stderr, "Usage: %s [options]\n"
+		"  --seed N            Seed (default 1)\n"
+		"  --size BYTES        Size of each source, k/M suffixes "
+		"(default 1M)\n"
+		"  --preset NAME       realistic (default) or adversarial\n"
+		"  --mix KIND=W,...    Weights of functions, structs, typedefs,\n"
+		"                      funcptrs, preprocessor, initializers,\n"
+		"                      unparsable\n"
+		"  --comments PCT      Items and statements with comments\n"
+		"  --squeeze PCT       Items written without Betty spacing\n"
+		"  --nesting N         Deepest statement nesting\n"
+		"  --initializer N     Elements per giant initializer\n"
+		"  --header FILE       Write the matching header to FILE\n"
+		"  -o FILE             Write the source to FILE\n"
+		"  --out DIR           Write --files pairs gen_NNN.c/.h to DIR\n"
+		"  --files N           Number of pairs (default 1)\n", program);
+}
+
+/*
+ * parse_size - Parse a byte count with an optional k or M suffix
+ *
+ * Return: Bytes, or 0 if malformed
+ */
+static size_t parse_size(const char *text)
+{
+	char *end;
+	unsigned long value = strtoul(text, &end, 10);
+
+	if (end == text)
+		return (0);
+	if (*end == 'k' || *end == 'K')
+		value *= 1024;
+	else if (*end == 'm' || *end == 'M')
+		value *= 1024 * 1024;
+	else
+		return (*end == '\0' ? value : 0);
+	return (end[1] == '\0' ? value : 0);
+}
+
+/*
+ * write_text - Write text to a file, or stdout for NULL
+ *
+ * Return: 0 on success, -1 on error (reported)
+ */
+static int write_text(const char *path, const char *text)
+{
+	FILE *fp = path ? fopen(path, "w") : stdout;
+	int status = 0;
+
+	if (!fp)
+	{
+		fprintf(stderr, "Error: Could not write '%s'\n", path);
+		return (-1);
+	}
+	if (fputs(text, fp) == EOF)
+		status = -1;
+	if (path ? fclose(fp) != 0 : fflush(fp) != 0)
+		status = -1;
+	if (status != 0)
+		fprintf(stderr, "Error: Could not write '%s'\n",
+			path ? path : "stdout");
+	return (status);
+}
+
+/*
+ * generate - Generate and write one source file and its header
+ * @opts: Settings
+ * @source_path: Destination of the source (NULL for stdout)
+ *
+ * Return: 0 on success, -1 on error (reported)
+ */
+static int generate(const CorpusOptions *opts, const char *source_path)
+{
+	char *source, *header;
+	int status;
+
+	if (corpus_generate(opts, &source, &header) != 0)
+	{
+		fprintf(stderr, "Error: Could not generate the corpus\n");
+		return (-1);
+	}
+
+	status = write_text(source_path, source);
+	if (status == 0 && opts->header)
+		status = write_text(opts->header, header);
+
+	free(source);
+	free(header);
+	return (status);
+}
+
+/*
+ * main - Generate a synthetic corpus
+ * @argc: Argument count
+ * @argv: Options
+ *
+ * Return: 0 on success, 1 on error
+ */
+int main(int argc, char **argv)
+{
+	CorpusOptions opts;
+	const char *output = NULL, *dir = NULL, *preset = NULL, *mix = NULL;
+	char source_path[MAX_PATH_LENGTH], header_path[MAX_PATH_LENGTH];
+	long files = 1;
+	int i;
+
+	corpus_defaults(&opts);
+
+	/* The preset goes first so that the other options refine it */
+	for (i = 1; i + 1 < argc; i++)
+		if (strcmp(argv[i], "--preset") == 0)
+			preset = argv[i + 1];
+	if (preset && corpus_preset(&opts, preset) != 0)
+	{
+		fprintf(stderr, "Error: Unknown preset '%s'\n", preset);
+		return (1);
+	}
+
+	for (i = 1; i < argc; i++)
+	{
+		const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (!value)
+		{
+			usage(argv[0]);
+			return (1);
+		}
+		if (strcmp(argv[i], "--seed") == 0)
+			opts.seed = strtoul(value, NULL, 10);
+		else if (strcmp(argv[i], "--size") == 0)
+			opts.bytes = parse_size(value);
+		else if (strcmp(argv[i], "--preset") == 0)
+			preset = value;  /* Applied above */
+		else if (strcmp(argv[i], "--mix") == 0)
+			mix = value;
+		else if (strcmp(argv[i], "--comments") == 0)
+			opts.comments = atoi(value);
+		else if (strcmp(argv[i], "--squeeze") == 0)
+			opts.squeeze = atoi(value);
+		else if (strcmp(argv[i], "--nesting") == 0)
+			opts.nesting = atoi(value);
+		else if (strcmp(argv[i], "--initializer") == 0)
+			opts.initializer = atoi(value);
+		else if (strcmp(argv[i], "--header") == 0)
+			opts.header = value;
+		else if (strcmp(argv[i], "-o") == 0)
+			output = value;
+		else if (strcmp(argv[i], "--out") == 0)
+			dir = value;
+		else if (strcmp(argv[i], "--files") == 0)
+			files = atol(value);
+		else
+		{
+			usage(argv[0]);
+			return (1);
+		}
+		i++;
+	}
+
+	if ((mix && corpus_set_mix(&opts, mix) != 0) || opts.bytes == 0 ||
+	    files < 1 || opts.comments < 0 || opts.squeeze < 0 ||
+	    opts.nesting < 0 || opts.initializer < 1 ||
+	    (dir && (output || opts.header)) || (!dir && files != 1))
+	{
+		usage(argv[0]);
+		return (1);
+	}
+
+	if (!dir)
+		return (generate(&opts, output) == 0 ? 0 : 1);
+
+	if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+	{
+		fprintf(stderr, "Error: Could not create '%s'\n", dir);
+		return (1);
+	}
+	for (i = 0; i < files; i++)
+	{
+		CorpusOptions file_opts = opts;
+
+		snprintf(source_path, sizeof(source_path), "%s/gen_%03d.c",
+			 dir, i);
+		snprintf(header_path, sizeof(header_path), "%s/gen_%03d.h",
+			 dir, i);
+		file_opts.seed = opts.seed + i;
+		file_opts.header = header_path;
+		if (generate(&file_opts, source_path) != 0)
+			return (1);
+	}
+
+	return (0);
+}
@@ -0,0 +1,95 @@
+/*
+ * gen_deep.c - Write a C source nested DEPTH levels deep (make test-deep)
+ *
+ * Shapes: else-if (a chain of DEPTH branches), if (nested if blocks),
+ * block (nested braces), paren (nested parentheses), unary (a chain of
+ * unary minus) and init (nested initializer braces). The source goes to
+ * stdout.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * repeat - Write @text @count times
+ */
+static void repeat(const char *text, long count)
+{
+	long i;
+
+	for (i = 0; i < count; i++)
+		fputs(text, stdout);
+}
+
+/*
+ * main - Write the source
+ * @argc: Argument count
+ * @argv: SHAPE DEPTH
+ *
+ * Return: 0 on success, 1 on error
+ */
+int main(int argc, char **argv)
+{
+	const char *shape = argc == 3 ? argv[1] : "";
+	long depth = argc == 3 ? atol(argv[2]) : 0;
+	long i;
+
+	if (depth < 1)
+	{
+		fprintf(stderr, "Usage: %s else-if|if|block|paren|unary|init "
+			"DEPTH\n", argv[0]);
+		return (1);
+	}
+
+	if (strcmp(shape, "init") == 0)
+	{
+		fputs("int table[] = ", stdout);
+		repeat("{", depth);
+		fputs("1", stdout);
+		repeat("}", depth);
+		fputs(";\n", stdout);
+		return (fflush(stdout) == 0 ? 0 : 1);
+	}
+
+	fputs("int deep(int x)\n{\n", stdout);
+	if (strcmp(shape, "else-if") == 0)
+	{
+		fputs("\tif (x == 0)\n\t\treturn (0);\n", stdout);
+		for (i = 1; i < depth; i++)
+			printf("\telse if (x == %ld)\n\t\treturn (%ld);\n", i, i);
+	}
+	else if (strcmp(shape, "if") == 0)
+	{
+		repeat("if (x) {\n", depth);
+		fputs("x--;\n", stdout);
+		repeat("}\n", depth);
+	}
+	else if (strcmp(shape, "block") == 0)
+	{
+		repeat("{\n", depth);
+		fputs("x--;\n", stdout);
+		repeat("}\n", depth);
+	}
+	else if (strcmp(shape, "paren") == 0)
+	{
+		fputs("\tx = ", stdout);
+		repeat("(", depth);
+		fputs("x", stdout);
+		repeat(")", depth);
+		fputs(";\n", stdout);
+	}
+	else if (strcmp(shape, "unary") == 0)
+	{
+		fputs("\tx = ", stdout);
+		repeat("- ", depth);
+		fputs("x;\n", stdout);
+	}
+	else
+	{
+		fprintf(stderr, "Error: Unknown shape '%s'\n", shape);
+		return (1);
+	}
+	fputs("\treturn (x);\n}\n", stdout);
+
+	return (fflush(stdout) == 0 ? 0 : 1);
+}
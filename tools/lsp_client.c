@@ -0,0 +1,497 @@
+/*
+ * lsp_client.c - Scripted language server client for testing --lsp
+ *
+ * Runs a server command and feeds it a session read from stdin, one
+ * message per line; every message the server sends is printed on its
+ * own line. Lines are:
+ *
+ *   {...}                    JSON-RPC message, sent as is (a request
+ *                            waits for its response)
+ *   @open URI FILE           didOpen with the contents of FILE
+ *   @replace URI FILE        didChange replacing the text with FILE
+ *   @format ID URI           formatting request; the returned edits are
+ *                            applied to the file last sent for URI and
+ *                            must give what the server command prints
+ *                            for that file
+ *   # ...                    comment
+ *
+ * Exit status is 0 if every check passed and the server exited with 0.
+ */
+#define _GNU_SOURCE
+#include "../include/json.h"
+#include "../include/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_LINE 4096
+#define MAX_DOCUMENTS 16
+
+/*
+ * Client state
+ * Documents are tracked by the file last sent for them, so formatting
+ * results can be checked against the command line formatter.
+ */
+typedef struct {
+	FILE *to_server;
+	FILE *from_server;
+	char **server_argv;
+
+	char *uris[MAX_DOCUMENTS];
+	char *files[MAX_DOCUMENTS];
+	int document_count;
+
+	int failures;
+} Client;
+
+/*
+ * start_server - Run the server with pipes on its stdin and stdout
+ * @client: Client state
+ * @argv: Server command, NULL-terminated
+ *
+ * Return: Process id, or -1 on error
+ */
+static pid_t start_server(Client *client, char **argv)
+{
+	int to_child[2], from_child[2];
+	pid_t pid;
+
+	if (pipe(to_child) != 0 || pipe(from_child) != 0)
+		return (-1);
+
+	pid = fork();
+	if (pid < 0)
+		return (-1);
+	if (pid == 0)
+	{
+		dup2(to_child[0], STDIN_FILENO);
+		dup2(from_child[1], STDOUT_FILENO);
+		close(to_child[0]);
+		close(to_child[1]);
+		close(from_child[0]);
+		close(from_child[1]);
+		execvp(argv[0], argv);
+		perror(argv[0]);
+		_exit(127);
+	}
+
+	close(to_child[0]);
+	close(from_child[1]);
+	client->to_server = fdopen(to_child[1], "w");
+	client->from_server = fdopen(from_child[0], "r");
+
+	return (client->to_server && client->from_server ? pid : -1);
+}
+
+/*
+ * send_text - Send one message to the server
+ * @client: Client state
+ * @body: JSON text
+ * @length: Length of @body
+ */
+static void send_text(Client *client, const char *body, size_t length)
+{
+	fprintf(client->to_server, "Content-Length: %lu\r\n\r\n",
+		(unsigned long)length);
+	fwrite(body, 1, length, client->to_server);
+	fflush(client->to_server);
+}
+
+/*
+ * receive - Read and print the next message from the server
+ * @client: Client state
+ *
+ * Return: Parsed message (caller frees), or NULL at end of output
+ */
+static JsonValue *receive(Client *client)
+{
+	char line[MAX_LINE];
+	long length = -1;
+	char *body;
+	JsonValue *message;
+
+	while (fgets(line, sizeof(line), client->from_server))
+	{
+		if (strcmp(line, "\r\n") == 0)
+			break;
+		if (strncasecmp(line, "Content-Length:", 15) == 0)
+			length = strtol(line + 15, NULL, 10);
+	}
+	if (length < 0)
+		return (NULL);
+
+	body = malloc(length + 1);
+	if (!body || fread(body, 1, length, client->from_server) !=
+	    (size_t)length)
+	{
+		free(body);
+		return (NULL);
+	}
+	body[length] = '\0';
+	printf("%s\n", body);
+	fflush(stdout);
+
+	message = json_parse(body, length);
+	free(body);
+
+	return (message);
+}
+
+/*
+ * wait_response - Print messages until the response to a request
+ * @client: Client state
+ * @id: Request id
+ *
+ * Return: The response (caller frees), or NULL at end of output
+ */
+static JsonValue *wait_response(Client *client, long id)
+{
+	JsonValue *message;
+
+	while ((message = receive(client)) != NULL)
+	{
+		if (!json_get(message, "method") &&
+		    json_long(json_get(message, "id"), -1) == id)
+			return (message);
+		json_free(message);
+	}
+
+	return (NULL);
+}
+
+/*
+ * position_offset - Convert an LSP position to a byte offset
+ * @text: Document text
+ * @position: {"line":N,"character":N} in UTF-16 units
+ *
+ * Return: Byte offset
+ */
+static size_t position_offset(const char *text, const JsonValue *position)
+{
+	long line = json_long(json_get(position, "line"), 0);
+	long character = json_long(json_get(position, "character"), 0);
+	const char *p = text;
+
+	while (line > 0 && *p)
+		if (*p++ == '\n')
+			line--;
+
+	while (character > 0 && *p && *p != '\n')
+	{
+		unsigned char c = *p;
+		int length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+
+		character -= length == 4 ? 2 : 1;
+		p += length;
+	}
+
+	return (p - text);
+}
+
+/*
+ * apply_edits - Apply a TextEdit[] result to a text
+ * @text: Original text
+ * @edits: Edits in increasing order
+ *
+ * Return: New text (caller frees), or NULL on error
+ */
+static char *apply_edits(const char *text, const JsonValue *edits)
+{
+	char *result = NULL;
+	size_t size = 0, done = 0;
+	FILE *fp = open_memstream(&result, &size);
+	int i;
+
+	if (!fp)
+		return (NULL);
+
+	for (i = 0; edits && i < edits->count; i++)
+	{
+		const JsonValue *edit = json_index(edits, i);
+		const JsonValue *range = json_get(edit, "range");
+		const JsonValue *insert = json_get(edit, "newText");
+		size_t start = position_offset(text, json_get(range, "start"));
+		size_t end = position_offset(text, json_get(range, "end"));
+
+		if (start < done || end < start || !json_string(insert))
+		{
+			fclose(fp);
+			free(result);
+			return (NULL);
+		}
+		fwrite(text + done, 1, start - done, fp);
+		fwrite(insert->string, 1, insert->length, fp);
+		done = end;
+	}
+	fputs(text + done, fp);
+	fclose(fp);
+
+	return (result);
+}
+
+/*
+ * command_output - Run the server command on a file
+ * @client: Client state
+ * @file: File to format
+ *
+ * The server command is run without its last argument (the option that
+ * selects server mode), followed by @file.
+ *
+ * Return: Output (caller frees), or NULL on error
+ */
+static char *command_output(Client *client, const char *file)
+{
+	char *output = NULL;
+	size_t size = 0;
+	FILE *fp = open_memstream(&output, &size);
+	FILE *pipe_fp;
+	char buffer[MAX_LINE];
+	char **arg;
+	size_t n;
+
+	if (!fp)
+		return (NULL);
+
+	for (arg = client->server_argv; arg[1]; arg++)
+		fprintf(fp, "'%s' ", *arg);
+	fprintf(fp, "'%s'", file);
+	fclose(fp);
+
+	pipe_fp = popen(output, "r");
+	free(output);
+	if (!pipe_fp)
+		return (NULL);
+
+	output = NULL;
+	fp = open_memstream(&output, &size);
+	while ((n = fread(buffer, 1, sizeof(buffer), pipe_fp)) > 0)
+		fwrite(buffer, 1, n, fp);
+	fclose(fp);
+	if (pclose(pipe_fp) != 0)
+	{
+		free(output);
+		return (NULL);
+	}
+
+	return (output);
+}
+
+/*
+ * find_file - File last sent for a document
+ * @client: Client state
+ * @uri: Document URI
+ *
+ * Return: Slot index, or -1 if the document was never sent
+ */
+static int find_file(Client *client, const char *uri)
+{
+	int i;
+
+	for (i = 0; i < client->document_count; i++)
+		if (strcmp(client->uris[i], uri) == 0)
+			return (i);
+
+	return (-1);
+}
+
+/*
+ * send_file - Send a file as a document's text
+ * @client: Client state
+ * @uri: Document URI
+ * @file: File holding the text
+ * @open: 1 for didOpen, 0 for a whole-text didChange
+ */
+static void send_file(Client *client, const char *uri, const char *file,
+		      int open)
+{
+	char *text = read_file(file);
+	char *body = NULL;
+	size_t size = 0;
+	FILE *fp;
+	int slot = find_file(client, uri);
+
+	if (!text)
+	{
+		fprintf(stderr, "lsp_client: cannot read '%s'\n", file);
+		client->failures++;
+		return;
+	}
+
+	if (slot < 0 && client->document_count < MAX_DOCUMENTS)
+	{
+		slot = client->document_count++;
+		client->uris[slot] = strdup(uri);
+		client->files[slot] = NULL;
+	}
+	if (slot >= 0)
+	{
+		free(client->files[slot]);
+		client->files[slot] = strdup(file);
+	}
+
+	fp = open_memstream(&body, &size);
+	if (fp)
+	{
+		fputs("{\"jsonrpc\":\"2.0\",\"method\":", fp);
+		fputs(open ? "\"textDocument/didOpen\"" :
+		      "\"textDocument/didChange\"", fp);
+		fputs(",\"params\":{\"textDocument\":{\"uri\":", fp);
+		json_write_string(fp, uri, strlen(uri));
+		fputs(open ? ",\"languageId\":\"c\",\"version\":1,\"text\":" :
+		      "},\"contentChanges\":[{\"text\":", fp);
+		json_write_string(fp, text, strlen(text));
+		fputs(open ? "}}}" : "}]}}", fp);
+		fclose(fp);
+		send_text(client, body, size);
+	}
+	free(body);
+	free(text);
+}
+
+/*
+ * check_format - Request formatting and check the edits
+ * @client: Client state
+ * @id: Request id
+ * @uri: Document URI
+ */
+static void check_format(Client *client, long id, const char *uri)
+{
+	int slot = find_file(client, uri);
+	char *body = NULL, *text, *expected, *formatted = NULL;
+	size_t size = 0;
+	FILE *fp = open_memstream(&body, &size);
+	JsonValue *response;
+
+	if (!fp)
+		return;
+	fprintf(fp, "{\"jsonrpc\":\"2.0\",\"id\":%ld,\"method\":"
+		"\"textDocument/formatting\",\"params\":{\"textDocument\":"
+		"{\"uri\":", id);
+	json_write_string(fp, uri, strlen(uri));
+	fputs("},\"options\":{\"tabSize\":8,\"insertSpaces\":false}}}", fp);
+	fclose(fp);
+	send_text(client, body, size);
+	free(body);
+
+	response = wait_response(client, id);
+	if (slot < 0 || !response)
+	{
+		fprintf(stderr, "lsp_client: no formatting result for %s\n",
+			uri);
+		client->failures++;
+		json_free(response);
+		return;
+	}
+
+	text = read_file(client->files[slot]);
+	expected = command_output(client, client->files[slot]);
+	if (text)
+		formatted = apply_edits(text, json_get(response, "result"));
+
+	if (!formatted || !expected || strcmp(formatted, expected) != 0)
+	{
+		fprintf(stderr, "lsp_client: edits for %s do not give the "
+			"formatted text of %s\n", uri, client->files[slot]);
+		client->failures++;
+	}
+
+	free(formatted);
+	free(expected);
+	free(text);
+	json_free(response);
+}
+
+/*
+ * run_line - Run one session line
+ * @client: Client state
+ * @line: Line without its newline
+ */
+static void run_line(Client *client, char *line)
+{
+	char uri[MAX_LINE], file[MAX_LINE];
+	long id;
+
+	if (line[0] == '\0' || line[0] == '#')
+		return;
+
+	if (sscanf(line, "@open %s %s", uri, file) == 2)
+		send_file(client, uri, file, 1);
+	else if (sscanf(line, "@replace %s %s", uri, file) == 2)
+		send_file(client, uri, file, 0);
+	else if (sscanf(line, "@format %ld %s", &id, uri) == 2)
+		check_format(client, id, uri);
+	else
+	{
+		JsonValue *message = json_parse(line, strlen(line));
+		const JsonValue *request_id = json_get(message, "id");
+
+		send_text(client, line, strlen(line));
+		if (request_id)
+			json_free(wait_response(client,
+				json_long(request_id, -1)));
+		json_free(message);
+	}
+}
+
+/*
+ * main - Run a session against a server
+ * @argc: Argument count
+ * @argv: Server command (e.g. ./betty-fmt --lsp)
+ *
+ * Return: 0 if the session passed, 1 otherwise
+ */
+int main(int argc, char **argv)
+{
+	Client client;
+	char line[1 << 16];
+	JsonValue *message;
+	pid_t pid;
+	int status, i;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <server> [args...] < session\n",
+			argv[0]);
+		return (1);
+	}
+
+	memset(&client, 0, sizeof(client));
+	client.server_argv = argv + 1;
+	pid = start_server(&client, argv + 1);
+	if (pid < 0)
+	{
+		perror("lsp_client");
+		return (1);
+	}
+
+	while (fgets(line, sizeof(line), stdin))
+	{
+		line[strcspn(line, "\r\n")] = '\0';
+		run_line(&client, line);
+	}
+
+	/* Print what is left, then wait for the server to exit */
+	fclose(client.to_server);
+	while ((message = receive(&client)) != NULL)
+		json_free(message);
+	fclose(client.from_server);
+
+	if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+	    WEXITSTATUS(status) != 0)
+	{
+		fprintf(stderr, "lsp_client: server did not exit cleanly\n");
+		client.failures++;
+	}
+
+	for (i = 0; i < client.document_count; i++)
+	{
+		free(client.uris[i]);
+		free(client.files[i]);
+	}
+
+	return (client.failures ? 1 : 0);
+}